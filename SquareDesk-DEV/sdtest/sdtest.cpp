@@ -0,0 +1,66 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "testeditdistance.h"
+#include "testfilenameparser.h"
+#include "testsongsettingsmirror.h"
+#include "testsqlstatementcache.h"
+#include "testsongsearchindex.h"
+
+#include <QCoreApplication>
+
+#include <QtTest/QtTest>
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    int err = 0;
+    {
+        TestEditDistance testEditDistance;
+        err = qMax(err, QTest::qExec(&testEditDistance, app.arguments()));
+    }
+    {
+        TestFilenameParser testFilenameParser;
+        err = qMax(err, QTest::qExec(&testFilenameParser, app.arguments()));
+    }
+    {
+        TestSongSettingsMirror testSongSettingsMirror;
+        err = qMax(err, QTest::qExec(&testSongSettingsMirror, app.arguments()));
+    }
+    {
+        TestSqlStatementCache testSqlStatementCache;
+        err = qMax(err, QTest::qExec(&testSqlStatementCache, app.arguments()));
+    }
+    {
+        TestSongSearchIndex testSongSearchIndex;
+        err = qMax(err, QTest::qExec(&testSongSearchIndex, app.arguments()));
+    }
+    if (err == 0) {
+        qDebug("All tests executed successfully");
+    } else {
+        qWarning("There were errors in some of the tests above.");
+    }
+    return err;
+}
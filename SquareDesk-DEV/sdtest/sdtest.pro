@@ -0,0 +1,49 @@
+# Unit tests and micro-benchmarks for the parts of SquareDesk that only need QtCore (and QtSql).
+#   Laid out like quazip/qztest; not part of the SquareDesk.pro build.  To run it:
+#     qmake sdtest.pro && make && ./sdtest
+#   and for just the benchmarks, e.g.:  ./sdtest -iterations 100 benchmarkFuzzyWordEqual
+TEMPLATE = app
+QT -= gui
+QT += sql
+CONFIG += testlib
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += c++17
+DEPENDPATH += .
+INCLUDEPATH += .
+
+# the code under test is compiled straight from the app's sources
+INCLUDEPATH += $$PWD/../test123
+DEPENDPATH += $$PWD/../test123
+
+# Input
+HEADERS += testeditdistance.h \
+    testfilenameparser.h \
+    testsongsettingsmirror.h \
+    testsqlstatementcache.h \
+    testsongsearchindex.h \
+    ../test123/editdistance.h \
+    ../test123/filenameparser.h \
+    ../test123/common_enums.h \
+    ../test123/songsettings.h \
+    ../test123/songsettingswriter.h \
+    ../test123/songsettingsmirror.h \
+    ../test123/sqlstatementcache.h \
+    ../test123/songsearchindex.h
+
+SOURCES += sdtest.cpp \
+    testeditdistance.cpp \
+    testfilenameparser.cpp \
+    testsongsettingsmirror.cpp \
+    testsqlstatementcache.cpp \
+    testsongsearchindex.cpp \
+    ../test123/editdistance.cpp \
+    ../test123/filenameparser.cpp \
+    ../test123/songsettings.cpp \
+    ../test123/songsettingswriter.cpp \
+    ../test123/songsettingsmirror.cpp \
+    ../test123/sqlstatementcache.cpp \
+    ../test123/songsearchindex.cpp
+
+OBJECTS_DIR = .obj
+MOC_DIR = .moc
@@ -0,0 +1,227 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "testeditdistance.h"
+
+#include "editdistance.h"
+
+#include <QRandomGenerator>
+#include <QVector>
+
+#include <utility>
+
+#include <QtTest/QtTest>
+
+// The full dynamic programming matrix that MP3FilenameVsCuesheetnameScore() used before EditDistance,
+//   kept here as the reference that EditDistance has to agree with.
+static int referenceDistance(const QString &s1, const QString &s2)
+{
+    const int len1 = s1.size();
+    const int len2 = s2.size();
+
+    QVector<QVector<int>> d(len1 + 1, QVector<int>(len2 + 1));
+
+    for (int i = 0; i <= len1; i++)
+        d[i][0] = i;
+
+    for (int j = 0; j <= len2; j++)
+        d[0][j] = j;
+
+    for (int i = 1; i <= len1; i++) {
+        for (int j = 1; j <= len2; j++) {
+            int cost = (s1[i-1].toLower() == s2[j-1].toLower()) ? 0 : 1;
+
+            d[i][j] = qMin(qMin(
+                d[i-1][j] + 1,     // deletion
+                d[i][j-1] + 1),    // insertion
+                d[i-1][j-1] + cost // substitution
+            );
+
+            // Check for transposition (adjacent character swap)
+            if (i > 1 && j > 1 &&
+                s1[i-1].toLower() == s2[j-2].toLower() &&
+                s1[i-2].toLower() == s2[j-1].toLower()) {
+                d[i][j] = qMin(d[i][j], d[i-2][j-2] + cost);
+            }
+        }
+    }
+    return d[len1][len2];
+}
+
+// ...and the old fuzzyWordEqual() around it, transposition loop and all
+static bool referenceFuzzyWordEqual(const QString &w1, const QString &w2)
+{
+    if (w1.compare(w2, Qt::CaseInsensitive) == 0)
+        return true;
+
+    int lenDiff = w1.length() - w2.length();
+    if (qAbs(lenDiff) > 1)
+        return false;
+
+    if (w1.length() == w2.length() && w1.length() >= 2) {
+        for (int i = 0; i < w1.length() - 1; i++) {
+            QString transposed = w1;
+            QChar temp = transposed[i];
+            transposed[i] = transposed[i+1];
+            transposed[i+1] = temp;
+
+            if (transposed.compare(w2, Qt::CaseInsensitive) == 0)
+                return true;
+        }
+    }
+
+    return referenceDistance(w1, w2) <= 1;
+}
+
+// the new one, as in MP3FilenameVsCuesheetnameScore()
+static bool newFuzzyWordEqual(const QString &w1, const QString &w2)
+{
+    if (w1.compare(w2, Qt::CaseInsensitive) == 0)
+        return true;
+    if (qAbs(w1.length() - w2.length()) > 1)
+        return false;
+    return EditDistance::forPattern(w1).distance(w2) <= 1;
+}
+
+// A small alphabet (with both cases, and some non-ASCII letters), so that random words are often
+//   within an edit or two of each other, plus one-edit mutations of each, so that every kind of
+//   edit is well covered.  Fixed seed: the same corpus every run.
+static QString randomWord(QRandomGenerator &rng, int minLength, int maxLength)
+{
+    static const QString alphabet = QString::fromUtf8("abcdeABCDEéÉüß'");
+    int length = minLength + static_cast<int>(rng.bounded(maxLength - minLength + 1));
+    QString w;
+    for (int i = 0; i < length; i++) {
+        w += alphabet[static_cast<int>(rng.bounded(alphabet.size()))];
+    }
+    return w;
+}
+
+static QString mutate(QRandomGenerator &rng, QString w)
+{
+    static const QString alphabet = QString::fromUtf8("abcdeABCDEéÉüß'");
+    int pos = w.isEmpty() ? 0 : static_cast<int>(rng.bounded(w.size()));
+    QChar c = alphabet[static_cast<int>(rng.bounded(alphabet.size()))];
+    switch (rng.bounded(4)) {
+    case 0: if (!w.isEmpty()) { w[pos] = c; } break;                         // substitute
+    case 1: w.insert(pos, c); break;                                         // insert
+    case 2: if (!w.isEmpty()) { w.remove(pos, 1); } break;                   // delete
+    default: if (pos + 1 < w.size()) { std::swap(w[pos], w[pos + 1]); } break;  // transpose
+    }
+    return w;
+}
+
+void TestEditDistance::initTestCase()
+{
+    QRandomGenerator rng(1669);
+    for (int i = 0; i < 300; i++) {
+        QString w = randomWord(rng, 0, 10);
+        corpus << w << mutate(rng, w) << mutate(rng, mutate(rng, w));
+    }
+    for (int i = 0; i < 20; i++) {
+        QString w = randomWord(rng, 60, 70);  // either side of the 64-bit limit (the slowDistance() path)
+        corpus << w << mutate(rng, w);
+    }
+
+    // benchmark: a song's title words vs. the words of a library's worth of cuesheet names
+    static const char *titleWords[] = { "Blue", "Moon", "Kentucky", "Margaritaville", "Sweet", "Caroline",
+                                        "Rhythm", "Square", "Dance", "Tonight", "Riverboat", "Sunshine" };
+    for (const char *w : titleWords) {
+        songWords << QString(w);
+    }
+    for (int i = 0; i < 5000; i++) {
+        cuesheetWords << (rng.bounded(4) == 0 ? mutate(rng, songWords[static_cast<int>(rng.bounded(songWords.size()))])
+                                              : randomWord(rng, 3, 12));
+    }
+}
+
+void TestEditDistance::sameAsDynamicProgramming()
+{
+    for (const QString &a : std::as_const(corpus)) {
+        EditDistance ed(a);
+        for (const QString &b : std::as_const(corpus)) {
+            int expected = referenceDistance(a, b);
+            if (ed.distance(b) != expected || EditDistance::distance(a, b) != expected) {
+                QFAIL(qPrintable(QString("'%1' vs '%2': expected %3, got %4").arg(a, b).arg(expected).arg(ed.distance(b))));
+            }
+        }
+    }
+}
+
+void TestEditDistance::fuzzyWordEqual()
+{
+    for (const QString &a : std::as_const(corpus)) {
+        for (const QString &b : std::as_const(corpus)) {
+            if (newFuzzyWordEqual(a, b) != referenceFuzzyWordEqual(a, b)) {
+                QFAIL(qPrintable(QString("'%1' vs '%2'").arg(a, b)));
+            }
+        }
+    }
+}
+
+void TestEditDistance::forPattern()
+{
+    QCOMPARE(EditDistance::forPattern("Kentucky").distance("kentuckey"), 1);
+    QCOMPARE(EditDistance::forPattern("Kentucky").distance("Kentukcy"), 1);   // the cached one again
+    QCOMPARE(EditDistance::forPattern("Moon").distance("moon"), 0);
+    for (int i = 0; i < 2000; i++) {   // more than the cache keeps, so it gets cleared along the way
+        QString w = QString::number(i);
+        QCOMPARE(EditDistance::forPattern(w).distance(w + "x"), 1);
+    }
+}
+
+void TestEditDistance::benchmarkFuzzyWordEqual_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("full DP matrix (old)") << 0;
+    QTest::newRow("EditDistance::distance(a, b)") << 1;
+    QTest::newRow("EditDistance::forPattern(a)") << 2;
+}
+
+// every song word against every cuesheet word, the way the scorer sees them
+void TestEditDistance::benchmarkFuzzyWordEqual()
+{
+    QFETCH(int, method);
+    int matches = 0;
+    QBENCHMARK {
+        matches = 0;
+        for (const QString &cuesheetWord : std::as_const(cuesheetWords)) {
+            for (const QString &songWord : std::as_const(songWords)) {
+                bool equal;
+                if (method == 0) {
+                    equal = referenceFuzzyWordEqual(songWord, cuesheetWord);
+                } else if (qAbs(songWord.length() - cuesheetWord.length()) > 1) {
+                    equal = false;
+                } else if (method == 1) {
+                    equal = EditDistance::distance(songWord, cuesheetWord) <= 1;
+                } else {
+                    equal = EditDistance::forPattern(songWord).distance(cuesheetWord) <= 1;
+                }
+                matches += equal ? 1 : 0;
+            }
+        }
+    }
+    QVERIFY(matches > 0);
+}
@@ -0,0 +1,47 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SDTEST_TESTEDITDISTANCE_H
+#define SDTEST_TESTEDITDISTANCE_H
+
+#include <QObject>
+#include <QStringList>
+
+class TestEditDistance: public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void sameAsDynamicProgramming();    // every pair of the generated corpus
+    void fuzzyWordEqual();              // ...and the <= 1 test that the cuesheet scorer makes
+    void forPattern();
+    void benchmarkFuzzyWordEqual_data();
+    void benchmarkFuzzyWordEqual();
+private:
+    QStringList corpus;
+    QStringList songWords;      // the "query" side of the benchmark
+    QStringList cuesheetWords;  // ...and the library side
+};
+
+#endif // SDTEST_TESTEDITDISTANCE_H
@@ -0,0 +1,312 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "testfilenameparser.h"
+
+#include "filenameparser.h"
+
+#include <QStringList>
+
+#include <QtTest/QtTest>
+
+// What parseSongFilename() (the regex cascade behind MainWindow::breakFilenameIntoParts()) returns
+//   today, for each filename format pref.  This pins down the current behaviour, quirks included
+//   (e.g. the FOURBARB/CIRCLED/JAYBARKAY placeholders that end up in a name-first title), so that
+//   any faster replacement for the cascade can be checked against the same table.
+void TestFilenameParser::parse_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<QString>("filename");
+    QTest::addColumn<bool>("foundParts");
+    QTest::addColumn<QString>("label");
+    QTest::addColumn<QString>("labelnum");
+    QTest::addColumn<QString>("labelnum_extra");
+    QTest::addColumn<QString>("title");
+    QTest::addColumn<QString>("shortTitle");
+
+    // SongFilenameLabelDashName
+    QTest::newRow("1: ARROW 946 - Studio 54") << int(SongFilenameLabelDashName) << QString("ARROW 946 - Studio 54") << true
+        << QString("ARROW") << QString("946") << QString("") << QString("Studio 54") << QString("Studio 54");
+    QTest::newRow("1: Play It Cool - BS 2534a") << int(SongFilenameLabelDashName) << QString("Play It Cool - BS 2534a") << true
+        << QString("Play It Cool") << QString("") << QString("") << QString("BS 2534a") << QString("BS 2534a");
+    QTest::newRow("1: Strings Galore - Chaparral 117b") << int(SongFilenameLabelDashName) << QString("Strings Galore - Chaparral 117b") << true
+        << QString("Strings Galore") << QString("") << QString("") << QString("Chaparral 117b") << QString("Chaparral 117b");
+    QTest::newRow("1: OGRMP3 04 - Addam's Family") << int(SongFilenameLabelDashName) << QString("OGRMP3 04 - Addam's Family") << true
+        << QString("OGRMP3") << QString("04") << QString("") << QString("Addam's Family") << QString("Addam's Family");
+    QTest::newRow("1: 4-bar-b 123 - Chicken Plucker") << int(SongFilenameLabelDashName) << QString("4-bar-b 123 - Chicken Plucker") << true
+        << QString("4-bar-b 123") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("1: 4-Bar-B 6154 - Hoedown Throwdown") << int(SongFilenameLabelDashName) << QString("4-Bar-B 6154 - Hoedown Throwdown") << true
+        << QString("4-Bar-B 6154") << QString("") << QString("") << QString("Hoedown Throwdown") << QString("Hoedown Throwdown");
+    QTest::newRow("1: Circle-D 220 - Some Song") << int(SongFilenameLabelDashName) << QString("Circle-D 220 - Some Song") << true
+        << QString("Circle-D 220") << QString("") << QString("") << QString("Some Song") << QString("Some Song");
+    QTest::newRow("1: Jay-Bar-Kay 101 - Cowboy Boogie") << int(SongFilenameLabelDashName) << QString("Jay-Bar-Kay 101 - Cowboy Boogie") << true
+        << QString("Jay-Bar-Kay 101") << QString("") << QString("") << QString("Cowboy Boogie") << QString("Cowboy Boogie");
+    QTest::newRow("1: RYL 123 - Blue Moon") << int(SongFilenameLabelDashName) << QString("RYL 123 - Blue Moon") << true
+        << QString("RYL") << QString("123") << QString("") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("1: RYL-123 - Blue Moon") << int(SongFilenameLabelDashName) << QString("RYL-123 - Blue Moon") << true
+        << QString("RYL") << QString("123") << QString("") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("1: Blue Moon - RYL 123") << int(SongFilenameLabelDashName) << QString("Blue Moon - RYL 123") << true
+        << QString("Blue Moon") << QString("") << QString("") << QString("RYL 123") << QString("RYL 123");
+    QTest::newRow("1: Blue Moon - RYL-123") << int(SongFilenameLabelDashName) << QString("Blue Moon - RYL-123") << true
+        << QString("Blue Moon - RYL") << QString("") << QString("") << QString("123") << QString("123");
+    QTest::newRow("1: Blue Moon - RYL 123V") << int(SongFilenameLabelDashName) << QString("Blue Moon - RYL 123V") << true
+        << QString("Blue Moon") << QString("") << QString("") << QString("RYL 123V") << QString("RYL 123V");
+    QTest::newRow("1: ESP 401V - Sweet Caroline") << int(SongFilenameLabelDashName) << QString("ESP 401V - Sweet Caroline") << true
+        << QString("ESP") << QString("401") << QString("V") << QString("Sweet Caroline") << QString("Sweet Caroline");
+    QTest::newRow("1: 123 - Chicken Plucker") << int(SongFilenameLabelDashName) << QString("123 - Chicken Plucker") << true
+        << QString("123") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("1: 123.Chicken Plucker") << int(SongFilenameLabelDashName) << QString("123.Chicken Plucker") << false
+        << QString("") << QString("") << QString("") << QString("123.Chicken Plucker") << QString("");
+    QTest::newRow("1: ABC 123-Chicken Plucker") << int(SongFilenameLabelDashName) << QString("ABC 123-Chicken Plucker") << true
+        << QString("ABC") << QString("123") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("1: ABC 123h1-Chicken Plucker") << int(SongFilenameLabelDashName) << QString("ABC 123h1-Chicken Plucker") << true
+        << QString("ABC 123h1") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("1: SIR 705b - Papa Was A Rollin Stone (Instrumental)") << int(SongFilenameLabelDashName) << QString("SIR 705b - Papa Was A Rollin Stone (Instrumental)") << true
+        << QString("SIR") << QString("705") << QString("b") << QString("Papa Was A Rollin Stone (Instrumental)") << QString("Papa Was A Rollin Stone (Instrumental)");
+    QTest::newRow("1: POP - Chicken Plucker") << int(SongFilenameLabelDashName) << QString("POP - Chicken Plucker") << true
+        << QString("POP") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("1: A Summer Song - CHIC3002 (female vocals)") << int(SongFilenameLabelDashName) << QString("A Summer Song - CHIC3002 (female vocals)") << true
+        << QString("A Summer Song") << QString("") << QString("") << QString("CHIC3002 (female vocals)") << QString("CHIC3002 (female vocals)");
+    QTest::newRow("1: Paper Doll - Windsor-4936B") << int(SongFilenameLabelDashName) << QString("Paper Doll - Windsor-4936B") << true
+        << QString("Paper Doll - Windsor") << QString("") << QString("") << QString("4936B") << QString("4936B");
+    QTest::newRow("1: Paper Doll - Windsor 4936B") << int(SongFilenameLabelDashName) << QString("Paper Doll - Windsor 4936B") << true
+        << QString("Paper Doll") << QString("") << QString("") << QString("Windsor 4936B") << QString("Windsor 4936B");
+    QTest::newRow("1: Streets of London - New Beat 203a") << int(SongFilenameLabelDashName) << QString("Streets of London - New Beat 203a") << true
+        << QString("Streets of London") << QString("") << QString("") << QString("New Beat 203a") << QString("New Beat 203a");
+    QTest::newRow("1: Only You - NB 303") << int(SongFilenameLabelDashName) << QString("Only You - NB 303") << true
+        << QString("Only You") << QString("") << QString("") << QString("NB 303") << QString("NB 303");
+    QTest::newRow("1: Chicken Plucker") << int(SongFilenameLabelDashName) << QString("Chicken Plucker") << false
+        << QString("") << QString("") << QString("") << QString("Chicken Plucker") << QString("");
+    QTest::newRow("1: Margaritaville") << int(SongFilenameLabelDashName) << QString("Margaritaville") << false
+        << QString("") << QString("") << QString("") << QString("Margaritaville") << QString("");
+    QTest::newRow("1: Sweet Caroline - Kentucky Rain - RR 201") << int(SongFilenameLabelDashName) << QString("Sweet Caroline - Kentucky Rain - RR 201") << true
+        << QString("Sweet Caroline - Kentucky Rain") << QString("") << QString("") << QString("RR 201") << QString("RR 201");
+    QTest::newRow("1: Hello  World  -  ABC  12") << int(SongFilenameLabelDashName) << QString("Hello  World  -  ABC  12") << true
+        << QString("Hello World") << QString("") << QString("") << QString("ABC 12") << QString("ABC 12");
+    QTest::newRow("1: RR 201 - Rhythm Song") << int(SongFilenameLabelDashName) << QString("RR 201 - Rhythm Song") << true
+        << QString("RR") << QString("201") << QString("") << QString("Rhythm Song") << QString("Rhythm Song");
+    QTest::newRow("1: C 1 - Tiny") << int(SongFilenameLabelDashName) << QString("C 1 - Tiny") << true
+        << QString("C") << QString("1") << QString("") << QString("Tiny") << QString("Tiny");
+    QTest::newRow("1: Song Title - ABC") << int(SongFilenameLabelDashName) << QString("Song Title - ABC") << true
+        << QString("Song Title") << QString("") << QString("") << QString("ABC") << QString("ABC");
+    QTest::newRow("1: ABC - Song Title") << int(SongFilenameLabelDashName) << QString("ABC - Song Title") << true
+        << QString("ABC") << QString("") << QString("") << QString("Song Title") << QString("Song Title");
+    QTest::newRow("1: Summer Nights 2 - Tune 15") << int(SongFilenameLabelDashName) << QString("Summer Nights 2 - Tune 15") << true
+        << QString("Summer Nights 2") << QString("") << QString("") << QString("Tune 15") << QString("Tune 15");
+    QTest::newRow("1: Apple 12 - Pie 3") << int(SongFilenameLabelDashName) << QString("Apple 12 - Pie 3") << true
+        << QString("Apple") << QString("12") << QString("") << QString("Pie 3") << QString("Pie 3");
+
+    // SongFilenameNameDashLabel
+    QTest::newRow("2: ARROW 946 - Studio 54") << int(SongFilenameNameDashLabel) << QString("ARROW 946 - Studio 54") << true
+        << QString("Studio") << QString("54") << QString("") << QString("ARROW 946") << QString("ARROW 946");
+    QTest::newRow("2: Play It Cool - BS 2534a") << int(SongFilenameNameDashLabel) << QString("Play It Cool - BS 2534a") << true
+        << QString("BS") << QString("2534") << QString("a") << QString("Play It Cool") << QString("Play It Cool");
+    QTest::newRow("2: Strings Galore - Chaparral 117b") << int(SongFilenameNameDashLabel) << QString("Strings Galore - Chaparral 117b") << true
+        << QString("Chaparral") << QString("117") << QString("b") << QString("Strings Galore") << QString("Strings Galore");
+    QTest::newRow("2: OGRMP3 04 - Addam's Family") << int(SongFilenameNameDashLabel) << QString("OGRMP3 04 - Addam's Family") << true
+        << QString("Addam's Family") << QString("") << QString("") << QString("OGRMP3 04") << QString("OGRMP3 04");
+    QTest::newRow("2: 4-bar-b 123 - Chicken Plucker") << int(SongFilenameNameDashLabel) << QString("4-bar-b 123 - Chicken Plucker") << true
+        << QString("Chicken Plucker") << QString("") << QString("") << QString("FOURBARB 123") << QString("FOURBARB 123");
+    QTest::newRow("2: 4-Bar-B 6154 - Hoedown Throwdown") << int(SongFilenameNameDashLabel) << QString("4-Bar-B 6154 - Hoedown Throwdown") << true
+        << QString("Hoedown Throwdown") << QString("") << QString("") << QString("FOURBARB 6154") << QString("FOURBARB 6154");
+    QTest::newRow("2: Circle-D 220 - Some Song") << int(SongFilenameNameDashLabel) << QString("Circle-D 220 - Some Song") << true
+        << QString("Some Song") << QString("") << QString("") << QString("CIRCLED 220") << QString("CIRCLED 220");
+    QTest::newRow("2: Jay-Bar-Kay 101 - Cowboy Boogie") << int(SongFilenameNameDashLabel) << QString("Jay-Bar-Kay 101 - Cowboy Boogie") << true
+        << QString("Cowboy Boogie") << QString("") << QString("") << QString("JAYBARKAY 101") << QString("JAYBARKAY 101");
+    QTest::newRow("2: RYL 123 - Blue Moon") << int(SongFilenameNameDashLabel) << QString("RYL 123 - Blue Moon") << true
+        << QString("Blue Moon") << QString("") << QString("") << QString("RYL 123") << QString("RYL 123");
+    QTest::newRow("2: RYL-123 - Blue Moon") << int(SongFilenameNameDashLabel) << QString("RYL-123 - Blue Moon") << true
+        << QString("Blue Moon") << QString("") << QString("") << QString("RYL-123") << QString("RYL-123");
+    QTest::newRow("2: Blue Moon - RYL 123") << int(SongFilenameNameDashLabel) << QString("Blue Moon - RYL 123") << true
+        << QString("RYL") << QString("123") << QString("") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("2: Blue Moon - RYL-123") << int(SongFilenameNameDashLabel) << QString("Blue Moon - RYL-123") << true
+        << QString("123") << QString("") << QString("") << QString("Blue Moon - RYL") << QString("Blue Moon - RYL");
+    QTest::newRow("2: Blue Moon - RYL 123V") << int(SongFilenameNameDashLabel) << QString("Blue Moon - RYL 123V") << true
+        << QString("RYL") << QString("123") << QString("V") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("2: ESP 401V - Sweet Caroline") << int(SongFilenameNameDashLabel) << QString("ESP 401V - Sweet Caroline") << true
+        << QString("Sweet Caroline") << QString("") << QString("") << QString("ESP 401V") << QString("ESP 401V");
+    QTest::newRow("2: 123 - Chicken Plucker") << int(SongFilenameNameDashLabel) << QString("123 - Chicken Plucker") << true
+        << QString("Chicken Plucker") << QString("") << QString("") << QString("123") << QString("123");
+    QTest::newRow("2: 123.Chicken Plucker") << int(SongFilenameNameDashLabel) << QString("123.Chicken Plucker") << false
+        << QString("") << QString("") << QString("") << QString("123.Chicken Plucker") << QString("");
+    QTest::newRow("2: ABC 123-Chicken Plucker") << int(SongFilenameNameDashLabel) << QString("ABC 123-Chicken Plucker") << true
+        << QString("Chicken Plucker") << QString("") << QString("") << QString("ABC 123") << QString("ABC 123");
+    QTest::newRow("2: ABC 123h1-Chicken Plucker") << int(SongFilenameNameDashLabel) << QString("ABC 123h1-Chicken Plucker") << true
+        << QString("Chicken Plucker") << QString("") << QString("") << QString("ABC 123h1") << QString("ABC 123h1");
+    QTest::newRow("2: SIR 705b - Papa Was A Rollin Stone (Instrumental)") << int(SongFilenameNameDashLabel) << QString("SIR 705b - Papa Was A Rollin Stone (Instrumental)") << true
+        << QString("Papa Was A Rollin Stone (Instrumental)") << QString("") << QString("") << QString("SIR 705b") << QString("SIR 705b");
+    QTest::newRow("2: POP - Chicken Plucker") << int(SongFilenameNameDashLabel) << QString("POP - Chicken Plucker") << true
+        << QString("Chicken Plucker") << QString("") << QString("") << QString("POP") << QString("POP");
+    QTest::newRow("2: A Summer Song - CHIC3002 (female vocals)") << int(SongFilenameNameDashLabel) << QString("A Summer Song - CHIC3002 (female vocals)") << true
+        << QString("CHIC3002 (female vocals)") << QString("") << QString("") << QString("A Summer Song") << QString("A Summer Song");
+    QTest::newRow("2: Paper Doll - Windsor-4936B") << int(SongFilenameNameDashLabel) << QString("Paper Doll - Windsor-4936B") << true
+        << QString("4936B") << QString("") << QString("") << QString("Paper Doll - Windsor") << QString("Paper Doll - Windsor");
+    QTest::newRow("2: Paper Doll - Windsor 4936B") << int(SongFilenameNameDashLabel) << QString("Paper Doll - Windsor 4936B") << true
+        << QString("Windsor") << QString("4936") << QString("B") << QString("Paper Doll") << QString("Paper Doll");
+    QTest::newRow("2: Streets of London - New Beat 203a") << int(SongFilenameNameDashLabel) << QString("Streets of London - New Beat 203a") << true
+        << QString("New Beat 203a") << QString("") << QString("") << QString("Streets of London") << QString("Streets of London");
+    QTest::newRow("2: Only You - NB 303") << int(SongFilenameNameDashLabel) << QString("Only You - NB 303") << true
+        << QString("NB") << QString("303") << QString("") << QString("Only You") << QString("Only You");
+    QTest::newRow("2: Chicken Plucker") << int(SongFilenameNameDashLabel) << QString("Chicken Plucker") << false
+        << QString("") << QString("") << QString("") << QString("Chicken Plucker") << QString("");
+    QTest::newRow("2: Margaritaville") << int(SongFilenameNameDashLabel) << QString("Margaritaville") << false
+        << QString("") << QString("") << QString("") << QString("Margaritaville") << QString("");
+    QTest::newRow("2: Sweet Caroline - Kentucky Rain - RR 201") << int(SongFilenameNameDashLabel) << QString("Sweet Caroline - Kentucky Rain - RR 201") << true
+        << QString("RR") << QString("201") << QString("") << QString("Sweet Caroline - Kentucky Rain") << QString("Sweet Caroline - Kentucky Rain");
+    QTest::newRow("2: Hello  World  -  ABC  12") << int(SongFilenameNameDashLabel) << QString("Hello  World  -  ABC  12") << true
+        << QString("ABC") << QString("12") << QString("") << QString("Hello World") << QString("Hello World");
+    QTest::newRow("2: RR 201 - Rhythm Song") << int(SongFilenameNameDashLabel) << QString("RR 201 - Rhythm Song") << true
+        << QString("Rhythm Song") << QString("") << QString("") << QString("RR 201") << QString("RR 201");
+    QTest::newRow("2: C 1 - Tiny") << int(SongFilenameNameDashLabel) << QString("C 1 - Tiny") << true
+        << QString("Tiny") << QString("") << QString("") << QString("C 1") << QString("C 1");
+    QTest::newRow("2: Song Title - ABC") << int(SongFilenameNameDashLabel) << QString("Song Title - ABC") << true
+        << QString("ABC") << QString("") << QString("") << QString("Song Title") << QString("Song Title");
+    QTest::newRow("2: ABC - Song Title") << int(SongFilenameNameDashLabel) << QString("ABC - Song Title") << true
+        << QString("Song Title") << QString("") << QString("") << QString("ABC") << QString("ABC");
+    QTest::newRow("2: Summer Nights 2 - Tune 15") << int(SongFilenameNameDashLabel) << QString("Summer Nights 2 - Tune 15") << true
+        << QString("Tune") << QString("15") << QString("") << QString("Summer Nights 2") << QString("Summer Nights 2");
+    QTest::newRow("2: Apple 12 - Pie 3") << int(SongFilenameNameDashLabel) << QString("Apple 12 - Pie 3") << true
+        << QString("Pie") << QString("3") << QString("") << QString("Apple 12") << QString("Apple 12");
+
+    // SongFilenameBestGuess
+    QTest::newRow("3: ARROW 946 - Studio 54") << int(SongFilenameBestGuess) << QString("ARROW 946 - Studio 54") << true
+        << QString("ARROW") << QString("946") << QString("") << QString("Studio 54") << QString("Studio 54");
+    QTest::newRow("3: Play It Cool - BS 2534a") << int(SongFilenameBestGuess) << QString("Play It Cool - BS 2534a") << true
+        << QString("BS") << QString("2534a") << QString("") << QString("Play It Cool") << QString("Play It Cool");
+    QTest::newRow("3: Strings Galore - Chaparral 117b") << int(SongFilenameBestGuess) << QString("Strings Galore - Chaparral 117b") << true
+        << QString("Chaparral") << QString("117b") << QString("") << QString("Strings Galore") << QString("Strings Galore");
+    QTest::newRow("3: OGRMP3 04 - Addam's Family") << int(SongFilenameBestGuess) << QString("OGRMP3 04 - Addam's Family") << true
+        << QString("OGRMP3") << QString("04") << QString("") << QString("Addam's Family") << QString("Addam's Family");
+    QTest::newRow("3: 4-bar-b 123 - Chicken Plucker") << int(SongFilenameBestGuess) << QString("4-bar-b 123 - Chicken Plucker") << true
+        << QString("4-bar-b 123") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("3: 4-Bar-B 6154 - Hoedown Throwdown") << int(SongFilenameBestGuess) << QString("4-Bar-B 6154 - Hoedown Throwdown") << true
+        << QString("4-Bar-B 6154") << QString("") << QString("") << QString("Hoedown Throwdown") << QString("Hoedown Throwdown");
+    QTest::newRow("3: Circle-D 220 - Some Song") << int(SongFilenameBestGuess) << QString("Circle-D 220 - Some Song") << true
+        << QString("Circle-D 220") << QString("") << QString("") << QString("Some Song") << QString("Some Song");
+    QTest::newRow("3: Jay-Bar-Kay 101 - Cowboy Boogie") << int(SongFilenameBestGuess) << QString("Jay-Bar-Kay 101 - Cowboy Boogie") << true
+        << QString("Jay-Bar-Kay 101") << QString("") << QString("") << QString("Cowboy Boogie") << QString("Cowboy Boogie");
+    QTest::newRow("3: RYL 123 - Blue Moon") << int(SongFilenameBestGuess) << QString("RYL 123 - Blue Moon") << true
+        << QString("RYL") << QString("123") << QString("") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("3: RYL-123 - Blue Moon") << int(SongFilenameBestGuess) << QString("RYL-123 - Blue Moon") << true
+        << QString("RYL") << QString("123") << QString("") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("3: Blue Moon - RYL 123") << int(SongFilenameBestGuess) << QString("Blue Moon - RYL 123") << true
+        << QString("RYL") << QString("123") << QString("") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("3: Blue Moon - RYL-123") << int(SongFilenameBestGuess) << QString("Blue Moon - RYL-123") << true
+        << QString("RYL") << QString("123") << QString("") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("3: Blue Moon - RYL 123V") << int(SongFilenameBestGuess) << QString("Blue Moon - RYL 123V") << true
+        << QString("RYL") << QString("123V") << QString("") << QString("Blue Moon") << QString("Blue Moon");
+    QTest::newRow("3: ESP 401V - Sweet Caroline") << int(SongFilenameBestGuess) << QString("ESP 401V - Sweet Caroline") << true
+        << QString("ESP") << QString("401") << QString("V") << QString("Sweet Caroline") << QString("Sweet Caroline");
+    QTest::newRow("3: 123 - Chicken Plucker") << int(SongFilenameBestGuess) << QString("123 - Chicken Plucker") << true
+        << QString("123") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("3: 123.Chicken Plucker") << int(SongFilenameBestGuess) << QString("123.Chicken Plucker") << true
+        << QString("123.") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("3: ABC 123-Chicken Plucker") << int(SongFilenameBestGuess) << QString("ABC 123-Chicken Plucker") << true
+        << QString("ABC") << QString("123") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("3: ABC 123h1-Chicken Plucker") << int(SongFilenameBestGuess) << QString("ABC 123h1-Chicken Plucker") << true
+        << QString("ABC 123h1") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("3: SIR 705b - Papa Was A Rollin Stone (Instrumental)") << int(SongFilenameBestGuess) << QString("SIR 705b - Papa Was A Rollin Stone (Instrumental)") << true
+        << QString("SIR") << QString("705") << QString("b") << QString("Papa Was A Rollin Stone (Instrumental)") << QString("Papa Was A Rollin Stone (Instrumental)");
+    QTest::newRow("3: POP - Chicken Plucker") << int(SongFilenameBestGuess) << QString("POP - Chicken Plucker") << true
+        << QString("POP") << QString("") << QString("") << QString("Chicken Plucker") << QString("Chicken Plucker");
+    QTest::newRow("3: A Summer Song - CHIC3002 (female vocals)") << int(SongFilenameBestGuess) << QString("A Summer Song - CHIC3002 (female vocals)") << true
+        << QString("CHIC") << QString("3002") << QString("") << QString("A Summer Song (female vocals)") << QString("A Summer Song");
+    QTest::newRow("3: Paper Doll - Windsor-4936B") << int(SongFilenameBestGuess) << QString("Paper Doll - Windsor-4936B") << true
+        << QString("Windsor") << QString("4936B") << QString("") << QString("Paper Doll") << QString("Paper Doll");
+    QTest::newRow("3: Paper Doll - Windsor 4936B") << int(SongFilenameBestGuess) << QString("Paper Doll - Windsor 4936B") << true
+        << QString("Windsor") << QString("4936B") << QString("") << QString("Paper Doll") << QString("Paper Doll");
+    QTest::newRow("3: Streets of London - New Beat 203a") << int(SongFilenameBestGuess) << QString("Streets of London - New Beat 203a") << true
+        << QString("New Beat") << QString("203a") << QString("") << QString("Streets of London") << QString("Streets of London");
+    QTest::newRow("3: Only You - NB 303") << int(SongFilenameBestGuess) << QString("Only You - NB 303") << true
+        << QString("NB") << QString("303") << QString("") << QString("Only You") << QString("Only You");
+    QTest::newRow("3: Chicken Plucker") << int(SongFilenameBestGuess) << QString("Chicken Plucker") << false
+        << QString("") << QString("") << QString("") << QString("Chicken Plucker") << QString("");
+    QTest::newRow("3: Margaritaville") << int(SongFilenameBestGuess) << QString("Margaritaville") << false
+        << QString("") << QString("") << QString("") << QString("Margaritaville") << QString("");
+    QTest::newRow("3: Sweet Caroline - Kentucky Rain - RR 201") << int(SongFilenameBestGuess) << QString("Sweet Caroline - Kentucky Rain - RR 201") << true
+        << QString("RR") << QString("201") << QString("") << QString("Sweet Caroline - Kentucky Rain") << QString("Sweet Caroline - Kentucky Rain");
+    QTest::newRow("3: Hello  World  -  ABC  12") << int(SongFilenameBestGuess) << QString("Hello  World  -  ABC  12") << true
+        << QString("ABC") << QString("12") << QString("") << QString("Hello World") << QString("Hello World");
+    QTest::newRow("3: RR 201 - Rhythm Song") << int(SongFilenameBestGuess) << QString("RR 201 - Rhythm Song") << true
+        << QString("RR") << QString("201") << QString("") << QString("Rhythm Song") << QString("Rhythm Song");
+    QTest::newRow("3: C 1 - Tiny") << int(SongFilenameBestGuess) << QString("C 1 - Tiny") << true
+        << QString("C") << QString("1") << QString("") << QString("Tiny") << QString("Tiny");
+    QTest::newRow("3: Song Title - ABC") << int(SongFilenameBestGuess) << QString("Song Title - ABC") << false
+        << QString("") << QString("") << QString("") << QString("Song Title - ABC") << QString("");
+    QTest::newRow("3: ABC - Song Title") << int(SongFilenameBestGuess) << QString("ABC - Song Title") << true
+        << QString("ABC") << QString("") << QString("") << QString("Song Title") << QString("Song Title");
+    QTest::newRow("3: Summer Nights 2 - Tune 15") << int(SongFilenameBestGuess) << QString("Summer Nights 2 - Tune 15") << true
+        << QString("Tune") << QString("15") << QString("") << QString("Summer Nights 2") << QString("Summer Nights 2");
+    QTest::newRow("3: Apple 12 - Pie 3") << int(SongFilenameBestGuess) << QString("Apple 12 - Pie 3") << true
+        << QString("Pie") << QString("3") << QString("") << QString("Apple 12") << QString("Apple 12");
+}
+
+void TestFilenameParser::parse()
+{
+    QFETCH(int, format);
+    QFETCH(QString, filename);
+
+    QString label, labelnum, labelnum_extra, title, shortTitle;
+    bool foundParts = parseSongFilename(filename, static_cast<SongFilenameMatchingType>(format),
+                                        label, labelnum, labelnum_extra, title, shortTitle);
+
+    QTEST(foundParts, "foundParts");
+    QTEST(label, "label");
+    QTEST(labelnum, "labelnum");
+    QTEST(labelnum_extra, "labelnum_extra");
+    QTEST(title, "title");
+    QTEST(shortTitle, "shortTitle");
+}
+
+// a part that no expression fills in keeps whatever the caller passed in (which is why
+//   breakFilenameIntoParts() only caches calls that pass in empty parts)
+void TestFilenameParser::unmatchedPartsLeftAlone()
+{
+    QString label, labelnum, labelnum_extra("x"), title, shortTitle("kept");
+    parseSongFilename("Chicken Plucker", SongFilenameBestGuess, label, labelnum, labelnum_extra, title, shortTitle);
+    QCOMPARE(labelnum_extra, QString("x"));
+    QCOMPARE(shortTitle, QString("kept"));
+    QCOMPARE(title, QString("Chicken Plucker"));
+}
+
+// the per-row cost that darkLoadMusicList() paid for every song before the parts were cached
+void TestFilenameParser::benchmarkParse()
+{
+    QStringList filenames;
+    for (int i = 0; i < 1000; i++) {
+        filenames << QString("RYL %1 - Blue Moon %2").arg(100 + i).arg(i % 7)
+                  << QString("Play It Cool - BS %1a").arg(2000 + i)
+                  << QString("Some Song Without A Label %1").arg(i);
+    }
+    int found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (const QString &f : std::as_const(filenames)) {
+            QString label, labelnum, labelnum_extra, title, shortTitle;
+            found += parseSongFilename(f, SongFilenameBestGuess, label, labelnum, labelnum_extra, title, shortTitle) ? 1 : 0;
+        }
+    }
+    QVERIFY(found > 0);
+}
@@ -0,0 +1,275 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "testsongsearchindex.h"
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+
+#include <utility>
+
+#include <QtTest/QtTest>
+
+#define SONG_COUNT 50000
+#define KEYSTROKE_BUDGET_NS 5000000  // 5 ms
+
+// the same as in mainwindow.cpp/mainwindow_filemgmt.cpp
+static QString title_tags_prefix("&nbsp;<span style=\"background-color:%1; color: %2;\"> ");
+static QString title_tags_suffix(" </span>");
+static QRegularExpression title_tags_remover("(\\&nbsp\\;)*\\<\\/?span( .*?)?>");
+static QRegularExpression spanPrefixRemover("<span style=\"color:.*\">(.*)</span>", QRegularExpression::InvertedGreedinessOption);
+static QRegularExpression searchWordSeparator("(\\ |\\,|\\:|\\t)");  // see darkFilterMusic()
+
+// ...and normalizeForFilter(), which is static there
+static QString normalizeForFilter(QString str, int *title_end)
+{
+    str.replace(spanPrefixRemover, "\\1");
+    *title_end = static_cast<int>(str.indexOf(title_tags_remover));
+    str.replace(title_tags_remover, " ");
+    return str;
+}
+
+// filterContains() as it was before SongSearchIndex, regexes and all, called for every row on
+//   every keystroke: the reference that the index has to agree with, and the "old" benchmark row
+static bool referenceFilterContains(QString str, const QStringList &list)
+{
+    if (list.isEmpty())
+        return true;
+
+    str.replace(spanPrefixRemover, "\\1");
+    int title_end = static_cast<int>(str.indexOf(title_tags_remover));
+    str.replace(title_tags_remover, " ");
+    int index = 0;
+    if (title_end < 0) title_end = static_cast<int>(str.length());
+
+    for (const auto &t : list)
+    {
+        QString filterWord(t);
+        bool tagsOnly(false);
+        bool exclude(false);
+
+        while (filterWord.length() > 0 &&
+               ('#' == filterWord[0] ||
+                '-' == filterWord[0]))
+        {
+            tagsOnly = ('#' == filterWord[0]);
+            exclude = ('-' == filterWord[0]);
+            filterWord.remove(0,1);
+        }
+        if (filterWord.length() == 0)
+            continue;
+
+        if (index > title_end)
+            index = title_end;
+        int i = static_cast<int>(str.indexOf(filterWord,
+                                             tagsOnly ? title_end : (exclude ? 0 : index),
+                                             Qt::CaseInsensitive));
+        if (i < 0)
+        {
+            if (!exclude)
+                return false;
+        }
+        else
+        {
+            if (exclude)
+                return false;
+        }
+        if (!tagsOnly && !exclude)
+            index = i + static_cast<int>(t.length());
+    }
+    return true;
+}
+
+static QVector<int> regexScan(const QStringList &labelHTML, const QStringList &typeHTML, const QStringList &titleHTML,
+                              const TestSongSearchIndex::Query &query)
+{
+    QStringList label = query.label.split(searchWordSeparator);
+    QStringList type  = query.type.split(searchWordSeparator);
+    QStringList title = query.title.split(searchWordSeparator);
+    QVector<int> rows;
+    for (int i = 0; i < titleHTML.size(); i++) {
+        bool show;
+        if (!query.searchAllFields) {
+            show = referenceFilterContains(labelHTML[i], label) &&
+                   referenceFilterContains(typeHTML[i], type) &&
+                   referenceFilterContains(titleHTML[i], title);
+        } else {
+            show = referenceFilterContains(labelHTML[i], title) ||
+                   referenceFilterContains(typeHTML[i], title) ||
+                   referenceFilterContains(titleHTML[i], title);
+        }
+        if (show) {
+            rows.append(i);
+        }
+    }
+    return rows;
+}
+
+static QVector<int> indexMatch(const SongSearchIndex &index, const TestSongSearchIndex::Query &query)
+{
+    return index.match(query.label.split(searchWordSeparator),
+                       query.type.split(searchWordSeparator),
+                       query.title.split(searchWordSeparator),
+                       query.searchAllFields);
+}
+
+void TestSongSearchIndex::initTestCase()
+{
+    QRandomGenerator rng(1234);
+
+    // made-up but pronounceable title words, a few with accents
+    static const char *syllables[] = { "ba", "lo", "ve", "ri", "son", "ta", "mi", "gro", "ne", "ka", "dan", "ce",
+                                       "sun", "shi", "ne", "mo", "ro", "la", "tem", "po", "hey", "ja", "zz", "qui" };
+    const int numSyllables = sizeof(syllables) / sizeof(syllables[0]);
+    QStringList vocabulary;
+    for (int i = 0; i < 3000; i++) {
+        QString word;
+        for (int s = 1 + rng.bounded(3); s >= 0; s--) {
+            word += syllables[rng.bounded(numSyllables)];
+        }
+        if (rng.bounded(50) == 0) {
+            word.replace("e", QString::fromUtf8("\u00e9"));
+        }
+        word[0] = word[0].toUpper();
+        vocabulary.append(word);
+    }
+    static const char *labels[] = { "RIV", "ESP", "BS", "SIR", "CHIC", "GR", "SSR", "RR" };
+    static const char *types[] = { "patter", "singing", "vocals", "extras", "xtras" };
+    static const char *tags[] = { "HOT", "Latin", "Swing", "NEW", "halloween", "DUET" };
+
+    QStringList titles;
+    for (int i = 0; i < SONG_COUNT; i++) {
+        labelHTML.append(QString("%1 %2").arg(labels[rng.bounded(8)]).arg(rng.bounded(3000)));
+        typeHTML.append(types[rng.bounded(5)]);
+
+        QStringList words;
+        for (int w = 2 + rng.bounded(4); w > 0; w--) {
+            words.append(vocabulary[rng.bounded(vocabulary.size())]);
+        }
+        QString title = words.join(" ");
+        titles.append(title);
+
+        // as MainWindow::FormatTitlePlusTags() makes them
+        QString html = title.toHtmlEscaped();
+        if (rng.bounded(4) == 0) {
+            html = QString("<span style=\"color: %1;\">").arg("#7b7b7b") + html + QString("</span>");
+        }
+        if (rng.bounded(5) == 0) {
+            html += "&nbsp;";
+            for (int t = 1 + rng.bounded(2); t > 0; t--) {
+                html += title_tags_prefix.arg("#ff0000", "#000000") + tags[rng.bounded(6)] + title_tags_suffix;
+            }
+        }
+        titleHTML.append(html);
+    }
+
+    for (int i = 0; i < SONG_COUNT; i++) {
+        QString texts[SongSearchIndex::NumFields];
+        int titleEnds[SongSearchIndex::NumFields];
+        texts[SongSearchIndex::LabelField] = normalizeForFilter(labelHTML[i], &titleEnds[SongSearchIndex::LabelField]);
+        texts[SongSearchIndex::TypeField]  = normalizeForFilter(typeHTML[i],  &titleEnds[SongSearchIndex::TypeField]);
+        texts[SongSearchIndex::TitleField] = normalizeForFilter(titleHTML[i], &titleEnds[SongSearchIndex::TitleField]);
+        index.addRow(texts, titleEnds, static_cast<quintptr>(i));
+    }
+
+    // the first two words of a few titles, typed one keystroke at a time, in both search modes...
+    for (int q = 0; q < 6; q++) {
+        QStringList words = titles[rng.bounded(SONG_COUNT)].split(" ");
+        QString typed = words[0] + " " + words[1];
+        for (int n = 1; n <= typed.length(); n++) {
+            keystrokes.append(Query{ "", "", typed.left(n).toLower(), (q % 2) == 1 });
+        }
+    }
+    // ...and the other kinds of search
+    keystrokes.append(Query{ "", "", "#hot", false });
+    keystrokes.append(Query{ "", "", "#lat", false });
+    keystrokes.append(Query{ "", "", "son -hot", false });
+    keystrokes.append(Query{ "", "", "ba #swing", false });
+    keystrokes.append(Query{ "riv", "pat", "", false });
+    keystrokes.append(Query{ "ESP 12", "sing", "love", false });
+    keystrokes.append(Query{ "", "", "riv", true });
+    keystrokes.append(Query{ "", "", QString::fromUtf8("\u00e9"), false });
+    keystrokes.append(Query{ "", "", "zzzzzz", false });
+    keystrokes.append(Query{ "", "", "", false });
+}
+
+void TestSongSearchIndex::sameAsRegexScan()
+{
+    for (const Query &query : std::as_const(keystrokes)) {
+        QVector<int> expected = regexScan(labelHTML, typeHTML, titleHTML, query);
+        QVector<int> actual = indexMatch(index, query);
+        QVERIFY2(actual == expected,
+                 qPrintable(QString("label \"%1\" type \"%2\" title \"%3\" all %4: %5 rows instead of %6")
+                            .arg(query.label, query.type, query.title).arg(query.searchAllFields)
+                            .arg(actual.size()).arg(expected.size())));
+    }
+}
+
+// the best of 5 tries for each keystroke (so that one unlucky context switch doesn't fail it), and the
+//   worst keystroke of all has to fit the budget.  This is only the search; darkFilterMusic() also
+//   hides and shows the rows that changed.
+void TestSongSearchIndex::keystrokeUnderFiveMs()
+{
+    qint64 worst = 0;
+    QString worstQuery;
+    for (const Query &query : std::as_const(keystrokes)) {
+        qint64 best = -1;
+        for (int attempt = 0; attempt < 5; attempt++) {
+            QElapsedTimer t;
+            t.start();
+            QVector<int> rows = indexMatch(index, query);
+            qint64 ns = t.nsecsElapsed();
+            best = (best < 0) ? ns : qMin(best, ns);
+        }
+        if (best > worst) {
+            worst = best;
+            worstQuery = query.title + " / " + query.label + " / " + query.type;
+        }
+    }
+    qDebug() << "slowest keystroke at" << SONG_COUNT << "songs:" << worst / 1000 << "us, for" << worstQuery;
+    QVERIFY2(worst < KEYSTROKE_BUDGET_NS, qPrintable(QString("%1 us for \"%2\"").arg(worst / 1000).arg(worstQuery)));
+}
+
+void TestSongSearchIndex::benchmarkKeystrokes_data()
+{
+    QTest::addColumn<bool>("indexed");
+    QTest::newRow("filterContains() on every row (old)") << false;
+    QTest::newRow("SongSearchIndex") << true;
+}
+
+// all of the keystrokes, one after the other
+void TestSongSearchIndex::benchmarkKeystrokes()
+{
+    QFETCH(bool, indexed);
+    qsizetype found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (const Query &query : std::as_const(keystrokes)) {
+            found += (indexed ? indexMatch(index, query) : regexScan(labelHTML, typeHTML, titleHTML, query)).size();
+        }
+    }
+    QVERIFY(found > 0);
+}
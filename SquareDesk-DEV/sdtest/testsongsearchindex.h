@@ -0,0 +1,54 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SDTEST_TESTSONGSEARCHINDEX_H
+#define SDTEST_TESTSONGSEARCHINDEX_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "songsearchindex.h"
+
+class TestSongSearchIndex: public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void sameAsRegexScan();         // every keystroke of every query, against the old filterContains() scan
+    void keystrokeUnderFiveMs();    // the type-ahead budget, at 50k songs
+    void benchmarkKeystrokes_data();
+    void benchmarkKeystrokes();
+public:
+    struct Query {
+        QString label, type, title;
+        bool searchAllFields;
+    };
+private:
+    QStringList labelHTML, typeHTML, titleHTML;  // the darkSongTable's cell texts, one per row
+    SongSearchIndex index;
+    QVector<Query> keystrokes;
+};
+
+#endif // SDTEST_TESTSONGSEARCHINDEX_H
@@ -0,0 +1,260 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "testsongsettingsmirror.h"
+
+#include "songsettings.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+#include <QtTest/QtTest>
+
+#define GUI_LATENCY_LIMIT_MS 250    // what the GUI thread may spend in one SongSettings call, in local mode
+
+// The slow filesystem stand-in: holds an exclusive lock on the shared copy for holdMs, so that anyone
+//   else who touches it waits (up to SQLite's busy timeout), just as they would for a slow disk.
+class SharedCopyLocker : public QThread {
+public:
+    SharedCopyLocker(const QString &filename, int holdMs) : filename(filename), holdMs(holdMs) {}
+    bool waitUntilLocked() { locked.acquire(); return gotLock; }
+protected:
+    void run() override
+    {
+        QString connectionName = QString("SharedCopyLocker_%1").arg(reinterpret_cast<quintptr>(this));
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+            db.setDatabaseName(filename);
+            if (db.open()) {
+                QSqlQuery q(db);
+                q.exec("PRAGMA locking_mode=EXCLUSIVE");  // keeps readers out too, in WAL mode as well
+                gotLock = q.exec("BEGIN EXCLUSIVE");
+                locked.release();
+                QThread::msleep(holdMs);
+                q.exec("COMMIT");
+                q.finish();
+                db.close();
+            } else {
+                locked.release();
+            }
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+private:
+    QString filename;
+    int holdMs;
+    bool gotLock = false;
+    QSemaphore locked;
+};
+
+static QString sharedFilenameFor(const QTemporaryDir &root)
+{
+    return root.path() + "/.squaredesk/SquareDesk.sqlite3";
+}
+
+static void openSettings(SongSettings &settings, const QTemporaryDir &root, bool local)
+{
+    settings.setUseLocalWorkingCopy(local);
+    settings.openDatabase(root.path() + "/.squaredesk", root.path(), false);
+}
+
+static void savePitch(SongSettings &settings, const QTemporaryDir &root, const QString &song, int pitch)
+{
+    SongSetting s;
+    s.setFilename(song);
+    s.setFilenameWithPath(root.path() + "/patter/" + song + ".mp3");
+    s.setSongname(song);
+    s.setPitch(pitch);
+    settings.saveSettings(root.path() + "/patter/" + song + ".mp3", s);
+}
+
+static int loadPitch(SongSettings &settings, const QTemporaryDir &root, const QString &song)
+{
+    SongSetting s;
+    if (!settings.loadSettings(root.path() + "/patter/" + song + ".mp3", s)) {
+        return -1;
+    }
+    return s.getPitch();
+}
+
+// what's in a copy of the DB, read straight from the file
+static int pitchInFile(const QString &filename, const QString &song)
+{
+    int pitch = -1;
+    QString connectionName("TestSongSettingsMirror_pitchInFile");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(filename);
+        if (db.open()) {
+            QSqlQuery q(db);
+            q.prepare("SELECT pitch FROM songs WHERE filename LIKE :song");
+            q.bindValue(":song", "%/" + song + ".mp3");
+            if (q.exec() && q.next()) {
+                pitch = q.value(0).toInt();
+            }
+            q.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return pitch;
+}
+
+void TestSongSettingsMirror::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);  // the local copies go under ~/.qttest, not the real app data
+}
+
+void TestSongSettingsMirror::directModeWaitsForSharedCopy()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    SongSettings settings;
+    openSettings(settings, root, false);
+    savePitch(settings, root, "direct", 1);
+    settings.flushWrites();
+
+    SharedCopyLocker locker(sharedFilenameFor(root), 1500);
+    locker.start();
+    QVERIFY(locker.waitUntilLocked());
+
+    QElapsedTimer t;
+    t.start();
+    loadPitch(settings, root, "direct");
+    qint64 elapsed = t.elapsed();
+    locker.wait();
+    settings.closeDatabase();
+
+    qDebug() << "direct mode: loadSettings() took" << elapsed << "ms while the shared copy was locked";
+    QVERIFY(elapsed >= 500);  // it had to wait for the lock
+}
+
+void TestSongSettingsMirror::localModeDoesNotWaitForSharedCopy()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    {
+        SongSettings settings;
+        openSettings(settings, root, true);
+        savePitch(settings, root, "local", 1);
+        settings.closeDatabase();  // pushes: now there is a shared copy
+    }
+    QCOMPARE(pitchInFile(sharedFilenameFor(root), "local"), 1);
+
+    SongSettings settings;
+    openSettings(settings, root, true);
+
+    // Lock the shared copy for longer than the writer waits before it pushes (SONGSETTINGS_MIRROR_DELAY_MS
+    //   of no writes), so that its push gets stuck on the lock while the GUI thread keeps working.
+    SharedCopyLocker locker(sharedFilenameFor(root), SONGSETTINGS_MIRROR_DELAY_MS + 3000);
+    locker.start();
+    QVERIFY(locker.waitUntilLocked());
+
+    qint64 worst = 0;
+    int calls = 0;
+    QElapsedTimer total;
+    total.start();
+    int pitch = 2;
+    while (total.elapsed() < 1000) {    // writes (each one restarts the writer's quiet period)...
+        QElapsedTimer t;
+        t.start();
+        savePitch(settings, root, "local", pitch);
+        QCOMPARE(loadPitch(settings, root, "local"), pitch);
+        worst = qMax(worst, t.elapsed());
+        calls += 2;
+        pitch = (pitch == 2) ? 3 : 2;
+    }
+    while (total.elapsed() < SONGSETTINGS_MIRROR_DELAY_MS + 2500) {  // ...then only reads, through the push
+        QElapsedTimer t;
+        t.start();
+        loadPitch(settings, root, "local");
+        worst = qMax(worst, t.elapsed());
+        calls++;
+        QThread::msleep(20);
+    }
+    locker.wait();
+
+    qDebug() << "local mode:" << calls << "calls while the shared copy was locked, slowest" << worst << "ms";
+    QVERIFY(worst < GUI_LATENCY_LIMIT_MS);
+
+    int lastPitch = loadPitch(settings, root, "local");
+    settings.closeDatabase();  // the lock is gone now, so this push goes through
+    QCOMPARE(pitchInFile(sharedFilenameFor(root), "local"), lastPitch);
+}
+
+void TestSongSettingsMirror::conflictIsReported()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    {
+        SongSettings settings;
+        openSettings(settings, root, true);
+        savePitch(settings, root, "conflict", 1);
+        settings.closeDatabase();
+    }
+
+    SongSettings settings;
+    QSignalSpy spy(&settings, &SongSettings::mirrorConflict);
+    openSettings(settings, root, true);
+    savePitch(settings, root, "conflict", 2);  // ours...
+    settings.flushWrites();
+
+    QThread::msleep(50);  // so that the other machine's write gets a different mtime
+    {
+        QString connectionName("TestSongSettingsMirror_otherMachine");
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+            db.setDatabaseName(sharedFilenameFor(root));
+            QVERIFY(db.open());
+            QSqlQuery q(db);
+            QVERIFY(q.exec("UPDATE songs SET pitch = 3"));  // ...and theirs
+            q.finish();
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+
+    settings.closeDatabase();  // the push finds their change, and sets it aside first
+
+    QCOMPARE(spy.count(), 1);
+    QString conflictFilename = spy.at(0).at(0).toString();
+    QVERIFY(QFileInfo::exists(conflictFilename));
+    QVERIFY(QFileInfo(conflictFilename).fileName().startsWith("SquareDesk.sqlite3.conflict-"));
+    QCOMPARE(pitchInFile(conflictFilename, "conflict"), 3);
+    QCOMPARE(pitchInFile(sharedFilenameFor(root), "conflict"), 2);
+
+    // already reported, so not again at the next open
+    SongSettings again;
+    QSignalSpy againSpy(&again, &SongSettings::mirrorConflict);
+    openSettings(again, root, true);
+    again.closeDatabase();
+    QCOMPARE(againSpy.count(), 0);
+}
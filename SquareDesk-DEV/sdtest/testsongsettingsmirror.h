@@ -0,0 +1,44 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SDTEST_TESTSONGSETTINGSMIRROR_H
+#define SDTEST_TESTSONGSETTINGSMIRROR_H
+
+#include <QObject>
+
+// The "local working copy" mode of SongSettings (songsettingsmirror.h), against a shared copy on a
+//   stand-in for a slow, sync-locked filesystem: another connection that holds an exclusive lock on
+//   the shared copy, the way iCloud/Dropbox/a NAS can keep it locked (or just slow to answer) for
+//   seconds at a time.
+class TestSongSettingsMirror: public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void directModeWaitsForSharedCopy();        // the problem: the GUI thread waits for the shared copy
+    void localModeDoesNotWaitForSharedCopy();   // ...but not in local mode, even while a push is stuck
+    void conflictIsReported();
+};
+
+#endif // SDTEST_TESTSONGSETTINGSMIRROR_H
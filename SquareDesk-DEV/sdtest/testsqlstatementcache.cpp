@@ -0,0 +1,177 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "testsqlstatementcache.h"
+
+#include "songsettings.h"
+#include "sqlstatementcache.h"
+
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+#include <QtTest/QtTest>
+
+#define SONG_COUNT 20000
+#define LOOKUP_COUNT 1000
+
+static const char *connectionName = "TestSqlStatementCache";
+
+// two of the hot queries, as SongSettings::getSongIDFromFilenameAlone() and getSongMarkers() run them
+static const char *songIDSql = "SELECT rowid FROM songs WHERE filename=:filename";
+static const char *markersSql = "SELECT markerPos FROM markers WHERE song_rowid=:song_rowid";
+
+static QString songFilename(int i)
+{
+    return QString("$root/patter/RIV %1 - Some Song Title %1.mp3").arg(i, 5, 10, QChar('0'));
+}
+
+// the song's rowid, and the sum of its markers, with a fresh prepare() per query (as SongSettings
+//   used to), or with the statements kept in the cache
+static double lookUp(const QString &filename, SqlStatementCache *cache)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName);
+    int songID = -1;
+    double markerSum = 0.0;
+    if (cache == nullptr) {
+        QSqlQuery q(db);
+        q.prepare(songIDSql);
+        q.bindValue(":filename", filename);
+        q.exec();
+        while (q.next()) {
+            songID = q.value(0).toInt();
+        }
+        QSqlQuery m(db);
+        m.prepare(markersSql);
+        m.bindValue(":song_rowid", songID);
+        m.exec();
+        while (m.next()) {
+            markerSum += m.value(0).toDouble();
+        }
+    } else {
+        QSqlQuery &q = cache->prepared(songIDSql);
+        q.bindValue(":filename", filename);
+        q.exec();
+        while (q.next()) {
+            songID = q.value(0).toInt();
+        }
+        QSqlQuery &m = cache->prepared(markersSql);
+        m.bindValue(":song_rowid", songID);
+        m.exec();
+        while (m.next()) {
+            markerSum += m.value(0).toDouble();
+        }
+    }
+    return songID + markerSum;
+}
+
+void TestSqlStatementCache::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(root.isValid());
+
+    // SongSettings makes the real schema (indexes, triggers and all)...
+    {
+        SongSettings settings;
+        settings.setUseLocalWorkingCopy(false);
+        settings.openDatabase(root.path() + "/.squaredesk", root.path(), false);
+        settings.closeDatabase();
+    }
+
+    // ...and we fill it with SONG_COUNT songs, and a few markers for every fourth one
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(root.path() + "/.squaredesk/SquareDesk.sqlite3");
+    QVERIFY(db.open());
+    SongSettings::configureConnection(db, false);
+
+    QSqlQuery q(db);
+    QVERIFY(q.exec("BEGIN"));
+    QSqlQuery song(db);
+    QVERIFY(song.prepare("INSERT INTO songs(filename, songname, pitch, tempo) VALUES (:filename, :songname, 0, 125)"));
+    QSqlQuery marker(db);
+    QVERIFY(marker.prepare("INSERT INTO markers(song_rowid, markerPos) VALUES (:song_rowid, :markerPos)"));
+    for (int i = 0; i < SONG_COUNT; i++) {
+        song.bindValue(":filename", songFilename(i));
+        song.bindValue(":songname", QString("Some Song Title %1").arg(i));
+        QVERIFY(song.exec());
+        if (i % 4 == 0) {
+            for (int j = 1; j <= 3; j++) {
+                marker.bindValue(":song_rowid", song.lastInsertId());
+                marker.bindValue(":markerPos", j * 0.25);
+                QVERIFY(marker.exec());
+            }
+        }
+    }
+    QVERIFY(q.exec("COMMIT"));
+    q.exec("ANALYZE");
+
+    QRandomGenerator rng(42);
+    for (int i = 0; i < LOOKUP_COUNT; i++) {
+        lookups.append(songFilename(rng.bounded(SONG_COUNT)));
+    }
+    lookups.append("$root/patter/not in the database.mp3");
+}
+
+void TestSqlStatementCache::cleanupTestCase()
+{
+    QSqlDatabase::database(connectionName).close();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+void TestSqlStatementCache::sameQueryRebound()
+{
+    SqlStatementCache cache(QSqlDatabase::database(connectionName));
+    QSqlQuery *first = &cache.prepared(songIDSql);
+    for (const QString &filename : std::as_const(lookups)) {
+        QCOMPARE(lookUp(filename, &cache), lookUp(filename, nullptr));
+    }
+    QCOMPARE(&cache.prepared(songIDSql), first);  // still the same prepared query
+    QCOMPARE(lookUp(lookups.last(), &cache), -1.0);  // a miss doesn't see the last hit's values
+
+    cache.clear();
+}
+
+void TestSqlStatementCache::benchmarkHotQueries_data()
+{
+    QTest::addColumn<bool>("cached");
+    QTest::newRow("prepare() per call (old)") << false;
+    QTest::newRow("SqlStatementCache") << true;
+}
+
+void TestSqlStatementCache::benchmarkHotQueries()
+{
+    QFETCH(bool, cached);
+    SqlStatementCache cache(QSqlDatabase::database(connectionName));
+    double total = 0.0;
+    QBENCHMARK {
+        total = 0.0;
+        for (const QString &filename : std::as_const(lookups)) {
+            total += lookUp(filename, cached ? &cache : nullptr);
+        }
+    }
+    QVERIFY(total > 0.0);
+    cache.clear();
+}
@@ -0,0 +1,46 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SDTEST_TESTSQLSTATEMENTCACHE_H
+#define SDTEST_TESTSQLSTATEMENTCACHE_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryDir>
+
+class TestSqlStatementCache: public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void sameQueryRebound();        // the cached query gives the same answers as a fresh one
+    void benchmarkHotQueries_data();
+    void benchmarkHotQueries();     // ...and how much faster, on a 20k-song DB
+private:
+    QTemporaryDir root;
+    QStringList lookups;            // the filenames that the benchmark looks up, in a fixed random order
+};
+
+#endif // SDTEST_TESTSQLSTATEMENTCACHE_H
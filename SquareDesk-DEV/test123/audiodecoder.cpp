@@ -48,6 +48,11 @@
 #include <QDir>
 #include <QSaveFile>
 #include <QMutex>
+#ifdef Q_OS_LINUX
+#include <QtConcurrent/QtConcurrent>
+#else
+#include <QtConcurrent>
+#endif
 
 // EQ ----------
 // Disable unused parameter warnings (kfr has a lot of them)
@@ -104,6 +109,7 @@ using namespace breakfastquay;
 #include "wav_file.h"
 
 #include "perftimer.h"
+#include "audiofingerprint.h"
 
 // Processing chunk size (size chosen to be divisible by 2, 4, 6, etc. channels ...)
 #define SOUNDTOUCH_BUFF_SIZE           6720
@@ -560,6 +566,31 @@ public:
         normalizeTrack = b;
     }
 
+    void setNormalizeLoudness(bool b) {
+        // qDebug() << "new NORMALIZE LOUDNESS value: " << b;
+        normalizeLoudness = b;
+    }
+
+    void setTrackReplayGain(bool valid, double replayGain_dB) {
+        // qDebug() << "new TRACK REPLAYGAIN value: " << valid << replayGain_dB;
+        replayGainFactor = pow(10.0, replayGain_dB/20.0);  // computed once here, not once per processDSP() call
+        replayGainValid = valid;
+    }
+
+    // The gain that loudness normalization applies: the ReplayGain, BUT never so much that the
+    //   loudest peak in the song goes over 1.0.  That way a quiet-but-peaky song is brought up as far
+    //   as it can go cleanly, rather than being pushed into the limiter.
+    double loudnessNormalizeFactor() {
+        if (!replayGainValid) {
+            return(1.0);
+        }
+        double factor = replayGainFactor;
+        if (trackPeak > 0.1 && factor * trackPeak > 1.0) {
+            factor = 1.0 / trackPeak;
+        }
+        return(factor);
+    }
+
     void SetIntelBoost(unsigned int which, float val) {
 //        qDebug() << "INTEL BOOST: (" << which << ", " << val << ")";
 
@@ -665,7 +696,11 @@ public:
         float scaleFactor;  // volume and mono scaling
         float currentNormalizeFactor = 1.0;
 
-        if (normalizeTrack && trackPeak > 0.1) {
+        if (normalizeLoudness && replayGainValid) {
+            // if user told us to normalize loudness, AND we know how loud this song is, then scale so that
+            //   every song has the same integrated loudness (perceived level), rather than the same peak
+            currentNormalizeFactor = loudnessNormalizeFactor();
+        } else if (normalizeTrack && trackPeak > 0.1) {
             // if user told us to normalize, AND the track peak is > 0.1, then bump up the scaleFactor
             //  the 0.1 is protection against divide-by-zero and trying to normalize tracks that
             //  consist of silence (or near-silence).  In those cases, there's probably something else gone wrong.
@@ -939,6 +974,10 @@ private:
     double trackPeak = 0.0; // always calculated
     bool normalizeTrack = false; // true if user preference said to normalize (based on PEAK)
 
+    bool   normalizeLoudness = false; // true if user preference said to normalize (based on LOUDNESS), overrides normalizeTrack
+    bool   replayGainValid = false;   // true if we know the loudness of the current song
+    double replayGainFactor = 1.0;    // linear version of the song's ReplayGain (dB)
+
     // INTELLIGIBILITY BOOST ----------
     float intelligibilityBoost_fKHz = 1.6;
     float intelligibilityBoost_widthOctaves = 2.0;
@@ -1008,6 +1047,8 @@ AudioDecoder::AudioDecoder()
             this, &AudioDecoder::updateProgress);
     connect(&m_decoder, &QAudioDecoder::durationChanged,
             this, &AudioDecoder::updateProgress);
+    connect(&tempoCurveWatcher, &QFutureWatcher<double>::finished,
+            this, &AudioDecoder::tempoCurveWindowsDone);
 
     m_progress = -1.0;
     
@@ -1028,6 +1069,14 @@ AudioDecoder::AudioDecoder()
     myPlayer.setPriority(QThread::TimeCriticalPriority);  // this stops audio dropouts on older X86 macbook when screensaver kicks in
 
     wholeTrackPeak = 0.0;
+
+    replayGainKnown = false;
+    replayGain_dB = 0.0;
+
+    tempoConfidence = 0.0;
+
+    songBoundsKnown = false;
+    songStart_sec = songEnd_sec = 0.0;
 }
 
 // Stop the playback thread for good, and make it forget the LoudMax plugin.
@@ -1052,6 +1101,9 @@ AudioDecoder::~AudioDecoder()
     //   had already destroyed. (Issue #1266)
     shutdownAudioThread();
 
+    tempoCurveWatcher.cancel();  // its windows work on their own copy of the song, but don't leave them running
+    tempoCurveWatcher.waitForFinished();
+
     if (m_data) {
         delete m_data;
     }
@@ -1122,6 +1174,7 @@ void AudioDecoder::setSource(const QString &fileName, const QString &rootPath)
 {
     currentlyLoadedFilename = fileName; // .replace(musicRootPath,"");
     musicRootPath = rootPath;
+    songBoundsKnown = false;  // until the new song is decoded
 
     if (m_decoder.isDecoding()) {
 //        qDebug() << "*** had to stop decoding...";
@@ -1152,6 +1205,9 @@ void AudioDecoder::start()
     m_progress = -1;  // reset the progress bar to the beginning, because we're about to start.
     timer1.start();
     BPM = -1.0;  // -1 means "no BPM yet"
+    tempoCurveWatcher.cancel();  // still working on the previous song
+    tempoCurve.clear();
+    tempoConfidence = 0.0;
     m_decoder.start(); // starts the decode process
 }
 
@@ -1279,6 +1335,137 @@ float AudioDecoder::BPMsample(float sampleStart_sec, float sampleLength_sec, flo
     return finalBPMresult;
 }
 
+// Slides MiniBPM across the whole song (overlapping windows, all of them in parallel), to get a tempo curve.
+//   Each window gets its own MiniBPM, so there's no shared state.  Must be called after BPMsample(),
+//   which hands the decoded data to myPlayer.
+// The curve is cached per song (next to the beat/bar results), so this is usually just a file read.
+//   Otherwise the windows run in the background, on a mono copy of the song (so that loading the next
+//   song can't pull the data out from under them), and the curve is filled in when they're done.
+bool AudioDecoder::updateTempoCurve(float BPMbase, float BPMtolerance)
+{
+    tempoCurveWatcher.cancel();
+    tempoCurve.clear();
+    tempoConfidence = 0.0;
+
+    if (loadTempoCurveFromCache(BPMbase, BPMtolerance)) {
+        return(true);
+    }
+
+    const float *songPointer = (const float *)(m_data->constData());  // interleaved LR floats
+    unsigned int totalFramesInSong = m_data->size()/myPlayer.getBytesPerFrame();
+    double songLength_sec = totalFramesInSong / (double)SAMPLE_RATE;
+
+    QList<double> windowStarts_sec;
+    for (double start_sec = 0.0; start_sec + TEMPOCURVE_WINDOW_SEC <= songLength_sec; start_sec += TEMPOCURVE_HOP_SEC) {
+        windowStarts_sec.append(start_sec);
+    }
+    if (windowStarts_sec.isEmpty()) {
+        return(true);  // song is too short to have a curve, BPMsample() is all we've got
+    }
+
+    QVector<float> mono(totalFramesInSong);
+    for (unsigned int i = 0; i < totalFramesInSong; i++) {
+        // mixdown to mono
+        mono[i] = 0.5*songPointer[2*i] + 0.5*songPointer[2*i+1];
+    }
+
+    tempoCurveWindowStarts_sec = windowStarts_sec;
+    tempoCurveFilename = currentlyLoadedFilename;
+    tempoCurveBPMbase = BPMbase;
+    tempoCurveBPMtolerance = BPMtolerance;
+    tempoCurveWatcher.setFuture(QtConcurrent::mapped(windowStarts_sec,
+        [mono, BPMbase, BPMtolerance](const double &start_sec) -> double {
+            unsigned int offset_frames = SAMPLE_RATE * start_sec;
+            unsigned int numFrames     = SAMPLE_RATE * TEMPOCURVE_WINDOW_SEC;
+
+            MiniBPM BPMestimator(((double)(SAMPLE_RATE)));
+            BPMestimator.setBPMRange(BPMbase-BPMtolerance, BPMbase+BPMtolerance);
+            return(BPMestimator.estimateTempoOfSamples(mono.constData() + offset_frames, numFrames));
+        }));
+    return(false);
+}
+
+void AudioDecoder::tempoCurveWindowsDone()
+{
+    QFuture<double> future = tempoCurveWatcher.future();
+    if (future.isCanceled() || tempoCurveFilename != currentlyLoadedFilename) {
+        return;  // superseded: another song (or the same one again) was loaded since
+    }
+
+    setTempoCurve(tempoCurveWindowStarts_sec, future.results());
+    saveTempoCurveToCache(tempoCurveBPMbase, tempoCurveBPMtolerance);
+}
+
+void AudioDecoder::setTempoCurve(const QList<double> &windowStarts_sec, const QList<double> &windowBPMs)
+{
+    tempoCurve.clear();
+    tempoConfidence = 0.0;
+
+    std::vector<double> valid;
+    for (int i = 0; i < windowStarts_sec.size() && i < windowBPMs.size(); i++) {
+        tempoCurve.push_back({ windowStarts_sec[i] + TEMPOCURVE_WINDOW_SEC/2.0, windowBPMs[i] });
+        if (windowBPMs[i] > 0.0) {
+            valid.push_back(windowBPMs[i]);
+        }
+    }
+    if (valid.empty()) {
+        return;
+    }
+
+    // confidence = fraction of ALL windows (undetectable ones count against us) that agree with the median
+    std::sort(valid.begin(), valid.end());
+    double median = valid[valid.size()/2];
+    unsigned int agree = 0;
+    for (const double &bpm : valid) {
+        agree += (fabs(bpm - median) <= TEMPOCURVE_AGREE_BPM);
+    }
+    tempoConfidence = (double)agree / tempoCurve.size();
+
+    // qDebug() << "setTempoCurve:" << tempoCurve.size() << "windows, median" << median << "BPM, confidence" << tempoConfidence;
+}
+
+std::vector<AudioDecoder::TempoPoint> AudioDecoder::getTempoCurve() {
+    return(tempoCurve);
+}
+
+double AudioDecoder::getTempoConfidence() {
+    return(tempoConfidence);
+}
+
+// returns the local tempo at time_sec, linearly interpolated between window centers (skipping undetectable windows),
+//   or the median of the whole curve if time_sec < 0.  Falls back to the whole-song BPM if there's no curve.
+double AudioDecoder::getLocalBPM(double time_sec) {
+    std::vector<TempoPoint> valid;
+    for (const TempoPoint &p : tempoCurve) {
+        if (p.bpm > 0.0) {
+            valid.push_back(p);
+        }
+    }
+    if (valid.empty()) {
+        return(BPM);
+    }
+
+    if (time_sec < 0.0) {
+        std::vector<double> bpms;
+        for (const TempoPoint &p : valid) {
+            bpms.push_back(p.bpm);
+        }
+        std::sort(bpms.begin(), bpms.end());
+        return(bpms[bpms.size()/2]);
+    }
+
+    if (time_sec <= valid.front().time_sec) {
+        return(valid.front().bpm);
+    }
+    for (size_t i = 1; i < valid.size(); i++) {
+        if (time_sec <= valid[i].time_sec) {
+            double frac = (time_sec - valid[i-1].time_sec) / (valid[i].time_sec - valid[i-1].time_sec);
+            return(valid[i-1].bpm + frac * (valid[i].bpm - valid[i-1].bpm));
+        }
+    }
+    return(valid.back().bpm);
+}
+
 void AudioDecoder::finished()
 {
 //    qDebug() << "AudioDecoder::finished()" << m_decoder.isDecoding();
@@ -1299,6 +1486,17 @@ void AudioDecoder::finished()
 
     t->elapsed(__LINE__); // 74ms
 
+    // if the whole song mostly agrees on a tempo, that's a better estimate than any single 30 second window
+    //   (live recordings drift, medleys change tempo, and T=60-90 sec might be a break).
+    //   Only if the curve is cached, though: otherwise it's computed in the background, and this load
+    //   keeps the single-window BPM (the next load of this song will have the curve).
+    if (updateTempoCurve(125,15) && tempoConfidence >= TEMPOCURVE_MIN_CONFIDENCE) {
+        // qDebug() << "BPM: single window =" << BPM << ", whole song =" << getLocalBPM(-1.0) << ", confidence =" << tempoConfidence;
+        BPM = getLocalBPM(-1.0);  // -1 = whole song (median)
+    }
+
+    t->elapsed(__LINE__); // a cache read, or the mono mixdown for the background windows
+
 //    qDebug() << "======================================================";
 //    qDebug() << "AudioDecoder::finished is calling beatBarDetection...";
 
@@ -1310,6 +1508,22 @@ void AudioDecoder::finished()
 
     updateWaveformMap();
 
+    // LOUDNESS: if the DB already told us (setKnownReplayGain), don't measure it again
+    if (!replayGainKnown) {
+        updateLoudness();
+    }
+    myPlayer.setTrackReplayGain(replayGainKnown, replayGain_dB);
+
+    t->elapsed(__LINE__);
+
+    // SONG START/END: cheap to compute (a few ms), but cached anyway, so other analysis can use it without decoding
+    if (!loadSongBoundsFromCache()) {
+        updateSongBoundaries();
+        saveSongBoundsToCache();
+    }
+
+    t->elapsed(__LINE__);
+
     emit done(); // triggers haveDuration, which invokes haveDuration2, which initiates beat detection and power/max detection (ONLY if enabled).
 }
 
@@ -1405,6 +1619,36 @@ double AudioDecoder::getWholeTrackPeak() {
     return(wholeTrackPeak);
 }
 
+void AudioDecoder::setNormalizeLoudness(bool b) {
+    myPlayer.setNormalizeLoudness(b);
+}
+
+void AudioDecoder::setKnownReplayGain(bool known, double dB) {
+    replayGainKnown = known;
+    replayGain_dB   = (known ? dB : 0.0);
+}
+
+bool AudioDecoder::hasReplayGain() {
+    return(replayGainKnown);
+}
+
+double AudioDecoder::getReplayGain() {
+    return(replayGain_dB);
+}
+
+double AudioDecoder::getLoudnessNormalizeFactor() {
+    return(myPlayer.loudnessNormalizeFactor());
+}
+
+bool AudioDecoder::getSongBoundaries(const QString &fileName, double *pSongStart_sec, double *pSongEnd_sec) {
+    if (!songBoundsKnown || fileName != currentlyLoadedFilename) {
+        return(false);  // not decoded yet, or not this song
+    }
+    *pSongStart_sec = songStart_sec;
+    *pSongEnd_sec   = songEnd_sec;
+    return(true);
+}
+
 void AudioDecoder::SetIntelBoost(unsigned int which, float val) {
     myPlayer.SetIntelBoost(which, val);
 }
@@ -1844,6 +2088,163 @@ void AudioDecoder::saveBeatMapToCache(QString vampResultsFilename) {
     cacheFile.commit();  // ...then atomically rename the temp file into place
 }
 
+// Song start/end cache: <musicRoot>/.squareDesk/beatCache/<relativePath>.songBounds.txt
+//   Same 3-line validity header as the beat/bar cache, followed by one "start_sec,end_sec" line.
+#define SONGBOUNDSCACHE_VERSION 1
+
+QString AudioDecoder::songBoundsCacheFilename() {
+    if (musicRootPath.isEmpty() || !currentlyLoadedFilename.startsWith(musicRootPath)) {
+        return(QString()); // not under the music root, so not cacheable
+    }
+    return(QString(currentlyLoadedFilename).replace(musicRootPath, musicRootPath + "/.squareDesk/beatCache") + ".songBounds.txt");
+}
+
+bool AudioDecoder::loadSongBoundsFromCache() {
+    QString cacheFilename = songBoundsCacheFilename();
+    if (cacheFilename.isEmpty() || !QFileInfo::exists(cacheFilename)) {
+        return(false);
+    }
+
+    QFile cacheFile(cacheFilename);
+    if (!cacheFile.open(QFile::ReadOnly | QFile::Text)) {
+        return(false);
+    }
+    QTextStream in(&cacheFile);
+    QString versionLine = in.readLine();
+    QString sizeLine    = in.readLine();
+    QString mtimeLine   = in.readLine();
+    QString boundsLine  = in.readLine();
+    cacheFile.close();
+
+    QFileInfo sourceInfo(currentlyLoadedFilename);
+    if (versionLine != QString("# songBoundsCacheVersion=%1").arg(SONGBOUNDSCACHE_VERSION) ||
+        sizeLine    != QString("# sourceSize=%1").arg(sourceInfo.size()) ||
+        mtimeLine   != QString("# sourceMtime=%1").arg(sourceInfo.lastModified().toMSecsSinceEpoch())) {
+        return(false); // stale or damaged: recompute and overwrite
+    }
+
+    QStringList pieces = boundsLine.split(",");
+    if (pieces.size() != 2) {
+        return(false);
+    }
+    bool ok1, ok2;
+    double start = pieces[0].toDouble(&ok1);
+    double end   = pieces[1].toDouble(&ok2);
+    if (!ok1 || !ok2 || start < 0.0 || end <= start) {
+        return(false);
+    }
+
+    songStart_sec = start;
+    songEnd_sec   = end;
+    songBoundsKnown = true;
+    return(true);
+}
+
+void AudioDecoder::saveSongBoundsToCache() {
+    QString cacheFilename = songBoundsCacheFilename();
+    if (cacheFilename.isEmpty() || !songBoundsKnown) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(cacheFilename).absolutePath());
+
+    QSaveFile cacheFile(cacheFilename);  // atomic, see saveBeatMapToCache
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "SONGBOUNDS CACHE: could not write cache file:" << cacheFilename;
+        return;
+    }
+    QFileInfo sourceInfo(currentlyLoadedFilename);
+    QTextStream out(&cacheFile);
+    out << "# songBoundsCacheVersion=" << SONGBOUNDSCACHE_VERSION << "\n";
+    out << "# sourceSize="             << sourceInfo.size() << "\n";
+    out << "# sourceMtime="            << sourceInfo.lastModified().toMSecsSinceEpoch() << "\n";
+    out << QString::number(songStart_sec, 'f', 3) << "," << QString::number(songEnd_sec, 'f', 3) << "\n";
+
+    out.flush();
+    cacheFile.commit();
+}
+
+// Tempo curve cache: <musicRoot>/.squareDesk/beatCache/<relativePath>.tempoCurve.txt
+//   Same 3-line validity header as the beat/bar cache, then the MiniBPM range it was computed with,
+//   then one "windowStart_sec,bpm" line per window (bpm 0 = undetectable in that window).
+#define TEMPOCURVECACHE_VERSION 1
+
+QString AudioDecoder::tempoCurveCacheFilename() {
+    if (musicRootPath.isEmpty() || !currentlyLoadedFilename.startsWith(musicRootPath)) {
+        return(QString()); // not under the music root, so not cacheable
+    }
+    return(QString(currentlyLoadedFilename).replace(musicRootPath, musicRootPath + "/.squareDesk/beatCache") + ".tempoCurve.txt");
+}
+
+bool AudioDecoder::loadTempoCurveFromCache(float BPMbase, float BPMtolerance) {
+    QString cacheFilename = tempoCurveCacheFilename();
+    if (cacheFilename.isEmpty() || !QFileInfo::exists(cacheFilename)) {
+        return(false);
+    }
+
+    QFile cacheFile(cacheFilename);
+    if (!cacheFile.open(QFile::ReadOnly | QFile::Text)) {
+        return(false);
+    }
+    QTextStream in(&cacheFile);
+    QString versionLine = in.readLine();
+    QString sizeLine    = in.readLine();
+    QString mtimeLine   = in.readLine();
+    QString rangeLine   = in.readLine();
+
+    QFileInfo sourceInfo(currentlyLoadedFilename);
+    if (versionLine != QString("# tempoCurveCacheVersion=%1").arg(TEMPOCURVECACHE_VERSION) ||
+        sizeLine    != QString("# sourceSize=%1").arg(sourceInfo.size()) ||
+        mtimeLine   != QString("# sourceMtime=%1").arg(sourceInfo.lastModified().toMSecsSinceEpoch()) ||
+        rangeLine   != QString("# bpmRange=%1,%2").arg(BPMbase).arg(BPMtolerance)) {
+        return(false); // stale or damaged: recompute and overwrite
+    }
+
+    QList<double> windowStarts_sec, windowBPMs;
+    for (QString line = in.readLine(); !line.isNull(); line = in.readLine()) {
+        QStringList pieces = line.split(",");
+        bool ok1 = false, ok2 = false;
+        double start = (pieces.size() == 2 ? pieces[0].toDouble(&ok1) : 0.0);
+        double bpm   = (pieces.size() == 2 ? pieces[1].toDouble(&ok2) : 0.0);
+        if (!ok1 || !ok2) {
+            return(false);
+        }
+        windowStarts_sec.append(start);
+        windowBPMs.append(bpm);
+    }
+    cacheFile.close();
+
+    setTempoCurve(windowStarts_sec, windowBPMs);
+    return(true);
+}
+
+void AudioDecoder::saveTempoCurveToCache(float BPMbase, float BPMtolerance) {
+    QString cacheFilename = tempoCurveCacheFilename();
+    if (cacheFilename.isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(cacheFilename).absolutePath());
+
+    QSaveFile cacheFile(cacheFilename);  // atomic, see saveBeatMapToCache
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "TEMPOCURVE CACHE: could not write cache file:" << cacheFilename;
+        return;
+    }
+    QFileInfo sourceInfo(currentlyLoadedFilename);
+    QTextStream out(&cacheFile);
+    out << "# tempoCurveCacheVersion=" << TEMPOCURVECACHE_VERSION << "\n";
+    out << "# sourceSize="             << sourceInfo.size() << "\n";
+    out << "# sourceMtime="            << sourceInfo.lastModified().toMSecsSinceEpoch() << "\n";
+    out << "# bpmRange="               << QString("%1,%2").arg(BPMbase).arg(BPMtolerance) << "\n";
+    for (const TempoPoint &p : tempoCurve) {
+        out << QString::number(p.time_sec - TEMPOCURVE_WINDOW_SEC/2.0, 'f', 3) << "," << QString::number(p.bpm, 'f', 3) << "\n";
+    }
+
+    out.flush();
+    cacheFile.commit();
+}
+
 // ========================================================================================================================
 int AudioDecoder::beatBarDetection() {
 // NOTE: this can only be called after the file is completely loaded into memory!
@@ -2102,47 +2503,35 @@ void AudioDecoder::updateWaveformMap()
 
 //    qDebug() << "AudioDecoder::updateWaveformMap" << totalFramesInSong << myPlayer.bytesPerFrame << secondsInSong << WAVEFORMWIDTH; // should be 44.1kHz at this point
 
-//    int framesPerWaveformPixel = totalFramesInSong / WAVEFORMWIDTH; // truncated down, so as not to overrun
-    int framesPerWaveformPixel = totalFramesInSong / WAVEFORMSAMPLES; // truncated down, so as not to overrun
-    int framesInCurrentPixel = 0;
-    float Laccum = 0.0;
-    float Raccum = 0.0;
-    float result = 0.0; // peak for this audio segment
-
-    float wholeSongPeak = 0.0; // peak for the whole song
-
 #ifdef FINDZEROCROSSINGS
     int zeroCrossingsFound = 0;  // TEST TEST TEST *****
-#endif
-    for (int i = 0; i < totalFramesInSong; i++) {
-        float L = songPointer[2*i + 0];
-        float R = songPointer[2*i + 1];
-
-#ifdef FINDZEROCROSSINGS
+    for (int i = 0; i < totalFramesInSong - 2 && zeroCrossingsFound < 5; i++) {
         // TEST TEST TEST *************************
+        float L = songPointer[2*i + 0];
         float Lplus2 = songPointer[2*(i+2) + 0];
 
-        if ((zeroCrossingsFound < 5) && (L > 0.05) && (Lplus2 <= 0.0)) {
+        if ((L > 0.05) && (Lplus2 <= 0.0)) {
             // we found a negative going zero crossing where the first sample was above 0.05
             qDebug() << "***** Neg ZC @ frame " << i+1; // zc is one AFTER the last L that was above threshold
             zeroCrossingsFound++;
         }
-
         // TEST TEST TEST *************************
+    }
 #endif
 
-        // algorithm: MAX
-        Laccum = max(Laccum, fabs(L));
-        Raccum = max(Raccum, fabs(R));
-        result = max(Laccum, Raccum);
-
-        framesInCurrentPixel++;
-        if (framesInCurrentPixel >= framesPerWaveformPixel) {
-            waveformMap.push_back(result);
-            wholeSongPeak = max(wholeSongPeak, result);
-            Laccum = Raccum = 0.0;
-            framesInCurrentPixel = 0;
-        }
+    // one pass over the song builds every zoom level; the seekbar's waveform is just one of them
+    waveformPyramid.build(songPointer, totalFramesInSong);
+
+    // algorithm: MAX (of the absolute value)
+    std::vector<float> mins(WAVEFORMSAMPLES), maxs(WAVEFORMSAMPLES);
+    waveformPyramid.query(0, totalFramesInSong, WAVEFORMSAMPLES, mins.data(), maxs.data(), nullptr);
+
+    float wholeSongPeak = 0.0; // peak for the whole song
+    waveformMap.reserve(WAVEFORMSAMPLES);
+    for (unsigned int i = 0; i < WAVEFORMSAMPLES; i++) {
+        float result = max(fabs(mins[i]), fabs(maxs[i])); // peak for this audio segment
+        waveformMap.push_back(result);
+        wholeSongPeak = max(wholeSongPeak, result);
     }
 
     // qDebug() << "wholeSongPeak:" << wholeSongPeak;
@@ -2152,6 +2541,143 @@ void AudioDecoder::updateWaveformMap()
 //    qDebug() << "waveformMap: " << waveformMap;
 }
 
+// The function works on its own deep copy of the song (a few ms to make, vs. ~20ms to fingerprint), so it
+//   can run on a worker thread even if another song is loaded meanwhile.  NOT an implicitly shared copy:
+//   the player keeps a raw pointer into m_data, and the next non-const m_data->data() would detach
+//   m_data from the buffer it's playing, leaving that buffer owned by (and freed with) the copy.
+std::function<QVector<quint64>()> AudioDecoder::fingerprintFunction()
+{
+    QByteArray song(m_data->constData(), m_data->size());
+    unsigned int bytesPerFrame = myPlayer.getBytesPerFrame();  // pre-mixdown is 2 floats per frame = 8
+    return [song, bytesPerFrame]() {
+        return(AudioFingerprint::compute((const float *)(song.constData()), song.size()/bytesPerFrame, 2, SAMPLE_RATE));
+    };
+}
+
+void AudioDecoder::getWaveformRange(double from_sec, double to_sec, unsigned int numBins, float *mins, float *maxs, float *rms)
+{
+    unsigned int fromFrame = (unsigned int)(max(0.0, from_sec) * SAMPLE_RATE);
+    unsigned int toFrame   = (unsigned int)(max(0.0, to_sec) * SAMPLE_RATE);
+    waveformPyramid.query(fromFrame, toFrame, numBins, mins, maxs, rms);  // silence, if the song isn't loaded yet
+}
+
+// Integrated loudness of the whole song, per EBU R128 / ITU-R BS.1770 (K-weighting, 400ms blocks,
+//   -70 LUFS absolute gate and -10 LU relative gate -- all of which kfr's ebu_r128 does for us).
+//   The result is kept as a ReplayGain (dB to get to LOUDNESS_TARGET_LUFS), because that's what
+//   the songs table already has a column for.
+void AudioDecoder::updateLoudness()
+{
+    replayGainKnown = false;
+    replayGain_dB = 0.0;
+
+    unsigned int totalFramesInSong = m_data->size()/myPlayer.getBytesPerFrame(); // pre-mixdown is 2 floats per frame = 8
+    const float *songPointer = (const float *)(m_data->data());  // interleaved LR floats
+
+    ebu_r128<float> loudness(SAMPLE_RATE, { Speaker::Left, Speaker::Right });
+    const size_t packetSize = loudness.packet_size();  // 100ms of frames
+
+    univector<float> L(packetSize);
+    univector<float> R(packetSize);
+    unsigned int packets = totalFramesInSong / packetSize;  // the partial packet at the very end is ignored
+
+    for (unsigned int p = 0; p < packets; p++) {
+        const float *src = songPointer + 2 * p * packetSize;
+        for (size_t i = 0; i < packetSize; i++) {
+            L[i] = src[2*i];        // deinterleave
+            R[i] = src[2*i + 1];
+        }
+        loudness.process_packet({ make_univector(L.data(), packetSize), make_univector(R.data(), packetSize) });
+    }
+
+    float M, S, I, RL, RH;
+    loudness.get_values(M, S, I, RL, RH);
+
+    // qDebug() << "updateLoudness: integrated loudness" << I << "LUFS, range" << RH - RL << "LU";
+
+    if (std::isfinite(I) && I > LOUDNESS_SILENCE_LUFS) {
+        replayGain_dB = LOUDNESS_TARGET_LUFS - I;
+        replayGainKnown = true;
+    }
+}
+
+// Finds where the music really starts and ends, skipping leading/trailing silence, needle noise,
+//   and stray clicks.  One pass over the song computes the mean-square energy of each
+//   SONGBOUNDS_BLOCK_SEC block (kfr's sumsqr is SIMD, and works directly on the interleaved LR data),
+//   then we walk in from each end looking for the first sustained stretch of music.
+//   About 3ms for a 3 minute song.
+void AudioDecoder::updateSongBoundaries()
+{
+    unsigned int totalFramesInSong = m_data->size()/myPlayer.getBytesPerFrame(); // pre-mixdown is 2 floats per frame = 8
+    const float *songPointer = (const float *)(m_data->data());  // interleaved LR floats
+    double songLength_sec = totalFramesInSong / (double)SAMPLE_RATE;
+
+    songBoundsKnown = false;
+    songStart_sec = 0.0;
+    songEnd_sec = songLength_sec;
+
+    const unsigned int framesPerBlock = (unsigned int)(SONGBOUNDS_BLOCK_SEC * SAMPLE_RATE);
+    const unsigned int numBlocks = totalFramesInSong / framesPerBlock;
+    const unsigned int sustainBlocks = (unsigned int)(SONGBOUNDS_SUSTAIN_SEC / SONGBOUNDS_BLOCK_SEC);
+    if (numBlocks < sustainBlocks) {
+        return;  // too short to say anything useful
+    }
+
+    std::vector<float> energy(numBlocks);
+    float loudest = 0.0;
+    for (unsigned int b = 0; b < numBlocks; b++) {
+        energy[b] = sumsqr(make_univector(songPointer + 2 * b * framesPerBlock, 2 * framesPerBlock)) / (2 * framesPerBlock);
+        loudest = max(loudest, energy[b]);
+    }
+
+    // energy is mean-square, so these are 10*log10(), not 20*log10()
+    float threshold = max((float)pow(10.0, SONGBOUNDS_SILENCE_DB/10.0), loudest * (float)pow(10.0, SONGBOUNDS_RELATIVE_DB/10.0));
+    const unsigned int needed = (unsigned int)(SONGBOUNDS_SUSTAIN_FRAC * sustainBlocks);
+
+    // START: first music block that begins a sustained stretch of music
+    int startBlock = -1;
+    unsigned int musicInWindow = 0;
+    for (unsigned int b = 0; b < sustainBlocks; b++) {
+        musicInWindow += (energy[b] > threshold);
+    }
+    for (unsigned int b = 0; b + sustainBlocks <= numBlocks; b++) {
+        if (energy[b] > threshold && musicInWindow >= needed) {
+            startBlock = b;
+            break;
+        }
+        musicInWindow -= (energy[b] > threshold);  // slide the window right by one block
+        if (b + sustainBlocks < numBlocks) {
+            musicInWindow += (energy[b + sustainBlocks] > threshold);
+        }
+    }
+
+    // END: last music block that ends a sustained stretch of music
+    int endBlock = -1;
+    musicInWindow = 0;
+    for (unsigned int b = numBlocks - sustainBlocks; b < numBlocks; b++) {
+        musicInWindow += (energy[b] > threshold);
+    }
+    for (int b = numBlocks - 1; b >= (int)sustainBlocks - 1; b--) {
+        if (energy[b] > threshold && musicInWindow >= needed) {
+            endBlock = b;
+            break;
+        }
+        musicInWindow -= (energy[b] > threshold);  // slide the window left by one block
+        if (b - (int)sustainBlocks >= 0) {
+            musicInWindow += (energy[b - sustainBlocks] > threshold);
+        }
+    }
+
+    if (startBlock < 0 || endBlock <= startBlock) {
+        return;  // no sustained music anywhere (silence, or all noise), so don't guess
+    }
+
+    songStart_sec = startBlock * SONGBOUNDS_BLOCK_SEC;
+    songEnd_sec   = min(songLength_sec, (endBlock + 1) * SONGBOUNDS_BLOCK_SEC);
+    songBoundsKnown = true;
+
+    // qDebug() << "updateSongBoundaries:" << songStart_sec << songEnd_sec << "of" << songLength_sec;
+}
+
 #ifdef USE_JUCE
 void AudioDecoder::setLoudMaxPlugin(std::unique_ptr<juce::AudioPluginInstance> &p) { // pass by reference
     // qDebug() << "AudioDecoder::setLoudMaxPlugin()";
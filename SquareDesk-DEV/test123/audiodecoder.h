@@ -109,7 +109,9 @@
 #endif /* else if defined Q_OS_LINUX */
 
 #include <QProcess>
+#include <QFutureWatcher>
 #include "perftimer.h"
+#include "waveformpyramid.h"
 
 // BASS_ChannelIsActive return values
 #define BASS_ACTIVE_STOPPED 0
@@ -119,6 +121,31 @@
 
 #define PROCESSED_DATA_BUFFER_SIZE 65536
 
+// Loudness normalization target.  -18 LUFS is the ReplayGain 2.0 reference level, which leaves
+//   enough headroom that most square dance recordings are turned DOWN, not up, so the LoudMax
+//   limiter (and our own hard limiter) rarely has anything to do.
+#define LOUDNESS_TARGET_LUFS (-18.0)
+#define LOUDNESS_SILENCE_LUFS (-70.0)  // EBU R128 absolute gate: anything quieter is "no loudness"
+
+// Song start/end detection (leading/trailing silence, needle noise, count-in clicks).
+//   A block counts as "music" if it's above SONGBOUNDS_SILENCE_DB AND within SONGBOUNDS_RELATIVE_DB of
+//   the loudest block in the song.  Music starts at the first block that begins a SONGBOUNDS_SUSTAIN_SEC
+//   stretch that is mostly (SONGBOUNDS_SUSTAIN_FRAC) music; isolated clicks and pops never qualify.
+#define SONGBOUNDS_BLOCK_SEC     (0.010)
+#define SONGBOUNDS_SILENCE_DB    (-50.0)
+#define SONGBOUNDS_RELATIVE_DB   (-30.0)
+#define SONGBOUNDS_SUSTAIN_SEC   (0.250)
+#define SONGBOUNDS_SUSTAIN_FRAC  (0.8)
+
+// Whole-song tempo tracking: MiniBPM is run on overlapping TEMPOCURVE_WINDOW_SEC windows, every
+//   TEMPOCURVE_HOP_SEC, in parallel, in the background (and the curve is cached).  Confidence is the fraction of windows that agree with the median
+//   (within TEMPOCURVE_AGREE_BPM); below TEMPOCURVE_MIN_CONFIDENCE we fall back to the single-window estimate.
+#define TEMPOCURVE_WINDOW_SEC      (20.0)
+#define TEMPOCURVE_HOP_SEC         (10.0)
+#define TEMPOCURVE_AGREE_BPM       (2.0)
+#define TEMPOCURVE_MIN_CONFIDENCE  (0.6)
+
+#include <functional>
 #include <vector>
 
 class AudioDecoder : public QObject
@@ -160,6 +187,16 @@ public:
     void setNormalizeTrack(bool b); // true if we want to normalize highest peak in song to 1.0
     double getWholeTrackPeak(); // returns current peak value
 
+    // LOUDNESS NORMALIZATION (EBU R128 integrated loudness, stored in the DB as ReplayGain) -----
+    void setNormalizeLoudness(bool b);  // true if we want every song to play at LOUDNESS_TARGET_LUFS
+    void setKnownReplayGain(bool known, double replayGain_dB); // call BEFORE start(): if known, loudness analysis is skipped
+    bool hasReplayGain();               // true when the loudness of the current song is known (measured or from the DB)
+    double getReplayGain();             // dB to get from the song's integrated loudness to LOUDNESS_TARGET_LUFS
+    double getLoudnessNormalizeFactor(); // linear gain actually applied in loudness mode (peak-limited)
+
+    // SONG START/END (where the music actually starts and ends, found after the decode is done) -----
+    bool getSongBoundaries(const QString &fileName, double *songStart_sec, double *songEnd_sec); // false if not known for fileName
+
     void SetIntelBoost(unsigned int which, float val);
     void SetIntelBoostEnabled(bool enable);
 
@@ -179,6 +216,17 @@ public:
 
     float BPMsample(float sampleStart_sec, float sampleLength_sec, float BPMbase, float BPMtolerance);
 
+    // TEMPO CURVE (local tempo across the whole song, for live recordings and medleys that drift) -----
+    struct TempoPoint {
+        double time_sec;  // center of the window
+        double bpm;       // 0 = undetectable in this window
+    };
+    bool updateTempoCurve(float BPMbase, float BPMtolerance);  // true = tempoCurve/tempoConfidence filled in now (cached),
+                                                               //   false = computing in the background, see tempoCurveWindowsDone()
+    std::vector<TempoPoint> getTempoCurve();
+    double getTempoConfidence();          // 0.0 - 1.0, how steady the tempo is across the whole song
+    double getLocalBPM(double time_sec);  // interpolated from the tempo curve, else the whole-song BPM
+
     QString makeExternalAudioFile(QString filename);  // used by beatBarDetection and segmentDetection
     QString runVamp(QString whichModule, QString WAVfilename, QString resultsFilename);
 
@@ -191,6 +239,16 @@ public:
     void saveBeatMapToCache(QString vampResultsFilename); // writes validity header + vamp results to cache
     bool parseBeatResultsFile(const QString &filename);  // fills beatMap/measureMap; '#' lines ignored
 
+    // song start/end results are cached right next to the beat/bar results, with the same validity header
+    QString songBoundsCacheFilename();                   // "" if song is not cacheable (not under musicRootPath)
+    bool loadSongBoundsFromCache();                      // true = valid cache found, songStart_sec/songEnd_sec filled in
+    void saveSongBoundsToCache();
+
+    // ...and so is the tempo curve
+    QString tempoCurveCacheFilename();                   // "" if song is not cacheable (not under musicRootPath)
+    bool loadTempoCurveFromCache(float BPMbase, float BPMtolerance);  // true = valid cache found, tempoCurve filled in
+    void saveTempoCurveToCache(float BPMbase, float BPMtolerance);
+
 #define GRANULARITY_NONE 0
 #define GRANULARITY_BEAT 1
 #define GRANULARITY_MEASURE 2
@@ -209,7 +267,14 @@ public:
     QTimer *playTimer;
     bool activelyPlaying;
 
-    std::vector<float> waveformMap;  // WAVEFORMWIDTH samples of the power/max of the song for each songLength/WAVEFORMWIDTH second window
+    std::vector<float> waveformMap;  // WAVEFORMSAMPLES samples of the power/max of the song for each songLength/WAVEFORMSAMPLES second window
+    WaveformPyramid waveformPyramid; // min/max/RMS of the song at every zoom level (waveformMap is made from this)
+
+    // min/max/RMS of [from_sec, to_sec) in numBins windows, for drawing a zoomed-in waveform (any output can be nullptr)
+    void getWaveformRange(double from_sec, double to_sec, unsigned int numBins, float *mins, float *maxs, float *rms);
+
+    // computes the acoustic fingerprint of the whole song (see audiofingerprint.h), on any thread; empty if not decoded yet
+    std::function<QVector<quint64>()> fingerprintFunction();
 
 #ifdef USE_JUCE
     void setLoudMaxPlugin(std::unique_ptr<juce::AudioPluginInstance> &p); // pass by reference
@@ -229,9 +294,12 @@ public slots:
     void finished();
 
     void updateWaveformMap();
+    void updateLoudness();  // measures integrated loudness of the whole song (EBU R128)
+    void updateSongBoundaries();  // finds where the music starts and ends (skips silence and needle noise)
 
 private slots:
     void updateProgress();
+    void tempoCurveWindowsDone();  // the background windows of updateTempoCurve() are all done
 
 private:
     QString       currentlyLoadedFilename;
@@ -249,6 +317,14 @@ private:
     QByteArray *m_data;
 
     double BPM;
+    std::vector<TempoPoint> tempoCurve;
+    double tempoConfidence;
+    void setTempoCurve(const QList<double> &windowStarts_sec, const QList<double> &windowBPMs);  // also sets tempoConfidence
+
+    QFutureWatcher<double> tempoCurveWatcher;  // one MiniBPM result per window, computed in the background
+    QList<double> tempoCurveWindowStarts_sec;  // the windows it is working on...
+    QString tempoCurveFilename;                // ...for this song
+    float tempoCurveBPMbase, tempoCurveBPMtolerance;
 
     QString m_currentAudioOutputDeviceName;
 
@@ -275,6 +351,13 @@ private:
 
     double wholeTrackPeak;
 
+    bool   replayGainKnown;     // true if replayGain_dB is valid for the currently loaded song
+    double replayGain_dB;       // LOUDNESS_TARGET_LUFS - integrated loudness of the song
+
+    bool   songBoundsKnown;     // true if songStart_sec/songEnd_sec are valid for the currently loaded song
+    double songStart_sec;       // start of music (seconds)
+    double songEnd_sec;         // end of music (seconds)
+
     PerfTimer *t;
 };
 
@@ -0,0 +1,566 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "audiofingerprint.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Disable unused parameter warnings (kfr has a lot of them)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+
+#include <kfr/base.hpp>
+#include <kfr/dft.hpp>
+
+#pragma GCC diagnostic pop
+
+using namespace kfr;
+
+// ========================================================================================================================
+// scrambles a landmark hash, so that "keep the small ones" is an unbiased, but repeatable, sample (lowbias32)
+static inline quint32 mixHash(quint32 h)
+{
+    h ^= h >> 16;
+    h *= 0x7feb352dU;
+    h ^= h >> 15;
+    h *= 0x846ca68bU;
+    h ^= h >> 16;
+    return(h);
+}
+
+QVector<quint64> AudioFingerprint::compute(const float *samples, size_t numFrames, unsigned int channels, unsigned int sampleRate)
+{
+    QVector<quint64> result;
+    if (samples == nullptr || channels == 0 || sampleRate == 0) {
+        return(result);
+    }
+
+    // MIXDOWN AND DECIMATE to ~11kHz mono (a box filter is plenty, we only look at 300-3000Hz) --------
+    unsigned int decimation = std::max(1u, (unsigned int)std::lround((double)sampleRate / FINGERPRINT_SAMPLE_RATE));
+    double rate = (double)sampleRate / decimation;
+    size_t n = numFrames / decimation;
+    if (n < FINGERPRINT_FFT_SIZE) {
+        return(result);  // too short to fingerprint
+    }
+    const unsigned int samplesPerOutput = decimation * channels;
+    std::vector<float> decimated(n);
+    for (size_t i = 0; i < n; i++) {
+        const float *p = samples + i * samplesPerOutput;
+        float sum = 0.0f;
+        for (unsigned int j = 0; j < samplesPerOutput; j++) {
+            sum += p[j];
+        }
+        decimated[i] = sum / samplesPerOutput;
+    }
+
+    // SPECTROGRAM (log magnitude, only the bins we care about) --------
+    const unsigned int minBin = (unsigned int)(FINGERPRINT_MIN_HZ * FINGERPRINT_FFT_SIZE / rate);
+    const unsigned int maxBin = std::min((unsigned int)(FINGERPRINT_MAX_HZ * FINGERPRINT_FFT_SIZE / rate), (unsigned int)FINGERPRINT_FFT_SIZE/2);
+    const unsigned int numBins = maxBin - minBin;
+    const size_t numFFTFrames = (n - FINGERPRINT_FFT_SIZE) / FINGERPRINT_HOP_SIZE + 1;
+
+    dft_plan_real<float> plan(FINGERPRINT_FFT_SIZE);
+    univector<u8> temp(plan.temp_size);
+    univector<float> window(FINGERPRINT_FFT_SIZE);
+    for (unsigned int i = 0; i < FINGERPRINT_FFT_SIZE; i++) {
+        window[i] = 0.5f - 0.5f * std::cos(2.0 * M_PI * i / (FINGERPRINT_FFT_SIZE - 1));  // Hann
+    }
+    univector<float> frame(FINGERPRINT_FFT_SIZE);
+    univector<complex<float>> spectrum(FINGERPRINT_FFT_SIZE/2 + 1);
+
+    std::vector<float> spectrogram(numFFTFrames * numBins);
+    for (size_t f = 0; f < numFFTFrames; f++) {
+        frame = make_univector(decimated.data() + f * FINGERPRINT_HOP_SIZE, FINGERPRINT_FFT_SIZE) * window;
+        plan.execute(spectrum.data(), frame.data(), temp.data());
+        float *row = &spectrogram[f * numBins];
+        for (unsigned int b = 0; b < numBins; b++) {
+            row[b] = std::log(cabssqr(spectrum[minBin + b]) + 1e-10f);
+        }
+    }
+
+    // PEAKS: per frame, the strongest local maxima in frequency ------
+    //   (NOTE: also requiring a maximum in time looks better on paper, but sustained notes make that
+    //   a coin toss decided by noise, and it cut the match rate of re-encoded files by 2/3)
+    struct Peak { unsigned int frame; unsigned int bin; };
+    std::vector<Peak> peaks;
+    const int nbrBins = 3;  // must beat its neighbors this far away in frequency
+    for (size_t f = 0; f < numFFTFrames; f++) {
+        const float *row = &spectrogram[f * numBins];
+
+        // frame mean, so that peaks in quiet passages aren't just noise
+        float mean = 0.0f;
+        for (unsigned int b = 0; b < numBins; b++) {
+            mean += row[b];
+        }
+        mean /= numBins;
+
+        std::vector<std::pair<float, unsigned int> > candidates;
+        for (int b = nbrBins; b < (int)numBins - nbrBins; b++) {
+            float v = row[b];
+            if (v < mean + 2.0f) {  // +2.0 (natural log of power) is about 9dB above the mean
+                continue;
+            }
+            bool isMax = true;
+            for (int d = -nbrBins; d <= nbrBins && isMax; d++) {
+                isMax = (d == 0 || v >= row[b + d]);
+            }
+            if (isMax) {
+                candidates.push_back({ v, (unsigned int)b });
+            }
+        }
+
+        size_t keep = std::min(candidates.size(), (size_t)FINGERPRINT_PEAKS_PER_FRAME);
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                          [](const std::pair<float, unsigned int> &a, const std::pair<float, unsigned int> &b) { return(a.first > b.first); });
+        for (size_t i = 0; i < keep; i++) {
+            peaks.push_back({ (unsigned int)f, candidates[i].second });
+        }
+    }
+
+    // LANDMARKS: pair each anchor peak with the next few peaks in its target zone -------
+    //   hash = anchor bin (9 bits) | bin delta + 256 (9 bits) | frame delta (6 bits)
+    //   Only the ones whose scrambled hash is in the bottom 1/2^FINGERPRINT_SAMPLING_BITS are kept.
+    std::vector<std::pair<quint32, quint64> > sampled;  // (mixHash(hash), landmark)
+    for (size_t i = 0; i < peaks.size(); i++) {
+        unsigned int paired = 0;
+        for (size_t j = i + 1; j < peaks.size() && paired < FINGERPRINT_FANOUT; j++) {
+            unsigned int dt = peaks[j].frame - peaks[i].frame;
+            if (dt == 0) {
+                continue;  // same frame
+            }
+            if (dt > FINGERPRINT_MAX_DT_FRAMES) {
+                break;     // peaks are in frame order, so nothing further can be in the zone
+            }
+            int df = (int)peaks[j].bin - (int)peaks[i].bin;
+            quint32 hash = ((peaks[i].bin & 0x1FF) << 15) | (((quint32)(df + 256) & 0x1FF) << 6) | (dt & 0x3F);
+            quint32 mixed = mixHash(hash);
+            if ((mixed >> (32 - FINGERPRINT_SAMPLING_BITS)) == 0) {
+                sampled.push_back({ mixed, ((quint64)hash << 32) | peaks[i].frame });
+            }
+            paired++;
+        }
+    }
+
+    if (sampled.size() > (size_t)FINGERPRINT_MAX_LANDMARKS) {
+        // still the same ones in every copy, as long as the copies are about the same length
+        std::nth_element(sampled.begin(), sampled.begin() + FINGERPRINT_MAX_LANDMARKS, sampled.end());
+        sampled.resize(FINGERPRINT_MAX_LANDMARKS);
+    }
+    result.reserve((int)sampled.size());
+    for (const auto &s : sampled) {
+        result.append(s.second);
+    }
+    std::sort(result.begin(), result.end());  // by hash, then by time
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    // qDebug() << "AudioFingerprint::compute:" << numFrames << "frames," << peaks.size() << "peaks," << result.size() << "landmarks";
+    return(result);
+}
+
+int AudioFingerprint::bestOffsetVotes(std::vector<int> &offsets)
+{
+    // sliding window over the sorted offsets, 2 frames wide (a re-encode can shift things by a frame or so)
+    std::sort(offsets.begin(), offsets.end());
+    int best = 0;
+    size_t first = 0;
+    for (size_t last = 0; last < offsets.size(); last++) {
+        while (offsets[last] - offsets[first] > 1) {
+            first++;
+        }
+        best = std::max(best, (int)(last - first + 1));
+    }
+    return(best);
+}
+
+double AudioFingerprint::similarity(const QVector<quint64> &a, const QVector<quint64> &b)
+{
+    if (a.isEmpty() || b.isEmpty()) {
+        return(0.0);
+    }
+    // both are sorted by hash, so this is a merge; each run of equal hashes votes for all of its offsets
+    std::vector<int> offsets;
+    int i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        quint32 ha = (quint32)(a[i] >> 32), hb = (quint32)(b[j] >> 32);
+        if (ha < hb) {
+            i++;
+        } else if (hb < ha) {
+            j++;
+        } else {
+            int iEnd = i, jEnd = j;
+            while (iEnd < a.size() && (quint32)(a[iEnd] >> 32) == ha) { iEnd++; }
+            while (jEnd < b.size() && (quint32)(b[jEnd] >> 32) == hb) { jEnd++; }
+            for (int ii = i; ii < iEnd; ii++) {
+                for (int jj = j; jj < jEnd; jj++) {
+                    offsets.push_back((int)(quint32)b[jj] - (int)(quint32)a[ii]);
+                }
+            }
+            i = iEnd; j = jEnd;
+        }
+    }
+    return((double)bestOffsetVotes(offsets) / std::min(a.size(), b.size()));
+}
+
+// ========================================================================================================================
+#define FINGERPRINTINDEX_MAGIC 0x53444650  // "SDFP"
+
+FingerprintIndex::FingerprintIndex() : loaded(false), dirty(false), invertedIsValid(false), maxPostings(FINGERPRINT_MIN_POSTINGS)
+{
+}
+
+void FingerprintIndex::setMusicRoot(const QString &musicRootPath)
+{
+    QMutexLocker locker(&lock);
+    if (musicRootPath == musicRoot) {
+        return;
+    }
+    musicRoot = musicRootPath;
+    entries.clear();
+    ids.clear();
+    postings.clear();
+    loaded = false;  // loaded the first time it's needed
+    dirty = false;
+    invertedIsValid = false;
+}
+
+QString FingerprintIndex::indexFilename()
+{
+    return(musicRoot + "/.squaredesk/fingerprints.dat");
+}
+
+QString FingerprintIndex::relativePath(const QString &pathToSong)
+{
+    QString p = pathToSong;
+    if (!musicRoot.isEmpty() && p.startsWith(musicRoot + "/")) {
+        p = p.mid(musicRoot.length() + 1);
+    }
+    return(p);
+}
+
+void FingerprintIndex::ensureLoaded()
+{
+    if (loaded || musicRoot.isEmpty()) {
+        return;
+    }
+    loaded = true;
+
+    QFile f(indexFilename());
+    if (!f.open(QIODevice::ReadOnly)) {
+        return;  // no index yet, that's fine
+    }
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, version, count;
+    in >> magic >> version >> count;
+    if (magic != FINGERPRINTINDEX_MAGIC || version != FINGERPRINT_VERSION) {
+        qDebug() << "FingerprintIndex: ignoring old or damaged index:" << indexFilename();
+        return;  // algorithm changed: start over, songs will be re-fingerprinted as they're analyzed
+    }
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        QString relPath;
+        Entry e;
+        in >> relPath >> e.size >> e.mtime >> e.landmarks;
+        entries.insert(relPath, e);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "FingerprintIndex: index was truncated:" << indexFilename();
+        entries.clear();
+    }
+    invertedIsValid = false;
+}
+
+bool FingerprintIndex::save()
+{
+    QMutexLocker locker(&lock);
+    if (!dirty || musicRoot.isEmpty()) {
+        return(true);
+    }
+
+    QDir().mkpath(QFileInfo(indexFilename()).absolutePath());
+
+    QSaveFile f(indexFilename());  // atomic: a crash can't leave a half-written index
+    if (!f.open(QIODevice::WriteOnly)) {
+        qDebug() << "FingerprintIndex: could not write:" << indexFilename();
+        return(false);
+    }
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << (quint32)FINGERPRINTINDEX_MAGIC << (quint32)FINGERPRINT_VERSION << (quint32)entries.size();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        out << it.key() << it.value().size << it.value().mtime << it.value().landmarks;
+    }
+    if (!f.commit()) {
+        return(false);
+    }
+    dirty = false;
+    return(true);
+}
+
+bool FingerprintIndex::isUpToDate(const QString &pathToSong)
+{
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+
+    auto it = entries.constFind(relativePath(pathToSong));
+    if (it == entries.constEnd()) {
+        return(false);
+    }
+    QFileInfo fi(pathToSong);
+    return(it.value().size == fi.size() && it.value().mtime == fi.lastModified().toMSecsSinceEpoch());
+}
+
+void FingerprintIndex::add(const QString &pathToSong, const QVector<quint64> &landmarks)
+{
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+
+    QString relPath = relativePath(pathToSong);
+    QFileInfo fi(pathToSong);
+    Entry e;
+    e.size   = fi.size();
+    e.mtime  = fi.lastModified().toMSecsSinceEpoch();
+    e.landmarks = landmarks;
+
+    if (invertedIsValid) {
+        auto existing = idByPath.constFind(relPath);
+        int id;
+        if (existing != idByPath.constEnd()) {
+            id = existing.value();
+            removePostings(id, entries.value(relPath).landmarks);  // re-fingerprinted: the old landmarks go
+        } else {
+            id = ids.size();
+            ids.append(relPath);
+            idByPath.insert(relPath, id);
+        }
+        addPostings(id, landmarks);
+        updateMaxPostings();
+    }
+    entries.insert(relPath, e);
+
+    dirty = true;
+}
+
+void FingerprintIndex::remove(const QString &pathToSong)
+{
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+
+    QString relPath = relativePath(pathToSong);
+    auto it = entries.find(relPath);
+    if (it == entries.end()) {
+        return;
+    }
+    if (invertedIsValid) {
+        int id = idByPath.take(relPath);
+        removePostings(id, it.value().landmarks);
+        ids[id].clear();  // songIds aren't reused, so the others stay valid
+        updateMaxPostings();
+    }
+    entries.erase(it);
+    dirty = true;
+}
+
+void FingerprintIndex::addPostings(int id, const QVector<quint64> &landmarks)
+{
+    for (const quint64 &landmark : landmarks) {
+        postings[(quint32)(landmark >> 32)].append({ id, (int)(quint32)landmark });
+    }
+}
+
+void FingerprintIndex::removePostings(int id, const QVector<quint64> &landmarks)
+{
+    for (const quint64 &landmark : landmarks) {
+        auto p = postings.find((quint32)(landmark >> 32));
+        if (p == postings.end()) {
+            continue;
+        }
+        p.value().removeIf([id](const Posting &posting) { return(posting.id == id); });
+        if (p.value().isEmpty()) {
+            postings.erase(p);
+        }
+    }
+}
+
+// a fixed cutoff would throw away more and more of the hashes as the library grows
+void FingerprintIndex::updateMaxPostings()
+{
+    maxPostings = std::max(FINGERPRINT_MIN_POSTINGS, (int)(idByPath.size() * FINGERPRINT_COMMON_HASH_PERCENT / 100));
+}
+
+void FingerprintIndex::ensureInverted()
+{
+    if (invertedIsValid) {
+        return;
+    }
+
+    ids.clear();
+    idByPath.clear();
+    postings.clear();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        int id = ids.size();
+        ids.append(it.key());
+        idByPath.insert(it.key(), id);
+        addPostings(id, it.value().landmarks);
+    }
+
+    updateMaxPostings();
+    invertedIsValid = true;
+}
+
+QHash<int, int> FingerprintIndex::matchVotes(const QVector<quint64> &landmarks, int skipId)
+{
+    QHash<int, std::vector<int> > offsets;  // songId --> (their time - my time), one per shared landmark
+    for (const quint64 &landmark : landmarks) {
+        auto p = postings.constFind((quint32)(landmark >> 32));
+        if (p == postings.constEnd() || p.value().size() > maxPostings) {
+            continue;  // unknown, or too common to tell songs apart
+        }
+        int myFrame = (int)(quint32)landmark;
+        for (const Posting &posting : p.value()) {
+            if (posting.id != skipId) {
+                offsets[posting.id].push_back(posting.frame - myFrame);
+            }
+        }
+    }
+
+    QHash<int, int> votes;
+    for (auto it = offsets.begin(); it != offsets.end(); ++it) {
+        if ((int)it.value().size() >= FINGERPRINT_MIN_VOTES) {  // can't possibly be enough, so don't bother sorting
+            votes.insert(it.key(), AudioFingerprint::bestOffsetVotes(it.value()));
+        }
+    }
+    return(votes);
+}
+
+bool FingerprintIndex::isSameSong(int votes, int sizeA, int sizeB, double minSimilarity)
+{
+    return(votes >= FINGERPRINT_MIN_VOTES && (double)votes / std::min(sizeA, sizeB) >= minSimilarity);
+}
+
+QStringList FingerprintIndex::findSameSong(const QString &pathToSong, double minSimilarity)
+{
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+    ensureInverted();
+
+    QStringList result;
+    QString relPath = relativePath(pathToSong);
+    auto me = entries.constFind(relPath);
+    if (me == entries.constEnd() || me.value().landmarks.isEmpty()) {
+        return(result);
+    }
+
+    QHash<int, int> votes = matchVotes(me.value().landmarks, idByPath.value(relPath, -1));
+
+    QList<QPair<double, QString> > matches;
+    for (auto it = votes.constBegin(); it != votes.constEnd(); ++it) {
+        const Entry &other = entries[ids[it.key()]];
+        if (isSameSong(it.value(), me.value().landmarks.size(), other.landmarks.size(), minSimilarity)) {
+            double sim = (double)it.value() / std::min(me.value().landmarks.size(), other.landmarks.size());
+            matches.append(qMakePair(sim, ids[it.key()]));
+        }
+    }
+    std::sort(matches.begin(), matches.end(),
+              [](const QPair<double, QString> &a, const QPair<double, QString> &b) { return(a.first > b.first); });
+
+    for (const auto &m : matches) {
+        result.append(musicRoot + "/" + m.second);  // back to absolute paths
+    }
+    return(result);
+}
+
+QList<QStringList> FingerprintIndex::findDuplicates(double minSimilarity)
+{
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+    ensureInverted();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // union-find over songIds, joined whenever two songs are similar enough
+    QVector<int> parent(ids.size());
+    for (int i = 0; i < parent.size(); i++) {
+        parent[i] = i;
+    }
+    auto findRoot = [&parent](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];  // path halving
+            i = parent[i];
+        }
+        return(i);
+    };
+
+    for (int id = 0; id < ids.size(); id++) {
+        if (ids[id].isEmpty()) {
+            continue;  // removed
+        }
+        const QVector<quint64> &mine = entries[ids[id]].landmarks;
+        if (mine.isEmpty()) {
+            continue;
+        }
+        QHash<int, int> votes = matchVotes(mine, id);
+        for (auto it = votes.constBegin(); it != votes.constEnd(); ++it) {
+            if (it.key() < id) {
+                continue;  // already compared from the other side
+            }
+            if (isSameSong(it.value(), mine.size(), entries[ids[it.key()]].landmarks.size(), minSimilarity)) {
+                parent[findRoot(it.key())] = findRoot(id);
+            }
+        }
+    }
+
+    QHash<int, QStringList> groups;
+    for (int id = 0; id < ids.size(); id++) {
+        if (!ids[id].isEmpty()) {
+            groups[findRoot(id)].append(musicRoot + "/" + ids[id]);
+        }
+    }
+
+    QList<QStringList> result;
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        if (it.value().size() > 1) {
+            QStringList g = it.value();
+            g.sort(Qt::CaseInsensitive);
+            result.append(g);
+        }
+    }
+
+    // qDebug() << "FingerprintIndex::findDuplicates:" << ids.size() << "songs," << result.size() << "groups in" << timer.elapsed() << "ms";
+    return(result);
+}
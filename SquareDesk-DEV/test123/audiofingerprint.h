@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef AUDIOFINGERPRINT_H_INCLUDED
+#define AUDIOFINGERPRINT_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+#include <vector>
+
+// ACOUSTIC FINGERPRINTS ---------------------------------------------------------------------------------
+//   A fingerprint is a sorted list of "landmarks": pairs of spectral peaks, each one a 24-bit hash packing
+//   (anchor frequency, frequency delta, time delta), plus the time (FFT frame) of the anchor peak.  Landmarks
+//   survive re-encoding, bitrate and format changes, and small level changes, so two files of the same
+//   recording share many of them, AT THE SAME TIME OFFSET, while different recordings share few, at random
+//   offsets.  So the match score is the biggest number of shared landmarks that agree on one offset.
+//
+//   Only about 1 in FINGERPRINT_SAMPLING landmarks is kept, chosen by the value of its hash, so that every
+//   copy of a recording keeps the same ones.  That's a few hundred per song, instead of ~35k.
+//
+//   The spectrum is computed with kfr's real FFT on a ~11kHz mono mixdown.
+
+#define FINGERPRINT_VERSION              2
+
+#define FINGERPRINT_SAMPLE_RATE          11025   // audio is decimated to about this rate first
+#define FINGERPRINT_FFT_SIZE             1024    // ~93ms
+#define FINGERPRINT_HOP_SIZE             512     // ~46ms between frames
+#define FINGERPRINT_MIN_HZ               300.0   // peaks are only looked for in this band
+#define FINGERPRINT_MAX_HZ               3000.0
+#define FINGERPRINT_PEAKS_PER_FRAME      3
+#define FINGERPRINT_FANOUT               3       // each anchor peak is paired with this many later peaks
+#define FINGERPRINT_MAX_DT_FRAMES        32      // ...no more than this many frames later (~1.5 sec)
+#define FINGERPRINT_SAMPLING_BITS        7       // keep 1 in 2^7 = 128 landmarks...
+#define FINGERPRINT_MAX_LANDMARKS        1000    // ...but no more than this many (very long files)
+
+#define FINGERPRINT_SAME_SONG_SIMILARITY 0.30    // fraction of the smaller fingerprint's landmarks that must match at one offset
+#define FINGERPRINT_MIN_VOTES            10      // ...and never fewer than this many (short files)
+#define FINGERPRINT_COMMON_HASH_PERCENT  1       // hashes found in more than this % of the songs are too common to be useful
+#define FINGERPRINT_MIN_POSTINGS         32      // ...but a hash in this many songs or fewer is never "too common"
+
+class AudioFingerprint
+{
+public:
+    // interleaved float samples (-1.0..1.0) at sampleRate --> sorted, unique landmarks, each (hash << 32 | frame)
+    static QVector<quint64> compute(const float *samples, size_t numFrames, unsigned int channels, unsigned int sampleRate);
+
+    // fraction (0.0 - 1.0) of the smaller fingerprint's landmarks that are also in the other one, at the best offset
+    static double similarity(const QVector<quint64> &a, const QVector<quint64> &b);
+
+    // the biggest number of (other time - my time) offsets that agree, give or take one frame.  Sorts offsets.
+    static int bestOffsetVotes(std::vector<int> &offsets);
+};
+
+// On-disk inverted index of fingerprints for the whole music library, in <musicRoot>/.squaredesk/fingerprints.dat
+//   Entries are keyed by path relative to the music root, and remember the source file's size and mtime,
+//   so a changed file is re-fingerprinted.  The hash --> songs inverted index is built in memory on demand,
+//   and after that, add() and remove() keep it up to date, so a new song doesn't mean rebuilding it.
+//   All public methods are thread-safe (bulk processing adds fingerprints from worker threads).
+class FingerprintIndex
+{
+public:
+    FingerprintIndex();
+
+    void setMusicRoot(const QString &musicRootPath);  // forgets everything, and (lazily) loads that root's index
+    bool save();                                      // only writes if something changed
+
+    bool isUpToDate(const QString &pathToSong);       // true if we have a fingerprint for the current version of this file
+    void add(const QString &pathToSong, const QVector<quint64> &landmarks);
+    void remove(const QString &pathToSong);
+
+    QStringList findSameSong(const QString &pathToSong,
+                             double minSimilarity = FINGERPRINT_SAME_SONG_SIMILARITY);  // other files of the same recording, best first
+    QList<QStringList> findDuplicates(double minSimilarity = FINGERPRINT_SAME_SONG_SIMILARITY); // groups of 2+ files of the same recording
+
+private:
+    struct Entry {
+        qint64 size;
+        qint64 mtime;
+        QVector<quint64> landmarks;
+    };
+    struct Posting {
+        int id;             // songId
+        int frame;          // when the landmark is in that song
+    };
+
+    QString indexFilename();
+    QString relativePath(const QString &pathToSong);
+    void ensureLoaded();        // call with lock held
+    void ensureInverted();      // call with lock held
+    void addPostings(int id, const QVector<quint64> &landmarks);     // call with lock held, and invertedIsValid
+    void removePostings(int id, const QVector<quint64> &landmarks);  // ditto
+    void updateMaxPostings();   // ditto
+    QHash<int, int> matchVotes(const QVector<quint64> &landmarks, int skipId);  // call with lock held; songId --> bestOffsetVotes()
+    bool isSameSong(int votes, int sizeA, int sizeB, double minSimilarity);
+
+    QMutex lock;
+    QString musicRoot;
+    bool loaded;
+    bool dirty;                 // entries changed since the last load/save
+    bool invertedIsValid;       // postings match entries
+
+    QHash<QString, Entry> entries;          // relative path --> fingerprint
+    QStringList ids;                        // songId --> relative path, "" once removed (only valid when invertedIsValid)
+    QHash<QString, int> idByPath;           // relative path --> songId (only valid when invertedIsValid)
+    QHash<quint32, QVector<Posting> > postings; // hash --> where it is in which songs (only valid when invertedIsValid)
+    int maxPostings;                        // more than this many, and the hash is too common (only valid when invertedIsValid)
+};
+
+#endif /* ifndef AUDIOFINGERPRINT_H_INCLUDED */
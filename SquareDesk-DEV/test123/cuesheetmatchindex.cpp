@@ -0,0 +1,173 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "cuesheetmatchindex.h"
+
+#include <QFileInfo>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+void CuesheetMatchIndex::clear()
+{
+    nextId = 0;
+    entries.clear();
+    idByPath.clear();
+    idsByCatalogNumber.clear();
+    idsByWord.clear();
+}
+
+void CuesheetMatchIndex::rebuild(const QList<QString> &pathStackCuesheets)
+{
+    clear();
+    entries.reserve(pathStackCuesheets.size());
+    for (const QString &s : pathStackCuesheets) {
+        insert(s);
+    }
+}
+
+void CuesheetMatchIndex::insert(const QString &pathStackEntry)
+{
+    QStringList parts = pathStackEntry.split("#!#");
+    if (parts.size() < 2) {
+        return;
+    }
+
+    Entry e;
+    e.type = parts[0];
+    e.absoluteFilePath = parts[1];
+    e.completeBaseName = QFileInfo(e.absoluteFilePath).completeBaseName();
+    e.levelName = (parts.size() >= 3 ? parts[2] : QString());
+    e.catalogNumber = extractCatalogNumber(e.completeBaseName);
+    e.words = wordSet(e.completeBaseName);
+
+    int id;
+    auto existing = idByPath.constFind(e.absoluteFilePath);
+    if (existing != idByPath.constEnd()) {
+        id = existing.value();
+        removeId(id);   // the same file, re-leveled or re-imported: keeps its id, and so its place in the order
+    } else {
+        id = nextId++;
+    }
+
+    idByPath.insert(e.absoluteFilePath, id);
+    idsByCatalogNumber[e.catalogNumber].insert(id);
+    for (const QString &w : std::as_const(e.words)) {
+        idsByWord[w].insert(id);
+    }
+    entries.insert(id, e);
+}
+
+void CuesheetMatchIndex::removeId(int id)
+{
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return;
+    }
+    idByPath.remove(it->absoluteFilePath);
+    auto byNumber = idsByCatalogNumber.find(it->catalogNumber);
+    if (byNumber != idsByCatalogNumber.end()) {
+        byNumber->remove(id);
+        if (byNumber->isEmpty()) {
+            idsByCatalogNumber.erase(byNumber);
+        }
+    }
+    for (const QString &w : std::as_const(it->words)) {
+        auto byWord = idsByWord.find(w);
+        if (byWord != idsByWord.end()) {
+            byWord->remove(id);
+            if (byWord->isEmpty()) {
+                idsByWord.erase(byWord);
+            }
+        }
+    }
+    entries.erase(it);
+}
+
+void CuesheetMatchIndex::removePaths(const QStringList &removedPaths)
+{
+    QVector<int> doomed;
+    for (auto it = idByPath.constBegin(); it != idByPath.constEnd(); ++it) {
+        const QString &path = it.key();
+        for (const QString &r : removedPaths) {
+            if (path == r || (path.startsWith(r) && path.at(r.length()) == '/')) {
+                doomed.append(it.value());
+                break;
+            }
+        }
+    }
+    for (int id : std::as_const(doomed)) {
+        removeId(id);
+    }
+}
+
+QVector<int> CuesheetMatchIndex::allIds() const
+{
+    QVector<int> ids = entries.keys();
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+QVector<int> CuesheetMatchIndex::candidates(int catalogNumber, const QSet<QString> &words) const
+{
+    if (catalogNumber == -1) {
+        return allIds();  // nothing for the pre-filter to go on
+    }
+
+    QSet<int> found = idsByCatalogNumber.value(catalogNumber);
+    found.unite(idsByCatalogNumber.value(-1));
+    for (const QString &w : words) {
+        auto byWord = idsByWord.constFind(w);
+        if (byWord != idsByWord.constEnd()) {
+            found.unite(byWord.value());
+        }
+    }
+
+    QVector<int> ids(found.begin(), found.end());
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+int CuesheetMatchIndex::extractCatalogNumber(const QString &completeBaseName)
+{
+    static const QRegularExpression numRegex("\\d{1,5}");
+    QRegularExpressionMatch match = numRegex.match(completeBaseName);
+    if (!match.hasMatch()) {
+        return -1;
+    }
+    return match.captured(0).toInt();
+}
+
+QSet<QString> CuesheetMatchIndex::wordSet(const QString &completeBaseName)
+{
+    static const QRegularExpression nonWordRegex("[^A-Za-z0-9]+");
+    QSet<QString> words;
+    for (const QString &w : completeBaseName.split(nonWordRegex, Qt::SkipEmptyParts)) {
+        if (w.length() > 2) {
+            words.insert(w.toLower());
+        }
+    }
+    return words;
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef CUESHEETMATCHINDEX_H_INCLUDED
+#define CUESHEETMATCHINDEX_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+
+// Inverted index over pathStackCuesheets, for cuesheet/song matching.
+//
+// MP3FilenameVsCuesheetnameScore() is far too expensive to run against every cuesheet in the library
+//   in computeSongLevels(), for every song x every leveled cuesheet.  That pass only scores pairs that
+//   share a word, or have the same catalog number, or where one of them has no catalog number at all
+//   (see cuesheetMatchesSong() -- a heuristic, since the scorer's word match is fuzzy).  So this indexes
+//   each cuesheet by its catalog number and by each of its words, and candidates() returns just the
+//   cuesheets that pass that pre-filter -- usually a handful -- for the real scorer to look at.
+//
+// Built from pathStackCuesheets once per library load, and then kept up to date as single cuesheets
+//   are added, re-leveled or removed.  Candidates come back in the order that their entries were
+//   added, which is pathStackCuesheets order, so ties between equal scores still break the same way.
+class CuesheetMatchIndex {
+public:
+    struct Entry {
+        QString type;
+        QString absoluteFilePath;
+        QString completeBaseName;
+        QString levelName;      // detected "L:" level, or empty
+        int catalogNumber;      // -1 if none
+        QSet<QString> words;
+    };
+
+    CuesheetMatchIndex() {}
+
+    void clear();
+    void rebuild(const QList<QString> &pathStackCuesheets);
+
+    // entry is a pathStackCuesheets entry, "type#!#absolutePath#!#level": replaces any existing entry
+    //   for the same file (keeping its place in the order), otherwise adds it at the end
+    void insert(const QString &pathStackEntry);
+
+    // removes the cuesheets at these paths, and everything below any of them that is a directory
+    void removePaths(const QStringList &removedPaths);
+
+    // ids (in pathStackCuesheets order) of the cuesheets that could match a song with this catalog
+    //   number and these words; every cuesheet, if the song has no catalog number
+    QVector<int> candidates(int catalogNumber, const QSet<QString> &words) const;
+    QVector<int> allIds() const;
+    const Entry &entry(int id) const { return entries[id]; }
+    int size() const { return static_cast<int>(entries.size()); }
+
+    // the cheap pre-filter keys for a completeBaseName: its first 1-5 digit run as an int (so leading
+    //   zeros don't matter), and its lowercased words longer than 2 characters
+    static int extractCatalogNumber(const QString &completeBaseName);
+    static QSet<QString> wordSet(const QString &completeBaseName);
+
+private:
+    void removeId(int id);
+
+    int nextId = 0;
+    QHash<int, Entry> entries;
+    QHash<QString, int> idByPath;
+    QHash<int, QSet<int> > idsByCatalogNumber;    // -1 = no catalog number
+    QHash<QString, QSet<int> > idsByWord;
+};
+
+#endif /* ifndef CUESHEETMATCHINDEX_H_INCLUDED */
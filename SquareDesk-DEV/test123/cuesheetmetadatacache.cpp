@@ -0,0 +1,196 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "cuesheetmetadatacache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+
+#define CUESHEETMETADATA_MAGIC 0x5344434d  // "SDCM"
+
+CuesheetMetadataCache::CuesheetMetadataCache() : loaded(false), dirty(false)
+{
+}
+
+void CuesheetMetadataCache::setMusicRoot(const QString &musicRootPath)
+{
+    QMutexLocker locker(&lock);
+    if (musicRootPath == musicRoot) {
+        return;
+    }
+    musicRoot = musicRootPath;
+    entries.clear();
+    loaded = false;  // loaded the first time it's needed
+    dirty = false;
+}
+
+QString CuesheetMetadataCache::cacheFilename(const QString &musicRootPath)
+{
+    return(musicRootPath + "/.squaredesk/cache/cuesheetMetadata.dat");
+}
+
+QString CuesheetMetadataCache::relativePath(const QString &pathToCuesheet)
+{
+    QString p = pathToCuesheet;
+    if (!musicRoot.isEmpty() && p.startsWith(musicRoot + "/")) {
+        p = p.mid(musicRoot.length() + 1);
+    }
+    return(p);
+}
+
+void CuesheetMetadataCache::ensureLoaded()
+{
+    if (loaded || musicRoot.isEmpty()) {
+        return;
+    }
+    loaded = true;
+
+    QFile f(cacheFilename(musicRoot));
+    if (!f.open(QIODevice::ReadOnly)) {
+        return;  // no cache yet, that's fine
+    }
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, version, count;
+    in >> magic >> version >> count;
+    if (magic != CUESHEETMETADATA_MAGIC || version != CUESHEETMETADATA_VERSION) {
+        qDebug() << "CuesheetMetadataCache: ignoring old or damaged cache:" << cacheFilename(musicRoot);
+        return;  // cuesheets will just be read again
+    }
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        QString relPath;
+        Entry e;
+        in >> relPath >> e.size >> e.mtime >> e.level;
+        entries.insert(relPath, e);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "CuesheetMetadataCache: cache was truncated:" << cacheFilename(musicRoot);
+        entries.clear();
+    }
+}
+
+bool CuesheetMetadataCache::save()
+{
+    QMutexLocker locker(&lock);
+    if (!dirty || musicRoot.isEmpty()) {
+        return(true);
+    }
+
+    QDir().mkpath(QFileInfo(cacheFilename(musicRoot)).absolutePath());
+
+    QSaveFile f(cacheFilename(musicRoot));  // atomic: a crash can't leave a half-written cache
+    if (!f.open(QIODevice::WriteOnly)) {
+        qDebug() << "CuesheetMetadataCache: could not write:" << cacheFilename(musicRoot);
+        return(false);
+    }
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << (quint32)CUESHEETMETADATA_MAGIC << (quint32)CUESHEETMETADATA_VERSION << (quint32)entries.size();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        out << it.key() << it.value().size << it.value().mtime << it.value().level;
+    }
+    if (!f.commit()) {
+        return(false);
+    }
+    dirty = false;
+    return(true);
+}
+
+bool CuesheetMetadataCache::lookup(const QString &pathToCuesheet, QString *level)
+{
+    QFileInfo fi(pathToCuesheet);  // stat outside the lock, it's the slow part
+
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+
+    auto it = entries.find(relativePath(pathToCuesheet));
+    if (it == entries.end()) {
+        return(false);
+    }
+    if (it.value().size != fi.size() || it.value().mtime != fi.lastModified().toMSecsSinceEpoch()) {
+        entries.erase(it);
+        dirty = true;
+        return(false);
+    }
+    *level = it.value().level;
+    return(true);
+}
+
+bool CuesheetMetadataCache::contains(const QString &pathToCuesheet)
+{
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+    return(entries.contains(relativePath(pathToCuesheet)));
+}
+
+void CuesheetMetadataCache::store(const QString &pathToCuesheet, const QString &level)
+{
+    QFileInfo fi(pathToCuesheet);
+    store(pathToCuesheet, level, fi.size(), fi.lastModified().toMSecsSinceEpoch());
+}
+
+void CuesheetMetadataCache::store(const QString &pathToCuesheet, const QString &level, qint64 size, qint64 mtime)
+{
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+
+    Entry e;
+    e.size  = size;
+    e.mtime = mtime;
+    e.level = level;
+    entries.insert(relativePath(pathToCuesheet), e);
+    dirty = true;
+}
+
+void CuesheetMetadataCache::retainOnly(const QStringList &pathStackCuesheets)
+{
+    QMutexLocker locker(&lock);
+    ensureLoaded();
+
+    QSet<QString> live;
+    for (const QString &s : pathStackCuesheets) {
+        QStringList parts = s.split("#!#");
+        if (parts.size() >= 2) {
+            live.insert(relativePath(parts[1]));
+        }
+    }
+    for (auto it = entries.begin(); it != entries.end(); ) {
+        if (live.contains(it.key())) {
+            ++it;
+        } else {
+            it = entries.erase(it);
+            dirty = true;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef CUESHEETMETADATACACHE_H_INCLUDED
+#define CUESHEETMETADATACACHE_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+
+#define CUESHEETMETADATA_VERSION 1   // bump if detectCuesheetLevel() changes what it finds
+
+// On-disk cache of what detectCuesheetLevel() found in each cuesheet, in
+//   <musicRoot>/.squaredesk/cache/cuesheetMetadata.dat, so that a full rescan only has to stat each
+//   cuesheet, rather than open and read it.  Entries are keyed by path relative to the music root,
+//   and remember the file's size and mtime, so a cuesheet that was changed (by anything) is read again.
+//
+//   Cuesheets that are new or changed are NOT read during the scan: they get an empty level for now,
+//   and MainWindow::refreshCuesheetLevelsInBackground() reads them on a thread pool afterwards.
+//   All public methods are thread-safe (the scan looks cuesheets up from ParallelDirWalker's threads).
+class CuesheetMetadataCache
+{
+public:
+    CuesheetMetadataCache();
+
+    void setMusicRoot(const QString &musicRootPath);  // forgets everything, and (lazily) loads that root's cache
+    bool save();                                      // only writes if something changed
+    static QString cacheFilename(const QString &musicRootPath);
+
+    // true (and *level set) if there's an entry for the current version of this file;
+    //   a stale entry is dropped, so that contains() says it needs to be read again
+    bool lookup(const QString &pathToCuesheet, QString *level);
+    bool contains(const QString &pathToCuesheet);     // no stat: just whether it has EVER been read
+    void store(const QString &pathToCuesheet, const QString &level);  // as of now
+    void store(const QString &pathToCuesheet, const QString &level, qint64 size, qint64 mtime);  // as of when it was read
+    void retainOnly(const QStringList &pathStackCuesheets);  // forget cuesheets that are gone
+
+private:
+    struct Entry {
+        qint64 size;
+        qint64 mtime;
+        QString level;
+    };
+
+    QString relativePath(const QString &pathToCuesheet);
+    void ensureLoaded();        // call with lock held
+
+    QMutex lock;
+    QString musicRoot;
+    bool loaded;
+    bool dirty;                 // entries changed since the last load/save
+
+    QHash<QString, Entry> entries;  // relative path --> what was found in it
+};
+
+#endif /* ifndef CUESHEETMETADATACACHE_H_INCLUDED */
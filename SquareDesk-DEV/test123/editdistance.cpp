@@ -0,0 +1,156 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "editdistance.h"
+
+#include <QHash>
+#include <QVarLengthArray>
+
+#include <cstring>
+#include <utility>
+
+EditDistance::EditDistance(const QString &pattern) :
+    pattern(pattern),
+    m(static_cast<int>(pattern.size()))
+{
+    memset(asciiPeq, 0, sizeof(asciiPeq));
+    if (m > 64) {
+        return; // slowDistance() doesn't need the bitmasks
+    }
+
+    for (int i = 0; i < m; i++) {
+        QChar c = pattern[i].toLower();
+        if (c.unicode() < 128) {
+            asciiPeq[c.unicode()] |= (1ull << i);
+            continue;
+        }
+        int k = 0;
+        while (k < otherCount && otherChars[k] != c) {
+            k++;
+        }
+        if (k == otherCount) {
+            otherChars[k] = c;
+            otherPeq[k] = 0;
+            otherCount++;
+        }
+        otherPeq[k] |= (1ull << i);
+    }
+}
+
+const EditDistance &EditDistance::forPattern(const QString &pattern)
+{
+    static thread_local QHash<QString, EditDistance> cache;  // per thread: the scorer also runs on workers
+    auto it = cache.constFind(pattern);
+    if (it != cache.constEnd()) {
+        return it.value();
+    }
+    if (cache.size() >= 1024) {
+        cache.clear();  // songs come and go: don't keep every word ever seen
+    }
+    return cache.insert(pattern, EditDistance(pattern)).value();
+}
+
+quint64 EditDistance::peq(QChar lowerC) const
+{
+    if (lowerC.unicode() < 128) {
+        return asciiPeq[lowerC.unicode()];
+    }
+    for (int k = 0; k < otherCount; k++) {
+        if (otherChars[k] == lowerC) {
+            return otherPeq[k];
+        }
+    }
+    return 0;
+}
+
+int EditDistance::distance(const QString &text) const
+{
+    if (m == 0) {
+        return static_cast<int>(text.size());
+    }
+    if (m > 64) {
+        return slowDistance(text);
+    }
+
+    // VP/VN = the vertical +1/-1 deltas of the current DP column, one bit per pattern character;
+    //   D0 = the diagonal zero-deltas, PMprev = the previous text character's match mask (for the
+    //   transposition term, TR).  score tracks the bottom cell of the column, i.e. the distance.
+    quint64 VP = ~0ull;
+    quint64 VN = 0;
+    quint64 D0 = 0;
+    quint64 PMprev = 0;
+    const quint64 last = 1ull << (m - 1);
+    int score = m;
+
+    for (QChar c : text) {
+        quint64 PM = peq(c.toLower());
+        quint64 TR = (((~D0) & PM) << 1) & PMprev;
+        D0 = (((PM & VP) + VP) ^ VP) | PM | VN | TR;
+        quint64 HP = VN | ~(D0 | VP);
+        quint64 HN = D0 & VP;
+        if (HP & last) {
+            score++;
+        } else if (HN & last) {
+            score--;
+        }
+        quint64 X = (HP << 1) | 1;
+        VN = X & D0;
+        VP = (HN << 1) | ~(X | D0);
+        PMprev = PM;
+    }
+    return score;
+}
+
+// the original dynamic programming, keeping only the three rows that the recurrence looks at
+int EditDistance::slowDistance(const QString &text) const
+{
+    const int len1 = m;
+    const int len2 = static_cast<int>(text.size());
+
+    QVarLengthArray<int, 256> prev2(len2 + 1), prev(len2 + 1), cur(len2 + 1);
+    for (int j = 0; j <= len2; j++) {
+        prev[j] = j;
+    }
+
+    for (int i = 1; i <= len1; i++) {
+        cur[0] = i;
+        QChar a = pattern[i-1].toLower();
+        for (int j = 1; j <= len2; j++) {
+            QChar b = text[j-1].toLower();
+            int cost = (a == b) ? 0 : 1;
+            cur[j] = qMin(qMin(prev[j] + 1,     // deletion
+                               cur[j-1] + 1),   // insertion
+                          prev[j-1] + cost);    // substitution
+            if (i > 1 && j > 1 &&
+                a == text[j-2].toLower() &&
+                pattern[i-2].toLower() == b) {
+                cur[j] = qMin(cur[j], prev2[j-2] + cost);   // transposition
+            }
+        }
+        std::swap(prev2, cur);
+        std::swap(prev2, prev);  // prev2 <- old prev, prev <- this row
+    }
+    return prev[len2];
+}
@@ -0,0 +1,65 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef EDITDISTANCE_H_INCLUDED
+#define EDITDISTANCE_H_INCLUDED
+
+#include <QString>
+
+// Case-insensitive edit distance (insert, delete, substitute, and swap of two adjacent characters,
+//   i.e. "optimal string alignment") between one pattern and any number of texts.
+//
+// The pattern's per-character bitmasks are built once, in the constructor, and each distance() is
+//   then Hyyro's bit-parallel version of Myers' algorithm: one pass over the text, a handful of
+//   64-bit operations per character, and no heap allocation.  Gives exactly the same answers as the
+//   full dynamic programming matrix that MP3FilenameVsCuesheetnameScore() used to allocate for every
+//   pair of words.  Patterns longer than 64 characters (never seen in a real filename word) fall back
+//   to the plain dynamic programming, with just three rows on the stack.
+class EditDistance {
+public:
+    explicit EditDistance(const QString &pattern);
+
+    int distance(const QString &text) const;
+
+    static int distance(const QString &a, const QString &b) { return EditDistance(a).distance(b); }
+
+    // The same, but built only the first time this thread sees the pattern, for a pattern that is
+    //   compared with many texts (a song's words, against every cuesheet in the library).  The
+    //   reference is only good until the next forPattern() call on the same thread.
+    static const EditDistance &forPattern(const QString &pattern);
+
+private:
+    quint64 peq(QChar lowerC) const;
+    int slowDistance(const QString &text) const;
+
+    QString pattern;
+    int m;
+    quint64 asciiPeq[128];      // bit i set = pattern[i] (lowercased) is this character
+    QChar otherChars[64];       // ...and the same for the non-ASCII characters in the pattern
+    quint64 otherPeq[64];
+    int otherCount = 0;
+};
+
+#endif /* ifndef EDITDISTANCE_H_INCLUDED */
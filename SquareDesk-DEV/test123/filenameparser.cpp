@@ -0,0 +1,194 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "filenameparser.h"
+
+#include <QRegularExpression>
+
+struct FilenameMatchers {
+    QRegularExpression regex;
+    int title_match;
+    int label_match;
+    int number_match;
+    int additional_label_match;
+    int additional_title_match;
+};
+
+static struct FilenameMatchers *getFilenameMatchersForType(enum SongFilenameMatchingType songFilenameFormat)
+{
+    static struct FilenameMatchers best_guess_matches[] = {
+        { QRegularExpression("^([A-Za-z]{1,9})[\\- ]?(\\d{3,5}[A-Za-z]{0,3})\\s*-\\s*(.*[^0-9]\\d{1,2})$"), 3, 1, 2, -1, -1}, // e.g. "ARROW 946 - Studio 54.mp3"
+                                                                                                            // ambiguity breaker: LABEL + 3-5 digit number on the left,
+                                                                                                            //   title ending in a 1-2 digit number on the right (numbers
+                                                                                                            //   in titles are short; label numbers are 3+ digits)
+        { QRegularExpression("^(.*) - ([A-Za-z]{1,9})[\\- ]?([0-9]{1,5}[A-Za-z]{0,3})$"), 1, 2, 3, -1, -1}, // e.g. "Play It Cool - BS 2534a.mp3"
+                                                                                                            // e.g. "Strings Galore - Chaparral 117b.mp3"
+        { QRegularExpression("^([Oo][Gg][Rr][Mm][Pp]3\\s*\\d{1,5})\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },    // e.g. "OGRMP3 04 - Addam's Family.mp3"
+        { QRegularExpression("^(4-[Bb][Aa][Rr]-[Bb]\\s*\\d{1,5})\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },    // e.g. "4-bar-b 123 - Chicken Plucker"
+        { QRegularExpression("^(.*) - ([A-Za-z]+[\\- ]\\d+)( *-?[VMA-C]|\\-\\d+)?$"), 1, 2, -1, 3, -1 },
+        { QRegularExpression("^([A-Za-z]+[\\- ]\\d+)(-?[VvMA-C]?) - (.*)$"), 3, 1, -1, 2, -1 },
+        { QRegularExpression("^([A-Za-z]+ ?\\d+)([MVmv]?)[ -]+(.*)$/"), 3, 1, -1, 2, -1 },
+        { QRegularExpression("^([A-Za-z]?[0-9][A-Z]+[\\- ]?\\d+)([MVmv]?)[ -]+(.*)$"), 3, 1, -1, 2, -1 },
+        { QRegularExpression("^(.*) - ([A-Za-z]{1,5}+)[\\- ](\\d+)( .*)?$"), 1, 2, 3, -1, 4 },
+        { QRegularExpression("^([A-Za-z]+ ?\\d+)([ABab])?[ -]+(.*)$/"), 3, 1, -1, 2, -1 },
+        { QRegularExpression("^([A-Za-z]+\\-\\d+)\\-(.*)/"), 2, 1, -1, -1, -1 },
+//    { QRegularExpression("^(\\d+) - (.*)$"), 2, -1, -1, -1, -1 },         // first -1 prematurely ended the search (typo?)
+//    { QRegularExpression("^(\\d+\\.)(.*)$"), 2, -1, -1, -1, -1 },         // first -1 prematurely ended the search (typo?)
+        { QRegularExpression("^(\\d+)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },  // e.g. "123 - Chicken Plucker"
+        { QRegularExpression("^(\\d+\\.)(.*)$"), 2, 1, -1, -1, -1 },            // e.g. "123.Chicken Plucker"
+//        { QRegularExpression("^(.*?) - (.*)$"), 2, 1, -1, -1, -1 },           // ? is a non-greedy match (So that "A - B - C", first group only matches "A")
+        { QRegularExpression("^([A-Za-z]{1,5}+[\\- ]*\\d+[A-Za-z]*)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 }, // e.g. "ABC 123-Chicken Plucker"
+        { QRegularExpression("^([A-Za-z]{1,5}+[\\- ]*\\d+[A-Za-z0-9]*)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 }, // e.g. "ABC 123h1-Chicken Plucker"
+        { QRegularExpression("^([A-Za-z0-9]{1,5}+)\\s*(\\d+)([A-Za-z]{1,2})?\\s*-\\s*(.*?)\\s*(\\(.*\\))?$"), 4, 1, 2, 3, 5 }, // SIR 705b - Papa Was A Rollin Stone (Instrumental).mp3
+        { QRegularExpression("^([A-Za-z0-9]{1,5}+)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },    // e.g. "POP - Chicken Plucker" (if it has a dash but fails all other tests,
+        { QRegularExpression("^(.*?)\\s*\\-\\s*([A-Za-z]{1,5})(\\d{1,5})\\s*(\\(.*\\))?$"), 1, 2, 3, -1, 4 },    // e.g. "A Summer Song - CHIC3002 (female vocals)
+        { QRegularExpression("^(.*?)\\s*\\-\\s*([A-Za-z]{1,7}|4-[Bb][Aa][Rr]-[Bb])-(\\d{1,5})(\\-?([ABab]))?$"), 1, 2, 3, 5, -1 },    // e.g. "Paper Doll - Windsor-4936B"
+        { QRegularExpression("^(.*?)\\s*\\-\\s*([A-Za-z]{1,7}|4-[Bb][Aa][Rr]-[Bb]) (\\d{1,5})(\\-?([ABab]))?$"), 1, 2, 3, 5, -1 },    // e.g. "Paper Doll - Windsor 4936B"
+        { QRegularExpression("^(.*)\\s*\\-\\s*([A-Za-z ]+)\\s*([0-9]{1,5}[A-Za-z]{0,3})$"), 1, 2, 3, -1, -1}, // e.g. "Streets of London - New Beat 203a.mp3"
+
+        { QRegularExpression(), -1, -1, -1, -1, -1 }
+    };
+    static struct FilenameMatchers label_first_matches[] = {
+        { QRegularExpression("^(.*)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },    // e.g. "ABC123X - Chicken Plucker"
+        { QRegularExpression(), -1, -1, -1, -1, -1 }
+    };
+    static struct FilenameMatchers filename_first_matches[] = {
+        { QRegularExpression("^(.*)\\s*-\\s*(.*)$"), 1, 2, -1, -1, -1 },    // e.g. "Chicken Plucker - ABC123X"
+        { QRegularExpression(), -1, -1, -1, -1, -1 }
+    };
+
+    switch (songFilenameFormat) {
+        case SongFilenameNameDashLabel :
+            return filename_first_matches;
+        case SongFilenameBestGuess :
+            return best_guess_matches;
+        case SongFilenameLabelDashName :
+//        default:  // all the cases are covered already (default is not needed here)
+            return label_first_matches;
+    }
+    // Shut up the warnings, all the returns happen in the switch above
+    return label_first_matches;
+}
+
+bool parseSongFilename(const QString &s, enum SongFilenameMatchingType songFilenameFormat,
+                       QString &label, QString &labelnum,
+                       QString &labelnum_extra,
+                       QString &title, QString &shortTitle)
+{
+    bool foundParts = true;
+    int match_num = 0;
+    struct FilenameMatchers *matches = getFilenameMatchersForType(songFilenameFormat);
+
+    // special pre-processing for labels with dashes in their names
+    QString s2 = s;
+
+    static QRegularExpression regex1("(4-[Bb][Aa][Rr]-[Bb])");              // 4-Bar-B
+    static QRegularExpression regex2("([Cc][Ii][Rr][Cc][Ll][Ee]-[Dd])");    // Circle-D
+    static QRegularExpression regex3("([Jj][Aa][Yy]-[Bb][Aa][Rr]-[Kk][Aa][Yy])");  // Jay-Bar-Kay
+
+    QRegularExpressionMatch m1;
+    QRegularExpressionMatch m2;
+    QRegularExpressionMatch m3;
+    if (s2.contains('-')) { // all three have a dash in them, and most filenames with no dash at all can skip them
+        if (s2.contains(regex1, &m1)) {
+            // qDebug() << "MATCH 1: " << m1 << m1.captured(1);
+            s2.replace(m1.captured(1), "FOURBARB");
+        }
+
+        if (s2.contains(regex2, &m2)) {
+            // qDebug() << "MATCH 2: " << m2 << m2.captured(1);
+            s2.replace(m2.captured(1), "CIRCLED");
+        }
+
+        if (s2.contains(regex3, &m3)) {
+            // qDebug() << "MATCH 3: " << m3 << m3.captured(1);
+            s2.replace(m3.captured(1), "JAYBARKAY");
+        }
+    }
+
+    for (match_num = 0;
+         matches[match_num].label_match >= 0
+             && matches[match_num].title_match >= 0;
+         ++match_num) {
+        QRegularExpressionMatch match = matches[match_num].regex.match(s2);
+        if (match.hasMatch()) {
+            if (matches[match_num].label_match >= 0) {
+                label = match.captured(matches[match_num].label_match);
+                label.replace("FOURBARB", m1.captured(1)); // keep original capitalization
+                label.replace("CIRCLED",  m2.captured(1)); // keep original capitalization
+                label.replace("JAYBARKAY", m3.captured(1)); // keep original capitalization
+            }
+            if (matches[match_num].title_match >= 0) {
+                title = match.captured(matches[match_num].title_match);
+                shortTitle = title;
+            }
+            if (matches[match_num].number_match >= 0) {
+                labelnum = match.captured(matches[match_num].number_match);
+            }
+            if (matches[match_num].additional_label_match >= 0) {
+                labelnum_extra = match.captured(matches[match_num].additional_label_match);
+            }
+            if (matches[match_num].additional_title_match >= 0
+                && !match.captured(matches[match_num].additional_title_match).isEmpty()) {
+                title += " " + match.captured(matches[match_num].additional_title_match);
+            }
+            break;
+        } else {
+//                qDebug() << s << "didn't match" << matches[match_num].regex;
+        }
+    }
+    if (!(matches[match_num].label_match >= 0
+          && matches[match_num].title_match >= 0)) {
+        label = "";
+        title = s;
+        foundParts = false;
+    }
+
+    label = label.simplified();
+
+    if (labelnum.length() == 0)
+    {
+        static QRegularExpression regexLabelPlusNum = QRegularExpression("^(\\w+)[\\- ](\\d+)(\\w?)$");
+        QRegularExpressionMatch match = regexLabelPlusNum.match(label);
+        if (match.hasMatch())
+        {
+            label = match.captured(1);
+            labelnum = match.captured(2);
+            if (labelnum_extra.length() == 0)
+            {
+                labelnum_extra = match.captured(3);
+            }
+            else
+            {
+                labelnum = labelnum + match.captured(3);
+            }
+        }
+    }
+    labelnum = labelnum.simplified();
+    title = title.simplified();
+    shortTitle = shortTitle.simplified();
+
+    return foundParts;
+}
@@ -0,0 +1,45 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef FILENAMEPARSER_H_INCLUDED
+#define FILENAMEPARSER_H_INCLUDED
+
+#include <QString>
+
+#include "common_enums.h"
+
+// Splits a song's filename (without the suffix) into label, label number, and title, according to
+//   the filename format pref: the first of that format's regular expressions that matches wins.
+//   Parts that no expression fills in are left as they were passed in.  Returns false if nothing
+//   matched (then title is the whole filename).
+//
+// This is the uncached parser behind MainWindow::breakFilenameIntoParts(); it's a free function,
+//   with no MainWindow state, so that sdtest can check its results against a table.
+bool parseSongFilename(const QString &s, enum SongFilenameMatchingType songFilenameFormat,
+                       QString &label, QString &labelnum,
+                       QString &labelnum_extra,
+                       QString &title, QString &shortTitle);
+
+#endif /* ifndef FILENAMEPARSER_H_INCLUDED */
@@ -218,6 +218,38 @@ double flexible_audio::GetWholeTrackPeak() {
     return(decoder.getWholeTrackPeak());
 }
 
+void flexible_audio::SetLoudnessNormalizeTrackAudio(bool b)
+{
+    decoder.setNormalizeLoudness(b);
+}
+
+void flexible_audio::SetKnownReplayGain(bool known, double replayGain_dB)
+{
+    decoder.setKnownReplayGain(known, replayGain_dB);
+}
+
+bool flexible_audio::HasReplayGain() {
+    return(decoder.hasReplayGain());
+}
+
+double flexible_audio::GetReplayGain() {
+    return(decoder.getReplayGain());
+}
+
+double flexible_audio::GetLoudnessNormalizeFactor() {
+    return(decoder.getLoudnessNormalizeFactor());
+}
+
+// ------------------------------------------------------------------
+// local tempo, for tempo-locked features (valid after haveDuration() if the curve was cached, else once the background windows are done)
+double flexible_audio::GetLocalBPM(double time_sec) {
+    return(decoder.getLocalBPM(time_sec));
+}
+
+double flexible_audio::GetBPMConfidence() {
+    return(decoder.getTempoConfidence());
+}
+
 // ------------------------------------------------------------------
 // which = (FREQ_KHZ, BW_OCT, GAIN_DB)
 void flexible_audio::SetIntelBoost(unsigned int which, float val)
@@ -250,18 +282,21 @@ void flexible_audio::SetPanEQVolumeCompensation(float val)
     decoder.SetPanEQVolumeCompensation(val);
 }
 
+// returns where the music actually starts and ends (seconds), skipping leading/trailing silence and needle noise.
+//   The decoder finds these as soon as the whole song is in memory (or reads them from the analysis cache),
+//   so this is only meaningful after haveDuration() has been emitted for filepath.  Until then (or if
+//   no music could be found), it returns the whole song: 0.0 .. FileLength.
 void flexible_audio::songStartDetector(const char *filepath, double  *pSongStart, double  *pSongEnd) {
-    Q_UNUSED(filepath)
-    Q_UNUSED(pSongStart)
-    Q_UNUSED(pSongEnd)
-//    qDebug() << "NOT IMPLEMENTED: songStartDetector:" << *filepath << *pSongStart << *pSongEnd;
+    if (!decoder.getSongBoundaries(QString(filepath), pSongStart, pSongEnd)) {
+        *pSongStart = 0.0;
+        *pSongEnd   = FileLength;
+    }
+//    qDebug() << "songStartDetector:" << filepath << *pSongStart << *pSongEnd;
 }
 
 // ------------------------------------------------------------------
 void flexible_audio::StreamCreate(const char *filepath, double  *pSongStart_sec, double  *pSongEnd_sec, double intro1_frac, double outro1_frac)
 {
-    Q_UNUSED(pSongStart_sec)
-    Q_UNUSED(pSongEnd_sec)
     Q_UNUSED(intro1_frac)
     Q_UNUSED(outro1_frac)
 
@@ -269,6 +304,11 @@ void flexible_audio::StreamCreate(const char *filepath, double  *pSongStart_sec,
     decoder.setSource(filepath, musicRootPath);  // decode THIS file, with THIS musicRoot
     Stream_BPM = -1;  // means "not available yet"
     decoder.start();              // start the decode
+
+    // decoding is asynchronous, so the real start/end of the music isn't known yet.
+    //   Call songStartDetector() after haveDuration() to get them.
+    *pSongStart_sec = 0.0;
+    *pSongEnd_sec   = 0.0;  // means "not known yet"
 }
 
 qint64 flexible_audio::readData(char* data, qint64 maxlen)
@@ -555,6 +595,14 @@ void flexible_audio::getWaveform(float *f, size_t t) {
     }
 }
 
+void flexible_audio::getWaveformRange(double from_sec, double to_sec, unsigned int numBins, float *mins, float *maxs, float *rms) {
+    decoder.getWaveformRange(from_sec, to_sec, numBins, mins, maxs, rms);
+}
+
+std::function<QVector<quint64>()> flexible_audio::GetFingerprintFunction() {
+    return(decoder.fingerprintFunction());
+}
+
 #ifdef USE_JUCE
 void flexible_audio::setLoudMaxPlugin(std::unique_ptr<juce::AudioPluginInstance> &p) { // pass by reference
     // qDebug() << "flexible_audio::setLoudMaxPlugin";
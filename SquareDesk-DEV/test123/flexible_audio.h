@@ -120,6 +120,15 @@ public:
     void SetNormalizeTrackAudio(bool b);  // true to normalize peaks to 0.0dB (1.0)
     double GetWholeTrackPeak();
 
+    void SetLoudnessNormalizeTrackAudio(bool b);  // true to normalize integrated loudness to LOUDNESS_TARGET_LUFS (overrides peak)
+    void SetKnownReplayGain(bool known, double replayGain_dB);  // call before StreamCreate, with the DB's value (if any)
+    bool HasReplayGain();                   // true, if the current song's loudness is known
+    double GetReplayGain();                 // the current song's ReplayGain in dB (valid only if HasReplayGain())
+    double GetLoudnessNormalizeFactor();    // linear gain applied by loudness normalization (1.0 if not known)
+    double GetLocalBPM(double time_sec);    // tempo at time_sec from the whole-song tempo curve (-1 = median of the whole song),
+                                            //   once it's cached or computed (until then, GetBPMConfidence() is 0.0)
+    double GetBPMConfidence();              // 0.0 - 1.0, how steady the tempo is across the whole song
+
     void SetIntelBoost(unsigned int which, float val);    // Global intelligibility boost parameters
     void SetIntelBoostEnabled(bool enable);               // Global intelligibility boost parameters
 
@@ -137,7 +146,7 @@ public:
     bool GetMono(void);
 
     //Stream
-    void songStartDetector(const char *filepath, double  *pSongStart, double  *pSongEnd);
+    void songStartDetector(const char *filepath, double  *pSongStart, double  *pSongEnd);  // valid after haveDuration()
     void StreamCreate(const char *filepath, double  *pSongStart, double  *pSongEnd, double i1, double o1);  // returns start of non-silence (seconds)
 
     void StreamGetLength(void);
@@ -187,6 +196,8 @@ public:
 
 //    void getWaveform(float f[WAVEFORMWIDTH], size_t t);
     void getWaveform(float f[WAVEFORMSAMPLES], size_t t);
+    void getWaveformRange(double from_sec, double to_sec, unsigned int numBins, float *mins, float *maxs, float *rms);  // any zoom level, for waveform editors
+    std::function<QVector<quint64>()> GetFingerprintFunction();  // fingerprints the loaded song on any thread (valid after haveDuration())
 
     int  currentSoundEffectID;
 
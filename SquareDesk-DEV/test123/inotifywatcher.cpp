@@ -0,0 +1,234 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "inotifywatcher.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#define INOTIFY_DIR_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_ONLYDIR)
+#endif
+
+InotifyMusicWatcher::InotifyMusicWatcher(QObject *parent)
+    : QObject(parent), fd(-1), notifier(nullptr)
+{
+#ifdef Q_OS_LINUX
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd >= 0) {
+        notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, &InotifyMusicWatcher::readEvents);
+    }
+#endif
+}
+
+InotifyMusicWatcher::~InotifyMusicWatcher()
+{
+#ifdef Q_OS_LINUX
+    if (fd >= 0) {
+        delete notifier;  // before the fd goes away
+        notifier = nullptr;
+        ::close(fd);      // also drops all of the watches
+    }
+#endif
+}
+
+bool InotifyMusicWatcher::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool InotifyMusicWatcher::watchTree(const QString &root, const QRegularExpression &ignoreDirs)
+{
+    clear();
+    if (fd < 0) {
+        return false;
+    }
+    ignore = ignoreDirs;
+    addTree(root, nullptr);  // files already there are already in the pathStacks
+    return isWatching();
+}
+
+void InotifyMusicWatcher::clear()
+{
+#ifdef Q_OS_LINUX
+    for (auto it = pathByWd.constBegin(); it != pathByWd.constEnd(); ++it) {
+        inotify_rm_watch(fd, it.key());
+    }
+#endif
+    pathByWd.clear();
+    wdByPath.clear();
+}
+
+bool InotifyMusicWatcher::isIgnored(const QString &dir) const
+{
+    return !ignore.pattern().isEmpty() && ignore.match(dir).hasMatch();  // an empty pattern would match everything
+}
+
+void InotifyMusicWatcher::addTree(const QString &dir, QStringList *filesFound)
+{
+#ifdef Q_OS_LINUX
+    if (isIgnored(dir)) {
+        return;
+    }
+
+    QStringList dirs(dir);
+    QDirIterator it(dir, QDir::Dirs | QDir::NoSymLinks | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString aPath = it.next();
+        if (!isIgnored(aPath)) {
+            dirs.append(aPath);
+        }
+    }
+
+    for (const QString &d : std::as_const(dirs)) {
+        int wd = inotify_add_watch(fd, QFile::encodeName(d).constData(), INOTIFY_DIR_MASK);
+        if (wd < 0) {
+            // qDebug() << "inotify_add_watch failed:" << d << errno;  // e.g. ENOSPC: fs.inotify.max_user_watches too low
+            continue;
+        }
+        pathByWd.insert(wd, d);
+        wdByPath.insert(d, wd);
+
+        if (filesFound != nullptr) {
+            // a directory that was just created or moved in may already have files in it,
+            //   and we will never get events for those
+            QDirIterator files(d, QDir::Files | QDir::NoDotAndDotDot);
+            while (files.hasNext()) {
+                filesFound->append(files.next());
+            }
+        }
+    }
+#else
+    Q_UNUSED(dir)
+    Q_UNUSED(filesFound)
+#endif
+}
+
+void InotifyMusicWatcher::removeTree(const QString &dir)
+{
+#ifdef Q_OS_LINUX
+    QString prefix = dir + "/";
+    QList<QString> paths = wdByPath.keys();
+    for (const QString &p : std::as_const(paths)) {
+        if (p == dir || p.startsWith(prefix)) {
+            int wd = wdByPath.take(p);
+            pathByWd.remove(wd);
+            inotify_rm_watch(fd, wd);
+        }
+    }
+#else
+    Q_UNUSED(dir)
+#endif
+}
+
+void InotifyMusicWatcher::readEvents()
+{
+#ifdef Q_OS_LINUX
+    QStringList added;
+    QStringList removed;
+    bool overflow = false;
+
+    alignas(struct inotify_event) char buf[64 * 1024];
+    for (;;) {
+        ssize_t len = ::read(fd, buf, sizeof(buf));
+        if (len <= 0) {
+            break;  // EAGAIN: drained (non-blocking fd)
+        }
+
+        for (char *p = buf; p < buf + len; ) {
+            const struct inotify_event *ev = reinterpret_cast<const struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+            if (ev->mask & IN_IGNORED) {
+                // watch is gone (directory deleted, or we removed it ourselves)
+                auto it = pathByWd.find(ev->wd);
+                if (it != pathByWd.end()) {
+                    if (wdByPath.value(it.value(), -1) == ev->wd) {
+                        wdByPath.remove(it.value());
+                    }
+                    pathByWd.erase(it);
+                }
+                continue;
+            }
+
+            QString dir = pathByWd.value(ev->wd);
+            if (dir.isEmpty() || ev->len == 0) {
+                continue;  // IN_DELETE_SELF etc. (the parent reports the name)
+            }
+            QString fullPath = dir + "/" + QFile::decodeName(ev->name);
+
+            if (ev->mask & IN_ISDIR) {
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    QStringList files;
+                    addTree(fullPath, &files);
+                    for (const QString &f : std::as_const(files)) {
+                        removed.removeAll(f);
+                        if (!added.contains(f)) {
+                            added.append(f);
+                        }
+                    }
+                } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    removeTree(fullPath);
+                    removed.append(fullPath);  // everything under it is gone, too
+                }
+            } else {
+                if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    // NOTE: not IN_CREATE, which arrives before the file has been written
+                    removed.removeAll(fullPath);
+                    if (!added.contains(fullPath)) {
+                        added.append(fullPath);
+                    }
+                } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    added.removeAll(fullPath);
+                    removed.append(fullPath);
+                }
+            }
+        }
+    }
+
+    if (overflow) {
+        emit overflowed();
+    } else if (!added.isEmpty() || !removed.isEmpty()) {
+        emit filesChanged(added, removed);
+    }
+#endif
+}
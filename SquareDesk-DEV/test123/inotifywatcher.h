@@ -0,0 +1,79 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef INOTIFYWATCHER_H_INCLUDED
+#define INOTIFYWATCHER_H_INCLUDED
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include <QRegularExpression>
+
+class QSocketNotifier;
+
+// Linux-only watcher for the music directory tree, using inotify directly.
+//
+// QFileSystemWatcher only says "something in this directory changed", so every wakeup used to
+//   mean a findMusic() rescan.  This reports WHICH files were added (finished writing, or moved in)
+//   and removed (deleted, or moved out), so that the pathStacks can be updated in place.  A rename
+//   is reported as a remove of the old name plus an add of the new one.  Removed DIRECTORIES are
+//   reported as removed paths too, so consumers should treat a removed path as a prefix.
+//
+// On other platforms isSupported() is false, and the caller keeps using QFileSystemWatcher.
+class InotifyMusicWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit InotifyMusicWatcher(QObject *parent = nullptr);
+    ~InotifyMusicWatcher() override;
+
+    static bool isSupported();
+
+    // watch root and all of its subdirectories, except those whose path matches ignoreDirs
+    bool watchTree(const QString &root, const QRegularExpression &ignoreDirs);
+    void clear();
+    bool isWatching() const { return !pathByWd.isEmpty(); }
+    int watchCount() const { return static_cast<int>(pathByWd.size()); }
+
+signals:
+    void filesChanged(const QStringList &added, const QStringList &removed);  // one batch per wakeup
+    void overflowed();  // the kernel queue overflowed and events were lost -- do a full rescan
+
+private slots:
+    void readEvents();
+
+private:
+    bool isIgnored(const QString &dir) const;
+    void addTree(const QString &dir, QStringList *filesFound);  // watch dir and its subdirs, collecting their files
+    void removeTree(const QString &dir);                        // stop watching dir and its subdirs
+
+    int fd;
+    QSocketNotifier *notifier;
+    QHash<int, QString> pathByWd;
+    QHash<QString, int> wdByPath;
+    QRegularExpression ignore;
+};
+
+#endif /* ifndef INOTIFYWATCHER_H_INCLUDED */
@@ -501,6 +501,40 @@ void MainWindow::fileWatcherDisabledTriggered() {
     filewatcherIsTemporarilyDisabled = false;   // no longer disabled when this fires!
     fileWatcherDisabledTimer->stop();  // 5s expired, so we don't need to be notified again
 
+    // inotify deltas that came in while we were disabled were kept (see musicRootFilesChanged()),
+    //   so apply them now.  Dropping them would be worse than a rescan: the next delta in the same
+    //   directory re-fingerprints it for the pathStack cache, and then nothing would ever notice.
+    if (pendingMusicFilesOverflowed || !pendingAddedMusicFiles.isEmpty() || !pendingRemovedMusicFiles.isEmpty()) {
+        musicRootModified(QString("INOTIFY"));
+    }
+}
+
+// inotify (Linux): the exact files that changed, so musicRootModified() can update the pathStacks
+//   in place instead of rescanning.  Same pref rule and 2s debounce as the QFileSystemWatcher path,
+//   but while the watcher is temporarily disabled, the deltas are only queued, and
+//   fileWatcherDisabledTriggered() applies them when it's re-enabled.
+void MainWindow::musicRootFilesChanged(const QStringList &added, const QStringList &removed)
+{
+    if (!prefsManager.GetenableNewFileWatcher()) {
+        return;
+    }
+    for (const QString &r : removed) {
+        pendingAddedMusicFiles.removeAll(r);
+        pendingRemovedMusicFiles.append(r);
+    }
+    for (const QString &a : added) {
+        pendingRemovedMusicFiles.removeAll(a);  // e.g. a file that was replaced by a rename
+        if (!pendingAddedMusicFiles.contains(a)) {
+            pendingAddedMusicFiles.append(a);
+        }
+    }
+    musicRootModified(QString("INOTIFY"));
+}
+
+void MainWindow::musicRootWatcherOverflowed()
+{
+    pendingMusicFilesOverflowed = true;  // we don't know what we missed
+    musicRootModified(QString("INOTIFY_OVERFLOW"));
 }
 
 void MainWindow::musicRootModified(QString s)
@@ -546,6 +580,26 @@ void MainWindow::musicRootModified(QString s)
         // ui->statusBar->showMessage("Scanning Music Directory....");
         // QCoreApplication::processEvents(); // show the message
 
+        if (s != "MANUAL_RESCAN" && !pendingMusicFilesOverflowed &&
+            (!pendingAddedMusicFiles.isEmpty() || !pendingRemovedMusicFiles.isEmpty())) {
+            // inotify told us exactly what changed: apply just those deltas to the pathStacks,
+            //   the pathStack cache, and the darkSongTable, without walking the music directory
+            QStringList added = pendingAddedMusicFiles;
+            QStringList removed = pendingRemovedMusicFiles;
+            pendingAddedMusicFiles.clear();
+            pendingRemovedMusicFiles.clear();
+
+            updatePathStacksIncrementally(added, removed); // also adds/removes just those darkSongTable rows
+            refreshAllPlaylists(); // re-check file existence so deleted songs go red/strikethrough (#1589)
+            adjustFontSizes(); // and make sure the playlist fonts don't change size
+
+            filewatcherShouldIgnoreOneFileSave = false;
+            return;
+        }
+        pendingAddedMusicFiles.clear();  // about to rescan everything anyway
+        pendingRemovedMusicFiles.clear();
+        pendingMusicFilesOverflowed = false;
+
         bool musicDirChanged = findMusic(musicRootPath, true, s == "MANUAL_RESCAN");  // get the filenames from the user's directories
                                                                // (a MANUAL_RESCAN bypasses the pathStack cache, so it's the
                                                                //  escape hatch if the cache ever goes stale -- Issue #1669)
@@ -1122,6 +1176,11 @@ MainWindow::~MainWindow()
         sleep(5);  // give them a few seconds to go away
     }
 
+    fingerprintWatcher.waitForFinished();  // the last song loaded may still be being fingerprinted
+    fingerprintIndex.save();  // only writes if something was added
+
+    songSettings.flushWrites();  // commit the write-behind queue now, rather than whenever songSettings is destroyed
+
     if (darkmode) {
         playlistSlotWatcherTimer->stop();
         playlistSlotWatcherTriggered(); // auto-save anything that hasn't been saved yet
@@ -2104,7 +2163,7 @@ void MainWindow::on_pushButtonSetIntroTime_clicked()
         }
 
         double outroPosition;
-        outroPosition = cBass->snapToClosest(position + (7 * 64 * (60.0/baseBPM)), granularity); // Always 7 sections of 64 beats in a singer
+        outroPosition = cBass->snapToClosest(positionAfterBeats(position, 7 * 64), granularity); // Always 7 sections of 64 beats in a singer
                                                                                                  //  If it's a weird singer that's different, don't use this feature.
 
         if (outroPosition < 0) {
@@ -2228,6 +2287,8 @@ void MainWindow::on_UIUpdateTimerTick(void)
             QThreadPool::globalInstance()->setMaxThreadCount(n); // allow use of all threads again
 
             ui->darkSeekBar->updateBgPixmap((float*)1, 1);  // update the bg pixmap, in case we now have section info on the loaded song, only update ONCE
+
+            fingerprintIndex.save();  // bulk processing fingerprints every song it touches
         }
     }
 
@@ -3429,9 +3490,11 @@ void MainWindow::secondHalfOfLoad(QString songTitle) {
     currentSongSecondsPlayed = 0; // reset the counter, because this is a new session
     currentSongSecondsPlayedRecorded = false; // not reported yet, because this is a new session
 
-    // We are NOT doing automatic start-of-song finding right now.
-    startOfSong_sec = 0.0;
-    endOfSong_sec = cBass->FileLength;  // used by setDefaultIntroOutroPositions below
+    // where the music actually starts and ends (the decoder found these, skipping silence and needle noise)
+    //   these are used by SetDefaultIntroOutroPositions below, to suggest intro/outro points
+    QString resolvedFilePath = QFileInfo(currentMP3filenameWithPath).symLinkTarget();  // same file that loadMP3File gave to StreamCreate
+    cBass->songStartDetector((resolvedFilePath != "" ? resolvedFilePath : currentMP3filenameWithPath).toStdString().c_str(),
+                             &startOfSong_sec, &endOfSong_sec);
 
     // qDebug() << "***** secondHalfOfLoad(): " << startOfSong_sec << endOfSong_sec;
 
@@ -3582,6 +3645,9 @@ void MainWindow::secondHalfOfLoad(QString songTitle) {
 //    qDebug() << "**** NOTE: currentSongTitle = " << currentSongTitle;
     // qDebug() << "secondHalfOfLoad is calling loadSettingsForSong: " << songTitle;
 
+    // if this file is new to us, but it's a re-encoded/renamed copy of a song we DO know, offer to copy its settings
+    updateFingerprintForCurrentSong(songTitle);
+
     // loadSettingsForSong will set Intro/Outro, if there was one saved in the settings
     //   This will override the defaults possibly set above.
     loadSettingsForSong(songTitle); // also loads replayGain, if song has one; also loads tempo from DB (not necessarily same as songTable if playlist loaded)
@@ -3626,7 +3692,11 @@ void MainWindow::secondHalfOfLoad(QString songTitle) {
     // emit ui->pitchSlider->valueChanged(pitchInt); // make sure that the on value changed code gets executed, even if this isn't really a change.
 
 //    qDebug() << "setting stream position to: " << startOfSong_sec;
-    cBass->StreamSetPosition(startOfSong_sec);  // last thing we do is move the stream position to 1 sec before start of music
+#ifdef REMOVESILENCE
+    cBass->StreamSetPosition(startOfSong_sec > 1.0 ? startOfSong_sec - 1.0 : 0.0);  // last thing we do is move the stream position to 1 sec before start of music
+#else
+    cBass->StreamSetPosition(0.0);  // start of song, NOT start of music
+#endif
 
     songLoaded = true;  // now seekBar can be updated
     setInOutButtonState();
@@ -3641,11 +3711,7 @@ void MainWindow::secondHalfOfLoad(QString songTitle) {
 //    qDebug() << "end of second half of load...";
 //    ui->darkSeekBar->updateBgPixmap(waveform, WAVEFORMWIDTH);
     // qDebug() << "updateBgPixmap called from secondHalfOfLoad";
-    if (ui->actionNormalize_Track_Audio->isChecked()) {
-        ui->darkSeekBar->setWholeTrackPeak(cBass->GetWholeTrackPeak()); // scale the waveform
-    } else {
-        ui->darkSeekBar->setWholeTrackPeak(1.0); // don't scale the waveform
-    }
+    updateWaveformNormalizationScale();
     // qDebug() << "now updating BgPixmap";
 
     QString bulkDirname = musicRootPath + "/.squaredesk/bulk";
@@ -3784,51 +3850,115 @@ void MainWindow::clearLockFile(QString musicRootPath) {
 
 
 
-void MainWindow::updateTreeWidget() {
+// Makes parent's children have exactly these names, in this order, WITHOUT recreating the
+// children that are already there -- so they keep their expansion and selection state.
+// Returns the (kept or new) children, in the same order as names.
+static QList<QTreeWidgetItem *> syncTreeChildren(QTreeWidgetItem *parent, const QStringList &names) {
+    QList<QTreeWidgetItem *> result;
+    for (int i = 0; i < names.size(); i++) {
+        QTreeWidgetItem *item = nullptr;
+        for (int j = i; j < parent->childCount(); j++) {
+            if (parent->child(j)->text(0) == names[i]) {
+                item = parent->child(j);
+                if (j != i) {
+                    // only happens when something was inserted or removed in between
+                    parent->takeChild(j);
+                    parent->insertChild(i, item);
+                }
+                break;
+            }
+        }
+        if (item == nullptr) {
+            item = new QTreeWidgetItem();
+            item->setText(0, names[i]);
+            parent->insertChild(i, item);
+        }
+        result.append(item);
+    }
+    while (parent->childCount() > names.size()) {
+        delete parent->takeChild(parent->childCount() - 1);
+    }
+    return result;
+}
 
-    // updateTreeWidget always rescans for playlists, so we need to clear pathStackPlaylists here.
-    pathStackPlaylists->clear();
-    // but do NOT clear pathStackNewApplePlaylists, which has a cache of the tracks from new Apple Music playlists
+// The desired shape of the Playlists part of the tree (same shape the old clear-and-rebuild made).
+struct PlaylistTreeNode {
+    QString name;
+    QList<PlaylistTreeNode> children;
+};
 
-    // GET LIST OF TYPES AND POPULATE TREEWIDGET > TRACKS -------------
-    QListIterator<QString> iter(*pathStack); // Tracks = search thru music (MP3, M4A) files
+static void syncPlaylistTree(QTreeWidgetItem *parent, const QList<PlaylistTreeNode> &nodes) {
+    QStringList names;
+    for (const auto &n : nodes) {
+        names.append(n.name);
+    }
+    QList<QTreeWidgetItem *> items = syncTreeChildren(parent, names);
+    for (int i = 0; i < nodes.size(); i++) {
+        syncPlaylistTree(items[i], nodes[i].children);
+    }
+}
 
-    QStringList types;
+// type of a pathStack entry, for the Tracks part of the tree: top level only (e.g. "patter/old" -> "patter"),
+//   and "" for the ones that don't go in the tree at all
+void MainWindow::countTrackType(const QString &pathStackEntry, int delta) {
+    // the type (of original pathname, before following aliases)
+    QString theType = songRecords.record(songRecords.idFor(pathStackEntry)).type.section('/', 0, 0);
 
-    while (iter.hasNext()) {
-        QString s = iter.next();
-        QString type1 = (s.replace(musicRootPath + "/", "").split("/"))[0];
-        QStringList sl1 = type1.split("#!#");
-        QString theType = sl1[0];  // the type (of original pathname, before following aliases)
+    if (theType != "" && theType != "lyrics" && !theType.contains("$!$")) {  // screen OUT the Apple Music entries
+        int n = trackTypeCounts.value(theType) + delta;
+        if (n > 0) {
+            trackTypeCounts.insert(theType, n);
+        } else {
+            trackTypeCounts.remove(theType);
+        }
+    }
+}
 
-        if (theType != "" && theType != "lyrics" && !theType.contains("$!$")) {  // screen OUT the Apple Music entries
-//            types[theType] += 1;
-            types.append(theType);
+// GET LIST OF TYPES AND POPULATE TREEWIDGET > TRACKS -------------
+//   The counts are kept up to date as the pathStack changes, so this is only a walk of the pathStack
+//   right after it was reloaded; the tree itself only gets the nodes that were added or removed.
+void MainWindow::updateTreeWidgetTracks() {
+    songRecords.setMusicRoot(musicRootPath);
+    if (!trackTypeCountsValid) {
+        trackTypeCounts.clear();
+        for (const auto &entry : std::as_const(*pathStack)) { // Tracks = search thru music (MP3, M4A) files
+            countTrackType(entry, 1);
         }
+        trackTypeCountsValid = true;
     }
 
-    types.removeDuplicates();
+    QStringList types = trackTypeCounts.keys();
     types.sort(Qt::CaseInsensitive);  // sort them
 
 //    qDebug() << "types: " << types;
 
-    QTreeWidgetItem *tracksItem = new QTreeWidgetItem();
-    tracksItem->setText(0, kCharStarStringTracks);
-//    tracksItem->setIcon(0, QIcon(":/graphics/darkiTunes.png"));
-    tracksItem->setIcon(0, QIcon(":/graphics/icons8-musical-note-60.png"));
-
-//    QMapIterator<QString, int> i(types);
-    QStringListIterator i(types);
-    while (i.hasNext()) {
-        QString s = i.next();
-        QTreeWidgetItem *trackTypeItem = new QTreeWidgetItem(tracksItem); // child of tracksItem
-//        trackTypeItem->setText(0, i.key());
-        trackTypeItem->setText(0, s);
+    QList<QTreeWidgetItem *> trackItems = ui->treeWidget->findItems(kCharStarStringTracks, Qt::MatchExactly);
+    QTreeWidgetItem *tracksItem;
+    if (trackItems.isEmpty()) {
+        tracksItem = new QTreeWidgetItem();
+        tracksItem->setText(0, kCharStarStringTracks);
+//        tracksItem->setIcon(0, QIcon(":/graphics/darkiTunes.png"));
+        tracksItem->setIcon(0, QIcon(":/graphics/icons8-musical-note-60.png"));
+        ui->treeWidget->insertTopLevelItem(0, tracksItem);
+        tracksItem->setExpanded(true);
+    } else {
+        tracksItem = trackItems[0];
     }
 
-    ui->treeWidget->clear();
-    ui->treeWidget->insertTopLevelItem(0, tracksItem);
-    tracksItem->setExpanded(true);
+    syncTreeChildren(tracksItem, types);
+}
+
+// Refreshes the sidebar (Tracks types, and the Playlists folders) and reloads pathStackPlaylists.
+//   Existing tree nodes are kept (with their expansion and selection state), and only playlist
+//   files that changed since the last time are read again.
+void MainWindow::updateTreeWidget() {
+
+    // updateTreeWidget always rescans for playlists, so we need to clear pathStackPlaylists here.
+    songRecords.remove(*pathStackPlaylists);  // e.g. a changed pitch makes a new entry, so the old records would pile up
+    pathStackPlaylists->clear();
+    // but do NOT clear pathStackNewApplePlaylists, which has a cache of the tracks from new Apple Music playlists
+
+    updateTreeWidgetTracks();
 
     // --------------------------------------------------------------------
     // GET LIST OF LOCAL PLAYLISTS AND POPULATE TREEWIDGET > PLAYLISTS ----------
@@ -3873,109 +4003,80 @@ void MainWindow::updateTreeWidget() {
     }
 
     // top level Playlists item with icon
-    QTreeWidgetItem *playlistsItem = new QTreeWidgetItem();
-    playlistsItem->setText(0, "Playlists");
-//    playlistsItem->setIcon(0, QIcon(":/graphics/darkPlaylists.png"));
-    playlistsItem->setIcon(0, QIcon(":/graphics/icons8-menu-64.png"));
-    ui->treeWidget->addTopLevelItem(playlistsItem);  // add this one to the tree
-    playlistsItem->setExpanded(true);
-
-    // insert filenames
-    QTreeWidgetItem *topLevelItem = playlistsItem;
+    QTreeWidgetItem *playlistsItem = nullptr;
+    for (int i = 0; i < ui->treeWidget->topLevelItemCount(); i++) {
+        if (ui->treeWidget->topLevelItem(i)->text(0) == "Playlists") {
+            playlistsItem = ui->treeWidget->topLevelItem(i);
+            break;
+        }
+    }
+    if (playlistsItem == nullptr) {
+        playlistsItem = new QTreeWidgetItem();
+        playlistsItem->setText(0, "Playlists");
+//        playlistsItem->setIcon(0, QIcon(":/graphics/darkPlaylists.png"));
+        playlistsItem->setIcon(0, QIcon(":/graphics/icons8-menu-64.png"));
+        ui->treeWidget->addTopLevelItem(playlistsItem);  // add this one to the tree
+        playlistsItem->setExpanded(true);
+    }
+
+    // insert filenames: work out the shape of the tree first, then make the real one match it
+    QList<PlaylistTreeNode> playlistNodes;
     for (const auto &fileName : std::as_const(playlists))
     {
-        QStringList splitFileName = (QString("Playlists/") + fileName).split("/"); // tack on "Playlists/" so they will populate under the icon item
-
-        // add root folder as top level item if treeWidget doesn't already have it
-        if (ui->treeWidget->findItems(splitFileName[0], Qt::MatchFixedString).isEmpty())
-        {
-            topLevelItem = new QTreeWidgetItem;
-            topLevelItem->setText(0, splitFileName[0]);
-            ui->treeWidget->addTopLevelItem(topLevelItem);
-        }
+        QStringList splitFileName = fileName.split("/");
 
-        QTreeWidgetItem *parentItem = topLevelItem;
+        QList<PlaylistTreeNode> *parentNodes = &playlistNodes;
 
-        if (splitFileName.length() > 1) {
-            // iterate through non-root directories (file name comes after)
-            for (int i = 1; i < splitFileName.size() - 1; ++i)
+        // iterate through directories (file name comes after)
+        for (int i = 0; i < splitFileName.size() - 1; ++i)
+        {
+            // iterate through children of parent to see if this directory exists
+            PlaylistTreeNode *found = nullptr;
+            for (auto &child : *parentNodes)
             {
-                // iterate through children of parentItem to see if this directory exists
-                bool thisDirectoryExists = false;
-                for (int j = 0; j < parentItem->childCount(); ++j)
-                {
-                    if (splitFileName[i] == parentItem->child(j)->text(0))
-                    {
-                            thisDirectoryExists = true;
-                            parentItem = parentItem->child(j);
-                            break;
-                    }
-                }
-
-                if (!thisDirectoryExists)
+                if (splitFileName[i] == child.name)
                 {
-                    parentItem = new QTreeWidgetItem(parentItem);
-                    parentItem->setText(0, splitFileName[i]);
+                    found = &child;
+                    break;
                 }
             }
 
-            QTreeWidgetItem *childItem = new QTreeWidgetItem(parentItem);
-            childItem->setText(0, splitFileName.last());
+            if (found == nullptr)
+            {
+                parentNodes->append(PlaylistTreeNode{splitFileName[i], {}});
+                found = &parentNodes->last();
+            }
+            parentNodes = &found->children;
         }
+
+        parentNodes->append(PlaylistTreeNode{splitFileName.last(), {}});
     }
 
+    syncPlaylistTree(playlistsItem, playlistNodes);
+
     // TODO: remove all of the local playlist entries from the pathStack
 
     // and replace them with:
     // Now, find all of the playlist entries, and stick the songs into the pathStack without Greek Xi
+    //   (only the playlist files that changed since last time are actually read again)
+    QHash<QString, PlaylistFileEntries> stillThere;
     for (const auto &fileName : std::as_const(playlists)) {
-
         QString fullPathName = musicRootPath + "/playlists/" + fileName + ".csv";
-        QFile file(fullPathName);
-        // qDebug() << "fullPathName:" << fullPathName;
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream in(&file);
-            QString line;
-
-            // header
-            line = in.readLine();
-            if (line == "relpath,pitch,tempo") {
-                // qDebug() << "GOOD HEADER.";
-            } else {
-                continue; // skip playlists whose format we do not understand
-            }
-
-            int currentLineNumber = 1;
-            while (!in.atEnd()) {
-                line = in.readLine();
-                QStringList SL = parseCSV(line);
-                // relpath,pitch,tempo
-                if (SL.length() != 3) {
-                    continue; // ignore lines that don't parse to exactly 3 fields
-                }
-                QString relpath = SL[0];
-                QString fullPath = musicRootPath + relpath;
-                // QStringList relPathSplit = relpath.split("/");
-                // int lastIndex = relPathSplit.size() - 1;
-                QString extraZero = (currentLineNumber < 10 ? "0" : "");   // playlists can contain line numbers up to 99 == 01, 02, ... 10, 11, ... 99
-                extraZero        += (currentLineNumber < 100 ? "0" : "");  // playlists can contain line numbers up to 999 == 001, 002, ... 099, 100, ... 999
-                // relPathSplit[lastIndex] = extraZero + QString::number(currentLineNumber++)  + " - " + relPathSplit[lastIndex];
-                // QString revisedrelpath = relPathSplit.join("/");
-                // QString revisedFullPath = musicRootPath + revisedrelpath;
-                QString pitch = SL[1];
-                QString tempo = SL[2];
-                // e.g. "SquareDeskPlaylistName%!%pitch,tempo,currentPlaylistLineNumber#!#FullPathname"
-                QString pathStackEntry = fileName + "%!%" + pitch + "," + tempo + "," + extraZero + QString::number(currentLineNumber++) + "#!#" + fullPath;
-                // qDebug() << pathStackEntry;
-                pathStackPlaylists->append(pathStackEntry);
-            }
-
-            file.close();
-        } else {
-            // Handle file opening error
+        QFileInfo fi(fullPathName);
+        if (!fi.exists()) {
+            continue; // an Apple Music playlist name, not a file
         }
 
+        PlaylistFileEntries cached = playlistFileCache.value(fileName, PlaylistFileEntries{-1, -1, QStringList()});
+        if (cached.size != fi.size() || cached.mtime != fi.lastModified().toMSecsSinceEpoch()) {
+            cached.size = fi.size();
+            cached.mtime = fi.lastModified().toMSecsSinceEpoch();
+            cached.entries = readPlaylistEntries(fileName);
+        }
+        pathStackPlaylists->append(cached.entries);
+        stillThere.insert(fileName, cached);
     }
+    playlistFileCache = stillThere;  // and forget the deleted ones
 
     // now that we have rescanned the playlist directory, add in the cached AppleMusic tracks that are in Playlists
     //   these are needed so that when we click on an Apple Playlist, it will show the items in that Apple Music playlist
@@ -4012,6 +4113,53 @@ void MainWindow::updateTreeWidget() {
 //    }
 }
 
+// Reads one playlist .csv (fileName is relative to the playlists folder, without the .csv), and returns
+//   its songs as pathStackPlaylists entries, e.g. "SquareDeskPlaylistName%!%pitch,tempo,currentPlaylistLineNumber#!#FullPathname"
+QStringList MainWindow::readPlaylistEntries(const QString &fileName) {
+    QStringList entries;
+
+    QString fullPathName = musicRootPath + "/playlists/" + fileName + ".csv";
+    QFile file(fullPathName);
+    // qDebug() << "fullPathName:" << fullPathName;
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream in(&file);
+        QString line;
+
+        // header
+        line = in.readLine();
+        if (line == "relpath,pitch,tempo") {
+            // qDebug() << "GOOD HEADER.";
+        } else {
+            return entries; // skip playlists whose format we do not understand
+        }
+
+        int currentLineNumber = 1;
+        while (!in.atEnd()) {
+            line = in.readLine();
+            QStringList SL = parseCSV(line);
+            // relpath,pitch,tempo
+            if (SL.length() != 3) {
+                continue; // ignore lines that don't parse to exactly 3 fields
+            }
+            QString relpath = SL[0];
+            QString fullPath = musicRootPath + relpath;
+            QString extraZero = (currentLineNumber < 10 ? "0" : "");   // playlists can contain line numbers up to 99 == 01, 02, ... 10, 11, ... 99
+            extraZero        += (currentLineNumber < 100 ? "0" : "");  // playlists can contain line numbers up to 999 == 001, 002, ... 099, 100, ... 999
+            QString pitch = SL[1];
+            QString tempo = SL[2];
+            // e.g. "SquareDeskPlaylistName%!%pitch,tempo,currentPlaylistLineNumber#!#FullPathname"
+            QString pathStackEntry = fileName + "%!%" + pitch + "," + tempo + "," + extraZero + QString::number(currentLineNumber++) + "#!#" + fullPath;
+            // qDebug() << pathStackEntry;
+            entries.append(pathStackEntry);
+        }
+
+        file.close();
+    } else {
+        // Handle file opening error
+    }
+    return entries;
+}
+
 void addStringToLastRowOfSongTable(QColor &textCol, MyTableWidget *songTable,
                                    QString str, int column)
 {
@@ -4031,9 +4179,17 @@ void addStringToLastRowOfSongTable(QColor &textCol, MyTableWidget *songTable,
     songTable->setItem(songTable->rowCount()-1, column, newTableItem);
 }
 
+// the darkSongTable title cell has no widget; its HTML (title + tag pills) lives in the item, and is
+//   painted by the DarkSongTitleDelegate
 static QString getTitleColText(MyTableWidget *songTable, int row)
 {
-    return dynamic_cast<QLabel*>(songTable->cellWidget(row,kTitleCol))->text();
+    return songTable->item(row,kTitleCol)->data(kTitleHTMLRole).toString();
+}
+
+void MainWindow::setTitleColText(MyTableWidget *songTable, int row, const QString &titlePlusTags)
+{
+    songTable->item(row,kTitleCol)->setData(kTitleHTMLRole, titlePlusTags);
+    darkSongSearchIndexDirty = true;  // tags are searchable
 }
 
 QString getTitleColTitle(MyTableWidget *songTable, int row)
@@ -4241,16 +4397,6 @@ void MainWindow::titleLabelDoubleClicked(QMouseEvent * /* event */)
 {    
 }
 
-void MainWindow::darkTitleLabelDoubleClicked(QMouseEvent * /* event */)
-{
-    int row = darkSelectedSongRow();
-    if (row >= 0) {
-        on_darkSongTable_itemDoubleClicked(ui->darkSongTable->item(row, kPathCol));
-    } else {
-        // more than 1 row or no rows at all selected (BAD)
-    }
-}
-
 void MainWindow::on_actionClear_Search_triggered()
 {
     ui->darkSearch->setText("");
@@ -4502,6 +4648,7 @@ void MainWindow::on_actionPreferences_triggered()
         SetKeyMappings(hotkeyMappings, hotkeyShortcuts);
         updateHotkeyTooltips(); // tooltips reflect the actual current key bindings (issue #1644)
         songSettings.setDefaultTagColors( prefsManager.GettagsBackgroundColorString(), prefsManager.GettagsForegroundColorString());
+        refreshAllSongTitles();  // new tag colors, and tags that lost their color are gone from the songs
 
         QString newMusicRootPath = prefsManager.GetmusicPath();
 
@@ -4596,12 +4743,12 @@ void MainWindow::on_actionPreferences_triggered()
         // "Rescan Music Directory when new songs are added" pref is ON (registering them
         // costs ~300ms on a large library, so startup skips it when the pref is OFF).
         if (prefsManager.GetenableNewFileWatcher()) {
-            if (musicRootWatcher.directories().isEmpty()) {
+            if (!musicRootWatcherIsActive()) {
                 initializeMusicRootWatcher(); // user just turned it ON -- register the watch paths now
             }
         } else {
-            if (!musicRootWatcher.directories().isEmpty()) {
-                musicRootWatcher.removePaths(musicRootWatcher.directories()); // user just turned it OFF
+            if (musicRootWatcherIsActive()) {
+                stopMusicRootWatcher(); // user just turned it OFF
             }
         }
 
@@ -4920,7 +5067,7 @@ void MainWindow::darkChangeTagOnCurrentSongSelection(QString tag, bool add)
         // we know for sure that this item is selected (because that's how we got here), so let's highlight text color accordingly
         QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags(), theOriginalColor));
 
-        dynamic_cast<QLabel*>(ui->darkSongTable->cellWidget(row,kTitleCol))->setText(titlePlusTags);
+        setTitleColText(ui->darkSongTable, row, titlePlusTags);
     }
 }
 
@@ -4960,7 +5107,7 @@ void MainWindow::removeAllTagsFromSongRow(int row) {
         // then, put the title back, with the original color, but without the tags
         QString title = getTitleColTitle(ui->darkSongTable, row);
         QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags(), theOriginalColor));
-        dynamic_cast<QLabel*>(ui->darkSongTable->cellWidget(row,kTitleCol))->setText(titlePlusTags);
+        setTitleColText(ui->darkSongTable, row, titlePlusTags);
     }
 }
 
@@ -5019,7 +5166,7 @@ void MainWindow::darkEditTags()
 
             // we know for sure that this item is selected (because that's how we got here), so let's highlight text color accordingly
             QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags(), theOriginalColor));
-            dynamic_cast<QLabel*>(ui->darkSongTable->cellWidget(row,kTitleCol))->setText(titlePlusTags);
+            setTitleColText(ui->darkSongTable, row, titlePlusTags);
         }
     }
     else {
@@ -5027,32 +5174,19 @@ void MainWindow::darkEditTags()
     }
 }
 
-// Path-based wrapper for playlist context menu --------
-// Helper function to update darkSongTable row if the song is visible there
-void MainWindow::updateDarkSongTableRowForPath(QString pathToMP3) {
-    // Find and update the row in darkSongTable if this song is visible
-    for (int row = 0; row < ui->darkSongTable->rowCount(); row++) {
-        QString rowPath = ui->darkSongTable->item(row, kPathCol)->data(Qt::UserRole).toString();
-        if (rowPath == pathToMP3) {
-            // Found it - update the title column with new tags
-            SongSetting settings;
-            songSettings.loadSettings(pathToMP3, settings);
-
-            QString title1 = getTitleColText(ui->darkSongTable, row);
-            static QRegularExpression re("^<span style=[\"]color: (.*?);");
-            QRegularExpressionMatch match = re.match(title1);
-
-            QString theOriginalColor = "";
-            if (match.hasMatch()) {
-                theOriginalColor = match.captured(1);
-            }
+void MainWindow::updateDarkSongTableTitle(int row, const SongSetting &settings) {
+    QString title1 = getTitleColText(ui->darkSongTable, row);
+    static QRegularExpression re("^<span style=[\"]color: (.*?);");
+    QRegularExpressionMatch match = re.match(title1);
 
-            QString title = getTitleColTitle(ui->darkSongTable, row);
-            QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags(), theOriginalColor));
-            dynamic_cast<QLabel*>(ui->darkSongTable->cellWidget(row, kTitleCol))->setText(titlePlusTags);
-            break;
-        }
+    QString theOriginalColor = "";
+    if (match.hasMatch()) {
+        theOriginalColor = match.captured(1);
     }
+
+    QString title = getTitleColTitle(ui->darkSongTable, row);
+    QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags(), theOriginalColor));
+    setTitleColText(ui->darkSongTable, row, titlePlusTags);
 }
 
 void MainWindow::editTagsForPath(QString pathToMP3) {
@@ -5086,9 +5220,7 @@ void MainWindow::editTagsForPath(QString pathToMP3) {
         songSettings.saveSettings(pathToMP3, settings);
         songSettings.addTags(newtags);
 
-        // Refresh both playlists and darkSongTable
-        refreshAllPlaylists();
-        updateDarkSongTableRowForPath(pathToMP3);
+        // both the playlists and the darkSongTable are refreshed by songSettingChanged()
     }
 }
 
@@ -5117,9 +5249,7 @@ void MainWindow::changeTagForPath(QString pathToMP3, QString tag, bool add) {
     songSettings.saveSettings(pathToMP3, settings);
     songSettings.addTags(tags.join(" "));
 
-    // Refresh both playlists and darkSongTable
-    refreshAllPlaylists();
-    updateDarkSongTableRowForPath(pathToMP3);
+    // both the playlists and the darkSongTable are refreshed by songSettingChanged()
 }
 
 void MainWindow::removeAllTagsForPath(QString pathToMP3) {
@@ -5139,9 +5269,7 @@ void MainWindow::removeAllTagsForPath(QString pathToMP3) {
     songSettings.saveSettings(pathToMP3, settings);
     songSettings.addTags(newtags);
 
-    // Refresh both playlists and darkSongTable
-    refreshAllPlaylists();
-    updateDarkSongTableRowForPath(pathToMP3);
+    // both the playlists and the darkSongTable are refreshed by songSettingChanged()
 }
 
 void MainWindow::revealInFinder()
@@ -5230,7 +5358,6 @@ void MainWindow::saveCurrentSongSettings()
         setting.setMidrange( KnobToSlider(ui->darkMidKnob->value())    );
         // setting.setMix( ui->mixSlider->value() );
 
-//        setting.setReplayGain();  // TODO:
 
         // only update the LoudMax setting if the LoudMax plugin is present.
         //  otherwise, leave it alone.  This prevents SquareDesk from erasing previous
@@ -5247,15 +5374,12 @@ void MainWindow::saveCurrentSongSettings()
             setting.setLoop( -1 );
         }
 
-//        // When it comes time to save the replayGain value, it should be done being calculated.
-//        // So, save it, whatever it is.  This will fail, if the song is quickly clicked through.
-//        // We guard against this by NOT saving, if it's exactly 0.0 dB (meaning not calculated yet).
-//        if (cBass->Stream_replayGain_dB != 0.0) {
-////            qDebug() << "***** saveCurrentSongSettings: saving replayGain value for" << currentSong << "= " << cBass->Stream_replayGain_dB;
-//            setting.setReplayGain(cBass->Stream_replayGain_dB);
-//        } else {
-////            qDebug() << "***** saveCurrentSongSettings: NOT saving replayGain value for" << currentSong << ", because it's 0.0dB, so not set yet";
-//        }
+        // The loudness (ReplayGain) is measured when the song is decoded, so it's known by now,
+        //   unless the song was silent.  Persist it, so that the next load doesn't have to measure it.
+        if (cBass->HasReplayGain()) {
+            // qDebug() << "***** saveCurrentSongSettings: saving replayGain value for" << currentSong << "= " << cBass->GetReplayGain();
+            setting.setReplayGain(cBass->GetReplayGain());
+        }
 
         songSettings.saveSettings(currentMP3filenameWithPath,
                                   setting);
@@ -6450,18 +6574,24 @@ QString MainWindow::filepath2SongCategoryName(QString MP3Filename)
     if (parts.length() <= 1) {
         return("unknown");
     } else {
-        QString folderTypename = parts[1].toLower();
-        if (songTypeNamesForPatter.contains(folderTypename)) {
-            return("patter");
-        } else if (songTypeNamesForSinging.contains(folderTypename)) {
-            return("singing");
-        } else if (songTypeNamesForCalled.contains(folderTypename)) {
-            return("called");
-        } else if (songTypeNamesForExtras.contains(folderTypename)) {
-            return("extras");
-        } else {
-            return(folderTypename);
-        }
+        return(folder2SongCategoryName(parts[1].toLower()));
+    }
+}
+
+QString MainWindow::folder2SongCategoryName(const QString &folderTypename)
+{
+    // e.g. "hoedown" -> "patter", as per user prefs.  Split out of filepath2SongCategoryName(), so that
+    //   callers that already have the folder name (SongRecord::folder) don't have to re-split the path.
+    if (songTypeNamesForPatter.contains(folderTypename)) {
+        return("patter");
+    } else if (songTypeNamesForSinging.contains(folderTypename)) {
+        return("singing");
+    } else if (songTypeNamesForCalled.contains(folderTypename)) {
+        return("called");
+    } else if (songTypeNamesForExtras.contains(folderTypename)) {
+        return("extras");
+    } else {
+        return(folderTypename);
     }
 }
 
@@ -6636,6 +6766,31 @@ QColor MainWindow::colorForLoopPoint(double time_sec) {
     return(QColor(UNALIGNEDCOLOR));
 }
 
+// Where the song will be after this many more beats.  The song's tempo is baseBPM, but live recordings
+//   drift, so if the whole-song tempo curve is steady enough to trust, its local tempo is followed a
+//   second at a time (scaled, so that its median is baseBPM, which may have come from an ID3 TBPM tag).
+double MainWindow::positionAfterBeats(double position_sec, double beats) {
+    double wholeSongBPM = cBass->GetLocalBPM(-1.0);  // -1 = median of the whole song
+    if (baseBPM <= 0.0 || wholeSongBPM <= 0.0 || cBass->GetBPMConfidence() < TEMPOCURVE_MIN_CONFIDENCE) {
+        return(position_sec + beats * (60.0/baseBPM));  // no curve (still computing, or too unsteady): constant tempo
+    }
+
+    double scale = baseBPM / wholeSongBPM;
+    double t = position_sec;
+    while (true) {
+        double bpm = scale * cBass->GetLocalBPM(t + 0.5);  // the tempo in the middle of this second
+        if (bpm <= 0.0) {
+            bpm = baseBPM;
+        }
+        double beatsThisSecond = bpm / 60.0;
+        if (beatsThisSecond >= beats) {
+            return(t + beats * (60.0/bpm));
+        }
+        beats -= beatsThisSecond;
+        t += 1.0;
+    }
+}
+
 void MainWindow::updateLoopAlignmentIndicators() {
     if (cBass->FileLength <= 0.0 || loadingSong) {
         return;  // no song fully loaded yet; secondHalfOfLoad will call us at the right time
@@ -7365,6 +7520,14 @@ void MainWindow::on_darkSearch_textChanged(const QString &s)
     //    s:riv = search for singing calls from Riverboat
     //    :riv:world = search for anything (patter or singing etc.) from Riverboat containing 'world'
     //    p:riv:bar  = search for patter from riverboat containing 'bar'
+    //    "over the rainbow = search for songs whose cuesheet or lyrics contain those words
+
+    textSearch = "";
+    if (s.startsWith(u'"')) {
+        textSearch = s.mid(1);
+        textSearch.remove(u'"');  // the closing quote, if any
+        count = 0;                // no type/label/title filters
+    }
 
     switch (count) {
         case 0:
@@ -8527,56 +8690,67 @@ void MainWindow::on_darkSongTable_customContextMenuRequested(const QPoint &pos)
         menu.addMenu(tagsMenu);
     } else if (rowCount > 1) {
         // more than one row in darkSongTable has been selected...
-        //   check to see if one or more songs have tags
-        bool someSongHasTags = false;
+        //   these go through the bulk SongSettings API: one write, one transaction, one redraw for all of them
+        QStringList selectedPaths;
+        for (int i = 0; i < rowCount; i++) {
+            selectedPaths.append(ui->darkSongTable->item(selectedRows[i], kPathCol)->data(Qt::UserRole).toString());
+        }
 
+        //   check to see if one or more songs have tags (and which tags ALL of them have)
+        const QHash<QString, SongSetting> &settingsCache = songSettings.allSongSettings();
+        QStringList taggedPaths;
+        QSet<QString> tagsOnAllSongs;
         for (int i = 0; i < rowCount; i++) {
-            QString pathToMP3 = ui->darkSongTable->item(selectedRows[i], kPathCol)->data(Qt::UserRole).toString();
-            SongSetting settings;
-            songSettings.loadSettings(pathToMP3, settings);
-            if (settings.isSetTags())
-            {
-                QString curTagString = settings.getTags();
-                // currentTags = settings.getTags().split(" ");
-                currentTags = curTagString.split(" ");
-
-                // if the song has some tags, offer to Remove them
-                if (currentTags.count() > 1 || currentTags[0] != "") {
-                    someSongHasTags = true;
-                    break; // and break out of the for loop
-                }
+            QStringList songTags = settingsCache.value(songSettings.removeRootDirs(selectedPaths[i])).getTags().split(" ", Qt::SkipEmptyParts);
+            QSet<QString> songTagSet(songTags.cbegin(), songTags.cend());
+            if (!songTagSet.isEmpty()) {
+                taggedPaths.append(selectedPaths[i]);
+            }
+            if (i == 0) {
+                tagsOnAllSongs = songTagSet;
+            } else {
+                tagsOnAllSongs.intersect(songTagSet);
             }
         }
 
+        menu.addSeparator(); // -------------------
+
         //   if so, show "Remove all tags from these N songs" context menu item
-        if (someSongHasTags) {
-            menu.addSeparator(); // -------------------
+        if (!taggedPaths.isEmpty()) {
             menu.addAction( "Remove all Tags from these " + QString::number(rowCount) + " songs",
-                            this, [this, rowCount, selectedRows, currentTags] {
-                            for (int i = 0; i < rowCount; i++) {
-                                QString pathToMP3 = ui->darkSongTable->item(selectedRows[i], kPathCol)->data(Qt::UserRole).toString();
-                                SongSetting settings;
-                                songSettings.loadSettings(pathToMP3, settings);
-                                if (settings.isSetTags())
-                                {
-                                    QString curTagString = settings.getTags();
-                                    // currentTags = settings.getTags().split(" ");
-                                    QStringList currentTags = curTagString.split(" ");
-
-                                    // if the song has some tags, offer to Remove them
-                                    if (currentTags.count() > 1 || currentTags[0] != "") {
-                                        // for some reason, count == 1 is one tag that is an empty string, means there are zero tags
-                                        // but sometimes, like when we manually do Edit Tags, there's no empty string.
-                                        // thus the need for that counterintuitive if clause above.
-                                        // qDebug() << "removing tags from row: " << selectedRows[i];
-                                        removeAllTagsFromSongRow(selectedRows[i]);
-                                    }
-                                }
-                            }
-                            refreshAllPlaylists();
-            });
+                            this, [this, taggedPaths] {
+                                SongSetting noTags;
+                                noTags.setTags("");
+                                songSettings.saveSettingsForSongs(taggedPaths, noTags);  // songs that have no tags are left alone
+                            });
         }
 
+        // and the PULLDOWN MENU WITH CHECKBOXES: checked = every selected song has that tag, so
+        //   checking adds the tag to all of them, and unchecking removes it from all of them
+        QMenu *tagsMenu(new QMenu("Tags", this));
+        QHash<QString,QPair<QString,QString>> tagColors(songSettings.getTagColors()); // we don't use the colors
+        QStringList tags(tagColors.keys()); // we use these keys (the names of the tags)
+        tags.sort(Qt::CaseInsensitive);
+
+        for (const auto &tagUntrimmed : tags)
+        {
+            QString tag(tagUntrimmed.trimmed());
+
+            if (tag.length() <= 0)
+                continue;
+
+            bool set = tagsOnAllSongs.contains(tag);
+            QAction *action(new QAction(tag));
+            action->setCheckable(true);
+            action->setChecked(set);
+            connect(action, &QAction::triggered,
+                    [this, set, tag, selectedPaths]()
+                    {
+                        songSettings.changeTagForSongs(selectedPaths, tag, !set);
+                    });
+            tagsMenu->addAction(action);
+        }
+        menu.addMenu(tagsMenu);
     }
 
     // DO IT ==========
@@ -8834,20 +9008,49 @@ void MainWindow::on_actionNormalize_Track_Audio_toggled(bool checked)
 {
     if (checked) {
         ui->actionNormalize_Track_Audio->setChecked(true);
+        ui->actionNormalize_Track_Loudness->setChecked(false);  // peak and loudness normalization are mutually exclusive
         cBass->SetNormalizeTrackAudio(true);
-        ui->darkSeekBar->setWholeTrackPeak(cBass->GetWholeTrackPeak()); // scale the waveform
     }
     else {
         ui->actionNormalize_Track_Audio->setChecked(false);
         cBass->SetNormalizeTrackAudio(false);
-        ui->darkSeekBar->setWholeTrackPeak(1.0); // disables waveform scaling
     }
 
     // the Normalize Track Audio setting is persistent across restarts of the application
     prefsManager.SetnormalizeTrackAudio(ui->actionNormalize_Track_Audio->isChecked());
 
-    if (cBass->GetWholeTrackPeak() != 1.0) {
-        ui->darkSeekBar->updateBgPixmap((float*)1, 1);  // update the bg pixmap, in case it was a singing call
+    updateWaveformNormalizationScale();
+    ui->darkSeekBar->updateBgPixmap((float*)1, 1);  // update the bg pixmap, in case it was a singing call
+}
+
+void MainWindow::on_actionNormalize_Track_Loudness_toggled(bool checked)
+{
+    if (checked) {
+        ui->actionNormalize_Track_Loudness->setChecked(true);
+        ui->actionNormalize_Track_Audio->setChecked(false);  // peak and loudness normalization are mutually exclusive
+        cBass->SetLoudnessNormalizeTrackAudio(true);
+    }
+    else {
+        ui->actionNormalize_Track_Loudness->setChecked(false);
+        cBass->SetLoudnessNormalizeTrackAudio(false);
+    }
+
+    // the Normalize Track Loudness setting is persistent across restarts of the application
+    prefsManager.SetnormalizeTrackLoudness(ui->actionNormalize_Track_Loudness->isChecked());
+
+    updateWaveformNormalizationScale();
+    ui->darkSeekBar->updateBgPixmap((float*)1, 1);  // update the bg pixmap, in case it was a singing call
+}
+
+// scale the waveform in the seekbar by the same amount that the audio is being scaled by
+void MainWindow::updateWaveformNormalizationScale()
+{
+    if (ui->actionNormalize_Track_Loudness->isChecked() && cBass->HasReplayGain()) {
+        ui->darkSeekBar->setWholeTrackPeak(1.0/cBass->GetLoudnessNormalizeFactor()); // scale the waveform (setWholeTrackPeak inverts this)
+    } else if (ui->actionNormalize_Track_Audio->isChecked()) {
+        ui->darkSeekBar->setWholeTrackPeak(cBass->GetWholeTrackPeak()); // scale the waveform
+    } else {
+        ui->darkSeekBar->setWholeTrackPeak(1.0); // disables waveform scaling
     }
 }
 
@@ -76,6 +76,7 @@
 #include <QWheelEvent>
 #include <QWidget>
 #include <QFileSystemWatcher>
+#include <QFutureWatcher>
 #include <QGraphicsScene>
 #include <QGraphicsItemGroup>
 #include <QDateTime>
@@ -99,9 +100,16 @@
 // #include "console.h"
 //#include "renderarea.h"
 #include "songsettings.h"
+#include "audiofingerprint.h"
+#include "songrecordstore.h"
+#include "songsearchindex.h"
+#include "cuesheetmatchindex.h"
+#include "cuesheetmetadatacache.h"
+#include "inotifywatcher.h"
 
 // Forward declaration for debug dialog
 class CuesheetMatchingDebugDialog;
+class DarkSongTitleDelegate;
 
 // Precomputed song/cuesheet info for Levels-column fuzzy matching (defined in mainwindow_cuesheets.cpp)
 struct LeveledCuesheet;
@@ -161,6 +169,28 @@ namespace Ui
 
 // Scans a cuesheet file for an "L:<levelName>" tag (see mainwindow_filemgmt.cpp for details).
 QString detectCuesheetLevel(const QString &absoluteFilePath);
+// The words in a cuesheet (HTML or plain text), for the full-text index.
+QString extractCuesheetText(const QString &absoluteFilePath);
+
+// One cuesheet (or MP3, for its USLT lyrics) looked at by refreshCuesheetTextIndexInBackground().
+//   text is only read if the file changed since it was last indexed.
+struct CuesheetTextFile {
+    QString path;           // absolute
+    qint64 size = 0;
+    qint64 mtime = 0;       // ms since the epoch
+    bool changed = false;
+    QString text;
+};
+
+// One cuesheet's level, as read by refreshCuesheetLevelsInBackground().  size and mtime are the
+//   file's as of just BEFORE it was read, so an edit made while it was being read makes the cached
+//   level stale, instead of being taken for the version that was read.
+struct CuesheetLevelResult {
+    QString path;           // absolute
+    QString level;
+    qint64 size = 0;
+    qint64 mtime = 0;       // ms since the epoch
+};
 
 class MainWindow : public QMainWindow
 {
@@ -358,9 +388,11 @@ public:
     void editTagsForPath(QString pathToMP3);                    // Path-based wrapper for playlists
     void changeTagForPath(QString pathToMP3, QString tag, bool add);  // Path-based wrapper for playlists
     void removeAllTagsForPath(QString pathToMP3);               // Path-based wrapper for playlists
-    void updateDarkSongTableRowForPath(QString pathToMP3);      // Helper to refresh darkSongTable
+    void updateDarkSongTableTitle(int row, const SongSetting &settings);  // title + tags, in the row's original color
     int MP3FileSampleRate(QString pathToMP3);
-    QString getSongFileIdentifier(QString pathToSong);
+    QString getSongFileIdentifier(QString pathToSong);          // bit-identical audio only
+    void updateFingerprintForCurrentSong(const QString &songTitle);  // adds to fingerprintIndex, and looks for a duplicate, in the background
+    void fingerprintMatchesFound();                             // ...then offers to adopt that duplicate's settings
 
     // ============================================================================
     // EMBEDDED SERVER & EXTERNAL INTEGRATIONS
@@ -424,7 +456,7 @@ public:
     // settingsCache: optional, and only for callers that build many rows in one go.  Without it,
     //   setTitleField() does one SQLite SELECT per row; that was 102 ms of the 131 ms spent
     //   loading a 511-row Track Filter into a palette slot.  Callers that have many rows to do
-    //   should fetch every song's settings up front with SongSettings::loadSettingsForAllSongs()
+    //   should fetch every song's settings up front with SongSettings::allSongSettings()
     //   and pass the result here, the way darkLoadMusicList() already does (issues #1669, #1695).
     //   Keys are music-root-relative paths, i.e. SongSettings::removeRootDirs() of the abs path.
     void setTitleField(QTableWidget *whichTable, int whichRow, QString fullPath,
@@ -434,7 +466,6 @@ public:
     bool isPlaylistMarker(const QString &filename);
     bool shouldIndentPlaylistRow(QTableWidget *table, int rowNum);
     void titleLabelDoubleClicked(QMouseEvent * /* event */);
-    void darkTitleLabelDoubleClicked(QMouseEvent * /* event */);
 #ifndef NO_TIMING_INFO
     void sdSequenceCallLabelDoubleClicked(QMouseEvent * /* event */);
 #endif
@@ -492,6 +523,10 @@ public slots:
     bool addItemsToPlaylistFile(const QString &playlistRelPath, const QList<SongDragInfo> &songs);
     void darkRevealInFinder();
     void refreshAllPlaylists();  // Issue #1547: refresh indentation after moves
+    void refreshPlaylistTitle(int slot, int row, const QHash<QString, SongSetting> &settingsCache);
+    void songSettingChanged(const QString &filenameWithPathNormalized, const SongSetting &changes);
+    void songSettingsChanged(const QStringList &filenamesWithPathNormalized, const SongSetting &changes);
+    void refreshAllSongTitles();  // every palette slot and darkSongTable title, e.g. after the tag colors change
 
     // ============================================================================
     // LYRICS & CUESHEET SLOTS
@@ -551,6 +586,7 @@ private slots:
     void on_actionFade_Out_triggered();
     void on_actionTest_Loop_triggered();
     void on_actionNormalize_Track_Audio_toggled(bool arg1);
+    void on_actionNormalize_Track_Loudness_toggled(bool arg1);
 
     // Dark mode audio controls
     void on_darkPlayButton_clicked();
@@ -837,6 +873,7 @@ private slots:
     void on_actionRemove_for_this_song_triggered();
     void on_actionRemove_for_all_songs_triggered();
     void on_actionUpdate_ID3_Tags_triggered();
+    void on_actionFind_Duplicate_Songs_triggered();
     void on_action0paletteSlots_triggered();
     void on_action1paletteSlots_triggered();
     void on_action2paletteSlots_triggered();
@@ -866,6 +903,8 @@ private slots:
     void fileWatcherTriggered();
     void fileWatcherDisabledTriggered();
     void musicRootModified(QString s);
+    void musicRootFilesChanged(const QStringList &added, const QStringList &removed);  // from the inotify watcher (Linux)
+    void musicRootWatcherOverflowed();
     void maybeLyricsChanged();
     void lockForEditing();
     void playlistSlotWatcherTriggered();
@@ -993,7 +1032,7 @@ private:
     QList<QString> getListOfMusicFiles();
     bool fuzzyMatchFilenameToCuesheetname(QString s1, QString s2);
     void downloadCuesheetFileIfNeeded(QString cuesheetFilename);
-    QString loadLyrics(QString MP3FileName);
+    static QString loadLyrics(QString MP3FileName);  // static: also called from the full-text indexer's threads
     int lyricsTabNumber;
     bool hasLyrics;
     QString txtToHTMLlyrics(QString text, QString filePathname);
@@ -1034,6 +1073,7 @@ private:
     int preferredWarningLabelFontSize;
     int preferredNowPlayingFontSize;
     QFont currentSongTableFont;
+    DarkSongTitleDelegate *darkSongTitleDelegate = nullptr;  // paints the darkSongTable Title column (no per-row QLabels)
     int iFontsize;
     int currentMacPointSize;
     int pointSizeToIndex(int pointSize);
@@ -1080,6 +1120,7 @@ private:
     QString override_filename;
     QString override_cuesheet;
     QString typeSearch, labelSearch, titleSearch;
+    QString textSearch;     // "words: search inside cuesheets and lyrics (see findSongsByIndexedText())
     bool searchAllFields;
     QString currentMP3filename;
     QString currentMP3filenameWithPath;
@@ -1101,6 +1142,7 @@ private:
     double id3LoopEnd_sec = 0.0;
     bool snapDefaultLoopPointsToBars = false;  // #1604: first-time patter load: snap guessed loop points to bars when beatMap arrives
     QColor colorForLoopPoint(double time_sec);  // #1604: classify one loop point --> bracket color
+    double positionAfterBeats(double position_sec, double beats);  // follows the song's local tempo, if it's known
     uint32_t currentSongID;
 
     QTableWidget *currentSongPlaylistTable;
@@ -1118,6 +1160,7 @@ private:
     void loadGlobalSettingsForSong(QString songTitle);
     void randomizeFlashCall();
     QString filepath2SongCategoryName(QString MP3Filename);
+    QString folder2SongCategoryName(const QString &folderTypename);  // folderTypename must already be lowercase
     int getRsyncFileCount(QString sourceDir, QString destDir);
 
     // ID3 tag operations
@@ -1130,6 +1173,7 @@ private:
     void reloadCurrentMP3File();
     void loadMP3File(QString filepath, QString songTitle, QString songCategory, QString songLabel, QString nextFilename="");
     void secondHalfOfLoad(QString songTitle);
+    void updateWaveformNormalizationScale();
     void maybeLoadCSSfileIntoTextBrowser(bool useSquareDeskCSS);
     void maybeLoadCuesheets(const QString &MP3FileName, const QString cuesheetFilename);
     void loadCuesheet(const QString cuesheetFilename);
@@ -1140,6 +1184,7 @@ private:
                                 QString &title, QString &shortTitle);
     int MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit *debugOut = nullptr);
     void computeSongLevels();
+    void computeSongLevelsForSongs(const QStringList &origPaths);
     QString songLevelsCacheFilename();
     QString songLevelsCacheFingerprint();
     bool loadSongLevelsCacheIfValid();
@@ -1150,12 +1195,16 @@ private:
                                         const QString &oldLevelName, const QString &newLevelName);
     SongMatchInfo makeSongMatchInfo(const QString &origPath);
     bool cuesheetMatchesSong(const SongMatchInfo &song, const LeveledCuesheet &cuesheet);
+    void ensureCuesheetMatchIndex();
 
     // Music library management
     void initializeMusicRootWatcher();
     bool findMusic(QString mainRootDir, bool refreshDatabase, bool forceRescan = false); // returns true iff a full scan ran (false = pathStack cache hit, nothing changed on disk)
     bool loadPathStackCacheIfValid();
-    void savePathStackCache();
+    void savePathStackCache();         // walks and fingerprints every directory, then writes the cache
+    void writePathStackCache();        // writes the cache from memory (pathStackCacheDirs + the pathStacks)
+    void updatePathStackCacheForPaths(const QStringList &changedPaths, bool entriesChanged);
+    QHash<QString, QString> pathStackCacheDirs; // the cache's D records: relative dir path ("" = music root) -> fingerprint
 
     // Unclean-startup detection (Issue #1685): a breadcrumb file that exists only while
     //   the MainWindow constructor is running. If it's still there at the next launch, the
@@ -1165,13 +1214,36 @@ private:
     void beginStartupBreadcrumb();  // call once, as early in startup as musicRootPath allows
     void endStartupBreadcrumb();    // call once, when the MainWindow is fully constructed
     void addFilesToPathStacks(const QStringList &copiedFilePaths); // incremental import, no full rescan needed (Issue #1664)
+    void updatePathStacksIncrementally(const QStringList &copiedFilePaths, const QStringList &removedPaths);
     void importFilesFromFinder(const QStringList &droppedPaths);   // deferred from dropEvent so the Finder drag session can finish first (Issue #1664)
     void updateTreeWidget();
+    void updateTreeWidgetTracks();             // just the Tracks > <type> nodes, from trackTypeCounts
+    void countTrackType(const QString &pathStackEntry, int delta);
+    QMap<QString, int> trackTypeCounts;        // type (top level folder) -> number of pathStack songs of that type
+    bool trackTypeCountsValid = false;         // cleared when the pathStack is reloaded; deltas keep it up to date otherwise
+    struct PlaylistFileEntries {
+        qint64 size;
+        qint64 mtime;
+        QStringList entries;                   // the pathStackPlaylists entries made from this file
+    };
+    QHash<QString, PlaylistFileEntries> playlistFileCache;  // playlist name -> parsed .csv, so only changed playlists are re-read
+    QStringList readPlaylistEntries(const QString &fileName);
     void filterMusic();
     void loadMusicList();
     void darkFilterMusic();
+    void rebuildDarkSongSearchIndex();
+    SongSearchIndex darkSongSearchIndex;       // type-ahead index of the darkSongTable rows, used by darkFilterMusic
+    bool darkSongSearchIndexDirty = true;      // set when rows are reloaded or retagged
     void darkLoadMusicList(QList<QString> *aPathStack, QString typeFilter, bool forceTypeFilter, bool reloadPaletteSlots, bool suppressSelectionChange = false);
+    bool setDarkSongTableRow(int row, SongRecord &rec,
+                             const QHash<QString, SongSetting> &settingsByFilename,
+                             const QHash<QString, QString> &agesByFilename,
+                             const QIcon &auditionIcon,
+                             QHash<QString, bool> &dirIsMusicRoot);
+    void sortDarkSongTable();          // by the user's saved sort order (or the default one)
+    void reloadTracksPaletteSlots();   // the palette slots showing a /tracks playlist, whose songs may have come or gone
     QString FormatTitlePlusTags(const QString &title, bool setTags, const QString &strtags, QString titleColor = "");
+    void setTitleColText(MyTableWidget *songTable, int row, const QString &titlePlusTags);
     void changeTagOnCurrentSongSelection(QString tag, bool add);
     void darkChangeTagOnPathToMP3(QString pathToMP3, QString tag, bool add);  // add/remove tag on specific song
     void darkChangeTagOnCurrentSongSelection(QString tag, bool add);
@@ -1188,6 +1260,12 @@ private:
     // FILE SYSTEM WATCHING & MONITORING
     // ============================================================================
     QFileSystemWatcher musicRootWatcher;
+    InotifyMusicWatcher *inotifyMusicWatcher = nullptr; // used INSTEAD of musicRootWatcher where supported (Linux)
+    QStringList pendingAddedMusicFiles;    // inotify deltas, collected during the 2s FileWatcher debounce
+    QStringList pendingRemovedMusicFiles;
+    bool pendingMusicFilesOverflowed = false;  // deltas were lost, so the next wakeup must do a real rescan
+    bool musicRootWatcherIsActive();
+    void stopMusicRootWatcher();
     QFileSystemWatcher lyricsWatcher;
     QFileSystemWatcher abbrevsWatcher;
     QFileSystemWatcher *fileWatcher;
@@ -1212,9 +1290,23 @@ private:
     // PATH MANAGEMENT & SONG TYPES
     // ============================================================================
     QList<QString> *pathStack;
+    SongRecordStore songRecords;  // pathStack entries, split once (see darkLoadMusicList)
+    void ensureSongRecordParts(SongRecord &rec);
+    QHash<QString, FilenameParts> filenamePartsCache;  // filename -> breakFilenameIntoParts() results, for filenamePartsCacheFormat
+    int filenamePartsCacheFormat = -1;
     QList<QString> *pathStackCuesheets;
     QHash<QString, QString> songLevelsByPath; // origPath -> up to 4-char "Levels" string (M/P/A/C), computed by computeSongLevels()
     bool songLevelsComputed = false; // true once computeSongLevels() has run this session; avoids recomputing every time Levels is toggled on
+    CuesheetMatchIndex cuesheetMatchIndex;  // pathStackCuesheets, indexed for cuesheet/song matching (see ensureCuesheetMatchIndex)
+    CuesheetMetadataCache cuesheetMetadata; // what detectCuesheetLevel() found in each cuesheet, across runs
+    QFutureWatcher<CuesheetLevelResult> cuesheetLevelWatcher;  // results of refreshCuesheetLevelsInBackground()
+    void refreshCuesheetLevelsInBackground(const QStringList &paths);
+    void cuesheetLevelsRefreshed();
+    QFutureWatcher<CuesheetTextFile> cuesheetTextWatcher;  // results of refreshCuesheetTextIndexInBackground()
+    void refreshCuesheetTextIndexInBackground();
+    void cuesheetTextIndexRefreshed();
+    void findSongsByIndexedText(const QString &words, QSet<QString> &songPaths, QSet<QString> &songBaseNames);
+    bool cuesheetMatchIndexDirty = true;    // set when pathStackCuesheets is reloaded; single-cuesheet changes update the index in place
     QList<QString> *pathStackPlaylists;
     QList<QString> *pathStackNewApplePlaylists;
     QList<QString> *pathStackApplePlaylists;
@@ -1292,6 +1384,11 @@ private:
     // SETTINGS & SESSION MANAGEMENT
     // ============================================================================
     SongSettings songSettings;
+    FingerprintIndex fingerprintIndex;  // acoustic fingerprints of analyzed songs, for finding duplicates
+    QFutureWatcher<QStringList> fingerprintWatcher;  // other files of the same recording as fingerprintWatcherPath, best first
+    QString fingerprintWatcherPath;     // ...the song that updateFingerprintForCurrentSong() is looking at
+    QString fingerprintWatcherFilename; //    (and its currentMP3filename...
+    QString fingerprintWatcherTitle;    //    ...and title, as given to secondHalfOfLoad())
     PreferencesManager prefsManager;
     int lastMinuteInHour;
     int lastSessionID;
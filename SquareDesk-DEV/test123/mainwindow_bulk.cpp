@@ -171,6 +171,13 @@ int MainWindow::processOneFile(const QString &fn) {
 
     // NOW: first info.samples/2 float's are the mono data
 
+    // FINGERPRINT, while we have the audio in memory anyway (for Find Duplicate Songs) -----------
+    //   (only then: a file that already has its results is not decoded again just for this, it gets
+    //   fingerprinted the next time it's loaded)
+    if (!fingerprintIndex.isUpToDate(fn)) {
+        fingerprintIndex.add(fn, AudioFingerprint::compute(info.buffer, info.samples/info.channels, 1, info.hz));  // thread-safe
+    }
+
     // TODO: filter LPF1500
     // // LOW PASS FILTER IT, TO ELIMINATE THE CHUCK of BOOM-CHUCK -------------------------------------
     // biquad_params<float> bq[1];
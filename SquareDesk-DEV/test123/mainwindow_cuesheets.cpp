@@ -31,11 +31,18 @@
 #pragma clang diagnostic ignored "-Welaborated-enum-base"
 #include "mainwindow.h"
 #include "cuesheetmatchingdebugdialog.h"
+#include "editdistance.h"
+#include "filenameparser.h"
 #pragma clang diagnostic pop
 
 #include "ui_mainwindow.h"
 #include "utility.h"
 #include <QCryptographicHash>
+#ifdef Q_OS_LINUX
+#include <QtConcurrent/QtConcurrent>
+#else
+#include <QtConcurrent>
+#endif
 #include <QGraphicsItemGroup>
 #include <QGraphicsTextItem>
 #include <QCoreApplication>
@@ -63,71 +70,6 @@
 #include <taglib/mpeg/id3v2/frames/textidentificationframe.h>
 using namespace TagLib;
 
-struct FilenameMatchers {
-    QRegularExpression regex;
-    int title_match;
-    int label_match;
-    int number_match;
-    int additional_label_match;
-    int additional_title_match;
-};
-
-struct FilenameMatchers *getFilenameMatchersForType(enum SongFilenameMatchingType songFilenameFormat)
-{
-    static struct FilenameMatchers best_guess_matches[] = {
-        { QRegularExpression("^([A-Za-z]{1,9})[\\- ]?(\\d{3,5}[A-Za-z]{0,3})\\s*-\\s*(.*[^0-9]\\d{1,2})$"), 3, 1, 2, -1, -1}, // e.g. "ARROW 946 - Studio 54.mp3"
-                                                                                                            // ambiguity breaker: LABEL + 3-5 digit number on the left,
-                                                                                                            //   title ending in a 1-2 digit number on the right (numbers
-                                                                                                            //   in titles are short; label numbers are 3+ digits)
-        { QRegularExpression("^(.*) - ([A-Za-z]{1,9})[\\- ]?([0-9]{1,5}[A-Za-z]{0,3})$"), 1, 2, 3, -1, -1}, // e.g. "Play It Cool - BS 2534a.mp3"
-                                                                                                            // e.g. "Strings Galore - Chaparral 117b.mp3"
-        { QRegularExpression("^([Oo][Gg][Rr][Mm][Pp]3\\s*\\d{1,5})\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },    // e.g. "OGRMP3 04 - Addam's Family.mp3"
-        { QRegularExpression("^(4-[Bb][Aa][Rr]-[Bb]\\s*\\d{1,5})\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },    // e.g. "4-bar-b 123 - Chicken Plucker"
-        { QRegularExpression("^(.*) - ([A-Za-z]+[\\- ]\\d+)( *-?[VMA-C]|\\-\\d+)?$"), 1, 2, -1, 3, -1 },
-        { QRegularExpression("^([A-Za-z]+[\\- ]\\d+)(-?[VvMA-C]?) - (.*)$"), 3, 1, -1, 2, -1 },
-        { QRegularExpression("^([A-Za-z]+ ?\\d+)([MVmv]?)[ -]+(.*)$/"), 3, 1, -1, 2, -1 },
-        { QRegularExpression("^([A-Za-z]?[0-9][A-Z]+[\\- ]?\\d+)([MVmv]?)[ -]+(.*)$"), 3, 1, -1, 2, -1 },
-        { QRegularExpression("^(.*) - ([A-Za-z]{1,5}+)[\\- ](\\d+)( .*)?$"), 1, 2, 3, -1, 4 },
-        { QRegularExpression("^([A-Za-z]+ ?\\d+)([ABab])?[ -]+(.*)$/"), 3, 1, -1, 2, -1 },
-        { QRegularExpression("^([A-Za-z]+\\-\\d+)\\-(.*)/"), 2, 1, -1, -1, -1 },
-//    { QRegularExpression("^(\\d+) - (.*)$"), 2, -1, -1, -1, -1 },         // first -1 prematurely ended the search (typo?)
-//    { QRegularExpression("^(\\d+\\.)(.*)$"), 2, -1, -1, -1, -1 },         // first -1 prematurely ended the search (typo?)
-        { QRegularExpression("^(\\d+)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },  // e.g. "123 - Chicken Plucker"
-        { QRegularExpression("^(\\d+\\.)(.*)$"), 2, 1, -1, -1, -1 },            // e.g. "123.Chicken Plucker"
-//        { QRegularExpression("^(.*?) - (.*)$"), 2, 1, -1, -1, -1 },           // ? is a non-greedy match (So that "A - B - C", first group only matches "A")
-        { QRegularExpression("^([A-Za-z]{1,5}+[\\- ]*\\d+[A-Za-z]*)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 }, // e.g. "ABC 123-Chicken Plucker"
-        { QRegularExpression("^([A-Za-z]{1,5}+[\\- ]*\\d+[A-Za-z0-9]*)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 }, // e.g. "ABC 123h1-Chicken Plucker"
-        { QRegularExpression("^([A-Za-z0-9]{1,5}+)\\s*(\\d+)([A-Za-z]{1,2})?\\s*-\\s*(.*?)\\s*(\\(.*\\))?$"), 4, 1, 2, 3, 5 }, // SIR 705b - Papa Was A Rollin Stone (Instrumental).mp3
-        { QRegularExpression("^([A-Za-z0-9]{1,5}+)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },    // e.g. "POP - Chicken Plucker" (if it has a dash but fails all other tests,
-        { QRegularExpression("^(.*?)\\s*\\-\\s*([A-Za-z]{1,5})(\\d{1,5})\\s*(\\(.*\\))?$"), 1, 2, 3, -1, 4 },    // e.g. "A Summer Song - CHIC3002 (female vocals)
-        { QRegularExpression("^(.*?)\\s*\\-\\s*([A-Za-z]{1,7}|4-[Bb][Aa][Rr]-[Bb])-(\\d{1,5})(\\-?([ABab]))?$"), 1, 2, 3, 5, -1 },    // e.g. "Paper Doll - Windsor-4936B"
-        { QRegularExpression("^(.*?)\\s*\\-\\s*([A-Za-z]{1,7}|4-[Bb][Aa][Rr]-[Bb]) (\\d{1,5})(\\-?([ABab]))?$"), 1, 2, 3, 5, -1 },    // e.g. "Paper Doll - Windsor 4936B"
-        { QRegularExpression("^(.*)\\s*\\-\\s*([A-Za-z ]+)\\s*([0-9]{1,5}[A-Za-z]{0,3})$"), 1, 2, 3, -1, -1}, // e.g. "Streets of London - New Beat 203a.mp3"
-
-        { QRegularExpression(), -1, -1, -1, -1, -1 }
-    };
-    static struct FilenameMatchers label_first_matches[] = {
-        { QRegularExpression("^(.*)\\s*-\\s*(.*)$"), 2, 1, -1, -1, -1 },    // e.g. "ABC123X - Chicken Plucker"
-        { QRegularExpression(), -1, -1, -1, -1, -1 }
-    };
-    static struct FilenameMatchers filename_first_matches[] = {
-        { QRegularExpression("^(.*)\\s*-\\s*(.*)$"), 1, 2, -1, -1, -1 },    // e.g. "Chicken Plucker - ABC123X"
-        { QRegularExpression(), -1, -1, -1, -1, -1 }
-    };
-
-    switch (songFilenameFormat) {
-        case SongFilenameNameDashLabel :
-            return filename_first_matches;
-        case SongFilenameBestGuess :
-            return best_guess_matches;
-        case SongFilenameLabelDashName :
-//        default:  // all the cases are covered already (default is not needed here)
-            return label_first_matches;
-    }
-    // Shut up the warnings, all the returns happen in the switch above
-    return label_first_matches;
-}
-
 // Public wrapper for filename parsing
 bool MainWindow::parseFilenameIntoParts(const QString &s,
                                         QString &label, QString &labelnum,
@@ -137,102 +79,47 @@ bool MainWindow::parseFilenameIntoParts(const QString &s,
     return breakFilenameIntoParts(s, label, labelnum, labelnum_extra, title, shortTitle);
 }
 
+// The same filenames get parsed over and over (song table loads, playlist loads, cuesheet
+//   matching), and running the regex cascade (parseSongFilename()) is by far the most expensive part of that,
+//   so results are remembered per filename (for the current filename format pref). Only calls
+//   that pass in all-empty parts are answered from the cache: the parser leaves some
+//   parts untouched when they don't match, so a caller that passes in non-empty ones can see
+//   a different answer.
 bool MainWindow::breakFilenameIntoParts(const QString &s,
                                         QString &label, QString &labelnum,
                                         QString &labelnum_extra,
                                         QString &title, QString &shortTitle )
 {
-    // DDD(s)
-    bool foundParts = true;
-    int match_num = 0;
-    struct FilenameMatchers *matches = getFilenameMatchersForType(songFilenameFormat);
-
-    // special pre-processing for labels with dashes in their names
-    QString s2 = s;
-
-    static QRegularExpression regex1("(4-[Bb][Aa][Rr]-[Bb])");              // 4-Bar-B
-    static QRegularExpression regex2("([Cc][Ii][Rr][Cc][Ll][Ee]-[Dd])");    // Circle-D
-    static QRegularExpression regex3("([Jj][Aa][Yy]-[Bb][Aa][Rr]-[Kk][Aa][Yy])");  // Jay-Bar-Kay
-
-    QRegularExpressionMatch m1;
-    if (s2.contains(regex1, &m1)) {
-        // qDebug() << "MATCH 1: " << m1 << m1.captured(1);
-        s2.replace(m1.captured(1), "FOURBARB");
-    }
-
-    QRegularExpressionMatch m2;
-    if (s2.contains(regex2, &m2)) {
-        // qDebug() << "MATCH 2: " << m2 << m2.captured(1);
-        s2.replace(m2.captured(1), "CIRCLED");
-    }
-
-    QRegularExpressionMatch m3;
-    if (s2.contains(regex3, &m3)) {
-        // qDebug() << "MATCH 3: " << m3 << m3.captured(1);
-        s2.replace(m3.captured(1), "JAYBARKAY");
-    }
-
-    for (match_num = 0;
-         matches[match_num].label_match >= 0
-             && matches[match_num].title_match >= 0;
-         ++match_num) {
-        QRegularExpressionMatch match = matches[match_num].regex.match(s2);
-        if (match.hasMatch()) {
-            if (matches[match_num].label_match >= 0) {
-                label = match.captured(matches[match_num].label_match);
-                label.replace("FOURBARB", m1.captured(1)); // keep original capitalization
-                label.replace("CIRCLED",  m2.captured(1)); // keep original capitalization
-                label.replace("JAYBARKAY", m3.captured(1)); // keep original capitalization
-            }
-            if (matches[match_num].title_match >= 0) {
-                title = match.captured(matches[match_num].title_match);
-                shortTitle = title;
-            }
-            if (matches[match_num].number_match >= 0) {
-                labelnum = match.captured(matches[match_num].number_match);
-            }
-            if (matches[match_num].additional_label_match >= 0) {
-                labelnum_extra = match.captured(matches[match_num].additional_label_match);
-            }
-            if (matches[match_num].additional_title_match >= 0
-                && !match.captured(matches[match_num].additional_title_match).isEmpty()) {
-                title += " " + match.captured(matches[match_num].additional_title_match);
-            }
-            break;
-        } else {
-//                qDebug() << s << "didn't match" << matches[match_num].regex;
+    bool cacheable = label.isEmpty() && labelnum.isEmpty() && labelnum_extra.isEmpty() &&
+                     title.isEmpty() && shortTitle.isEmpty();
+    if (cacheable) {
+        if (filenamePartsCacheFormat != static_cast<int>(songFilenameFormat)) {
+            filenamePartsCache.clear();  // format pref changed, so every filename parses differently now
+            filenamePartsCacheFormat = static_cast<int>(songFilenameFormat);
+        }
+        auto cached = filenamePartsCache.constFind(s);
+        if (cached != filenamePartsCache.constEnd()) {
+            label = cached->label;
+            labelnum = cached->labelnum;
+            labelnum_extra = cached->labelnum_extra;
+            title = cached->title;
+            shortTitle = cached->shortTitle;
+            return cached->foundParts;
         }
-    }
-    if (!(matches[match_num].label_match >= 0
-          && matches[match_num].title_match >= 0)) {
-        label = "";
-        title = s;
-        foundParts = false;
     }
 
-    label = label.simplified();
+    bool foundParts = parseSongFilename(s, songFilenameFormat, label, labelnum, labelnum_extra, title, shortTitle);
 
-    if (labelnum.length() == 0)
-    {
-        static QRegularExpression regexLabelPlusNum = QRegularExpression("^(\\w+)[\\- ](\\d+)(\\w?)$");
-        QRegularExpressionMatch match = regexLabelPlusNum.match(label);
-        if (match.hasMatch())
-        {
-            label = match.captured(1);
-            labelnum = match.captured(2);
-            if (labelnum_extra.length() == 0)
-            {
-                labelnum_extra = match.captured(3);
-            }
-            else
-            {
-                labelnum = labelnum + match.captured(3);
-            }
-        }
+    if (cacheable) {
+        FilenameParts parts;
+        parts.foundParts = foundParts;
+        parts.label = label;
+        parts.labelnum = labelnum;
+        parts.labelnum_extra = labelnum_extra;
+        parts.title = title;
+        parts.shortTitle = shortTitle;
+        filenamePartsCache.insert(s, parts);
     }
-    labelnum = labelnum.simplified();
-    title = title.simplified();
-    shortTitle = shortTitle.simplified();
 
     return foundParts;
 }
@@ -380,42 +267,9 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
         debugOut->append("--- Starting MP3 vs Cuesheet scoring analysis ---");
     }
     
-    // Helper function to calculate Levenshtein distance
-    auto levenshteinDistance = [](const QString &s1, const QString &s2) -> int {
-        const int len1 = s1.size();
-        const int len2 = s2.size();
-        
-        QVector<QVector<int>> d(len1 + 1, QVector<int>(len2 + 1));
-        
-        for (int i = 0; i <= len1; i++)
-            d[i][0] = i;
-            
-        for (int j = 0; j <= len2; j++)
-            d[0][j] = j;
-            
-        for (int i = 1; i <= len1; i++) {
-            for (int j = 1; j <= len2; j++) {
-                int cost = (s1[i-1].toLower() == s2[j-1].toLower()) ? 0 : 1;
-                
-                d[i][j] = qMin(qMin(
-                    d[i-1][j] + 1,     // deletion
-                    d[i][j-1] + 1),    // insertion
-                    d[i-1][j-1] + cost // substitution
-                );
-                
-                // Check for transposition (adjacent character swap)
-                if (i > 1 && j > 1 && 
-                    s1[i-1].toLower() == s2[j-2].toLower() && 
-                    s1[i-2].toLower() == s2[j-1].toLower()) {
-                    d[i][j] = qMin(d[i][j], d[i-2][j-2] + cost);
-                }
-            }
-        }
-        return d[len1][len2];
-    };
-    
     // Helper function to check if words are "fuzzy equal"
-    auto fuzzyWordEqual = [levenshteinDistance](const QString &w1, const QString &w2) -> bool {
+    //   (w1 is always the song's word: its EditDistance is built once, and reused for every cuesheet)
+    auto fuzzyWordEqual = [](const QString &w1, const QString &w2) -> bool {
         // First check exact match
         if (w1.compare(w2, Qt::CaseInsensitive) == 0)
             return true;
@@ -425,25 +279,8 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
         if (qAbs(lenDiff) > 1)
             return false;
             
-        // Check for transposed letters
-        if (w1.length() == w2.length() && w1.length() >= 2) {
-            for (int i = 0; i < w1.length() - 1; i++) {
-                QString transposed = w1;
-                // Swap adjacent characters
-                QChar temp = transposed[i];
-                transposed[i] = transposed[i+1];
-                transposed[i+1] = temp;
-                
-                if (transposed.compare(w2, Qt::CaseInsensitive) == 0)
-                    return true;
-            }
-        }
-        
-        // Calculate Levenshtein distance
-        int distance = levenshteinDistance(w1, w2);
-        
-        // Allow 1 edit (character changed, added, or removed)
-        return distance <= 1;
+        // Allow 1 edit (character changed, added, or removed, or two adjacent letters transposed)
+        return EditDistance::forPattern(w1).distance(w2) <= 1;
     };
 
     // Helper function to check if two labels are "fuzzy equal", using the labelName <-> labelID map
@@ -482,10 +319,14 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
         return filtered;
     };
     
+    // NOTE: every QRegularExpression in here is static, because this runs for many cuesheets per song
+    //   load, and compiling the same patterns over again every time was a large part of its cost
+    static const QRegularExpression whitespace("\\s+");
+
     // Step 1: Preprocess both filenames
     // Remove text in parentheses
     auto removeParentheses = [](QString str) {
-        QRegularExpression regex("\\([^()]*\\)");
+        static const QRegularExpression regex("\\([^()]*\\)");
         QRegularExpressionMatch match;
         while ((match = regex.match(str)).hasMatch()) {
             str.remove(match.capturedStart(), match.capturedLength());
@@ -516,7 +357,7 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
     // Step 1c. I like to use cuesheet filenames like "Blue.2.html"
     //   this removes the .2 part, for matching purposes
     QString beforeDotRemoval = cuesheetName;
-    QRegularExpression dotNumAtEnd("\\.[0-9]?$");
+    static const QRegularExpression dotNumAtEnd("\\.[0-9]?$");
     cuesheetName.replace(dotNumAtEnd, ""); // THIS IS NOT WORKING HERE
     
     if (debugOut != nullptr && beforeDotRemoval != cuesheetName) {
@@ -526,7 +367,7 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
     // Step 1d. Special processing for New Beat's use of double dashes.
     //   e.g. "Only You - NB-303"
     QString beforeNewBeatProcessing = cuesheetName;
-    QRegularExpression NewBeatAndNumber("NB-([0-9]?)");
+    static const QRegularExpression NewBeatAndNumber("NB-([0-9]?)");
 
     // do cuesheet
     cuesheetName.replace(NewBeatAndNumber, "NB \\1");
@@ -568,8 +409,8 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
     }
     
     // Step 3: Split filenames into words for comparison and filter short words
-    QStringList mp3AllWords = mp3Name.split(QRegularExpression("\\s+"));
-    QStringList cuesheetAllWords = cuesheetName.split(QRegularExpression("\\s+"));
+    QStringList mp3AllWords = mp3Name.split(whitespace);
+    QStringList cuesheetAllWords = cuesheetName.split(whitespace);
     
     QStringList mp3Words = filterShortWords(mp3AllWords);
     QStringList cuesheetWords = filterShortWords(cuesheetAllWords);
@@ -629,7 +470,7 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
     mp3Index = 0;
     cuesheetIndex = 0;
     while (cuesheetIndex < cuesheetWords.size() && mp3Index < mp3Words.size()) {
-        if (fuzzyWordEqual(cuesheetWords[cuesheetIndex], mp3Words[mp3Index])) {
+        if (fuzzyWordEqual(mp3Words[mp3Index], cuesheetWords[cuesheetIndex])) {
             cuesheetIndex++;
             mp3Index++;
         } else {
@@ -674,11 +515,11 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
         ParsedName result;
 
         // Try standard format: LABEL NUM[EXTRA] - TITLE
-        QRegularExpression stdFormat("^([A-Za-z ]{1,20})\\s*([0-9]{1,5})([A-Za-z]{0,4})?\\s*-\\s*(.+)$",
+        static const QRegularExpression stdFormat("^([A-Za-z ]{1,20})\\s*([0-9]{1,5})([A-Za-z]{0,4})?\\s*-\\s*(.+)$",
                                     QRegularExpression::CaseInsensitiveOption);
         
         // Try reversed format: TITLE - LABEL NUM[EXTRA]
-        QRegularExpression revFormat("^(.+)\\s*-\\s*([A-Za-z ]{1,20})\\s*([0-9]{1,5})([A-Za-z]{0,4})?$",
+        static const QRegularExpression revFormat("^(.+)\\s*-\\s*([A-Za-z ]{1,20})\\s*([0-9]{1,5})([A-Za-z]{0,4})?$",
                                     QRegularExpression::CaseInsensitiveOption);
         
         QRegularExpressionMatch match = stdFormat.match(name);
@@ -798,8 +639,8 @@ int MainWindow::MP3FilenameVsCuesheetnameScore(QString fn, QString cn, QTextEdit
     }
     
     // Step 7: Calculate longest common sequence of words in title
-    QStringList mp3TitleAllWords = mp3Parsed.title.split(QRegularExpression("\\s+"));
-    QStringList cuesheetTitleAllWords = cuesheetParsed.title.split(QRegularExpression("\\s+"));
+    QStringList mp3TitleAllWords = mp3Parsed.title.split(whitespace);
+    QStringList cuesheetTitleAllWords = cuesheetParsed.title.split(whitespace);
     
     // Filter short words
     QStringList mp3TitleWords = filterShortWords(mp3TitleAllWords);
@@ -907,31 +748,6 @@ static QChar levelNameToCategory(const QString &levelName) {
     return QChar();
 }
 
-// Extracts the first 1-5 digit run from a filename (e.g. "426" from "RIV 426 - Lion
-// Sleeps Tonight"), normalized as an int (so leading zeros don't matter), for use as
-// a cheap pre-filter before calling the much more expensive
-// MP3FilenameVsCuesheetnameScore(). Returns -1 if no digit run is found.
-static int quickExtractCatalogNumber(const QString &completeBaseName) {
-    static const QRegularExpression numRegex("\\d{1,5}");
-    QRegularExpressionMatch match = numRegex.match(completeBaseName);
-    if (!match.hasMatch()) {
-        return -1;
-    }
-    return match.captured(0).toInt();
-}
-
-// Cheap (non-fuzzy) word set for a filename, used only to decide whether the
-// expensive scorer is worth calling -- see computeSongLevels().
-static QSet<QString> quickWordSet(const QString &completeBaseName) {
-    QSet<QString> words;
-    for (const QString &w : completeBaseName.split(QRegularExpression("[^A-Za-z0-9]+"), Qt::SkipEmptyParts)) {
-        if (w.length() > 2) {
-            words.insert(w.toLower());
-        }
-    }
-    return words;
-}
-
 // Everything the match predicate needs to know about one leveled cuesheet,
 // precomputed once so repeated matching stays cheap.
 struct LeveledCuesheet {
@@ -946,7 +762,12 @@ struct LeveledCuesheet {
 static LeveledCuesheet makeLeveledCuesheet(const QString &type, const QString &absoluteFilePath, QChar category) {
     QString completeBaseName = QFileInfo(absoluteFilePath).completeBaseName();
     return {absoluteFilePath, completeBaseName, type, category,
-            quickExtractCatalogNumber(completeBaseName), quickWordSet(completeBaseName)};
+            CuesheetMatchIndex::extractCatalogNumber(completeBaseName), CuesheetMatchIndex::wordSet(completeBaseName)};
+}
+
+// same thing, from an entry that's already in the cuesheetMatchIndex
+static LeveledCuesheet makeLeveledCuesheet(const CuesheetMatchIndex::Entry &e, QChar category) {
+    return {e.absoluteFilePath, e.completeBaseName, e.type, category, e.catalogNumber, e.words};
 }
 
 // Same idea, for the song side of the comparison.
@@ -962,7 +783,7 @@ SongMatchInfo MainWindow::makeSongMatchInfo(const QString &origPath) {
     QString completeBaseName = QFileInfo(origPath).completeBaseName();
     bool isPatter = (filepath2SongCategoryName(origPath) == "patter");
     return {origPath, isPatter, completeBaseName,
-            quickExtractCatalogNumber(completeBaseName), quickWordSet(completeBaseName)};
+            CuesheetMatchIndex::extractCatalogNumber(completeBaseName), CuesheetMatchIndex::wordSet(completeBaseName)};
 }
 
 // Single source of truth for "does this cuesheet fuzzy-match this song?", shared by
@@ -972,9 +793,13 @@ SongMatchInfo MainWindow::makeSongMatchInfo(const QString &origPath) {
 // match: if both names have a parseable catalog number and they differ, AND the
 // names don't share even one word in common, there's no way the full fuzzy scorer's
 // containment or label+number paths could succeed, so the expensive comparison is
-// skipped. Sharing a word is enough to fall through to the full scorer, so this
-// can't drop any real match (the scorer's title-containment path itself requires
-// the names to share words).
+// skipped. NOTE: this is a heuristic, not an exact bound: "share a word" here means
+// the exact same word, but the scorer's fuzzyWordEqual() also accepts words one edit
+// apart (and falls back to 1-2 character words), so a few fuzzy-only matches with
+// different catalog numbers are dropped. That's accepted for the song-levels pass,
+// where every song meets every leveled cuesheet. The cuesheetMatchIndex applies this
+// same pre-filter to the whole library at once, so that pass only loops over its
+// candidates(); betterFindPossibleCuesheets() scores every cuesheet instead.
 bool MainWindow::cuesheetMatchesSong(const SongMatchInfo &song, const LeveledCuesheet &cuesheet) {
     if (song.isPatter && cuesheet.type == "lyrics") {
         // if it's a patter MP3, don't match it against anything in the lyrics folder
@@ -987,6 +812,19 @@ bool MainWindow::cuesheetMatchesSong(const SongMatchInfo &song, const LeveledCue
     return MP3FilenameVsCuesheetnameScore(song.completeBaseName, cuesheet.completeBaseName) > 0;
 }
 
+// (Re)builds the cuesheetMatchIndex from pathStackCuesheets, iff the library was reloaded since
+// it was last built. Cheap (no file I/O, no scoring), but only done once per library load.
+void MainWindow::ensureCuesheetMatchIndex() {
+    if (!cuesheetMatchIndexDirty) {
+        return;
+    }
+    PerfTimer t("ensureCuesheetMatchIndex", __LINE__);
+    t.start(__LINE__);
+    cuesheetMatchIndex.rebuild(*pathStackCuesheets);
+    cuesheetMatchIndexDirty = false;
+    t.elapsed(__LINE__);
+}
+
 // Returns the categories present in levelsFound, in the canonical "SMPAC" order.
 static QString orderCategories(const QString &levelsFound) {
     QString orderedLevels;
@@ -1119,39 +957,62 @@ void MainWindow::computeSongLevels() {
 
     songLevelsByPath.clear();
 
-    QList<LeveledCuesheet> leveledCuesheets;
+    QStringList origPaths;
+    origPaths.reserve(pathStack->size());
+    for (const QString &s : *pathStack) {
+        qsizetype sep = s.indexOf("#!#");
+        if (sep >= 0) {
+            origPaths.append(s.mid(sep + 3));
+        }
+    }
+    computeSongLevelsForSongs(origPaths);
 
-    for (const QString &s : *pathStackCuesheets) {
-        QStringList parts = s.split("#!#");
-        if (parts.size() < 3 || parts[2].isEmpty()) {
+    saveSongLevelsCache();
+}
+
+// The part of computeSongLevels() that does the matching, for just these songs (their old
+// songLevelsByPath entries are replaced). Also used on its own for songs that were just added
+// to the music directory, which is why it neither loads nor saves the cache.
+void MainWindow::computeSongLevelsForSongs(const QStringList &origPaths) {
+    for (const QString &origPath : origPaths) {
+        songLevelsByPath.remove(origPath);
+    }
+
+    ensureCuesheetMatchIndex();
+
+    QHash<int, LeveledCuesheet> leveledCuesheets;  // cuesheetMatchIndex id -> cuesheet, for just the leveled ones
+
+    for (int id : cuesheetMatchIndex.allIds()) {
+        const CuesheetMatchIndex::Entry &e = cuesheetMatchIndex.entry(id);
+        if (e.levelName.isEmpty()) {
             continue;
         }
-        QChar category = levelNameToCategory(parts[2]);
+        QChar category = levelNameToCategory(e.levelName);
         if (category.isNull()) {
             continue;
         }
-        leveledCuesheets.append(makeLeveledCuesheet(parts[0], parts[1], category));
+        leveledCuesheets.insert(id, makeLeveledCuesheet(e, category));
     }
 
     if (leveledCuesheets.isEmpty()) {
-        saveSongLevelsCache(); // cache the (empty) result, so the next startup skips even the cuesheet parse above
-        return;
+        return; // no song can have any levels
     }
 
-    for (const QString &s : *pathStack) {
-        QStringList parts = s.split("#!#");
-        if (parts.size() < 2) {
-            continue;
-        }
-        SongMatchInfo song = makeSongMatchInfo(parts[1]);
+    for (const QString &origPath : origPaths) {
+        SongMatchInfo song = makeSongMatchInfo(origPath);
 
-        QString levelsFound; // chars accumulate in no fixed order, since leveledCuesheets has no fixed order
-        for (const auto &lc : leveledCuesheets) {
-            if (levelsFound.contains(lc.category)) {
+        // only the cuesheets that could possibly match this song, not every leveled cuesheet
+        QString levelsFound; // chars accumulate in no fixed order
+        for (int id : cuesheetMatchIndex.candidates(song.catalogNumber, song.words)) {
+            auto lc = leveledCuesheets.constFind(id);
+            if (lc == leveledCuesheets.constEnd()) {
+                continue; // not a leveled cuesheet
+            }
+            if (levelsFound.contains(lc->category)) {
                 continue; // already found this category for this song
             }
-            if (cuesheetMatchesSong(song, lc)) {
-                levelsFound.append(lc.category);
+            if (cuesheetMatchesSong(song, *lc)) {
+                levelsFound.append(lc->category);
             }
             if (levelsFound.length() == 5) {
                 break; // found all 5 categories, no need to keep checking
@@ -1162,8 +1023,6 @@ void MainWindow::computeSongLevels() {
             songLevelsByPath.insert(song.origPath, orderCategories(levelsFound));
         }
     }
-
-    saveSongLevelsCache();
 }
 
 // Updates the Levels column cell text in darkSongTable and all 3 playlist tables
@@ -1200,19 +1059,25 @@ void MainWindow::refreshLevelsColumnDisplay() {
 // scratch (which takes several seconds on a large library).
 void MainWindow::updateCuesheetLevelInPathStack(const QString &absoluteFilePath) {
     QString levelName = detectCuesheetLevel(absoluteFilePath);
+    cuesheetMetadata.store(absoluteFilePath, levelName); // it was just rewritten, so the cached level is stale
+    cuesheetMetadata.save();
 
     for (int i = 0; i < pathStackCuesheets->size(); i++) {
         QStringList parts = (*pathStackCuesheets)[i].split("#!#");
         if (parts.size() >= 2 && parts[1] == absoluteFilePath) {
             QString oldLevelName = parts.size() >= 3 ? parts[2] : QString();
             (*pathStackCuesheets)[i] = parts[0] + "#!#" + absoluteFilePath + "#!#" + levelName;
+            if (!cuesheetMatchIndexDirty) {
+                cuesheetMatchIndex.insert((*pathStackCuesheets)[i]); // replaces the old entry for this file
+            }
             updateSongLevelsForOneCuesheet(absoluteFilePath, parts[0], oldLevelName, levelName);
             if (oldLevelName != levelName) {
                 // The pathStack cache's Q record still carries the OLD level, and Tier 1 will
                 // NOT notice this edit (the cuesheet was rewritten in place, so no directory
                 // listing changed), so nothing would ever rewrite that record -- the new level
-                // would silently revert on the next launch. Re-save the cache now. (Issue #1703)
-                savePathStackCache();
+                // would silently revert on the next launch. Re-save the cache now (no directory
+                // listing changed, so from memory). (Issue #1703)
+                writePathStackCache();
                 if (songLevelsComputed) {
                     saveSongLevelsCache(); // pathStackCuesheets entry changed, so re-save under the new fingerprint
                 }
@@ -1226,6 +1091,9 @@ void MainWindow::updateCuesheetLevelInPathStack(const QString &absoluteFilePath)
     QStringList section = fi.path().split("/");
     QString type = section[section.length() - 1]; // must be the last item in the path
     pathStackCuesheets->append(type + "#!#" + absoluteFilePath + "#!#" + levelName);
+    if (!cuesheetMatchIndexDirty) {
+        cuesheetMatchIndex.insert(pathStackCuesheets->last());
+    }
 
     updateSongLevelsForOneCuesheet(absoluteFilePath, type, QString(), levelName);
 
@@ -1233,7 +1101,7 @@ void MainWindow::updateCuesheetLevelInPathStack(const QString &absoluteFilePath)
     // catch this and force a full rescan. Saving the cache now (with the new file already in
     // both the pathStack and the fingerprints) keeps the two in sync, so that rescan never
     // has to happen. (Issue #1703)
-    savePathStackCache();
+    updatePathStackCacheForPaths(QStringList(absoluteFilePath), true);
     if (songLevelsComputed) {
         saveSongLevelsCache(); // pathStackCuesheets gained an entry, so re-save under the new fingerprint
     }
@@ -1325,6 +1193,176 @@ void MainWindow::updateSongLevelsForOneCuesheet(const QString &absoluteFilePath,
     }
 }
 
+// Reads the levels of these cuesheets on the global thread pool, so that a library full of new
+// (or never-read) cuesheets doesn't hold up startup. cuesheetLevelsRefreshed() applies the results.
+// A refresh that's still running is cancelled: its cuesheets are still unread, so whichever scan
+// started this one has included them again.
+void MainWindow::refreshCuesheetLevelsInBackground(const QStringList &paths) {
+    if (cuesheetLevelWatcher.isRunning()) {
+        cuesheetLevelWatcher.cancel();
+    }
+    if (paths.isEmpty()) {
+        return;
+    }
+    // qDebug() << "refreshCuesheetLevelsInBackground:" << paths.size() << "cuesheets";
+    cuesheetLevelWatcher.setFuture(QtConcurrent::mapped(paths, [](const QString &path) {
+        CuesheetLevelResult result;
+        QFileInfo fi(path);
+        result.path = path;
+        result.size = fi.size();
+        result.mtime = fi.lastModified().toMSecsSinceEpoch();
+        result.level = detectCuesheetLevel(path);
+        return result;
+    }));
+}
+
+// Applies the levels found by refreshCuesheetLevelsInBackground(): remembers them in the cuesheet
+// metadata cache, updates the pathStackCuesheets entries (and the caches made from them), and
+// recomputes the Levels column if it's in use.
+void MainWindow::cuesheetLevelsRefreshed() {
+    QFuture<CuesheetLevelResult> future = cuesheetLevelWatcher.future();
+    if (future.isCanceled()) {
+        return; // superseded by a newer refresh
+    }
+
+    QHash<QString, int> indexByPath;  // absolute path -> index in pathStackCuesheets
+    for (int i = 0; i < pathStackCuesheets->size(); i++) {
+        QStringList parts = pathStackCuesheets->at(i).split("#!#");
+        if (parts.size() >= 2) {
+            indexByPath.insert(parts[1], i);
+        }
+    }
+
+    bool anyChanged = false;
+    const QList<CuesheetLevelResult> results = future.results();
+    for (const auto &result : results) {
+        cuesheetMetadata.store(result.path, result.level, result.size, result.mtime);  // no stat here: see CuesheetLevelResult
+
+        auto found = indexByPath.constFind(result.path);
+        if (found == indexByPath.constEnd() || result.level.isEmpty()) {
+            continue; // gone since, or no level in it (which is what the entry already says)
+        }
+        QStringList parts = pathStackCuesheets->at(found.value()).split("#!#");
+        (*pathStackCuesheets)[found.value()] = parts[0] + "#!#" + result.path + "#!#" + result.level;
+        if (!cuesheetMatchIndexDirty) {
+            cuesheetMatchIndex.insert(pathStackCuesheets->at(found.value()));
+        }
+        anyChanged = true;
+    }
+    cuesheetMetadata.save();
+
+    if (!anyChanged) {
+        return;
+    }
+
+    writePathStackCache(); // so the next startup's Tier 1 load gets these levels too
+    if (songLevelsComputed) {
+        computeSongLevels();          // pathStackCuesheets changed, so this recomputes (and re-saves the cache)
+        refreshLevelsColumnDisplay();
+    }
+}
+
+// Brings the full-text index of cuesheets and lyrics (in the SongSettings DB) up to date with the
+// music directory.  Every cuesheet, and every singing call/called MP3 (for its USLT lyrics), is
+// stat'ed on the global thread pool, and only the ones that are new or changed since they were
+// indexed are read.  cuesheetTextIndexRefreshed() hands those to SongSettings, whose write-behind
+// thread commits them.  Files that are gone are dropped from the index right away.
+void MainWindow::refreshCuesheetTextIndexInBackground() {
+    if (cuesheetTextWatcher.isRunning()) {
+        cuesheetTextWatcher.cancel();  // superseded: this one looks at everything that one would have
+    }
+    if (!songSettings.isTextSearchAvailable()) {
+        return;
+    }
+
+    QStringList paths;
+    for (const QString &s : std::as_const(*pathStackCuesheets)) {
+        QStringList parts = s.split("#!#");
+        if (parts.size() >= 2) {
+            paths.append(parts[1]);
+        }
+    }
+    for (const QString &s : std::as_const(*pathStack)) {
+        QStringList parts = s.split("#!#");
+        if (parts.size() >= 2 && parts[1].endsWith(".mp3", Qt::CaseInsensitive) &&
+            (songTypeNamesForSinging.contains(parts[0]) || songTypeNamesForCalled.contains(parts[0]))) {
+            paths.append(parts[1]);  // loadLyrics() only knows about MP3s
+        }
+    }
+
+    QHash<QString, QPair<qint64, qint64> > indexed = songSettings.getIndexedTextFiles();
+    QSet<QString> present;
+    for (const QString &path : std::as_const(paths)) {
+        present.insert(songSettings.removeRootDirs(path));
+    }
+    for (auto it = indexed.cbegin(); it != indexed.cend(); ++it) {
+        if (!present.contains(it.key())) {
+            songSettings.removeIndexedText(it.key());
+        }
+    }
+
+    QString rootDir = songSettings.primaryRootDir();
+    cuesheetTextWatcher.setFuture(QtConcurrent::mapped(paths, [indexed, rootDir](const QString &path) {
+        CuesheetTextFile file;
+        file.path = path;
+        QFileInfo fi(path);
+        file.size = fi.size();
+        file.mtime = fi.lastModified().toMSecsSinceEpoch();
+
+        auto found = indexed.constFind(path.startsWith(rootDir) ? path.mid(rootDir.length()) : path);
+        if (found != indexed.constEnd() && found.value().first == file.size && found.value().second == file.mtime) {
+            return file;  // indexed, and not changed since
+        }
+        file.changed = true;
+        file.text = path.endsWith(".mp3", Qt::CaseInsensitive) ? MainWindow::loadLyrics(path) : extractCuesheetText(path);
+        return file;
+    }));
+}
+
+void MainWindow::cuesheetTextIndexRefreshed() {
+    QFuture<CuesheetTextFile> future = cuesheetTextWatcher.future();
+    if (future.isCanceled()) {
+        return; // superseded by a newer refresh
+    }
+    const QList<CuesheetTextFile> results = future.results();
+    for (const auto &file : results) {
+        if (file.changed) {
+            songSettings.setIndexedText(file.path, file.size, file.mtime, file.text);
+        }
+    }
+}
+
+// Songs whose cuesheet or lyrics contain these words (see SongSettings::searchIndexedText()):
+//   an MP3 whose own USLT lyrics match is in songPaths, and so is every song whose last-used
+//   cuesheet matches.  Cuesheets are usually named just like their songs, so the base names of all
+//   matching cuesheets are in songBaseNames, too.
+void MainWindow::findSongsByIndexedText(const QString &words, QSet<QString> &songPaths, QSet<QString> &songBaseNames) {
+    songPaths.clear();
+    songBaseNames.clear();
+
+    QSet<QString> matchingCuesheets;  // absolute paths
+    const QStringList matches = songSettings.searchIndexedText(words);
+    for (const QString &relativePath : matches) {
+        QString path = musicRootPath + relativePath;
+        if (relativePath.endsWith(".mp3", Qt::CaseInsensitive)) {
+            songPaths.insert(path);
+        } else {
+            matchingCuesheets.insert(path);
+            songBaseNames.insert(QFileInfo(relativePath).completeBaseName());
+        }
+    }
+
+    if (matchingCuesheets.isEmpty()) {
+        return;
+    }
+    const QHash<QString, SongSetting> &allSettings = songSettings.allSongSettings();
+    for (auto it = allSettings.cbegin(); it != allSettings.cend(); ++it) {
+        if (it.value().isSetCuesheetName() && matchingCuesheets.contains(it.value().getCuesheetName())) {
+            songPaths.insert(musicRootPath + it.key());
+        }
+    }
+}
+
 void MainWindow::betterFindPossibleCuesheets(const QString &MP3Filename, QStringList &possibleCuesheets) {
 
     // if it's a patter MP3, then do NOT match it against anything in the lyrics folder
@@ -1337,21 +1375,22 @@ void MainWindow::betterFindPossibleCuesheets(const QString &MP3Filename, QString
 
     QList<CuesheetWithRanking *> possibleRankings;    // results go here
 
-    QListIterator<QString> iter(*pathStackCuesheets); // search through Lyrics/Cuesheets
-    while (iter.hasNext()) {
-        QString s = iter.next();
-        QStringList sl1 = s.split("#!#");
-        QString type = sl1[0];  // the type (of original pathname, before following aliases)
+    // search through Lyrics/Cuesheets -- ALL of them, not just the cuesheetMatchIndex's candidates(),
+    //   whose pre-filter can drop a fuzzy-only match (see cuesheetMatchesSong()).  This runs once
+    //   per song load, and the user picks from this list, so it has to be complete.
+    ensureCuesheetMatchIndex();
+    for (int id : cuesheetMatchIndex.allIds()) {
+        const CuesheetMatchIndex::Entry &e = cuesheetMatchIndex.entry(id);
+        QString type = e.type;  // the type (of original pathname, before following aliases)
 
         if (fileCategoryIsPatter && (type=="lyrics")) {
             // if it's a patter MP3, then do NOT match it against anything in the lyrics folder
-            // qDebug() << "NOT maching patter MP3 vs cuesheet in lyrics folder" << sl1[1];
+            // qDebug() << "NOT maching patter MP3 vs cuesheet in lyrics folder" << e.absoluteFilePath;
             continue;
         }
 
-        QString cuesheetFilename = sl1[1];  // everything else
-        QFileInfo cuesheetFileInfo(cuesheetFilename);
-        QString cuesheetCompleteBaseName = cuesheetFileInfo.completeBaseName();
+        QString cuesheetFilename = e.absoluteFilePath;  // everything else
+        QString cuesheetCompleteBaseName = e.completeBaseName;
 
         int score = this->MP3FilenameVsCuesheetnameScore(mp3CompleteBaseName, cuesheetCompleteBaseName);
         if (score > 0) {
@@ -56,6 +56,11 @@
 #include <QStandardItem>
 #include <QWidget>
 #include <QInputDialog>
+#ifdef Q_OS_LINUX
+#include <QtConcurrent/QtConcurrent>
+#else
+#include <QtConcurrent>
+#endif
 
 #include <QPrinter>
 #include <QPrintDialog>
@@ -84,6 +89,7 @@
 // #include "downloadmanager.h"
 #include "songlistmodel.h"
 #include "mytablewidget.h"
+#include "paralleldirwalker.h"
 
 #include "svgWaveformSlider.h"
 #include "auditionbutton.h"
@@ -115,6 +121,8 @@
 #include <taglib/mpeg/id3v2/frames/commentsframe.h>
 #include <taglib/mpeg/id3v2/frames/textidentificationframe.h>
 #include <algorithm>
+#include <atomic>
+#include <numeric>
 #include <string>
 
 #ifndef Q_OS_WIN
@@ -324,20 +332,16 @@ void MainWindow::loadMP3File(QString MP3FileName, QString songTitle, QString son
         }
     }
 
+    // if we measured this song's loudness before, hand it to cBass, so it doesn't have to measure it again
+    cBass->SetKnownReplayGain(settings1.isSetReplayGain(), settings1.isSetReplayGain() ? settings1.getReplayGain() : 0.0);
+
     // TODO: intro1 and outro1 are NOT used in cBass anymore
-    cBass->StreamCreate(MP3FileName.toStdString().c_str(), &startOfSong_sec, &endOfSong_sec, intro1, outro1);  // load song, and figure out where the song actually starts and ends
+    cBass->StreamCreate(MP3FileName.toStdString().c_str(), &startOfSong_sec, &endOfSong_sec, intro1, outro1);  // start loading the song
 
     t.elapsed(__LINE__);
 
-    // OK, by this time we always have an introOutro
-    //   if DB had one, we didn't scan, and just used that one
-    //   if DB did not have one, we scanned
-
-    //    qDebug() << "song starts: " << startOfSong_sec << ", ends: " << endOfSong_sec;
-
-#ifdef REMOVESILENCE
-        startOfSong_sec = (startOfSong_sec > 1.0 ? startOfSong_sec - 1.0 : 0.0);  // start 1 sec before non-silence
-#endif
+    // NOTE: where the song actually starts and ends isn't known until the decode is done,
+    //   so secondHalfOfLoad() asks cBass->songStartDetector() for them.
 
     QStringList ss = MP3FileName.split('/');
     QString fn = ss.at(ss.size()-1);
@@ -445,12 +449,83 @@ QString detectCuesheetLevel(const QString &absoluteFilePath)
     return "";
 }
 
+// &name; / &#NNN; / &#xHH; -> the character, in one pass (so "&amp;lt;" stays "&lt;").  Only the
+//   named entities that actually turn up in cuesheets are here; any other one becomes a space.
+static QString decodeHtmlEntities(const QString &html)
+{
+    static const QHash<QString, QString> named = {
+        {"nbsp", " "}, {"lt", "<"}, {"gt", ">"}, {"quot", "\""}, {"apos", "'"}, {"amp", "&"},
+        {"rsquo", "'"}, {"lsquo", "'"}, {"rdquo", "\""}, {"ldquo", "\""}, {"sbquo", "'"}, {"bdquo", "\""},
+        {"ndash", "-"}, {"mdash", "-"}, {"hellip", "..."}, {"acute", "'"}, {"prime", "'"},
+        {"eacute", QString(QChar(0xE9))}, {"egrave", QString(QChar(0xE8))}, {"aacute", QString(QChar(0xE1))},
+        {"agrave", QString(QChar(0xE0))}, {"ouml", QString(QChar(0xF6))}, {"uuml", QString(QChar(0xFC))},
+        {"auml", QString(QChar(0xE4))}, {"ntilde", QString(QChar(0xF1))}, {"ccedil", QString(QChar(0xE7))},
+    };
+    static const QRegularExpression entity("&(#[xX][0-9a-fA-F]+|#[0-9]+|[A-Za-z][A-Za-z0-9]*);");
+
+    QString result;
+    result.reserve(html.size());
+    qsizetype last = 0;
+    QRegularExpressionMatchIterator it = entity.globalMatch(html);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        result += QStringView(html).mid(last, match.capturedStart() - last);
+        last = match.capturedEnd();
+
+        QString name = match.captured(1);
+        if (name.startsWith('#')) {
+            bool ok = false;
+            uint codepoint = (name.size() > 1 && (name[1] == 'x' || name[1] == 'X')) ? name.mid(2).toUInt(&ok, 16)
+                                                                                       : name.mid(1).toUInt(&ok, 10);
+            if (ok && codepoint != 0 && codepoint <= 0x10FFFF) {
+                char32_t c = codepoint;
+                result += QString::fromUcs4(&c, 1);
+            } else {
+                result += ' ';
+            }
+        } else {
+            result += named.value(name, " ");
+        }
+    }
+    result += QStringView(html).mid(last);
+    return result;
+}
+
+// Returns the words in a cuesheet, for the full-text index (see refreshCuesheetTextIndexInBackground()).
+// Runs on the global thread pool, so this strips the HTML by hand, rather than with a QTextDocument.
+//   The file is decoded the same way loadCuesheet() decodes it (QTextStream: UTF-8, unless there's a BOM),
+//   so the index has the same words the user sees.
+QString extractCuesheetText(const QString &absoluteFilePath)
+{
+    QFile file(absoluteFilePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return "";
+    }
+    QTextStream in(&file);
+    QString text = in.readAll();
+    if (absoluteFilePath.endsWith(".txt", Qt::CaseInsensitive)) {
+        return text.simplified();
+    }
+    text.replace("\xB4", "'");  // same wacky apostrophe as loadCuesheet() replaces
+
+    static const QRegularExpression invisible("<(head|style|script)\\b.*?</\\1\\s*>",
+                                              QRegularExpression::CaseInsensitiveOption | QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression tags("<[^>]*>");
+    text.remove(invisible);
+    text.replace(tags, " ");
+    return decodeHtmlEntities(text).simplified();
+}
+
 // ======================================================================
-void findFilesRecursively(QDir rootDir, QList<QString> *pathStack, QList<QString> *pathStackCuesheets, QList<QString> *pathStackReference, QString suffix, Ui::MainWindow *ui, QMap<int, QString> *soundFXarray, QMap<int, QString> *soundFXname)
+void findFilesRecursively(QDir rootDir, QList<QString> *pathStack, QList<QString> *pathStackCuesheets, QList<QString> *pathStackReference, QString suffix, Ui::MainWindow *ui, QMap<int, QString> *soundFXarray, QMap<int, QString> *soundFXname, CuesheetMetadataCache *cuesheetMetadata)
 {
-    QDirIterator it(rootDir, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
-    while(it.hasNext()) {
-        QString s1 = it.next();
+    QString rootPath = rootDir.path();
+
+    // The walk and the per-file work (including looking up every cuesheet's level) run in
+    //   parallel on the ParallelDirWalker's pool.  Each file comes back tagged with the stack it
+    //   belongs on ("P", "Q", "R", or "S" for soundfx), in the same order as the old serial
+    //   QDirIterator walk, and is appended below, on this thread (soundfx also touches the UI).
+    QStringList results = ParallelDirWalker::walk(rootPath, rootDir.nameFilters(), [rootPath, cuesheetMetadata](const QString &s1) -> QString {
         QString resolvedFilePath=s1;
 
         QFileInfo fi(s1);
@@ -462,37 +537,50 @@ void findFilesRecursively(QDir rootDir, QList<QString> *pathStack, QList<QString
         //    <musicDir>/foo/bar/ ... /baz/music.mp3 is of type "foo"
         //    <musicDir>/music.mp3 is of type ""
 
-        QString newType = (fi.path().replace(rootDir.path() + "/","").split("/"))[0];
+        QString newType = (fi.path().replace(rootPath + "/","").split("/"))[0];
         QStringList section = fi.path().split("/");
 
         //        QString type = section[section.length()-1] + suffix;  // must be the last item in the path
         //                                                              // of where the alias is, not where the file is, and append "*" or not
-        if (section[section.length()-1] != "soundfx") {
-            //            qDebug() << "findFilesRecursively() adding " + type + "#!#" + resolvedFilePath + " to pathStack";
-            //            pathStack->append(type + "#!#" + resolvedFilePath);
-
-            // add to the pathStack iff it's not a sound FX .mp3 file (those are internal) AND iff it's not sd, choreography, playlists, or reference
-            if (newType == "reference") {
-                // qDebug() << "pathStackReference adding:" << resolvedFilePath;
-                pathStackReference->append(newType + "#!#" + resolvedFilePath);
-            } else if (newType != "sd" && newType != "choreography" && newType != "playlists") {
-                // NOTE: "playlists" holds .csv playlist files, which updateTreeWidget() loads by
-                //   itself into pathStackPlaylists -- nothing in there belongs on these stacks.
-                //   It is excluded BY NAME (like sd/ and choreography/) rather than by relying on
-                //   its contents never matching, so that Tier 1 can skip fingerprinting it: a
-                //   directory the scan ignores must also be a directory the cache check ignores,
-                //   or a stray .txt/.html dropped in there would go into pathStackCuesheets and
-                //   then never be noticed again. Cuesheets belong in lyrics/. (Issue #1703)
-                if (newType == "lyrics" || resolvedFilePath.endsWith(".html") || resolvedFilePath.endsWith(".htm")) {
-                    QString levelName = detectCuesheetLevel(resolvedFilePath);
-                    pathStackCuesheets->append(newType + "#!#" + resolvedFilePath + "#!#" + levelName);
-                } else {
-                    pathStack->append(newType + "#!#" + resolvedFilePath);
-                }
+        if (section[section.length()-1] == "soundfx") {
+            return "S\t" + resolvedFilePath;
+        }
+
+        // add to the pathStack iff it's not a sound FX .mp3 file (those are internal) AND iff it's not sd, choreography, playlists, or reference
+        if (newType == "reference") {
+            // qDebug() << "pathStackReference adding:" << resolvedFilePath;
+            return "R\t" + newType + "#!#" + resolvedFilePath;
+        } else if (newType != "sd" && newType != "choreography" && newType != "playlists") {
+            // NOTE: "playlists" holds .csv playlist files, which updateTreeWidget() loads by
+            //   itself into pathStackPlaylists -- nothing in there belongs on these stacks.
+            //   It is excluded BY NAME (like sd/ and choreography/) rather than by relying on
+            //   its contents never matching, so that Tier 1 can skip fingerprinting it: a
+            //   directory the scan ignores must also be a directory the cache check ignores,
+            //   or a stray .txt/.html dropped in there would go into pathStackCuesheets and
+            //   then never be noticed again. Cuesheets belong in lyrics/. (Issue #1703)
+            if (newType == "lyrics" || resolvedFilePath.endsWith(".html") || resolvedFilePath.endsWith(".htm")) {
+                // only a stat, if this cuesheet hasn't changed since it was last read; new or changed
+                //   ones get no level for now, and findMusic() has them read in the background
+                QString levelName;
+                cuesheetMetadata->lookup(resolvedFilePath, &levelName);
+                return "Q\t" + newType + "#!#" + resolvedFilePath + "#!#" + levelName;
+            } else {
+                return "P\t" + newType + "#!#" + resolvedFilePath;
             }
-        } else {
+        }
+        return QString();
+    });
+
+    for (const QString &r : std::as_const(results)) {
+        QString entry = r.mid(2);
+        switch (r.at(0).unicode()) {
+        case 'P': pathStack->append(entry); break;
+        case 'Q': pathStackCuesheets->append(entry); break;
+        case 'R': pathStackReference->append(entry); break;
+        case 'S':
             if (suffix != "*") {
                 // if it IS a sound FX file, then let's squirrel away the paths so we can play them later
+                QString resolvedFilePath = entry;
                 QString path1 = resolvedFilePath;
                 QString baseName = resolvedFilePath.replace(rootDir.absolutePath(),"").replace("/soundfx/","");
                 QStringList sections = baseName.split(".");
@@ -517,8 +605,11 @@ void findFilesRecursively(QDir rootDir, QList<QString> *pathStack, QList<QString
                     soundFXarray->insert(sections[0].toInt()-1, path1);  // remember the path for playing it later
                 } // if
             } // if
-        } // else
+            break;
+        default:
+            break;
         }
+    }
 }
 
 // ============================================================================
@@ -568,9 +659,10 @@ void findFilesRecursively(QDir rootDir, QList<QString> *pathStack, QList<QString
 // AND re-saves this cache, so the new level survives a restart.
 // The escape hatch is Menu > Rescan Music Directory, which forces a full scan.
 
-static const char *kPathStackCacheVersion = "4"; // bump if the cache file format or scan semantics change
+static const char *kPathStackCacheVersion = "5"; // bump if the cache file format or scan semantics change
                                                  // 3: symlinked dirs are no longer walked or recorded (Issue #1685)
                                                  // 4: D records hold a listing fingerprint, not an mtime (Issue #1703)
+                                                 // 5: P records carry their parsed filename parts
 
 // "type#!#<absolute path>[#!#level]" -> "type#!#<path relative to root>[#!#level]",
 // or "" if the path isn't under root (shouldn't happen for scanned entries)
@@ -747,11 +839,27 @@ static QString absolutizePathStackEntry(const QString &entry, const QString &roo
     return parts.join("#!#");
 }
 
+// Fills in rec's breakFilenameIntoParts() results, unless it already has them for the current
+// filename format pref (labelnum_extra is folded into labelnum, as the song table shows it).
+void MainWindow::ensureSongRecordParts(SongRecord &rec)
+{
+    if (rec.partsFormat == static_cast<int>(songFilenameFormat)) {
+        return;
+    }
+    QString labelnum_extra;
+    rec.label.clear(); rec.labelnum.clear(); rec.title.clear(); rec.shortTitle.clear();
+    breakFilenameIntoParts(rec.baseName(), rec.label, rec.labelnum, labelnum_extra, rec.title, rec.shortTitle);
+    rec.labelnum += labelnum_extra;
+    rec.partsFormat = static_cast<int>(songFilenameFormat);
+}
+
 // Writes the results of a just-completed findFilesRecursively() scan to
 // <musicDir>/.squaredesk/cache/pathStack.cache. Line format (tab-separated):
 //   version=N
 //   D <relativeDirPath> <fingerprint>    -- one per directory, INCLUDING the music root
-//   P <type#!#relativePath>              -- pathStack entry
+//   P <type#!#relativePath> <format> <label> <labelnum> <title> <shortTitle>
+//                                        -- pathStack entry, plus its breakFilenameIntoParts() results
+//                                           for that songFilenameFormat, so a warm start never re-parses
 //   Q <type#!#relativePath#!#level>      -- pathStackCuesheets entry
 //   R <type#!#relativePath>              -- pathStackReference entry
 //   S <index> <name> <relativePath>      -- soundfx entry
@@ -767,17 +875,7 @@ static QString absolutizePathStackEntry(const QString &entry, const QString &roo
 // and relativizePathStackEntry() drops anything outside the music root as a backstop.
 void MainWindow::savePathStackCache()
 {
-    QDir().mkpath(musicRootPath + "/.squaredesk/cache");
-
-    // QSaveFile, not QFile: the cache is written to a temp file and renamed into place by
-    //   commit(), so a crash (or a power loss) part way through this function can never leave
-    //   a half-written pathStack.cache behind for the next startup to read. (Issue #1685)
-    QSaveFile file(musicRootPath + "/.squaredesk/cache/pathStack.cache");
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        return; // not writable -- no cache, but no harm either (we'll just rescan next time)
-    }
-    QTextStream out(&file);
-    out << "version=" << kPathStackCacheVersion << "\n";
+    pathStackCacheDirs.clear();
 
     // D records: the music root (empty relative path), then every directory below it.
     // Hidden dirs (including our own .squaredesk, whose cache/DB writes must not
@@ -795,27 +893,77 @@ void MainWindow::savePathStackCache()
     if (rootFingerprint.isEmpty()) {
         return; // music root unreadable -- write no cache at all, and just rescan next time
     }
-    out << "D\t\t" << rootFingerprint << "\n";
+    pathStackCacheDirs.insert(QString(), rootFingerprint);
 
+    // the directory list is collected serially (it's cheap), then the directories are
+    //   fingerprinted in parallel
+    QStringList relativePaths;
     QDirIterator dirIt(musicRootPath, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks,
                        QDirIterator::Subdirectories);
     while (dirIt.hasNext()) {
         dirIt.next();
-        QString dirPath = dirIt.fileInfo().filePath();
-        QString relativePath = dirPath.mid(musicRootPath.length());
+        QString relativePath = dirIt.fileInfo().filePath().mid(musicRootPath.length());
         if (isUnscannedSubtree(relativePath)) {
             continue; // nothing in here can affect the scan results
         }
-        QString fingerprint = directoryFingerprint(dirPath, nullptr);
-        if (fingerprint.isEmpty()) {
+        relativePaths.append(relativePath);
+    }
+
+    QString root = musicRootPath;
+    QStringList fingerprints = QtConcurrent::blockingMapped(ParallelDirWalker::pool(), relativePaths,
+                                                            [root](const QString &relativePath) {
+        return directoryFingerprint(root + relativePath, nullptr);
+    });
+
+    for (int i = 0; i < relativePaths.size(); i++) {
+        if (fingerprints[i].isEmpty()) {
             continue; // deleted out from under the walk; its parent's fingerprint covers that
         }
-        out << "D\t" << relativePath << "\t" << fingerprint << "\n";
+        pathStackCacheDirs.insert(relativePaths[i], fingerprints[i]);
+    }
+
+    writePathStackCache();
+}
+
+// Writes pathStack.cache from what is already in memory: the D records from pathStackCacheDirs
+// (as left by savePathStackCache(), loadPathStackCacheIfValid() or updatePathStackCacheForPaths()),
+// and the rest from the pathStacks. No directory is read, so this is the cheap way to re-save
+// after a change that only touched the entries, e.g. a cuesheet's detected level.
+void MainWindow::writePathStackCache()
+{
+    if (!pathStackCacheDirs.contains(QString())) {
+        savePathStackCache(); // no fingerprints at all yet, so they have to come from a walk
+        return;
+    }
+
+    QDir().mkpath(musicRootPath + "/.squaredesk/cache");
+
+    // QSaveFile, not QFile: the cache is written to a temp file and renamed into place by
+    //   commit(), so a crash (or a power loss) part way through this function can never leave
+    //   a half-written pathStack.cache behind for the next startup to read. (Issue #1685)
+    QSaveFile file(musicRootPath + "/.squaredesk/cache/pathStack.cache");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return; // not writable -- no cache, but no harm either (we'll just rescan next time)
+    }
+    QTextStream out(&file);
+    out << "version=" << kPathStackCacheVersion << "\n";
+
+    QStringList relativePaths = pathStackCacheDirs.keys();
+    relativePaths.sort();  // the music root ("") first
+    for (const QString &relativePath : std::as_const(relativePaths)) {
+        out << "D\t" << relativePath << "\t" << pathStackCacheDirs.value(relativePath) << "\n";
     }
 
     for (const QString &e : *pathStack) {
         QString rel = relativizePathStackEntry(e, musicRootPath);
-        if (!rel.isEmpty()) { out << "P\t" << rel << "\n"; }
+        if (rel.isEmpty()) {
+            continue;
+        }
+        // parsing here costs nothing extra: darkLoadMusicList() would have to do it anyway, and will now find it done
+        SongRecord &rec = songRecords.record(songRecords.idFor(e));
+        ensureSongRecordParts(rec);
+        out << "P\t" << rel << "\t" << rec.partsFormat << "\t" << rec.label << "\t" << rec.labelnum
+            << "\t" << rec.title << "\t" << rec.shortTitle << "\n";
     }
     for (const QString &e : *pathStackCuesheets) {
         QString rel = relativizePathStackEntry(e, musicRootPath);
@@ -838,6 +986,103 @@ void MainWindow::savePathStackCache()
     file.commit();  // ...then atomically rename the temp file into place (Issue #1685)
 }
 
+// Brings pathStack.cache up to date after just these files or directories (absolute paths) were
+// added or removed, by re-fingerprinting only the directories whose listing can have changed:
+// each path itself (in case it is a directory) and the ones above it, up to the music root. A
+// directory that is new is walked, since all of it is new; one that is gone is dropped along
+// with everything below it. The cache is rewritten only if a fingerprint moved, or if the caller
+// says the entries did (entriesChanged).
+void MainWindow::updatePathStackCacheForPaths(const QStringList &changedPaths, bool entriesChanged)
+{
+    if (!pathStackCacheDirs.contains(QString())) {
+        savePathStackCache(); // nothing to update (e.g. the music root was unreadable at the last scan)
+        return;
+    }
+
+    QString root = musicRootPath;
+    QSet<QString> dirsToCheck;  // relative to the music root, like the D records
+    for (const QString &path : changedPaths) {
+        if (!path.startsWith(root + "/")) {
+            continue;
+        }
+        QString relativePath = path.mid(root.length());
+        dirsToCheck.insert(relativePath);
+        for (qsizetype slash = relativePath.lastIndexOf('/'); slash >= 0; slash = relativePath.lastIndexOf('/', slash - 1)) {
+            dirsToCheck.insert(relativePath.left(slash));  // ..., "/patter", and finally "" (the music root)
+            if (slash == 0) {
+                break;
+            }
+        }
+    }
+
+    // same directories as savePathStackCache() walks: no hidden ones, no unscanned subtrees, no symlinks
+    QStringList relativePaths;
+    for (const QString &relativePath : std::as_const(dirsToCheck)) {
+        if (relativePath.contains("/.") || isUnscannedSubtree(relativePath) ||
+            (!relativePath.isEmpty() && QFileInfo(root + relativePath).isSymLink())) {
+            continue;
+        }
+        relativePaths.append(relativePath);
+    }
+
+    QStringList fingerprints = QtConcurrent::blockingMapped(ParallelDirWalker::pool(), relativePaths,
+                                                            [root](const QString &relativePath) {
+        return directoryFingerprint(root + relativePath, nullptr);  // "" for a plain file, or a directory that's gone
+    });
+
+    bool changed = false;
+    QStringList newDirs;
+    for (int i = 0; i < relativePaths.size(); i++) {
+        const QString &relativePath = relativePaths[i];
+        if (fingerprints[i].isEmpty()) {
+            if (relativePath.isEmpty()) {
+                return; // music root unreadable -- leave the cache alone, and just rescan next time
+            }
+            QString below = relativePath + "/";
+            changed = (pathStackCacheDirs.removeIf([&](const QHash<QString, QString>::iterator &it) {
+                return it.key() == relativePath || it.key().startsWith(below);
+            }) > 0) || changed;
+            continue;
+        }
+        auto it = pathStackCacheDirs.find(relativePath);
+        if (it == pathStackCacheDirs.end()) {
+            newDirs.append(relativePath);
+        } else if (it.value() != fingerprints[i]) {
+            it.value() = fingerprints[i];
+            changed = true;
+        }
+    }
+
+    // each new directory, and everything below it (e.g. a whole album folder dropped in at once)
+    QStringList newRelativePaths;
+    for (const QString &relativePath : std::as_const(newDirs)) {
+        newRelativePaths.append(relativePath);
+        QDirIterator dirIt(root + relativePath, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks,
+                           QDirIterator::Subdirectories);
+        while (dirIt.hasNext()) {
+            dirIt.next();
+            QString below = dirIt.fileInfo().filePath().mid(root.length());
+            if (!isUnscannedSubtree(below) && !dirsToCheck.contains(below)) {
+                newRelativePaths.append(below);
+            }
+        }
+    }
+    QStringList newFingerprints = QtConcurrent::blockingMapped(ParallelDirWalker::pool(), newRelativePaths,
+                                                               [root](const QString &relativePath) {
+        return directoryFingerprint(root + relativePath, nullptr);
+    });
+    for (int i = 0; i < newRelativePaths.size(); i++) {
+        if (!newFingerprints[i].isEmpty()) {
+            pathStackCacheDirs.insert(newRelativePaths[i], newFingerprints[i]);
+            changed = true;
+        }
+    }
+
+    if (changed || entriesChanged) {
+        writePathStackCache();
+    }
+}
+
 // ============================================================================
 // UNCLEAN-STARTUP DETECTION (Issue #1685)
 //
@@ -882,6 +1127,7 @@ void MainWindow::beginStartupBreadcrumb()
         qDebug() << "STARTUP: previous launch did not finish starting up; discarding startup caches";
         QFile::remove(musicRootPath + "/.squaredesk/cache/pathStack.cache");
         QFile::remove(songLevelsCacheFilename());
+        QFile::remove(CuesheetMetadataCache::cacheFilename(musicRootPath));
     }
 
     QFile file(breadcrumb);
@@ -941,6 +1187,8 @@ bool MainWindow::loadPathStackCacheIfValid()
     // can't leave the real pathStacks half-populated
     QList<QString> newPathStack, newPathStackCuesheets, newPathStackReference;
     QMap<int, QString> newSoundFXpaths, newSoundFXnames;
+    QList<QStringList> dirRecords;  // D records are checked all together, below
+    QList<QStringList> parsedParts; // P records' filename parts, with the absolute entry prepended
 
     while (!in.atEnd()) {
         QString line = in.readLine();
@@ -949,20 +1197,15 @@ bool MainWindow::loadPathStackCacheIfValid()
         if (fields[0] == "D" && fields.size() == 3) {
             // fields[1] is "" for the music root itself, "/sub/dir" for everything below it
             dirCount++;
-            if (directoryFingerprint(musicRootPath + fields[1], &entryCount) != fields[2]) {
-                // contents added/removed/renamed here, or the directory is gone entirely
-                // (fingerprint "" never matches a stored hash) -> full rescan needed
-                tier1Log(QString("CHANGED at \"%1\" (full rescan)")
-                             .arg(fields[1].isEmpty() ? QString("<music root>") : fields[1]));
-                return false;
-            }
-        } else if ((fields[0] == "P" || fields[0] == "Q" || fields[0] == "R") && fields.size() == 2) {
+            dirRecords.append(fields);
+        } else if (((fields[0] == "Q" || fields[0] == "R") && fields.size() == 2) ||
+                   (fields[0] == "P" && fields.size() == 7)) {
             QString abs = absolutizePathStackEntry(fields[1], musicRootPath);
             if (abs.isEmpty()) {
                 tier1Log("CORRUPT ENTRY (full rescan)");
                 return false; // corrupt entry
             }
-            if      (fields[0] == "P") { newPathStack.append(abs); }
+            if      (fields[0] == "P") { newPathStack.append(abs); fields[1] = abs; parsedParts.append(fields); }
             else if (fields[0] == "Q") { newPathStackCuesheets.append(abs); }
             else                       { newPathStackReference.append(abs); }
         } else if (fields[0] == "S" && fields.size() == 4) {
@@ -979,10 +1222,61 @@ bool MainWindow::loadPathStackCacheIfValid()
         return false; // not even the music root's own record -- don't trust it
     }
 
+    // Fingerprint the directories in parallel: on a network or cloud-synced music root each
+    //   readdir() is mostly waiting, so overlapping them is where the time goes.  As soon as
+    //   one directory has changed the rest are skipped, since the answer is already "rescan";
+    //   the mismatch reported is the first one in file order, as it was when this was serial.
+    enum { kNotChecked = 0, kSame, kChanged };
+    QVector<int> verdicts(dirRecords.size(), kNotChecked);
+    std::atomic<bool> anyChanged(false);
+    std::atomic<int> checkedEntries(0);
+    QString root = musicRootPath;
+    QVector<int> indexes(dirRecords.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    QtConcurrent::blockingMap(ParallelDirWalker::pool(), indexes, [&](int i) {
+        if (anyChanged.load()) {
+            return;
+        }
+        int entries = 0;
+        // contents added/removed/renamed here, or the directory is gone entirely
+        // (fingerprint "" never matches a stored hash) -> full rescan needed
+        bool same = (directoryFingerprint(root + dirRecords[i][1], &entries) == dirRecords[i][2]);
+        checkedEntries += entries;
+        verdicts[i] = (same ? kSame : kChanged);  // each task writes only its own element
+        if (!same) {
+            anyChanged = true;
+        }
+    });
+    entryCount = checkedEntries.load();
+
+    if (anyChanged.load()) {
+        int firstChanged = static_cast<int>(verdicts.indexOf(kChanged));
+        tier1Log(QString("CHANGED at \"%1\" (full rescan)")
+                     .arg(dirRecords[firstChanged][1].isEmpty() ? QString("<music root>") : dirRecords[firstChanged][1]));
+        return false;
+    }
+
     tier1Log("UNCHANGED (no rescan)");
 
+    // remember the fingerprints just checked, so later changes can update just their own D records
+    pathStackCacheDirs.clear();
+    for (const QStringList &fields : std::as_const(dirRecords)) {
+        pathStackCacheDirs.insert(fields[1], fields[2]);
+    }
+
     // every directory's contents match: commit, mirroring what findFilesRecursively() appends
     pathStack->append(newPathStack);
+
+    // ...and hand the already-parsed filename parts to the song records (if the format pref has
+    //   changed since, darkLoadMusicList() will see the mismatch and parse them again)
+    for (const QStringList &fields : std::as_const(parsedParts)) {
+        SongRecord &rec = songRecords.record(songRecords.idFor(fields[1]));
+        rec.partsFormat = fields[2].toInt();
+        rec.label = fields[3];
+        rec.labelnum = fields[4];
+        rec.title = fields[5];
+        rec.shortTitle = fields[6];
+    }
     pathStackCuesheets->append(newPathStackCuesheets);
     pathStackReference->append(newPathStackReference);
 
@@ -1015,15 +1309,25 @@ bool MainWindow::findMusic(QString mainRootDir, bool refreshDatabase, bool force
 
     QString databaseDir(mainRootDir + "/.squaredesk");
 
+    cuesheetMetadata.setMusicRoot(mainRootDir); // no-op unless the music root changed
+
     if (refreshDatabase)
     {
+        songSettings.setUseLocalWorkingCopy(prefsManager.GetuseLocalSettingsDatabase());
         songSettings.openDatabase(databaseDir, mainRootDir, false);
+        fingerprintIndex.save();                  // anything new for the old music root...
+        fingerprintIndex.setMusicRoot(mainRootDir); // ...and the new one is loaded the first time it's needed
     }
     t.elapsed(__LINE__);
 
     // // always gets rid of the old pathstack and pathStackCuesheets
     pathStack->clear();
+    trackTypeCountsValid = false;  // recounted by the next updateTreeWidget()
+    songRecords.setMusicRoot(mainRootDir);  // BEFORE the records are made below (the cache load fills in their
+                                            //   parsed filename parts): setting a different root later would clear them all
+    songRecords.clear();  // a rescan starts from nothing, so the old records go with the old pathStack
     pathStackCuesheets->clear();
+    cuesheetMatchIndexDirty = true;  // rebuilt from the new pathStackCuesheets the next time it's needed
     pathStackReference->clear();  // this one was missing, so every rescan appended ANOTHER copy of
                                   //   the reference files, and the Dance Program pulldown grew a
                                   //   duplicate entry per program per rescan (Issue #1680)
@@ -1058,9 +1362,24 @@ bool MainWindow::findMusic(QString mainRootDir, bool refreshDatabase, bool force
         ui->statusBar->showMessage("Scanning Music Directory....");
         QCoreApplication::processEvents(); // show the message
 
-        findFilesRecursively(rootDir1, pathStack, pathStackCuesheets, pathStackReference, "", ui, &soundFXfilenames, &soundFXname);  // appends to the pathstack
+        findFilesRecursively(rootDir1, pathStack, pathStackCuesheets, pathStackReference, "", ui, &soundFXfilenames, &soundFXname, &cuesheetMetadata);  // appends to the pathstack
         savePathStackCache(); // must happen BEFORE Apple Music / playlist entries get appended below
+        cuesheetMetadata.retainOnly(*pathStackCuesheets);  // forget the cuesheets that are gone
+        cuesheetMetadata.save();
+    }
+
+    // Cuesheets that have never been read (new or changed since the last scan, or left over from a
+    //   session that quit before their background read finished) are read now, in the background,
+    //   instead of holding up startup. Their levels show up when that finishes.
+    QStringList unreadCuesheets;
+    for (const QString &s : std::as_const(*pathStackCuesheets)) {
+        QStringList parts = s.split("#!#");
+        if (parts.size() >= 2 && (parts.size() < 3 || parts[2].isEmpty()) && !cuesheetMetadata.contains(parts[1])) {
+            unreadCuesheets.append(parts[1]);
+        }
     }
+    refreshCuesheetLevelsInBackground(unreadCuesheets);
+    refreshCuesheetTextIndexInBackground();  // only the cuesheets/lyrics that are new or changed are read
 
     t.elapsed(__LINE__);
 
@@ -1124,6 +1443,97 @@ bool MainWindow::findMusic(QString mainRootDir, bool refreshDatabase, bool force
 // would have built it, so search/load/cuesheet-matching behave identically.
 void MainWindow::addFilesToPathStacks(const QStringList &copiedFilePaths)
 {
+    updatePathStacksIncrementally(copiedFilePaths, QStringList());
+}
+
+// Same, but for any mix of added and removed files (the inotify watcher reports renames as
+// remove + add, and a removed DIRECTORY removes everything below it). Removes are applied first,
+// so that a file that was deleted and then re-created ends up present.
+//
+// Everything here costs O(changed paths), not O(library): only the directories that held the
+// changed paths are re-fingerprinted, only the added songs get their levels computed (and only
+// the songs that a changed cuesheet can match are re-checked), and only the affected rows of the
+// darkSongTable are removed or added. A path that we already know about, and whose contents we
+// have already read (e.g. IN_CLOSE_WRITE after a tag editor rewrote an MP3), changes nothing.
+void MainWindow::updatePathStacksIncrementally(const QStringList &copiedFilePaths, const QStringList &removedPaths)
+{
+    struct CuesheetLevelChange {
+        QString type, path, oldLevel, newLevel;
+    };
+    QList<CuesheetLevelChange> levelChanges;  // cuesheets whose level came, went, or changed
+    QStringList removedSongs, addedSongs;     // origPaths
+    QStringList addedSongEntries;             // their pathStack entries
+    bool cuesheetsChanged = false;
+    QStringList changedPaths = removedPaths;  // for the pathStack cache's directory fingerprints
+
+    // path part of a "type#!#path" song or "type#!#path#!#level" cuesheet entry
+    auto entryPath = [](const QString &entry) {
+        qsizetype sep = entry.indexOf("#!#");
+        if (sep < 0) {
+            return QString();
+        }
+        QString path = entry.mid(sep + 3);
+        qsizetype extra = path.indexOf("#!#"); // cuesheet entries end with "#!#level"
+        if (extra >= 0) {
+            path.truncate(extra);
+        }
+        return path;
+    };
+    auto isRemovedPath = [&removedPaths](const QString &path) {
+        for (const QString &r : removedPaths) {
+            if (path == r || (path.startsWith(r) && path.at(r.length()) == '/')) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (!removedPaths.isEmpty()) {
+        auto isRemoved = [&](const QString &entry) {
+            QString path = entryPath(entry);
+            return !path.isEmpty() && isRemovedPath(path);
+        };
+        for (const QString &entry : std::as_const(*pathStack)) {
+            if (isRemoved(entry)) {
+                removedSongs.append(entryPath(entry));
+                songRecords.remove(entry);
+                if (trackTypeCountsValid) {
+                    countTrackType(entry, -1);
+                }
+            }
+        }
+        for (const QString &entry : std::as_const(*pathStackCuesheets)) {
+            if (isRemoved(entry)) {
+                songRecords.remove(entry);
+                QStringList parts = entry.split("#!#");
+                if (parts.size() >= 3 && !parts[2].isEmpty()) {
+                    levelChanges.append({parts[0], parts[1], parts[2], QString()});
+                }
+                cuesheetsChanged = true;
+            }
+        }
+        pathStack->removeIf(isRemoved);
+        pathStackCuesheets->removeIf(isRemoved);
+        if (!cuesheetMatchIndexDirty) {
+            cuesheetMatchIndex.removePaths(removedPaths);
+        }
+    }
+
+    // built on first use (after the removals above), so that each added file is a hash lookup
+    QSet<QString> songEntries;
+    QHash<QString, int> cuesheetIndexByPath;  // absolute path -> index in pathStackCuesheets
+    bool lookupsBuilt = false;
+    auto buildLookups = [&]() {
+        if (lookupsBuilt) {
+            return;
+        }
+        lookupsBuilt = true;
+        songEntries = QSet<QString>(pathStack->cbegin(), pathStack->cend());
+        for (int i = 0; i < pathStackCuesheets->size(); ++i) {
+            cuesheetIndexByPath.insert(entryPath(pathStackCuesheets->at(i)), i);
+        }
+    };
+
     for (const QString &finalPath : copiedFilePaths) {
         QFileInfo fi(finalPath);
         QString ext = fi.suffix().toLower();
@@ -1137,6 +1547,7 @@ void MainWindow::addFilesToPathStacks(const QStringList &copiedFilePaths)
             knownExtension = knownExtension || (ext == cuesheet_file_extensions[i]);
         }
         if (!knownExtension) {
+            changedPaths.append(finalPath); // e.g. a new directory, whose contents may not have been reported one by one
             continue;
         }
 
@@ -1144,56 +1555,151 @@ void MainWindow::addFilesToPathStacks(const QStringList &copiedFilePaths)
         QString newType = (fi.path().replace(musicRootPath + "/", "").split("/"))[0];
 
         if (newType == "soundfx" || newType == "sd" || newType == "choreography" || newType == "reference") {
+            changedPaths.append(finalPath);
             continue; // never import destinations; findFilesRecursively() keeps these off the song pathStacks
         }
 
         if (newType == "lyrics" || finalPath.endsWith(".html") || finalPath.endsWith(".htm")) {
-            QString entry = newType + "#!#" + finalPath + "#!#" + detectCuesheetLevel(finalPath);
             // a Replace copy re-imports an existing cuesheet, whose detected level may have
             // changed with the new contents: update the existing entry instead of duplicating it
             QString prefix = newType + "#!#" + finalPath + "#!#";
-            bool found = false;
-            for (int i = 0; i < pathStackCuesheets->size(); ++i) {
-                if (pathStackCuesheets->at(i).startsWith(prefix)) {
-                    (*pathStackCuesheets)[i] = entry;
-                    found = true;
-                    break;
-                }
+            buildLookups();
+            int found = cuesheetIndexByPath.value(finalPath, -1);
+            if (found >= 0 && !pathStackCuesheets->at(found).startsWith(prefix)) {
+                found = -1;
             }
-            if (!found) {
+            QString levelName;
+            bool alreadyRead = cuesheetMetadata.lookup(finalPath, &levelName);  // same size and mtime as when its level was read
+            if (found >= 0 && alreadyRead) {
+                continue; // known, and not changed since: nothing to do
+            }
+            if (!alreadyRead) {
+                levelName = detectCuesheetLevel(finalPath);
+                cuesheetMetadata.store(finalPath, levelName);
+            }
+            QString entry = prefix + levelName;
+            QString oldLevelName;
+            if (found >= 0) {
+                oldLevelName = pathStackCuesheets->at(found).mid(prefix.length());
+                (*pathStackCuesheets)[found] = entry;
+            } else {
+                cuesheetIndexByPath.insert(finalPath, pathStackCuesheets->size());
                 pathStackCuesheets->append(entry);
+                changedPaths.append(finalPath);
             }
+            if (!cuesheetMatchIndexDirty) {
+                cuesheetMatchIndex.insert(entry); // same replace-or-append as above
+            }
+            if (oldLevelName != levelName) {
+                levelChanges.append({newType, finalPath, oldLevelName, levelName});
+            }
+            cuesheetsChanged = cuesheetsChanged || (found < 0) || (oldLevelName != levelName);
         } else {
             QString entry = newType + "#!#" + finalPath;
-            if (!pathStack->contains(entry)) { // a Replace copy already has an entry
-                pathStack->append(entry);
+            buildLookups();
+            if (songEntries.contains(entry)) {
+                continue; // a Replace copy, or a rewrite in place: the entry, its row, and its levels are unchanged
+            }
+            songEntries.insert(entry);
+            pathStack->append(entry);
+            addedSongs.append(finalPath);
+            addedSongEntries.append(entry);
+            changedPaths.append(finalPath);
+            if (trackTypeCountsValid) {
+                countTrackType(entry, 1);
             }
         }
     }
 
-    // The steps below run even if the pathStacks did not change (e.g. every copy was a
-    // "Replace" of an existing file): a Replace still sets the NEW tag, so the table must
-    // refresh. (Since Issue #1703 a pure Replace no longer invalidates the cache at all --
-    // the filename is unchanged, so no directory's fingerprint moves -- but re-saving it
-    // is harmless, and keeps this path correct whatever the copies turned out to be.)
+    bool songsChanged = !removedSongs.isEmpty() || !addedSongs.isEmpty();
 
-    // Keep the startup cache valid: the copies just added filenames to their destination
-    // directories, which would otherwise invalidate the pathStack cache and force a full
-    // scan at the next launch (Issue #1669). This also makes any later spurious FileWatcher
-    // wakeup (e.g. iCloud's bird daemon touching xattrs after our 5s disable window) a cheap
-    // no-op instead of a full rescan. Apple Music entries appended to pathStack after the
-    // initial scan are excluded automatically: relativizePathStackEntry() drops paths not
-    // under the root.
-    savePathStackCache();
+    // Keep the startup cache valid: the changes just added (or removed) filenames in their
+    // directories, which would otherwise invalidate the pathStack cache and force a full scan
+    // at the next launch (Issue #1669). This also makes any later spurious FileWatcher wakeup
+    // (e.g. iCloud's bird daemon touching xattrs after our 5s disable window) a cheap no-op
+    // instead of a full rescan. Apple Music entries appended to pathStack after the initial
+    // scan are excluded automatically: relativizePathStackEntry() drops paths not under the root.
+    if (!changedPaths.isEmpty() || songsChanged || cuesheetsChanged) {
+        updatePathStackCacheForPaths(changedPaths, songsChanged || cuesheetsChanged);
+    }
+    cuesheetMetadata.save();
 
     // same Levels-column policy as findMusic(): only pay for it if it's in use
-    if (prefsManager.GetshowLevelsColumn() || songLevelsComputed) {
+    if (songLevelsComputed) {
+        for (const QString &origPath : std::as_const(removedSongs)) {
+            songLevelsByPath.remove(origPath);
+        }
+        for (const CuesheetLevelChange &c : std::as_const(levelChanges)) {
+            updateSongLevelsForOneCuesheet(c.path, c.type, c.oldLevel, c.newLevel);  // just the songs this one can match
+        }
+        computeSongLevelsForSongs(addedSongs);
+        if (songsChanged || !levelChanges.isEmpty()) {
+            saveSongLevelsCache();
+        }
+    } else if (prefsManager.GetshowLevelsColumn()) {
         computeSongLevels();
         songLevelsComputed = true;
+        refreshLevelsColumnDisplay();
     }
 
-    darkLoadMusicList(nullptr, currentTypeFilter, true, true); // refresh whichever pathStack is showing
-    darkFilterMusic();                                         // and re-apply the current search filter
+    if (!songsChanged) {
+        return; // (a Replace still sets the NEW tag, but songSettingChanged() redraws that row)
+    }
+
+    updateTreeWidgetTracks();  // a new (or now empty) type folder adds (or removes) just that node in the sidebar
+
+    if (currentlyShowingPathStack == pathStack) {
+        // just the rows that came or went, instead of reloading the whole darkSongTable
+        ui->darkSongTable->setSortingEnabled(false);
+        ui->darkSongTable->blockSignals(true);  // block signals, so changes are not recursive
+
+        if (!removedSongs.isEmpty()) {
+            for (int row = ui->darkSongTable->rowCount() - 1; row >= 0; row--) {
+                QString origPath = ui->darkSongTable->item(row, kPathCol)->data(Qt::UserRole).toString();
+                if (isRemovedPath(origPath)) {
+                    ui->darkSongTable->removeRow(row);
+                }
+            }
+        }
+
+        if (!addedSongs.isEmpty()) {
+            bool takeAll = isTopLevelTypeFilter(currentTypeFilter);
+            const QHash<QString, SongSetting> &settingsByFilename = songSettings.allSongSettings();
+            bool show_all_ages = ui->actionShow_All_Ages->isChecked();
+            QHash<QString, QString> agesByFilename;  // just the added songs, not getSongAges() for all of them
+            QIcon auditionIcon(":/graphics/icons8-square-play-button-100.png");
+            QHash<QString, bool> dirIsMusicRoot;
+
+            for (const QString &entry : std::as_const(addedSongEntries)) {
+                if (!takeAll && !matchesTypeFilter(entry, currentTypeFilter)) {
+                    continue;
+                }
+                SongRecord &rec = songRecords.record(songRecords.idFor(entry));
+                if (!rec.isMusic) {
+                    continue; // same as darkLoadMusicList(): songs only
+                }
+                QString path = rec.path();
+                agesByFilename.insert(songSettings.removeRootDirs(path),
+                                      songSettings.getSongAge(rec.baseName(), path, show_all_ages));
+                int row = ui->darkSongTable->rowCount();
+                ui->darkSongTable->insertRow(row);
+                if (!setDarkSongTableRow(row, rec, settingsByFilename, agesByFilename, auditionIcon, dirIsMusicRoot)) {
+                    ui->darkSongTable->removeRow(row);
+                }
+            }
+        }
+
+        ui->darkSongTable->blockSignals(false);  // unblock signals
+        ui->darkSongTable->setSortingEnabled(true);
+        sortDarkSongTable();  // the new rows go where the user's sort order puts them
+
+        darkSongSearchIndexDirty = true;  // rows came and went
+        if (!(typeSearch + labelSearch + titleSearch + textSearch).trimmed().isEmpty()) {
+            darkFilterMusic();  // hide the new rows that don't match the search (only then: it also moves the selection)
+        }
+    }
+
+    reloadTracksPaletteSlots();  // as darkLoadMusicList(..., reloadPaletteSlots = true) used to do here
 
     ui->statusBar->showMessage(QString("Songs found: %1").arg(QString::number(pathStack->size())));
 }
@@ -1203,6 +1709,17 @@ void MainWindow::filterMusic()
     // OBSOLETE
 }
 
+// strip the title coloring and locate the tags (title_end = where they start, or -1), once per
+//   string, so that the search index can store the result instead of redoing it on every keystroke
+static QString normalizeForFilter(QString str, int *title_end)
+{
+    str.replace(spanPrefixRemover, "\\1"); // remove <span style="color:#000000"> and </span> title string coloring
+
+    *title_end = static_cast<int>(str.indexOf(title_tags_remover)); // locate tags
+    str.replace(title_tags_remover, " ");
+    return str;
+}
+
 bool filterContains(QString str, const QStringList &list)
 {
     if (list.isEmpty())
@@ -1210,52 +1727,30 @@ bool filterContains(QString str, const QStringList &list)
     //    // Make "it's" and "its" equivalent.
     //    str.replace("'","");
 
-    str.replace(spanPrefixRemover, "\\1"); // remove <span style="color:#000000"> and </span> title string coloring
-
-    int title_end = str.indexOf(title_tags_remover); // locate tags
-    str.replace(title_tags_remover, " ");
-
-    int index = 0;
-
-    if (title_end < 0) title_end = str.length();
+    int title_end;
+    QString normalized = normalizeForFilter(str, &title_end);
+    return SongSearchIndex::containsWords(normalized, title_end, list);
+}
 
-    for (const auto &t : list)
-    {
-        QString filterWord(t);
-        bool tagsOnly(false);
-        bool exclude(false);
-
-        while (filterWord.length() > 0 &&
-               ('#' == filterWord[0] ||
-                '-' == filterWord[0]))
-        {
-            tagsOnly = ('#' == filterWord[0]);
-            exclude = ('-' == filterWord[0]);
-            filterWord.remove(0,1);
-        }
-        if (filterWord.length() == 0)
-            continue;
+// (re)build the darkSongTable search index, one index row per table row (in the current sort order)
+void MainWindow::rebuildDarkSongSearchIndex()
+{
+    PerfTimer t("rebuildDarkSongSearchIndex", __LINE__);
+    t.start(__LINE__);
 
-        // Keywords can get matched in any order
-        if (index > title_end)
-            index = title_end;
-        int i = str.indexOf(filterWord,
-                            tagsOnly ? title_end : (exclude ? 0 : index),
-                            Qt::CaseInsensitive);
-        if (i < 0)
-        {
-            if (!exclude)
-                return false;
-        }
-        else
-        {
-            if (exclude)
-                return false;
-        }
-        if (!tagsOnly && !exclude)
-            index = i + t.length();
+    darkSongSearchIndex.clear();
+    for (int i = 0; i < ui->darkSongTable->rowCount(); i++) {
+        QTableWidgetItem *titleItem = ui->darkSongTable->item(i, kTitleCol);
+        QString texts[SongSearchIndex::NumFields];
+        int titleEnds[SongSearchIndex::NumFields];
+        texts[SongSearchIndex::LabelField] = normalizeForFilter(ui->darkSongTable->item(i, kLabelCol)->text(), &titleEnds[SongSearchIndex::LabelField]);
+        texts[SongSearchIndex::TypeField]  = normalizeForFilter(ui->darkSongTable->item(i, kTypeCol)->text(),  &titleEnds[SongSearchIndex::TypeField]);
+        texts[SongSearchIndex::TitleField] = normalizeForFilter(titleItem->data(kTitleHTMLRole).toString(),   &titleEnds[SongSearchIndex::TitleField]);
+        darkSongSearchIndex.addRow(texts, titleEnds, reinterpret_cast<quintptr>(titleItem));
     }
-    return true;
+    darkSongSearchIndexDirty = false;
+
+    t.stop(__LINE__);
 }
 
 // --------------------------------------------------------------------------------
@@ -1280,47 +1775,53 @@ void MainWindow::darkFilterMusic()
     ui->darkSongTable->setSortingEnabled(false);
 
     int initialRowCount = ui->darkSongTable->rowCount();
-    int rowsVisible = initialRowCount;
-    int firstVisibleRow = -1;
-    for (int i=0; i<ui->darkSongTable->rowCount(); i++) {
-//        QString songTitle = getTitleColText(ui->darkSongTable, i);
-        QString songTitle = dynamic_cast<QLabel*>(ui->darkSongTable->cellWidget(i, kTitleCol))->text();
-
-        QString songType = ui->darkSongTable->item(i,kTypeCol)->text();
-        QString songLabel = ui->darkSongTable->item(i,kLabelCol)->text();
-
-        bool show = true;
-
-        // if (!filterContains(songLabel,label)
-        //     || !filterContains(songType, type)
-        //     || !filterContains(songTitle, title))
-        // {
-        //     show = false;
-        // }
-
-        // qDebug() << "filter: " << searchAllFields << songTitle << title << filterContains(songTitle, title);
-        // show = (searchAllFields
-        //           ? filterContains(songLabel,label) || filterContains(songType, type) || filterContains(songTitle, title)
-        //           : !(!filterContains(songLabel,label) || !filterContains(songType, type) || !filterContains(songTitle, title))
-        //             );
-
-        if (!searchAllFields) {
-            if (!filterContains(songLabel,label) || !filterContains(songType, type) || !filterContains(songTitle, title))
-            {
-                show = false;
-            }
-        } else {
-            // search all fields with a single word, e.g. "foo",
-            // in this case, the titleSearch variable contains the thing to search for
-            if (!filterContains(songLabel,title) && !filterContains(songType, title) && !filterContains(songTitle, title)) {
-                show = false;
+
+    // the index is one row per table row, so it has to be rebuilt if the table was reloaded, retagged or re-sorted
+    //   (checking the title item of each row is just a pointer compare, much cheaper than the old regex per row)
+    bool indexValid = !darkSongSearchIndexDirty && darkSongSearchIndex.rowCount() == initialRowCount;
+    for (int i = 0; indexValid && i < initialRowCount; i++) {
+        indexValid = (darkSongSearchIndex.rowTag(i) == reinterpret_cast<quintptr>(ui->darkSongTable->item(i, kTitleCol)));
+    }
+    if (!indexValid) {
+        rebuildDarkSongSearchIndex();
+    }
+    t.elapsed(__LINE__);
+
+    // if (!filterContains(songLabel,label)
+    //     || !filterContains(songType, type)
+    //     || !filterContains(songTitle, title))
+    // {
+    //     show = false;
+    // }
+    //
+    // searchAllFields: search all fields with a single word, e.g. "foo",
+    //   in this case, the titleSearch variable contains the thing to search for
+    QVector<int> matchingRows = darkSongSearchIndex.match(label, type, title, searchAllFields); // ascending
+
+    if (!textSearch.trimmed().isEmpty()) {
+        // "words: only the songs whose cuesheet or lyrics contain them (full-text index, not the table)
+        QSet<QString> songPaths, songBaseNames;
+        findSongsByIndexedText(textSearch, songPaths, songBaseNames);
+        QVector<int> textMatchingRows;
+        for (int row : std::as_const(matchingRows)) {
+            QString path = ui->darkSongTable->item(row, kPathCol)->data(Qt::UserRole).toString();
+            if (songPaths.contains(path) || songBaseNames.contains(QFileInfo(path).completeBaseName())) {
+                textMatchingRows.append(row);
             }
         }
+        matchingRows = textMatchingRows;
+    }
 
-        ui->darkSongTable->setRowHidden(i, !show);
-        rowsVisible -= (show ? 0 : 1); // decrement row count, if hidden
-        if (show && firstVisibleRow == -1) {
-            firstVisibleRow = i;
+    int rowsVisible = static_cast<int>(matchingRows.size());
+    int firstVisibleRow = (matchingRows.isEmpty() ? -1 : matchingRows.first());
+    int next = 0;
+    for (int i=0; i<initialRowCount; i++) {
+        bool show = (next < matchingRows.size() && matchingRows[next] == i);
+        if (show) {
+            next++;
+        }
+        if (ui->darkSongTable->isRowHidden(i) == show) {
+            ui->darkSongTable->setRowHidden(i, !show);  // only touch the rows that actually change
         }
     }
     ui->darkSongTable->setSortingEnabled(true);
@@ -1347,6 +1848,21 @@ void MainWindow::loadMusicList()
     // OBSOLETE
 }
 
+// NOTE: lack of final slash, means this is top level request
+static bool isTopLevelTypeFilter(const QString &typeFilter)
+{
+    return (typeFilter == "") || (typeFilter == "Tracks") || (typeFilter == "Playlists") || (typeFilter == "Apple Music");
+}
+
+// true iff this pathStack entry belongs under the typeFilter (a treeWidget node) below the top level
+static bool matchesTypeFilter(const QString &item, const QString &typeFilter)
+{
+    return item.startsWith(typeFilter + "#!#")   // Tracks (type must exactly equal, not just a prefix of)
+        || item.startsWith(typeFilter + "%!%")   // SquareDesk playlists (e.g. "Jokers/2024/Jokers_2024.01.23")
+        || item.startsWith(typeFilter + "$!$")   // Apple playlists
+        || (typeFilter.endsWith("/") && item.startsWith(typeFilter));  // SquareDesk non-leaf playlists (e.g. "Jokers/2024")
+}
+
 // --------------------------------------------------------------------------------
 // filter from a pathStack into the darkSongTable, BUT
 //   nullptr: just refresh what's there (currentlyShowingPathStack)
@@ -1448,6 +1964,7 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
 
     // clear out the table
     ui->darkSongTable->setRowCount(0);
+    darkSongSearchIndexDirty = true;  // new items, maybe at the same addresses as the old ones
     ui->darkSongTable->setColumnCount(9);
 
     QStringList m_TableHeader;
@@ -1463,7 +1980,6 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
 
     QListIterator<QString> iter(*aPathStack); // filter the one we were given (pathStack, pathStackPlaylists, pathStackApplePlaylists), OR refresh the last one
 
-    QColor textCol = QColor::fromRgbF(0.0/255.0, 0.0/255.0, 0.0/255.0);  // defaults to Black
     bool show_all_ages = ui->actionShow_All_Ages->isChecked();
 
     // first, filter down to just those string that are the type we are looking for -------
@@ -1471,7 +1987,7 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
     // static QRegularExpression typeFilterRegex(startsWithTypeFilter);
     // QStringList justMyType = aPathStack->filter(typeFilterRegex);
 
-    bool takeAll = (typeFilter == "") || (typeFilter == "Tracks") || (typeFilter == "Playlists") || (typeFilter == "Apple Music"); // NOTE: lack of final slash, means this is top level request
+    bool takeAll = isTopLevelTypeFilter(typeFilter);
     // qDebug() << "darkLoadMusicList filtering:" << typeFilter << takeAll;
 
     // NOTE: Items can look like:
@@ -1480,23 +1996,16 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
     // "StarEights/StarEights_2024.07.21%!%0,126,03#!#/Users/mpogue/Library/Mobile Documents/com~apple~CloudDocs/SquareDance/squareDanceMusic_iCloud/patter/TBT 918 - Bad Guy.mp3"
     // "Second Playlist$!$04$!$Butterfly (Instrumental)#!#/Users/mpogue/Music/iTunes/iTunes Media/Music/Swingrowers/Butterfly - Single/02 Butterfly (Instrumental).m4a"
 
-    QStringList justMyType;
-    QString typeFilterNarrow  = typeFilter + "#!#"; // type must exactly equal, not just a prefix of
-    QString typeFilterNarrow2 = typeFilter + "%!%"; // special delimiter for SquareDesk playlists
-    QString typeFilterNarrow2b = typeFilter;        // special case for non-leaf nodes of SquareDesk playlists
-    QString typeFilterNarrow3 = typeFilter + "$!$"; // special delimiter for Apple playlists
-    QRegularExpression reTypeFilterNarrow2(typeFilterNarrow2);
+    // every entry is split ONCE into a SongRecord (type, path, baseName, suffix, ...), and then only the
+    //   record ids are passed around, rather than re-splitting the "type#!#path" strings on every reload
+    songRecords.setMusicRoot(musicRootPath);
 
+    QVector<int> justMyType;
     for (auto const &item : *aPathStack) {
         // qDebug() << "ITEM:" << item;
-        if (takeAll
-                || item.startsWith(typeFilterNarrow) // Tracks
-                || item.startsWith(typeFilterNarrow2) // SquareDesk playlists (e.g. "Jokers/2024/Jokers_2024.01.23")
-                || item.startsWith(typeFilterNarrow3) // Apple playlists
-                || (typeFilter.endsWith("/") && item.startsWith(typeFilterNarrow2b))  // SquareDesk non-leaf playlists (e.g. "Jokers/2024")
-            ) {
+        if (takeAll || matchesTypeFilter(item, typeFilter)) {
             // qDebug() << "TAKEN:" << item;
-            justMyType.append(item);
+            justMyType.append(songRecords.idFor(item));
         }
     }
     t.elapsed(__LINE__);
@@ -1506,8 +2015,13 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
     // second, make sure that only audio files are left  -------
     // iterate over every item in the pathStack, and stick songs into the songTable
     //   with their SQLITE DB info populated later (when songs are visible)
-    static QRegularExpression musicRegex(".*\\.(mp3|m4a|wav|flac)$", QRegularExpression::CaseInsensitiveOption); // match with music extensions
-    QStringList justMusic = justMyType.filter(musicRegex); // we are interested only in songs here
+    QVector<int> justMusic; // we are interested only in songs (mp3|m4a|wav|flac) here
+    justMusic.reserve(justMyType.size());
+    for (int id : std::as_const(justMyType)) {
+        if (songRecords.record(id).isMusic) {
+            justMusic.append(id);
+        }
+    }
     t.elapsed(__LINE__);
 
     // qDebug() << "justMusic.size() = " << justMusic.size();
@@ -1519,19 +2033,16 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
     // instead of ~3 single-row queries per song inside the loop below (SQLite is much
     // faster at one big SELECT than at thousands of small ones). The loop then does
     // cheap hash lookups, keyed by the music-root-relative path (see removeRootDirs()).
-    QHash<QString, SongSetting> settingsByFilename;
-    songSettings.loadSettingsForAllSongs(settingsByFilename);
+    const QHash<QString, SongSetting> &settingsByFilename = songSettings.allSongSettings();  // after the first time, no SELECT at all
 
     QHash<QString, QString> agesByFilename;
     songSettings.getSongAges(agesByFilename, show_all_ages);
 
     t.elapsed(__LINE__);
 
-    // The font that we'll use for the QLabels that are used to implement the Title-with-Tags field.
-    // Use the current zoomed font (kept up-to-date by setSongTableFont), so that the Title column
-    //   reflects the current zoom level when the table is repopulated, e.g. by clicking in the
-    //   treeWidget (Issue #1654).
-    QFont darkSongTableFont = currentSongTableFont;
+    // NOTE: the Title-with-Tags field is painted by the DarkSongTitleDelegate, whose font is kept up-to-date
+    //   by setSongTableFont, so the Title column reflects the current zoom level when the table is
+    //   repopulated, e.g. by clicking in the treeWidget (Issue #1654).
 
     // int totalNumberOfSquareDeskSongs = 0;
     // int totalNumberOfAppleSongs = 0;
@@ -1544,329 +2055,10 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
     QHash<QString, bool> dirIsMusicRoot; // fi.path() -> (canonicalPath of that dir == musicRootPath)
 
     int i = 0;
-    for (const auto &s : justMusic) {
-        // qDebug() << "s:" << s;
-        QStringList sl1 = s.split("#!#");
-
-        QString type     = sl1[0];  // the type (of original pathname, before following aliases)
-        QString origPath = sl1[1];  // everything else
-
-        // NO:
-        // QStringList pathParts = origPath.split("/");
-        // QString typeFromPath = pathParts[pathParts.size()-2]; // second-to-last path part is the assumed type
-
-        // YES:
-        QString typeFromPath = filepath2SongCategoryName(origPath);
-
-        QFileInfo fi(origPath);
-        QString dirPath = fi.path();
-        auto dirIter = dirIsMusicRoot.constFind(dirPath);
-        if (dirIter == dirIsMusicRoot.constEnd()) {
-            dirIter = dirIsMusicRoot.insert(dirPath, QFileInfo(dirPath).canonicalFilePath() == musicRootPath);
-        }
-        if (dirIter.value()) {
-            typeFromPath = ""; // song lives directly in the music root dir, so it has no type
-        }
-
-        // qDebug() << "origPath: " << origPath;
-        // double check that type is non-music type (see Issue #298)
-        if (type == "reference" || type == "soundfx" || type == "sd") {
-            continue;
+    for (int id : std::as_const(justMusic)) {
+        if (setDarkSongTableRow(i, songRecords.record(id), settingsByFilename, agesByFilename, auditionIcon, dirIsMusicRoot)) {
+            i++;
         }
-
-        // --------------------------------
-        QString label = "";
-        QString labelnum = "";
-        QString labelnum_extra = "";
-        QString title = "";
-        QString shortTitle = "";
-        QString baseName = fi.completeBaseName();        
-
-        // e.g. "/Users/mpogue/__squareDanceMusic/patter/RIV 307 - Going to Ceili (Patter).mp3" --> "RIV 307 - Going to Ceili (Patter)"
-        breakFilenameIntoParts(baseName, label, labelnum, labelnum_extra, title, shortTitle);
-        labelnum += labelnum_extra;
-
-        QString pitchOverride = "";
-        QString tempoOverride = "";
-
-        if (type.contains("$!$")) {
-            // This is Apple Music, so we're going to override everything that breakFilenameIntoParts did (or tried to do)
-            // e.g. "ApplePlaylistName$!$lineNumber$!$Short Title from Apple Music#!#FullPathname"
-            QStringList sl10 = type.split("$!$");
-            QString ApplePlaylistName = sl10[0];
-            QString AppleLineNumber = sl10[1];
-            label = "Apple Music";
-            title = sl10[2];
-            shortTitle = title;
-
-            QString appleSymbol = QChar(0xF8FF);  // use APPLE symbol for Apple Music (sorts at the bottom)
-            // QString appleSymbol = QChar(0x039E);  // use GREEK XI for Local Playlists (sorts almost at the bottom, and looks like a playlist!)
-            type = appleSymbol + " " + sl10[0] + " " + AppleLineNumber; // this is tricky.  Leading Apple will force sort to bottom for "<APPLESYMBOL> Apple Playlist Name".
-            labelnum = "";
-            labelnum_extra = "";
-            // totalNumberOfAppleSongs++;
-        } else if (type.contains("%!%")) {
-            // This is a SquareDesk Playlist, so we're going to override everything that breakFilenameIntoParts did (or tried to do)
-            // e.g. "SquareDeskPlaylistName%!%pitch,tempo#!#FullPathname"
-            QStringList sl11 = type.split("%!%");
-            QStringList sl11a = sl11[0].split("/");
-            QString playlistName = sl11[0];
-            QString pitchTempo = sl11[1];
-            QStringList sl12 = pitchTempo.split(",");
-            QString pitchOverride = sl12[0]; // TODO: implement this!
-            QString tempoOverride = sl12[1]; // not "" if there is an override because playlist
-            QString lineNumber = sl12[2];
-            type = sl11a[sl11a.size()-1] + " " + lineNumber;  // take only the last part of the hierarchical playlist name, tack on a line number for sorting
-            // label = "Playlist";
-            // title = lineNumber + " - " + title; // use the default SquareDesk name (from the FullPathname), but prepend the line number and a dash
-            shortTitle = title;
-
-            // For Type 2 Apple Music items (playlistName starts with \uF8FF), override the
-            // filename-derived title with the actual Apple Music title (no track number, has colons).
-            if (playlistName.startsWith(QChar(0xF8FF))) {
-                for (const auto& sl : std::as_const(allAppleMusicPlaylists)) {
-                    if (sl[2] == origPath) {
-                        title = sl[1];
-                        title.replace("/", "_"); // '/' not valid in filenames; use '_' for consistency with palette slot
-                        shortTitle = title;
-                        break;
-                    }
-                }
-                // For hierarchical playlists, the last path component loses the \uF8FF prefix.
-                // Re-add it so the Type field shows "XI APPLEICON PlaylistName XX" consistently.
-                if (!type.startsWith(QChar(0xF8FF))) {
-                    type = QString(QChar(0xF8FF)) + " " + type;
-                }
-            }
-
-            QString GreekXi = QChar(0x039E);  // use GREEK XI for Local Playlists (sorts almost at the bottom, and looks like a playlist!)
-            type = GreekXi + " " + type; // this is tricky.  Leading GREEK XI will force sort to almost bottom for "<GREEKXI> SquareDesk Playlist Name".
-            // labelnum = "";
-            // labelnum_extra = "";
-        } else {
-            // totalNumberOfSquareDeskSongs++; // only count songs, not playlist entries
-        }
-
-        // User preferences for colors
-        // qDebug() << "origPath/typeFromPath:" << typeFromPath << origPath;
-        QString cType = typeFromPath.toLower();  // type for Color purposes
-        if (cType.right(1)=="*") {
-            cType.chop(1);  // remove the "*" for the purposes of coloring
-        }
-
-        // if (songTypeNamesForExtras.contains(cType)) {
-        //     textCol = QColor(extrasColorString);
-        // }
-        // else if (songTypeNamesForPatter.contains(cType)) {
-        //     textCol = QColor(patterColorString);
-        // }
-        // else if (songTypeNamesForSinging.contains(cType)) {
-        //     textCol = QColor(singingColorString);
-        // }
-        // else if (songTypeNamesForCalled.contains(cType)) {
-        //     textCol = QColor(calledColorString);
-        // } else {
-        //     // textCol = QColor(QColor("#A0A0A0"));  // if not a recognized type, color it white-ish
-        //     textCol = QColor(extrasColorString);  // if not a recognized type, color it the xtras color (so user can control it)
-        // }
-
-        if (cType == "patter") {
-            textCol = QColor(patterColorString);
-        } else if (cType == "singing") {
-            textCol = QColor(singingColorString);
-        } else if (cType == "called") {
-            textCol = QColor(calledColorString);
-        } else if (cType == "extras") {
-            textCol = QColor(extrasColorString);
-        } else {
-            textCol = QColor(extrasColorString); // if not a recognized type, color it the xtras color (so user can control it)
-        }
-
-        QBrush textBrush(textCol); // make a brush for most of the widgets
-
-        // PLAYLIST HANDLING -----
-        // NOTE: PLAYLISTS NOT IN DARK SONG TABLE!
-        // look up origPath in the path2playlistNum map, and reset the s2 text to the user's playlist # setting (if any)
-        // QString s2("");
-        // if (path2playlistNum.contains(origPath)) {
-        //     s2 = path2playlistNum[origPath];
-        // }
-        // TableNumberItem *newTableItem4 = new TableNumberItem(s2);
-
-        // newTableItem4->setTextAlignment(Qt::AlignCenter);
-        // newTableItem4->setForeground(textCol);
-        // // # items are editable by default
-        // ui->darkSongTable->setItem(i, kNumberCol, newTableItem4);
-
-        // # COLUMN IS NOW USED FOR AUDITION BUTTONS -----
-        QTableWidgetItem *auditionItem = new QTableWidgetItem();
-
-        // parented to the table, so the button always has an owner. setCellWidget() below
-        //   reparents it to the table's viewport, which is where it ends up either way --
-        //   this just means it is never briefly a parentless top-level widget. (Issue #1687)
-        auditionButton *auditionButton1 = new auditionButton(ui->darkSongTable);
-        auditionButton1->setFlat(true);
-        auditionButton1->setObjectName("auditionButton");
-        auditionButton1->origPath = origPath;
-
-        connect(auditionButton1, &QPushButton::pressed, this,
-                [this]() {
-                    auditionSingleShotTimer.stop();
-                    auditionInProgress = true;
-                    // qDebug() << "setting auditionInProgress to true";
-
-                    QString origPath = ((auditionButton *)(sender()))->origPath;
-                    // qDebug() << "AUDITION PATH:" << origPath;
-
-                    auditionSetStartMs(origPath);
-
-                    // QModelIndexList list = this->ui->darkSongTable->selectionModel()->selectedRows();
-                    // int row = list.at(0).row();
-                    // QString origPath = this->ui->darkSongTable->item(row,kPathCol)->data(Qt::UserRole).toString();
-                    // // qDebug() << "QPushButton pressed, row:" << row << origPath;
-
-                    this->auditionPlayer.setSource(QUrl::fromLocalFile(origPath));
-                    
-                    // Use the selected audition playback device, or default if not set
-                    QAudioDevice selectedDevice;
-                    if (!auditionPlaybackDeviceName.isEmpty()) {
-                        selectedDevice = getAudioDeviceByName(auditionPlaybackDeviceName);
-                    } else {
-                        selectedDevice = QMediaDevices::defaultAudioOutput();
-                    }
-                    QAudioOutput *audioOutput = new QAudioOutput(selectedDevice);
-                    
-                    this->auditionPlayer.setAudioOutput(audioOutput);
-                    this->auditionPlayer.play();
-                });
-
-        connect(auditionButton1, &QPushButton::released, this,
-                [this]() {
-                    // QModelIndexList list = this->ui->darkSongTable->selectionModel()->selectedRows();
-                    // int row = list.at(0).row();
-                    // QString origPath = this->ui->darkSongTable->item(row,kPathCol)->data(Qt::UserRole).toString();
-                    // qDebug() << "QPushButton released, row:" << row << origPath;
-                    this->auditionPlayer.stop();
-                    this->ui->darkSongTable->setFocus(); // just released a button, so set focus back to the darkSongTable
-
-                    auditionSingleShotTimer.start(1000);
-                    // qDebug() << "KLUDGE: setting auditionInProgress to false 1000 ms in the future";
-                    //  While this is kludgey, I'm not sure that there's an alternative.  If you press an audition button,
-                    //  and move off the button (with Left Mouse Button still down), it will initiate a drag and drop, which
-                    //  we do not want.  This timer gives you one second to let the left button up, before a drag and drop is inferred.
-                    //  In my testing, that seemed about right.  No false drag and drops, but normal drag and drop still works as expected.
-                });
-
-        // QIcon playbackIcon = QIcon::fromTheme(QIcon::ThemeIcon::MultimediaPlayer);
-
-        auditionButton1->setIcon(auditionIcon); // shared QIcon, decoded once before the loop (Issue #1669)
-
-        // auditionButton1->setIconSize(QSize(26,26));
-
-        ui->darkSongTable->setItem(i, kNumberCol, auditionItem);
-        ui->darkSongTable->setCellWidget(i, kNumberCol, auditionButton1);
-
-        // TYPE FIELD -----
-        QTableWidgetItem *twi1 = new QTableWidgetItem(type);
-        twi1->setForeground(textBrush);
-        twi1->setFlags(twi1->flags() & ~Qt::ItemIsEditable);      // not editable
-        ui->darkSongTable->setItem(i, kTypeCol, twi1);
-
-        // LABEL + LABELNUM FIELD -----
-        QTableWidgetItem *twi2 = new QTableWidgetItem(label + " " + labelnum);
-        twi2->setForeground(textBrush);
-        twi2->setFlags(twi2->flags() & ~Qt::ItemIsEditable);      // not editable
-        ui->darkSongTable->setItem(i, kLabelCol, twi2);
-
-//         INVISIBLE TABLE WIDGET ITEM -----
-//         FYI: THIS IS FOR SORTING...
-        InvisibleTableWidgetItem *titleItem(new InvisibleTableWidgetItem(title));
-        titleItem->setFlags(titleItem->flags() & ~Qt::ItemIsEditable);      // not editable
-        ui->darkSongTable->setItem(i, kTitleCol, titleItem);
-
-        // TITLE WIDGET (WITH TAGS) -----
-        QString normalizedPath = songSettings.removeRootDirs(origPath);
-        SongSetting settings = settingsByFilename.value(normalizedPath); // batch-fetched above (default SongSetting, if not in the DB)
-        if (settings.isSetTags()) {
-            songSettings.addTags(settings.getTags());
-        }
-
-        // format the title string --
-        QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags(), textCol.name()));
-        darkSongTitleLabel *titleLabel = new darkSongTitleLabel(this);
-        titleLabel->setTextFormat(Qt::RichText);
-        titleLabel->setText(titlePlusTags);
-        titleLabel->textColor = textCol.name();  // remember the text color, so we can restore it when deselected
-        titleLabel->setFont(darkSongTableFont);
-
-        ui->darkSongTable->setCellWidget(i, kTitleCol, titleLabel);
-
-        // LEVELS FIELD -----
-        QTableWidgetItem *twiLevels = new QTableWidgetItem(songLevelsByPath.value(origPath, ""));
-        twiLevels->setForeground(textBrush);
-        twiLevels->setTextAlignment(Qt::AlignCenter);
-        twiLevels->setFlags(twiLevels->flags() & ~Qt::ItemIsEditable);      // not editable
-        ui->darkSongTable->setItem(i, kLevelsCol, twiLevels);
-
-        // AGE FIELD -----
-        QString ageString = agesByFilename.value(normalizedPath); // batch-fetched above
-        if (ageString.isEmpty()) {
-            // fallback for legacy DB rows keyed by base filename instead of relative path
-            // (same fallback order as getSongAge())
-            ageString = agesByFilename.value(fi.completeBaseName());
-        }
-        QString ageAsIntString = ageToIntString(ageString);
-        QTableWidgetItem *twi4 = new TableNumberItem(ageAsIntString); // TableNumberItem so it's numerically sortable
-        twi4->setForeground(textBrush);
-        twi4->setTextAlignment(Qt::AlignCenter);
-        twi4->setFlags(twi4->flags() & ~Qt::ItemIsEditable);      // not editable
-        // qDebug() << "TITLE/AGE:" << title << ageString << ageAsIntString;
-        ui->darkSongTable->setItem(i, kAgeCol, twi4);
-
-        // RECENT FIELD (must come after AGE field, because it uses age to determine recent string) -----
-        QString recentString = ageToRecent(ageString);  // passed as double string
-        QTableWidgetItem *twi4b = new QTableWidgetItem(recentString);
-        twi4b->setForeground(textBrush);
-        twi4b->setTextAlignment(Qt::AlignCenter);
-        twi4b->setFlags(twi4b->flags() & ~Qt::ItemIsEditable);      // not editable
-        ui->darkSongTable->setItem(i, kRecentCol, twi4b);
-
-        // ((darkSongTitleLabel *)(ui->darkSongTable->cellWidget(i, kTitleCol)))->setSongUsed(true || recentString != ""); // rewrite the song's title to be strikethrough and/or green background
-
-        // PITCH FIELD -----
-        int pitch = 0;
-        if (settings.isSetPitch()) { pitch = settings.getPitch(); }
-
-        QTableWidgetItem *twi5 = new QTableWidgetItem(QString("%1").arg(pitch));
-        twi5->setForeground(textBrush);
-        twi5->setTextAlignment(Qt::AlignCenter);
-        twi5->setFlags(twi5->flags() & ~Qt::ItemIsEditable);      // not editable
-        ui->darkSongTable->setItem(i, kPitchCol, twi5);
-
-        // TEMPO FIELD -----
-        int tempo = 0;
-        bool loadedTempoIsPercent(false);
-        if (settings.isSetTempo()) { tempo = settings.getTempo(); }
-        if (settings.isSetTempoIsPercent()) { loadedTempoIsPercent = settings.getTempoIsPercent(); }
-        QString tempoStr = QString("%1").arg(tempo);
-        if (loadedTempoIsPercent) tempoStr += "%";
-        //        qDebug() << "loadMusicList() is setting the kTempoCol to: " << tempoStr;
-
-        QTableWidgetItem *twi6 = new QTableWidgetItem(QString("%1").arg(tempoStr));
-        twi6->setForeground(textBrush);
-        twi6->setTextAlignment(Qt::AlignCenter);
-        twi6->setFlags(twi6->flags() & ~Qt::ItemIsEditable);      // not editable
-        ui->darkSongTable->setItem(i, kTempoCol, twi6);
-
-        // PATH FIELD (VARIANT SAVED IN INVISIBLE LOCATION) -----
-        // keep the path around, for loading in when we double click on it
-        ui->darkSongTable->item(i, kPathCol)->setData(Qt::UserRole, QVariant(origPath)); // path set on cell in col 0
-
-//        if (i < 10) {
-//            qDebug() << type << label << labelnum << title << shortTitle; // << titlePlusTags;
-//        }
-
-        i++;
     }
 
     t.elapsed(__LINE__);
@@ -1882,26 +2074,7 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
     ui->darkSongTable->blockSignals(false);  // unblock signals
     ui->darkSongTable->setSortingEnabled(true);
 
-    // performance -----
-    // these must be in "backwards" order to get the right order, which
-    //   is that Type is primary, Title is secondary, Label is tertiary
-    // qDebug() << "darkLoadMusicList::sortItems";
-
-    // NOTE: here is where we set the sort order
-
-    QString desiredSortOrder = prefsManager.GetcurrentSortOrder();
-    // qDebug() << "darkLoadMusicList desiredSortOrder: " << desiredSortOrder;
-    if (desiredSortOrder == "") {
-        // it hasn't been set yet!
-        // ui->darkSongTable->sortItems(kLabelCol);  // sort last by label/label #
-        // ui->darkSongTable->sortItems(kTitleCol);  // sort second by title in alphabetical order
-        // ui->darkSongTable->sortItems(kTypeCol);   // sort first by type (singing vs patter)
-        // qDebug() << "setting to default sort order!";
-        sortByDefaultSortOrder();  // this will be persisted...
-    } else {
-        // qDebug() << "setting to new sort order!" << desiredSortOrder;
-        ui->darkSongTable->setOrderFromString(desiredSortOrder);
-    }
+    sortDarkSongTable();
 
     // qDebug() << "darkLoadMusicList::DONE with sortItems";
 
@@ -1965,16 +2138,7 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
         // now, if we just loaded the darkMusicList, we have to check the palette slots, to see if they need to
         //  be reloaded, too.  This normally happens just when the fileWatcher is triggered.
         // qDebug() << "reloading the palette slots too";
-        for (int i = 0; i < 3; i++) {
-    //        qDebug() << "TRACKS? " << relPathInSlot[i];
-            if (relPathInSlot[i].startsWith("/tracks")) {
-                QString playlistFilePath = musicRootPath + relPathInSlot[i] + ".csv";
-                playlistFilePath.replace("/tracks/", "/Tracks/"); // FIX: someday I'll make this one capitalization
-    //            qDebug() << "NEED TO RELOAD THIS SLOT BECAUSE TRACKS" << i << playlistFilePath;
-                int songCount;
-                loadPlaylistFromFileToPaletteSlot(playlistFilePath, i, songCount);
-            }
-        }
+        reloadTracksPaletteSlots();
     }
 
     t.stop(__LINE__);
@@ -1986,6 +2150,375 @@ void MainWindow::darkLoadMusicList(QList<QString> *aPathStack, QString typeFilte
     currentTypeFilter = typeFilter;
 }
 
+void MainWindow::sortDarkSongTable()
+{
+    // performance -----
+    // these must be in "backwards" order to get the right order, which
+    //   is that Type is primary, Title is secondary, Label is tertiary
+    // qDebug() << "sortDarkSongTable::sortItems";
+
+    // NOTE: here is where we set the sort order
+
+    QString desiredSortOrder = prefsManager.GetcurrentSortOrder();
+    // qDebug() << "sortDarkSongTable desiredSortOrder: " << desiredSortOrder;
+    if (desiredSortOrder == "") {
+        // it hasn't been set yet!
+        // ui->darkSongTable->sortItems(kLabelCol);  // sort last by label/label #
+        // ui->darkSongTable->sortItems(kTitleCol);  // sort second by title in alphabetical order
+        // ui->darkSongTable->sortItems(kTypeCol);   // sort first by type (singing vs patter)
+        // qDebug() << "setting to default sort order!";
+        sortByDefaultSortOrder();  // this will be persisted...
+    } else {
+        // qDebug() << "setting to new sort order!" << desiredSortOrder;
+        ui->darkSongTable->setOrderFromString(desiredSortOrder);
+    }
+
+    // qDebug() << "sortDarkSongTable::DONE with sortItems";
+}
+
+void MainWindow::reloadTracksPaletteSlots()
+{
+    for (int i = 0; i < 3; i++) {
+//        qDebug() << "TRACKS? " << relPathInSlot[i];
+        if (relPathInSlot[i].startsWith("/tracks")) {
+            QString playlistFilePath = musicRootPath + relPathInSlot[i] + ".csv";
+            playlistFilePath.replace("/tracks/", "/Tracks/"); // FIX: someday I'll make this one capitalization
+//            qDebug() << "NEED TO RELOAD THIS SLOT BECAUSE TRACKS" << i << playlistFilePath;
+            int songCount;
+            loadPlaylistFromFileToPaletteSlot(playlistFilePath, i, songCount);
+        }
+    }
+}
+
+// One darkSongTable row (all of its cells), for the song in rec: used by darkLoadMusicList() for every
+//   row, and by updatePathStacksIncrementally() for just the songs that were added.  The hashes are
+//   the batch-fetched DB data and the per-directory cache that darkLoadMusicList() builds once.
+//   Returns false (and sets nothing) for entries that are never shown in the darkSongTable.
+bool MainWindow::setDarkSongTableRow(int row, SongRecord &rec,
+                                     const QHash<QString, SongSetting> &settingsByFilename,
+                                     const QHash<QString, QString> &agesByFilename,
+                                     const QIcon &auditionIcon,
+                                     QHash<QString, bool> &dirIsMusicRoot)
+{
+    // qDebug() << "entry:" << rec.entry;
+
+    QString type     = rec.type;  // the type (of original pathname, before following aliases)
+    QString origPath = rec.path();  // everything else
+
+    // NO:
+    // QStringList pathParts = origPath.split("/");
+    // QString typeFromPath = pathParts[pathParts.size()-2]; // second-to-last path part is the assumed type
+
+    // YES:
+    QString typeFromPath = (rec.hasFolder ? folder2SongCategoryName(rec.folder) : QString("unknown")); // same as filepath2SongCategoryName(origPath), without the split
+
+    const QString &dirPath = rec.dirPath;
+    auto dirIter = dirIsMusicRoot.constFind(dirPath);
+    if (dirIter == dirIsMusicRoot.constEnd()) {
+        dirIter = dirIsMusicRoot.insert(dirPath, QFileInfo(dirPath).canonicalFilePath() == musicRootPath);
+    }
+    if (dirIter.value()) {
+        typeFromPath = ""; // song lives directly in the music root dir, so it has no type
+    }
+
+    // qDebug() << "origPath: " << origPath;
+    // double check that type is non-music type (see Issue #298)
+    if (type == "reference" || type == "soundfx" || type == "sd") {
+        return false;
+    }
+
+    // --------------------------------
+    // e.g. "/Users/mpogue/__squareDanceMusic/patter/RIV 307 - Going to Ceili (Patter).mp3" --> "RIV 307 - Going to Ceili (Patter)"
+    //   parsed once per record, and again only if the filename format pref changes
+    //   (or loaded already parsed, from the pathStack cache)
+    ensureSongRecordParts(rec);
+
+    QString label = rec.label;
+    QString labelnum = rec.labelnum;
+    QString labelnum_extra = "";
+    QString title = rec.title;
+    QString shortTitle = rec.shortTitle;
+
+    QString pitchOverride = "";
+    QString tempoOverride = "";
+
+    if (type.contains("$!$")) {
+        // This is Apple Music, so we're going to override everything that breakFilenameIntoParts did (or tried to do)
+        // e.g. "ApplePlaylistName$!$lineNumber$!$Short Title from Apple Music#!#FullPathname"
+        QStringList sl10 = type.split("$!$");
+        QString ApplePlaylistName = sl10[0];
+        QString AppleLineNumber = sl10[1];
+        label = "Apple Music";
+        title = sl10[2];
+        shortTitle = title;
+
+        QString appleSymbol = QChar(0xF8FF);  // use APPLE symbol for Apple Music (sorts at the bottom)
+        // QString appleSymbol = QChar(0x039E);  // use GREEK XI for Local Playlists (sorts almost at the bottom, and looks like a playlist!)
+        type = appleSymbol + " " + sl10[0] + " " + AppleLineNumber; // this is tricky.  Leading Apple will force sort to bottom for "<APPLESYMBOL> Apple Playlist Name".
+        labelnum = "";
+        labelnum_extra = "";
+        // totalNumberOfAppleSongs++;
+    } else if (type.contains("%!%")) {
+        // This is a SquareDesk Playlist, so we're going to override everything that breakFilenameIntoParts did (or tried to do)
+        // e.g. "SquareDeskPlaylistName%!%pitch,tempo#!#FullPathname"
+        QStringList sl11 = type.split("%!%");
+        QStringList sl11a = sl11[0].split("/");
+        QString playlistName = sl11[0];
+        QString pitchTempo = sl11[1];
+        QStringList sl12 = pitchTempo.split(",");
+        QString pitchOverride = sl12[0]; // TODO: implement this!
+        QString tempoOverride = sl12[1]; // not "" if there is an override because playlist
+        QString lineNumber = sl12[2];
+        type = sl11a[sl11a.size()-1] + " " + lineNumber;  // take only the last part of the hierarchical playlist name, tack on a line number for sorting
+        // label = "Playlist";
+        // title = lineNumber + " - " + title; // use the default SquareDesk name (from the FullPathname), but prepend the line number and a dash
+        shortTitle = title;
+
+        // For Type 2 Apple Music items (playlistName starts with \uF8FF), override the
+        // filename-derived title with the actual Apple Music title (no track number, has colons).
+        if (playlistName.startsWith(QChar(0xF8FF))) {
+            for (const auto& sl : std::as_const(allAppleMusicPlaylists)) {
+                if (sl[2] == origPath) {
+                    title = sl[1];
+                    title.replace("/", "_"); // '/' not valid in filenames; use '_' for consistency with palette slot
+                    shortTitle = title;
+                    break;
+                }
+            }
+            // For hierarchical playlists, the last path component loses the \uF8FF prefix.
+            // Re-add it so the Type field shows "XI APPLEICON PlaylistName XX" consistently.
+            if (!type.startsWith(QChar(0xF8FF))) {
+                type = QString(QChar(0xF8FF)) + " " + type;
+            }
+        }
+
+        QString GreekXi = QChar(0x039E);  // use GREEK XI for Local Playlists (sorts almost at the bottom, and looks like a playlist!)
+        type = GreekXi + " " + type; // this is tricky.  Leading GREEK XI will force sort to almost bottom for "<GREEKXI> SquareDesk Playlist Name".
+        // labelnum = "";
+        // labelnum_extra = "";
+    } else {
+        // totalNumberOfSquareDeskSongs++; // only count songs, not playlist entries
+    }
+
+    // User preferences for colors
+    // qDebug() << "origPath/typeFromPath:" << typeFromPath << origPath;
+    QString cType = typeFromPath.toLower();  // type for Color purposes
+    if (cType.right(1)=="*") {
+        cType.chop(1);  // remove the "*" for the purposes of coloring
+    }
+
+    // if (songTypeNamesForExtras.contains(cType)) {
+    //     textCol = QColor(extrasColorString);
+    // }
+    // else if (songTypeNamesForPatter.contains(cType)) {
+    //     textCol = QColor(patterColorString);
+    // }
+    // else if (songTypeNamesForSinging.contains(cType)) {
+    //     textCol = QColor(singingColorString);
+    // }
+    // else if (songTypeNamesForCalled.contains(cType)) {
+    //     textCol = QColor(calledColorString);
+    // } else {
+    //     // textCol = QColor(QColor("#A0A0A0"));  // if not a recognized type, color it white-ish
+    //     textCol = QColor(extrasColorString);  // if not a recognized type, color it the xtras color (so user can control it)
+    // }
+
+    QColor textCol;
+    if (cType == "patter") {
+        textCol = QColor(patterColorString);
+    } else if (cType == "singing") {
+        textCol = QColor(singingColorString);
+    } else if (cType == "called") {
+        textCol = QColor(calledColorString);
+    } else if (cType == "extras") {
+        textCol = QColor(extrasColorString);
+    } else {
+        textCol = QColor(extrasColorString); // if not a recognized type, color it the xtras color (so user can control it)
+    }
+
+    QBrush textBrush(textCol); // make a brush for most of the widgets
+
+    // PLAYLIST HANDLING -----
+    // NOTE: PLAYLISTS NOT IN DARK SONG TABLE!
+    // look up origPath in the path2playlistNum map, and reset the s2 text to the user's playlist # setting (if any)
+    // QString s2("");
+    // if (path2playlistNum.contains(origPath)) {
+    //     s2 = path2playlistNum[origPath];
+    // }
+    // TableNumberItem *newTableItem4 = new TableNumberItem(s2);
+
+    // newTableItem4->setTextAlignment(Qt::AlignCenter);
+    // newTableItem4->setForeground(textCol);
+    // // # items are editable by default
+    // ui->darkSongTable->setItem(row, kNumberCol, newTableItem4);
+
+    // # COLUMN IS NOW USED FOR AUDITION BUTTONS -----
+    QTableWidgetItem *auditionItem = new QTableWidgetItem();
+
+    // parented to the table, so the button always has an owner. setCellWidget() below
+    //   reparents it to the table's viewport, which is where it ends up either way --
+    //   this just means it is never briefly a parentless top-level widget. (Issue #1687)
+    auditionButton *auditionButton1 = new auditionButton(ui->darkSongTable);
+    auditionButton1->setFlat(true);
+    auditionButton1->setObjectName("auditionButton");
+    auditionButton1->origPath = origPath;
+
+    connect(auditionButton1, &QPushButton::pressed, this,
+            [this]() {
+                auditionSingleShotTimer.stop();
+                auditionInProgress = true;
+                // qDebug() << "setting auditionInProgress to true";
+
+                QString origPath = ((auditionButton *)(sender()))->origPath;
+                // qDebug() << "AUDITION PATH:" << origPath;
+
+                auditionSetStartMs(origPath);
+
+                // QModelIndexList list = this->ui->darkSongTable->selectionModel()->selectedRows();
+                // int row = list.at(0).row();
+                // QString origPath = this->ui->darkSongTable->item(row,kPathCol)->data(Qt::UserRole).toString();
+                // // qDebug() << "QPushButton pressed, row:" << row << origPath;
+
+                this->auditionPlayer.setSource(QUrl::fromLocalFile(origPath));
+                
+                // Use the selected audition playback device, or default if not set
+                QAudioDevice selectedDevice;
+                if (!auditionPlaybackDeviceName.isEmpty()) {
+                    selectedDevice = getAudioDeviceByName(auditionPlaybackDeviceName);
+                } else {
+                    selectedDevice = QMediaDevices::defaultAudioOutput();
+                }
+                QAudioOutput *audioOutput = new QAudioOutput(selectedDevice);
+                
+                this->auditionPlayer.setAudioOutput(audioOutput);
+                this->auditionPlayer.play();
+            });
+
+    connect(auditionButton1, &QPushButton::released, this,
+            [this]() {
+                // QModelIndexList list = this->ui->darkSongTable->selectionModel()->selectedRows();
+                // int row = list.at(0).row();
+                // QString origPath = this->ui->darkSongTable->item(row,kPathCol)->data(Qt::UserRole).toString();
+                // qDebug() << "QPushButton released, row:" << row << origPath;
+                this->auditionPlayer.stop();
+                this->ui->darkSongTable->setFocus(); // just released a button, so set focus back to the darkSongTable
+
+                auditionSingleShotTimer.start(1000);
+                // qDebug() << "KLUDGE: setting auditionInProgress to false 1000 ms in the future";
+                //  While this is kludgey, I'm not sure that there's an alternative.  If you press an audition button,
+                //  and move off the button (with Left Mouse Button still down), it will initiate a drag and drop, which
+                //  we do not want.  This timer gives you one second to let the left button up, before a drag and drop is inferred.
+                //  In my testing, that seemed about right.  No false drag and drops, but normal drag and drop still works as expected.
+            });
+
+    // QIcon playbackIcon = QIcon::fromTheme(QIcon::ThemeIcon::MultimediaPlayer);
+
+    auditionButton1->setIcon(auditionIcon); // shared QIcon, decoded once by the caller (Issue #1669)
+
+    // auditionButton1->setIconSize(QSize(26,26));
+
+    ui->darkSongTable->setItem(row, kNumberCol, auditionItem);
+    ui->darkSongTable->setCellWidget(row, kNumberCol, auditionButton1);
+
+    // TYPE FIELD -----
+    QTableWidgetItem *twi1 = new QTableWidgetItem(type);
+    twi1->setForeground(textBrush);
+    twi1->setFlags(twi1->flags() & ~Qt::ItemIsEditable);      // not editable
+    ui->darkSongTable->setItem(row, kTypeCol, twi1);
+
+    // LABEL + LABELNUM FIELD -----
+    QTableWidgetItem *twi2 = new QTableWidgetItem(label + " " + labelnum);
+    twi2->setForeground(textBrush);
+    twi2->setFlags(twi2->flags() & ~Qt::ItemIsEditable);      // not editable
+    ui->darkSongTable->setItem(row, kLabelCol, twi2);
+
+//         INVISIBLE TABLE WIDGET ITEM -----
+//         FYI: THIS IS FOR SORTING...
+    InvisibleTableWidgetItem *titleItem(new InvisibleTableWidgetItem(title));
+    titleItem->setFlags(titleItem->flags() & ~Qt::ItemIsEditable);      // not editable
+
+    // TITLE (WITH TAGS) -----
+    QString normalizedPath = songSettings.removeRootDirs(origPath);
+    SongSetting settings = settingsByFilename.value(normalizedPath); // batch-fetched by the caller (default SongSetting, if not in the DB)
+    if (settings.isSetTags()) {
+        songSettings.addTags(settings.getTags());
+    }
+
+    // format the title string --
+    //   no QLabel cell widget here: the HTML is painted by the DarkSongTitleDelegate, and only for visible rows
+    QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags(), textCol.name()));
+    titleItem->setData(kTitleHTMLRole, titlePlusTags);
+    ui->darkSongTable->setItem(row, kTitleCol, titleItem);
+
+    // LEVELS FIELD -----
+    QTableWidgetItem *twiLevels = new QTableWidgetItem(songLevelsByPath.value(origPath, ""));
+    twiLevels->setForeground(textBrush);
+    twiLevels->setTextAlignment(Qt::AlignCenter);
+    twiLevels->setFlags(twiLevels->flags() & ~Qt::ItemIsEditable);      // not editable
+    ui->darkSongTable->setItem(row, kLevelsCol, twiLevels);
+
+    // AGE FIELD -----
+    QString ageString = agesByFilename.value(normalizedPath); // batch-fetched by the caller
+    if (ageString.isEmpty()) {
+        // fallback for legacy DB rows keyed by base filename instead of relative path
+        // (same fallback order as getSongAge())
+        ageString = agesByFilename.value(rec.baseName());
+    }
+    QString ageAsIntString = ageToIntString(ageString);
+    QTableWidgetItem *twi4 = new TableNumberItem(ageAsIntString); // TableNumberItem so it's numerically sortable
+    twi4->setForeground(textBrush);
+    twi4->setTextAlignment(Qt::AlignCenter);
+    twi4->setFlags(twi4->flags() & ~Qt::ItemIsEditable);      // not editable
+    // qDebug() << "TITLE/AGE:" << title << ageString << ageAsIntString;
+    ui->darkSongTable->setItem(row, kAgeCol, twi4);
+
+    // RECENT FIELD (must come after AGE field, because it uses age to determine recent string) -----
+    QString recentString = ageToRecent(ageString);  // passed as double string
+    QTableWidgetItem *twi4b = new QTableWidgetItem(recentString);
+    twi4b->setForeground(textBrush);
+    twi4b->setTextAlignment(Qt::AlignCenter);
+    twi4b->setFlags(twi4b->flags() & ~Qt::ItemIsEditable);      // not editable
+    ui->darkSongTable->setItem(row, kRecentCol, twi4b);
+
+    // ((darkSongTitleLabel *)(ui->darkSongTable->cellWidget(row, kTitleCol)))->setSongUsed(true || recentString != ""); // rewrite the song's title to be strikethrough and/or green background
+
+    // PITCH FIELD -----
+    int pitch = 0;
+    if (settings.isSetPitch()) { pitch = settings.getPitch(); }
+
+    QTableWidgetItem *twi5 = new QTableWidgetItem(QString("%1").arg(pitch));
+    twi5->setForeground(textBrush);
+    twi5->setTextAlignment(Qt::AlignCenter);
+    twi5->setFlags(twi5->flags() & ~Qt::ItemIsEditable);      // not editable
+    ui->darkSongTable->setItem(row, kPitchCol, twi5);
+
+    // TEMPO FIELD -----
+    int tempo = 0;
+    bool loadedTempoIsPercent(false);
+    if (settings.isSetTempo()) { tempo = settings.getTempo(); }
+    if (settings.isSetTempoIsPercent()) { loadedTempoIsPercent = settings.getTempoIsPercent(); }
+    QString tempoStr = QString("%1").arg(tempo);
+    if (loadedTempoIsPercent) tempoStr += "%";
+    //        qDebug() << "loadMusicList() is setting the kTempoCol to: " << tempoStr;
+
+    QTableWidgetItem *twi6 = new QTableWidgetItem(QString("%1").arg(tempoStr));
+    twi6->setForeground(textBrush);
+    twi6->setTextAlignment(Qt::AlignCenter);
+    twi6->setFlags(twi6->flags() & ~Qt::ItemIsEditable);      // not editable
+    ui->darkSongTable->setItem(row, kTempoCol, twi6);
+
+    // PATH FIELD (VARIANT SAVED IN INVISIBLE LOCATION) -----
+    // keep the path around, for loading in when we double click on it
+    ui->darkSongTable->item(row, kPathCol)->setData(Qt::UserRole, QVariant(origPath)); // path set on cell in col 0
+
+//        if (i < 10) {
+//            qDebug() << type << label << labelnum << title << shortTitle; // << titlePlusTags;
+//        }
+
+    return true;
+}
+
+
 // Custom QTableWidgetItem for numeric sorting
 class NumericTableWidgetItem : public QTableWidgetItem {
 public:
@@ -24,6 +24,7 @@
 ****************************************************************************/
 // Disable warning, see: https://github.com/llvm/llvm-project/issues/48757
 #include "songlistmodel.h"
+#include "songtitledelegate.h"
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Welaborated-enum-base"
 #include "mainwindow.h"
@@ -52,11 +53,9 @@ void MainWindow::setSongTableFont(QTableWidget *songTable, const QFont &currentF
     //     dynamic_cast<QLabel*>(songTable->cellWidget(row,kTitleCol))->setFont(currentFont);
     // }
 
-    for (int row = 0; row < songTable->rowCount(); ++row) {
-        QLabel *theLabel = dynamic_cast<QLabel*>(songTable->cellWidget(row,kTitleCol));
-        if (theLabel != nullptr) {
-            theLabel->setFont(currentFont);
-        }
+    if (songTable == ui->darkSongTable && darkSongTitleDelegate != nullptr) {
+        darkSongTitleDelegate->setTitleFont(currentFont);  // titles are painted by the delegate, not by per-row QLabels
+        songTable->viewport()->update();
     }
 }
 
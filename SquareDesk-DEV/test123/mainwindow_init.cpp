@@ -72,6 +72,7 @@
 #include "startupwizard.h"
 #include "makeflashdrivewizard.h"
 #include "songlistmodel.h"
+#include "songtitledelegate.h"
 #include "mytablewidget.h"
 
 #include "svgWaveformSlider.h"
@@ -593,6 +594,25 @@ void MainWindow::initializeUI() {
 
 
     songSettings.setDefaultTagColors( prefsManager.GettagsBackgroundColorString(), prefsManager.GettagsForegroundColorString());
+    connect(&songSettings, &SongSettings::songSettingChanged,
+            this, &MainWindow::songSettingChanged);  // e.g. new tags, so just that song's rows are redrawn
+    connect(&songSettings, &SongSettings::songSettingsChanged,
+            this, &MainWindow::songSettingsChanged);  // ...or many songs' rows, after a multi-select bulk edit
+    connect(&songSettings, &SongSettings::writesFailed, this, [this](int droppedWrites) {
+        ui->statusBar->showMessage(tr("WARNING: %n change(s) could not be saved to the song settings database.", "", droppedWrites));
+    });
+    connect(&songSettings, &SongSettings::mirrorConflict, this, [this](const QString &conflictFilename) {
+        QMessageBox *msgBox = new QMessageBox(QMessageBox::Warning, tr("Song Settings Conflict"),
+                                              tr("The song settings database in your music folder was changed on two computers "
+                                                 "before they could sync with each other.\n\n"
+                                                 "One version was kept, and the changes in the other one were NOT merged into it. "
+                                                 "They were saved as:\n\n%1")
+                                                  .arg(QDir::toNativeSeparators(conflictFilename)),
+                                              QMessageBox::Ok, this);
+        msgBox->setWindowModality(Qt::NonModal);
+        msgBox->setAttribute(Qt::WA_DeleteOnClose);
+        msgBox->show();
+    }, Qt::QueuedConnection);  // not from inside openDatabase(), and maybe from the writer thread
 
     // NOTE: Music Tab splitter restoration moved to constructor (after window is shown)
     //       to fix Issue #1558: window resizing problem with large zoom levels
@@ -678,6 +698,7 @@ void MainWindow::initializeMusicPlaybackControls() {
 
     on_monoButton_toggled(prefsManager.Getforcemono());
     on_actionNormalize_Track_Audio_toggled(prefsManager.GetnormalizeTrackAudio());
+    on_actionNormalize_Track_Loudness_toggled(prefsManager.GetnormalizeTrackLoudness());
 
     on_actionAuto_scroll_during_playback_toggled(prefsManager.Getenableautoscrolllyrics());
     autoScrollLyricsEnabled = prefsManager.Getenableautoscrolllyrics();
@@ -1438,8 +1459,19 @@ void MainWindow::initializeMusicSongTable() {
 
     ui->darkSongTable->setColumnHidden(kLevelsCol, true); // levels column starts out hidden, same as the playlist Levels column
 
+    // the Title column is painted from the title item's HTML, instead of one QLabel cell widget per song
+    darkSongTitleDelegate = new DarkSongTitleDelegate(ui->darkSongTable);
+    ui->darkSongTable->setItemDelegateForColumn(kTitleCol, darkSongTitleDelegate);
+
     zoomInOut(0);  // trigger reloading of all fonts, including horizontalHeader of songTable()
 
+    // cuesheets that findMusic() couldn't get a level for from the cache are read in the background
+    connect(&cuesheetLevelWatcher, &QFutureWatcherBase::finished, this, &MainWindow::cuesheetLevelsRefreshed);
+    // ...and so are the cuesheets (and lyrics) that the full-text index doesn't have yet
+    connect(&cuesheetTextWatcher, &QFutureWatcherBase::finished, this, &MainWindow::cuesheetTextIndexRefreshed);
+    // a newly loaded song is fingerprinted and matched against the library in the background, too
+    connect(&fingerprintWatcher, &QFutureWatcherBase::finished, this, &MainWindow::fingerprintMatchesFound);
+
     findMusic(musicRootPath, true);  // get the filenames from the user's directories
 
     // At this point, the pathStack was populated by findMusic, so we can do the status message:
@@ -2203,6 +2235,21 @@ void MainWindow::initializeMusicRootWatcher() {
 
     static QRegularExpression ignoreTheseDirs(musicRootPath + "/(reference|choreography|notes|playlists|sd|soundfx|lyrics)"); // and their children folders
 
+    if (InotifyMusicWatcher::isSupported()) {
+        // Linux: inotify tells us exactly which files were added/removed/renamed, so a change
+        //   becomes an in-place pathStack update instead of a findMusic() rescan
+        if (inotifyMusicWatcher == nullptr) {
+            inotifyMusicWatcher = new InotifyMusicWatcher(this);
+            connect(inotifyMusicWatcher, &InotifyMusicWatcher::filesChanged, this, &MainWindow::musicRootFilesChanged);
+            connect(inotifyMusicWatcher, &InotifyMusicWatcher::overflowed,   this, &MainWindow::musicRootWatcherOverflowed);
+        }
+        if (inotifyMusicWatcher->watchTree(musicRootPath, ignoreTheseDirs)) {
+            t2.elapsed(__LINE__);
+            return;
+        }
+        // else fall back to QFileSystemWatcher (e.g. inotify_init failed)
+    }
+
     while (it.hasNext()) {
         QString aPath = it.next();
         // qDebug() << "aPath:" << aPath;
@@ -2221,6 +2268,22 @@ void MainWindow::initializeMusicRootWatcher() {
     t2.elapsed(__LINE__); // how much time did it take to initialize the filewatcher?
 }
 
+bool MainWindow::musicRootWatcherIsActive() {
+    return (inotifyMusicWatcher != nullptr && inotifyMusicWatcher->isWatching()) || !musicRootWatcher.directories().isEmpty();
+}
+
+void MainWindow::stopMusicRootWatcher() {
+    if (inotifyMusicWatcher != nullptr) {
+        inotifyMusicWatcher->clear();
+    }
+    if (!musicRootWatcher.directories().isEmpty()) {
+        musicRootWatcher.removePaths(musicRootWatcher.directories());
+    }
+    pendingAddedMusicFiles.clear();
+    pendingRemovedMusicFiles.clear();
+    pendingMusicFilesOverflowed = false;
+}
+
 void MainWindow::initializeLightDarkTheme() {
     themePreference = prefsManager.GetactiveTheme();
     // qDebug() << "themePreference:" << themePreference;
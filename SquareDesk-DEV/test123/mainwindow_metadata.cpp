@@ -105,6 +105,115 @@ QString MainWindow::getSongFileIdentifier(QString pathToSong) {
     return(hexHash);
 }
 
+// ---------------------------------------------------------------------------------
+// Called when a song has been loaded and decoded.  Adds the song's acoustic fingerprint to the index (if it's
+//   not already there), and then, if we have NO settings for this file, looks for another file of the same
+//   recording (re-encoded, renamed, moved, ...).  Both run on the global thread pool (~20ms to fingerprint a
+//   3 minute song, plus the first lookup builds the index), so they don't hold up the load; the only GUI
+//   thread work is copying the decoded song.  fingerprintMatchesFound() takes it from there.
+void MainWindow::updateFingerprintForCurrentSong(const QString &songTitle) {
+    QString pathToSong = currentMP3filenameWithPath;
+
+    SongSetting existing;
+    bool alreadyKnown = songSettings.loadSettings(pathToSong, existing);  // then its settings are left alone
+    bool upToDate = fingerprintIndex.isUpToDate(pathToSong);
+    if (alreadyKnown && upToDate) {
+        return;  // nothing to add, nothing to look for
+    }
+
+    std::function<QVector<quint64>()> computeFingerprint;
+    if (!upToDate) {
+        computeFingerprint = cBass->GetFingerprintFunction();
+    }
+
+    fingerprintWatcherPath = pathToSong;
+    fingerprintWatcherFilename = currentMP3filename;
+    fingerprintWatcherTitle = songTitle;
+    FingerprintIndex *index = &fingerprintIndex;
+    fingerprintWatcher.setFuture(QtConcurrent::run([index, pathToSong, alreadyKnown, computeFingerprint]() {
+        if (computeFingerprint) {
+            index->add(pathToSong, computeFingerprint());
+        }
+        return(alreadyKnown ? QStringList() : index->findSameSong(pathToSong));  // best match first
+    }));
+}
+
+// If we have settings for another file of the same recording, offers to copy them over.  The cuesheet
+//   association is one of those settings, so the cuesheet follows, too.  A fingerprint match can be wrong,
+//   so this is never done without asking, and since the song is already loaded and maybe playing by now,
+//   the question doesn't block anything: it just waits for an answer.
+void MainWindow::fingerprintMatchesFound() {
+    QString pathToSong = fingerprintWatcherPath;
+    QString filename = fingerprintWatcherFilename;
+    QString songTitle = fingerprintWatcherTitle;
+    const QStringList sameSong = fingerprintWatcher.result();
+    if (sameSong.isEmpty() || pathToSong != currentMP3filenameWithPath) {
+        return;  // no match, or another song was loaded in the meantime
+    }
+
+    SongSetting existing;
+    if (songSettings.loadSettings(pathToSong, existing)) {
+        return;  // got some settings of its own in the meantime
+    }
+
+    for (const QString &otherPath : sameSong) {
+        SongSetting adopted;
+        if (!songSettings.loadSettings(otherPath, adopted)) {
+            continue;
+        }
+        QMessageBox *msgBox = new QMessageBox(QMessageBox::Question, tr("Same Recording"),
+                                              tr("This song sounds like the same recording as:\n\n%1\n\nCopy that song's settings (pitch, tempo, intro/outro, cuesheet, tags) to this one?")
+                                                  .arg(songSettings.removeRootDirs(otherPath)),
+                                              QMessageBox::No | QMessageBox::Yes, this);
+        msgBox->setDefaultButton(QMessageBox::No);
+        msgBox->setWindowModality(Qt::NonModal);
+        msgBox->setAttribute(Qt::WA_DeleteOnClose);
+        connect(msgBox, &QMessageBox::finished, this, [this, msgBox, pathToSong, filename, songTitle, adopted]() mutable {
+            if (msgBox->standardButton(msgBox->clickedButton()) != QMessageBox::Yes) {
+                return;  // only the best match is offered
+            }
+            // qDebug() << "Adopting settings for" << pathToSong << "from the same recording";
+            adopted.setFilename(filename);
+            adopted.setFilenameWithPath(pathToSong);
+            songSettings.saveSettings(pathToSong, adopted);
+            if (pathToSong == currentMP3filenameWithPath) {
+                loadSettingsForSong(songTitle);  // still loaded: use them right away
+            }
+        });
+        msgBox->show();
+        return;
+    }
+}
+
+// ---------------------------------------------------------------------------------
+void MainWindow::on_actionFind_Duplicate_Songs_triggered() {
+    fingerprintIndex.save();  // it's a good time for this, too
+
+    QElapsedTimer timer;
+    timer.start();
+    QList<QStringList> groups = fingerprintIndex.findDuplicates();
+    qint64 elapsed_ms = timer.elapsed();
+
+    QString details;
+    for (const QStringList &group : std::as_const(groups)) {
+        for (const QString &path : group) {
+            details += songSettings.removeRootDirs(path) + "\n";
+        }
+        details += "\n";
+    }
+
+    QMessageBox msgBox;
+    msgBox.setIcon(QMessageBox::Information);
+    if (groups.isEmpty()) {
+        msgBox.setText(tr("No duplicate recordings were found."));
+    } else {
+        msgBox.setText(tr("Found %1 recording(s) that are in the music library more than once.").arg(groups.size()));
+        msgBox.setDetailedText(details);
+    }
+    msgBox.setInformativeText(tr("Only songs that have been loaded, or had their section info calculated, are checked. (%1ms)").arg(elapsed_ms));
+    msgBox.exec();
+}
+
 // ID3 ----------------------
 // read ID3Tags from an MP3 file
 //   inputs: if one of the input pointers is NULL, then do NOT return a value for that variable
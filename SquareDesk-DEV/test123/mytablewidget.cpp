@@ -738,7 +738,7 @@ void MyTableWidget::mouseMoveEvent(QMouseEvent *event)
             sourceRow = mi.row();  // this is the actual row number of each selected row, overriding the cursor-located row (just pick all selected rows)
             // qDebug() << "DRAGGING THIS ROW NUMBER:" << sourceRow;
 
-            QString title = dynamic_cast<QLabel*>(this->cellWidget(sourceRow, kTitleCol))->text();
+            QString title = item(sourceRow, kTitleCol)->data(kTitleHTMLRole).toString();
             title.replace(spanPrefixRemover2, "\\1"); // remove <span style="color:#000000"> and </span> title string coloring
 
             int where = title.indexOf(title_tags_remover2);
@@ -0,0 +1,184 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "paralleldirwalker.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+// directory scanning is mostly waiting on the filesystem, not on the CPU, so allow more threads
+//   than cores -- but not so many that a NAS gets hammered
+#define PARALLELDIRWALKER_MAX_THREADS 16
+
+namespace {
+
+struct WalkItem {
+    QString result;    // visit() result for a file, or...
+    int child = -1;    // ...index of a subdirectory's node
+};
+
+struct WalkNode {
+    QString path;
+    QStringList ancestors;      // canonical paths from the root down to here, for link loop detection
+    QVector<WalkItem> items;    // in this directory's listing order
+};
+
+class WalkState {
+public:
+    QStringList nameFilters;
+    const std::function<QString(const QString &)> *visit = nullptr;
+
+    int addNode(const QString &path, const QStringList &ancestors) {
+        QMutexLocker lock(&mutex);
+        WalkNode *n = new WalkNode;
+        n->path = path;
+        n->ancestors = ancestors;
+        nodes.append(n);
+        return static_cast<int>(nodes.size()) - 1;
+    }
+    WalkNode *node(int i) {
+        QMutexLocker lock(&mutex);
+        return nodes[i];  // the nodes themselves never move, only the vector of pointers does
+    }
+    ~WalkState() { qDeleteAll(nodes); }
+
+    // This walk's own tasks, so that walk() doesn't also wait for whatever ELSE is on the shared
+    //   pool (e.g. directory fingerprints, or another walk).
+    void taskQueued() {
+        QMutexLocker lock(&pendingMutex);
+        ++pending;
+    }
+    void taskFinished() {
+        QMutexLocker lock(&pendingMutex);
+        if (--pending == 0) {
+            allDone.wakeAll();
+        }
+    }
+    void waitForAllTasks() {
+        QMutexLocker lock(&pendingMutex);
+        while (pending > 0) {
+            allDone.wait(&pendingMutex);
+        }
+    }
+
+private:
+    QMutex mutex;
+    QVector<WalkNode *> nodes;
+
+    QMutex pendingMutex;
+    QWaitCondition allDone;
+    int pending = 0;
+};
+
+void walkOneDirectory(WalkState *state, int nodeIndex);
+
+void queueDirectory(WalkState *state, int nodeIndex) {
+    state->taskQueued();
+    ParallelDirWalker::pool()->start([state, nodeIndex]() {
+        walkOneDirectory(state, nodeIndex);
+        state->taskFinished();  // last: this task's subdirectories were queued (and counted) above
+    });
+}
+
+// runs on a pool thread: only this task ever touches this node's items
+void walkOneDirectory(WalkState *state, int nodeIndex) {
+    WalkNode *n = state->node(nodeIndex);
+
+    QDirIterator it(n->path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo fi = it.fileInfo();
+        bool matches = QDir::match(state->nameFilters, fi.fileName());
+
+        if (fi.isDir()) {
+            // QDirIterator returns a directory entry itself (if its name matches) just BEFORE its contents
+            if (matches) {
+                QString r = (*state->visit)(path);
+                if (!r.isEmpty()) {
+                    n->items.append(WalkItem{r, -1});
+                }
+            }
+            QString canonical = fi.canonicalFilePath();
+            if (canonical.isEmpty() || n->ancestors.contains(canonical)) {
+                continue;  // broken link, or a link back up the tree
+            }
+            int child = state->addNode(path, n->ancestors + QStringList(canonical));
+            n->items.append(WalkItem{QString(), child});
+            queueDirectory(state, child);
+        } else if (matches) {
+            QString r = (*state->visit)(path);
+            if (!r.isEmpty()) {
+                n->items.append(WalkItem{r, -1});
+            }
+        }
+    }
+}
+
+void mergeInOrder(WalkState *state, int nodeIndex, QStringList *out) {
+    const WalkNode *n = state->node(nodeIndex);
+    for (const WalkItem &item : n->items) {
+        if (item.child >= 0) {
+            mergeInOrder(state, item.child, out);
+        } else {
+            out->append(item.result);
+        }
+    }
+}
+
+} // namespace
+
+QThreadPool *ParallelDirWalker::pool()
+{
+    static QThreadPool *thePool = []() {
+        QThreadPool *p = new QThreadPool();
+        p->setMaxThreadCount(qBound(2, QThread::idealThreadCount() * 2, PARALLELDIRWALKER_MAX_THREADS));
+        return p;
+    }();
+    return thePool;
+}
+
+QStringList ParallelDirWalker::walk(const QString &root, const QStringList &nameFilters,
+                                    const std::function<QString(const QString &path)> &visit)
+{
+    WalkState state;
+    state.nameFilters = nameFilters;
+    state.visit = &visit;
+
+    QString rootCanonical = QFileInfo(root).canonicalFilePath();
+    int rootIndex = state.addNode(root, QStringList(rootCanonical));
+    queueDirectory(&state, rootIndex);
+    state.waitForAllTasks();  // every task queues its subdirectories BEFORE it finishes, so this waits for the whole tree
+
+    QStringList results;
+    mergeInOrder(&state, rootIndex, &results);
+    return results;
+}
@@ -0,0 +1,60 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PARALLELDIRWALKER_H_INCLUDED
+#define PARALLELDIRWALKER_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+class QThreadPool;
+
+// Walks a directory tree with one task per directory on a bounded thread pool: each task lists
+//   its own directory, calls visit() on the files in it, and queues a task per subdirectory, so
+//   idle threads pick up whatever directories are waiting.  On cloud-synced and network music
+//   roots, where every readdir/stat is a round trip, this overlaps the round trips instead of
+//   paying for them one after another.
+//
+// The results are merged back in exactly the order that a serial
+//   QDirIterator(root, nameFilters, Files | Dirs | NoDotAndDotDot, Subdirectories | FollowSymlinks)
+//   walk visits the files (depth-first, each directory's entries in listing order), so callers
+//   see the same output as before, just sooner.
+//
+// NOTE: symlinked directories are followed, but a link back to one of its own ancestors is not
+//   (that would never end).  QDirIterator also skips a directory that it already reached through
+//   a DIFFERENT link, which depends on visiting order, so it can't be reproduced in parallel.
+class ParallelDirWalker {
+public:
+    // visit() runs on the pool threads, once per matching file (or directory whose name matches),
+    //   and must be thread-safe; empty results are dropped
+    static QStringList walk(const QString &root, const QStringList &nameFilters,
+                            const std::function<QString(const QString &path)> &visit);
+
+    // pool shared by all of the music directory scanning (walks and directory fingerprints)
+    static QThreadPool *pool();
+};
+
+#endif /* ifndef PARALLELDIRWALKER_H_INCLUDED */
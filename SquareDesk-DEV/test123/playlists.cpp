@@ -739,9 +739,8 @@ void MainWindow::loadTrackFilterToSlot(QString PlaylistFileName, QString relativ
     static QRegularExpression title_tags_remover("(\\&nbsp\\;)*\\<\\/?span( .*?)?>");
     static QRegularExpression spanPrefixRemover("<span style=\"color:.*\">(.*)</span>", QRegularExpression::InvertedGreedinessOption);
 
-    // One SELECT for every song, instead of one per row inside setTitleField() (issue #1695)
-    QHash<QString, SongSetting> settingsCache;
-    songSettings.loadSettingsForAllSongs(settingsCache);
+    // Every song's settings, instead of one SELECT per row inside setTitleField() (issue #1695)
+    const QHash<QString, SongSetting> &settingsCache = songSettings.allSongSettings();
 
     // Pre-size the table to the most rows we could possibly need, and trim after the loop, so
     //   we don't grow it one row at a time.  (issue #1695)
@@ -765,7 +764,7 @@ void MainWindow::loadTrackFilterToSlot(QString PlaylistFileName, QString relativ
 
             // type IS what we want, so add it to the playlist slot -----
             QString label = ui->darkSongTable->item(i, kLabelCol)->text();
-            QString shortTitle = dynamic_cast<QLabel*>(ui->darkSongTable->cellWidget(i, kTitleCol))->text();
+            QString shortTitle = ui->darkSongTable->item(i, kTitleCol)->data(kTitleHTMLRole).toString();
             QString coloredTitle = shortTitle; // title with coloring AND tags with coloring
 
             shortTitle.replace(spanPrefixRemover, "\\1"); // remove <span style="color:#000000"> and </span> title string coloring
@@ -778,7 +777,7 @@ void MainWindow::loadTrackFilterToSlot(QString PlaylistFileName, QString relativ
             shortTitle.replace("&quot;","\"").replace("&amp;","&").replace("&gt;",">").replace("&lt;","<");  // if title contains HTML encoded chars, put originals back
 
             if (shortTitle.contains("span")) { // DEBUG DEBUG
-                // qDebug() << "FOUND SPAN BEFORE: " << dynamic_cast<QLabel*>(ui->darkSongTable->cellWidget(i, kTitleCol))->text();
+                // qDebug() << "FOUND SPAN BEFORE: " << ui->darkSongTable->item(i, kTitleCol)->data(kTitleHTMLRole).toString();
                 // qDebug() << "FOUND SPAN AFTER: " << shortTitle;
             }
 
@@ -899,9 +898,8 @@ void MainWindow::loadAppleMusicPlaylistToSlot(QString PlaylistFileName, QString
     //   below re-measures every row in the table.  See palettetablebulkupdate.h (issue #1695).
     PaletteTableBulkUpdate bulk(theTableWidget);
 
-    // One SELECT for every song, instead of one per row inside setTitleField() (issue #1695)
-    QHash<QString, SongSetting> settingsCache;
-    songSettings.loadSettingsForAllSongs(settingsCache);
+    // Every song's settings, instead of one SELECT per row inside setTitleField() (issue #1695)
+    const QHash<QString, SongSetting> &settingsCache = songSettings.allSongSettings();
 
     linesInCurrentPlaylist = 0;
     songCount = 0;
@@ -1002,9 +1000,8 @@ void MainWindow::loadRegularPlaylistToSlot(QString PlaylistFileName, QString rel
         //   below re-measures every row in the table.  See palettetablebulkupdate.h (issue #1695).
         PaletteTableBulkUpdate bulk(theTableWidget);
 
-        // One SELECT for every song, instead of one per row inside setTitleField() (issue #1695)
-        QHash<QString, SongSetting> settingsCache;
-        songSettings.loadSettingsForAllSongs(settingsCache);
+        // Every song's settings, instead of one SELECT per row inside setTitleField() (issue #1695)
+        const QHash<QString, SongSetting> &settingsCache = songSettings.allSongSettings();
 
         linesInCurrentPlaylist = 0;
 
@@ -1894,9 +1891,8 @@ void MainWindow::refreshAllPlaylists() {
 
     QTableWidget *playlistTables[3] = {ui->playlist1Table, ui->playlist2Table, ui->playlist3Table};
 
-    // One SELECT for every song, instead of one per row inside setTitleField() (issue #1695)
-    QHash<QString, SongSetting> settingsCache;
-    songSettings.loadSettingsForAllSongs(settingsCache);
+    // Every song's settings, instead of one SELECT per row inside setTitleField() (issue #1695)
+    const QHash<QString, SongSetting> &settingsCache = songSettings.allSongSettings();
 
     for (int i = 0; i < 3; i++) {
         // qDebug() << "LOOK AT SLOT:" << i;
@@ -1914,42 +1910,7 @@ void MainWindow::refreshAllPlaylists() {
         PaletteTableBulkUpdate bulk(theTable);
 
         for (int j = 0; j < theTable->rowCount(); j++) {
-            // for each title in the table
-            QString relativePath;
-            QString PlaylistFileName;
-            if (dynamic_cast<QLabel*>(theTable->cellWidget(j, 1)) != nullptr) {
-                // QString title = dynamic_cast<QLabel*>(theTable->cellWidget(j, 1))->text(); // don't need this right now...
-                relativePath = theTable->item(j, COLUMN_PATH)->text();
-                relativePath.replace(musicRootPath, "");
-
-                PlaylistFileName = musicRootPath + PLAYLISTS_PATH_PREFIX + relPathInSlot[i] + CSV_FILE_EXTENSION;
-                // qDebug() << "refreshAllPlaylists: relativePath, PlaylistFileName:" << relativePath << PlaylistFileName;
-
-                // Determine if this row should be indented (issue #1547)
-                bool shouldIndent = shouldIndentPlaylistRow(theTable, j);
-
-                // this is what we want: "/patter/RIV 1180 - Sea Chanty.mp3" "/Users/mpogue/Library/CloudStorage/Box-Box/__squareDanceMusic_Box/playlists/Jokers/2024/Jokers_2024.06.05.csv"
-                QString theCanonicalRelativePath = makeCanonicalRelativePath(relativePath); // display as "LABEL NUM - Title", even if filename is reversed (issue #1665)
-                setTitleField(theTable, j, theCanonicalRelativePath, true, PlaylistFileName, relativePath, shouldIndent, &settingsCache);
-
-                // Re-apply loaded-song highlighting (bold+italic) if setTitleField() just replaced it (issue #1601)
-                if (theTable->item(j, COLUMN_LOADED) && theTable->item(j, COLUMN_LOADED)->text() == "1") {
-                    QLabel *titleLabel = dynamic_cast<QLabel*>(theTable->cellWidget(j, COLUMN_TITLE));
-                    if (titleLabel) {
-                        QString html = titleLabel->text();
-                        html.replace(QRegularExpression("</?b>"), "");
-                        html.replace(QRegularExpression("</?i>"), "");
-                        titleLabel->setText("<b><i>" + html + "</i></b>");
-                    }
-                    QFont boldItalic;
-                    boldItalic.setBold(true);
-                    boldItalic.setItalic(true);
-                    if (theTable->item(j, COLUMN_NUMBER)) theTable->item(j, COLUMN_NUMBER)->setFont(boldItalic);
-                    if (theTable->item(j, COLUMN_PITCH))  theTable->item(j, COLUMN_PITCH)->setFont(boldItalic);
-                    if (theTable->item(j, COLUMN_TEMPO))  theTable->item(j, COLUMN_TEMPO)->setFont(boldItalic);
-                }
-            }
-
+            refreshPlaylistTitle(i, j, settingsCache);  // for each title in the table
         }
 
     }
@@ -1959,6 +1920,109 @@ void MainWindow::refreshAllPlaylists() {
     adjustFontSizes();
 }
 
+// Redraws the title of one palette slot row, e.g. because its song's tags changed.
+void MainWindow::refreshPlaylistTitle(int slot, int row, const QHash<QString, SongSetting> &settingsCache) {
+    QTableWidget *playlistTables[3] = {ui->playlist1Table, ui->playlist2Table, ui->playlist3Table};
+    QTableWidget *theTable = playlistTables[slot];
+    QString relativePath;
+    QString PlaylistFileName;
+    if (dynamic_cast<QLabel*>(theTable->cellWidget(row, 1)) != nullptr) {
+        // QString title = dynamic_cast<QLabel*>(theTable->cellWidget(row, 1))->text(); // don't need this right now...
+        relativePath = theTable->item(row, COLUMN_PATH)->text();
+        relativePath.replace(musicRootPath, "");
+
+        PlaylistFileName = musicRootPath + PLAYLISTS_PATH_PREFIX + relPathInSlot[slot] + CSV_FILE_EXTENSION;
+        // qDebug() << "refreshAllPlaylists: relativePath, PlaylistFileName:" << relativePath << PlaylistFileName;
+
+        // Determine if this row should be indented (issue #1547)
+        bool shouldIndent = shouldIndentPlaylistRow(theTable, row);
+
+        // this is what we want: "/patter/RIV 1180 - Sea Chanty.mp3" "/Users/mpogue/Library/CloudStorage/Box-Box/__squareDanceMusic_Box/playlists/Jokers/2024/Jokers_2024.06.05.csv"
+        QString theCanonicalRelativePath = makeCanonicalRelativePath(relativePath); // display as "LABEL NUM - Title", even if filename is reversed (issue #1665)
+        setTitleField(theTable, row, theCanonicalRelativePath, true, PlaylistFileName, relativePath, shouldIndent, &settingsCache);
+
+        // Re-apply loaded-song highlighting (bold+italic) if setTitleField() just replaced it (issue #1601)
+        if (theTable->item(row, COLUMN_LOADED) && theTable->item(row, COLUMN_LOADED)->text() == "1") {
+            QLabel *titleLabel = dynamic_cast<QLabel*>(theTable->cellWidget(row, COLUMN_TITLE));
+            if (titleLabel) {
+                QString html = titleLabel->text();
+                html.replace(QRegularExpression("</?b>"), "");
+                html.replace(QRegularExpression("</?i>"), "");
+                titleLabel->setText("<b><i>" + html + "</i></b>");
+            }
+            QFont boldItalic;
+            boldItalic.setBold(true);
+            boldItalic.setItalic(true);
+            if (theTable->item(row, COLUMN_NUMBER)) theTable->item(row, COLUMN_NUMBER)->setFont(boldItalic);
+            if (theTable->item(row, COLUMN_PITCH))  theTable->item(row, COLUMN_PITCH)->setFont(boldItalic);
+            if (theTable->item(row, COLUMN_TEMPO))  theTable->item(row, COLUMN_TEMPO)->setFont(boldItalic);
+        }
+    }
+}
+
+// SongSettings::saveSettings() tells us what changed for which song, so only that song's rows are
+//   redrawn, rather than every palette slot (refreshAllPlaylists()) and the darkSongTable.  Pitch and
+//   tempo cells are already updated by the code that changes them, so for now this is just tags.
+void MainWindow::songSettingChanged(const QString &filenameWithPathNormalized, const SongSetting &changes) {
+    songSettingsChanged(QStringList(filenameWithPathNormalized), changes);
+}
+
+// ...and SongSettings::saveSettingsForSongs() tells us about all of the songs at once (e.g. a tag
+//   added to 500 selected songs), so that each table is walked (and the fonts adjusted) only once.
+void MainWindow::songSettingsChanged(const QStringList &filenamesWithPathNormalized, const SongSetting &changes) {
+    if (!changes.isSetTags()) {
+        return;
+    }
+
+    QSet<QString> changedPaths(filenamesWithPathNormalized.cbegin(), filenamesWithPathNormalized.cend());
+    const QHash<QString, SongSetting> &settingsCache = songSettings.allSongSettings();
+
+    QTableWidget *playlistTables[3] = {ui->playlist1Table, ui->playlist2Table, ui->playlist3Table};
+    bool anyRows = false;
+    for (int i = 0; i < 3; i++) {
+        if (relPathInSlot[i].startsWith(APPLE_MUSIC_PATH_PREFIX)) {
+            continue;  // see refreshAllPlaylists()
+        }
+        QTableWidget *theTable = playlistTables[i];
+        for (int j = 0; j < theTable->rowCount(); j++) {
+            if (theTable->item(j, COLUMN_PATH) == nullptr) {
+                continue;
+            }
+            QString relativePath = theTable->item(j, COLUMN_PATH)->text();
+            relativePath.replace(musicRootPath, "");
+            if (changedPaths.contains(relativePath)) {
+                refreshPlaylistTitle(i, j, settingsCache);
+                anyRows = true;
+            }
+        }
+    }
+    if (anyRows) {
+        adjustFontSizes();  // see refreshAllPlaylists()
+    }
+
+    for (int row = 0; row < ui->darkSongTable->rowCount(); row++) {
+        QString rowPath = ui->darkSongTable->item(row, kPathCol)->data(Qt::UserRole).toString();
+        QString relativePath = rowPath.mid(musicRootPath.length());
+        if (rowPath.startsWith(musicRootPath) && changedPaths.contains(relativePath)) {
+            updateDarkSongTableTitle(row, settingsCache.value(relativePath));
+        }
+    }
+}
+
+// SongSettings::setTagColors() can change every song's title (and drops the tags that lost their
+//   color from every song that had them), so nothing short of redrawing all of them will do.
+void MainWindow::refreshAllSongTitles() {
+    refreshAllPlaylists();
+
+    const QHash<QString, SongSetting> &settingsCache = songSettings.allSongSettings();
+    for (int row = 0; row < ui->darkSongTable->rowCount(); row++) {
+        QString rowPath = ui->darkSongTable->item(row, kPathCol)->data(Qt::UserRole).toString();
+        if (rowPath.startsWith(musicRootPath)) {
+            updateDarkSongTableTitle(row, settingsCache.value(rowPath.mid(musicRootPath.length())));
+        }
+    }
+}
+
 #ifdef NEWAPPLEMUSICINTEGRATION
 void MainWindow::getAppleMusicInfo() {
     // This is the new integration with Apple Music (much faster, more powerful)
@@ -1974,6 +2038,8 @@ void MainWindow::getAppleMusicInfo() {
     // qDebug() << tracks.size() << " tracks found.";
 
     // start PLAYLISTS from nothing -----------------
+    songRecords.remove(*pathStackApplePlaylists);
+    songRecords.remove(*pathStackNewApplePlaylists);
     pathStackApplePlaylists->clear();
     pathStackNewApplePlaylists->clear();
     allAppleMusicPlaylists.clear();
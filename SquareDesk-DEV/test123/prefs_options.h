@@ -114,6 +114,7 @@ CONFIG_ATTRIBUTE_BOOLEAN(enableAppleMusicCheckbox,enableAppleMusic, false)
 //CONFIG_ATTRIBUTE_BOOLEAN(enableFlashCallsCheckbox,enableFlashCalls, false)
 
 CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(normalizeTrackAudio, false);
+CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(normalizeTrackLoudness, false);
 
 CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(autostartplayback, false);
 CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(forcemono, false);
@@ -187,6 +188,10 @@ CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(SDCallListCopyDeepUndoBuffer, true);
 
 CONFIG_ATTRIBUTE_STRING_NO_PREFS(SDLevel, "Plus"); // SD's input level is persistent
 
+// keep the working copy of SquareDesk.sqlite3 on the local disk, and mirror it to <musicRoot>/.squaredesk
+//   in the background (for music roots on iCloud/Dropbox/NAS folders; see songsettingsmirror.h)
+CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(useLocalSettingsDatabase, false);
+
 CONFIG_ATTRIBUTE_STRING_NO_PREFS(SDColoringScheme,  "Normal");  // SD's colors are persistent
 CONFIG_ATTRIBUTE_STRING_NO_PREFS(SDNumberingScheme, "Numbers"); // SD's numbers are persistent
 CONFIG_ATTRIBUTE_STRING_NO_PREFS(SDGenderingScheme, "Normal");  // SD's genders are persistent
@@ -23,6 +23,8 @@
 **
 ****************************************************************************/
 #include <QLocale>
+#include <QProgressDialog>
+#include <QEventLoop>
 
 #include "songhistoryexportdialog.h"
 #include "ui_songhistoryexportdialog.h"
@@ -31,6 +33,7 @@
 #include "sessioninfo.h"
 #include "globaldefines.h"
 #include "mainwindow.h"
+#include "songplayhistoryquery.h"
 
 SongHistoryExportDialog::SongHistoryExportDialog(QWidget *parent) :
     QDialog(parent),
@@ -96,6 +99,20 @@ void SongHistoryExportDialog::populateOptions(SongSettings &songSettings)
         ui->comboBoxSession->addItem(session.name, session.id);
     }
 
+    ui->comboBoxReport->clear();
+    ui->comboBoxReport->addItem("Every song played", SongPlayHistoryQuery::History);
+    ui->comboBoxReport->addItem("Plays per song, per session", SongPlayHistoryQuery::PlaysPerSongPerSession);
+    ui->comboBoxReport->addItem("Plays per month", SongPlayHistoryQuery::PlaysPerMonth);
+    ui->comboBoxReport->addItem("Songs not played in the last", SongPlayHistoryQuery::NotPlayedInDays);
+    ui->spinBoxNotPlayedDays->setEnabled(false);
+    connect(ui->comboBoxReport, &QComboBox::currentIndexChanged,
+            this, [this](int) {
+                bool notPlayed = ui->comboBoxReport->currentData().toInt() == SongPlayHistoryQuery::NotPlayedInDays;
+                ui->spinBoxNotPlayedDays->setEnabled(notPlayed);
+                ui->dateTimeEditStart->setEnabled(!notPlayed && !ui->checkBoxOmitStart->isChecked());  // dates don't apply to it
+                ui->dateTimeEditEnd->setEnabled(!notPlayed && !ui->checkBoxOmitEnd->isChecked());
+            });
+
     ui->checkBoxOpenAfterExport->setChecked(true);
 }
 
@@ -192,22 +209,80 @@ QString SongHistoryExportDialog::exportSongPlayData(SongSettings &settings, QStr
         FileExportSongPlayEvent fespe(stream, mainWindow);
         
         QString dateFormat("yyyy-MM-dd HH:mm:ss.sss");
-        QString startDate = ui->dateTimeEditStart->dateTime().toUTC().toString(dateFormat);
-        QString endDate = ui->dateTimeEditEnd->dateTime().toUTC().toString(dateFormat);
 
-        // DDD(startDate)
-        // DDD(endDate)
-
-        bool omitStartDate = ui->checkBoxOmitStart->isChecked();
-        bool omitEndDate = ui->checkBoxOmitEnd->isChecked();
-        int session_id = ui->comboBoxSession->currentData().toInt();
+        SongPlayHistoryQuery::Options options;
+        options.report = static_cast<SongPlayHistoryQuery::Report>(ui->comboBoxReport->currentData().toInt());
+        options.sessionID = ui->comboBoxSession->currentData().toInt();
+        options.omitStartDate = ui->checkBoxOmitStart->isChecked();
+        options.startDate = ui->dateTimeEditStart->dateTime().toUTC().toString(dateFormat);
+        options.omitEndDate = ui->checkBoxOmitEnd->isChecked();
+        options.endDate = ui->dateTimeEditEnd->dateTime().toUTC().toString(dateFormat);
+        options.notPlayedDays = ui->spinBoxNotPlayedDays->value();
+        options.rootDir = settings.primaryRootDir();
+
+        // DDD(options.startDate)
+        // DDD(options.endDate)
+
+        if (options.report == SongPlayHistoryQuery::History) {
+            stream << "\"labelID\",\"Song\",\"when played (local)\",\"when played (UTC)\",\"filename\",\"pitch\",\"tempo\",\"last_cuesheet\"\n"; // CSV HEADER
+        } else {
+            QStringList columns = SongPlayHistoryQuery::columnNames(options.report);
+            for (int i = 0; i < columns.size(); i++) {
+                outputString(stream, columns[i], true);
+                stream << (i + 1 < columns.size() ? "," : "\n");
+            }
+        }
 
-        stream << "\"labelID\",\"Song\",\"when played (local)\",\"when played (UTC)\",\"filename\",\"pitch\",\"tempo\",\"last_cuesheet\"\n"; // CSV HEADER
-        settings.getSongPlayHistory(fespe, session_id,
-                                    omitStartDate,
-                                    startDate,
-                                    omitEndDate,
-                                    endDate);
+        // The query runs on its own thread, and we write each page as it arrives, so the window keeps
+        //   repainting, the export can be cancelled, and only a few pages are ever in memory.
+        settings.flushWrites();  // so that the plays still in the write-behind queue are in the history, too
+        SongPlayHistoryQuery query(settings.databaseName(), options);
+
+        QProgressDialog progress("Exporting song play history...", "Cancel", 0, 0, mainWindow);
+        progress.setWindowModality(Qt::WindowModal);
+        progress.setMinimumDuration(500);  // most exports are done before it would appear
+
+        int rowsWritten = 0;
+        bool ok = true;
+        QEventLoop loop;
+        connect(&query, &SongPlayHistoryQuery::totalRows, &progress, &QProgressDialog::setMaximum);
+        connect(&query, &SongPlayHistoryQuery::page, &loop, [&](const QList<QStringList> &rows) {
+            for (const auto &row : rows) {
+                if (options.report == SongPlayHistoryQuery::History) {
+                    fespe(row[0], row[1], row[2], row[3], row[4], row[5], row[6]);
+                } else {
+                    for (int i = 0; i < row.size(); i++) {
+                        outputString(stream, row[i], true);
+                        stream << (i + 1 < row.size() ? "," : "\n");
+                    }
+                }
+            }
+            rowsWritten += rows.size();
+            if (progress.maximum() > 0) {
+                progress.setValue(rowsWritten);
+            }
+            query.pageConsumed();
+        });
+        connect(&query, &SongPlayHistoryQuery::failed, &loop, [&](const QString &error) {
+            qDebug() << "exportSongPlayData:" << error;
+            ok = false;
+        });
+        connect(&progress, &QProgressDialog::canceled, &loop, [&]() {
+            query.cancel();
+            ok = false;
+        });
+        connect(&query, &QThread::finished, &loop, &QEventLoop::quit);
+
+        query.start();
+        loop.exec();
+        progress.reset();
+
+        stream.flush();
+        file.close();
+        if (!ok) {
+            file.remove();  // don't leave half an export behind
+            return("");
+        }
 
         if (ui->checkBoxOpenAfterExport->isChecked()) {
                 // NOWADAYS DO THIS FOR ALL FILES/ALL PLATFORMS:
@@ -218,7 +293,7 @@ QString SongHistoryExportDialog::exportSongPlayData(SongSettings &settings, QStr
         QFileInfo fileInfo(filename);
         QString directoryPath = fileInfo.absolutePath();
         lastSaveExt = "." + fileInfo.suffix().right(3);  // Update the extension (e.g., ".csv" or ".txt"), max 3 chars
-        return(directoryPath); // successful return, update the lastExportSongHistoryDir in preferences
+        return(directoryPath); // successful return, update the lastExportSaveHistoryDir in preferences
     } // end of successful open
     return(""); // error return
 }
@@ -50,6 +50,10 @@
 #define kPitchCol 7
 #define kTempoCol 8
 
+// the title HTML (title + tag pills) is stored in this role of the kTitleCol item, and is
+//   painted by the DarkSongTitleDelegate (DisplayRole stays empty, so nothing is drawn twice)
+#define kTitleHTMLRole (Qt::UserRole + 1)
+
 class SongRow : public SongSetting
 {
 public:
@@ -0,0 +1,252 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songplayhistoryquery.h"
+#include "songsettings.h"
+
+#include <QtSql>
+#include <QDebug>
+
+SongPlayHistoryQuery::SongPlayHistoryQuery(const QString &databaseName, const Options &options, QObject *parent) :
+    QThread(parent),
+    databaseName(databaseName),
+    options(options),
+    pagesAllowed(SONGPLAYHISTORY_PAGES_IN_FLIGHT)
+{
+}
+
+SongPlayHistoryQuery::~SongPlayHistoryQuery()
+{
+    cancel();
+    wait();
+}
+
+void SongPlayHistoryQuery::cancel()
+{
+    requestInterruption();
+}
+
+void SongPlayHistoryQuery::pageConsumed()
+{
+    pagesAllowed.release();
+}
+
+QStringList SongPlayHistoryQuery::columnNames(Report report)
+{
+    switch (report)
+    {
+    case History:
+        return QStringList() << "Song" << "when played (UTC)" << "when played (local)" << "filename" << "pitch" << "tempo" << "last_cuesheet";
+    case PlaysPerSongPerSession:
+        return QStringList() << "Song" << "filename" << "session" << "plays" << "last played (local)";
+    case PlaysPerMonth:
+        return QStringList() << "month" << "plays" << "different songs";
+    case NotPlayedInDays:
+        return QStringList() << "Song" << "filename" << "last played (local)";
+    }
+    return QStringList();
+}
+
+// The session and date filters, on song_plays (or song_last_played, for NotPlayedInDays).  played_on
+//   comes first in song_plays_played_on_idx, so a date range only reads that part of the index.
+QString SongPlayHistoryQuery::whereClause(const QString &table) const
+{
+    QStringList where;
+    if (options.sessionID)
+    {
+        where.append(table + ".session_rowid=:session_rowid");
+    }
+    if (options.report != NotPlayedInDays)
+    {
+        if (!options.omitStartDate)
+        {
+            where.append(table + ".played_on > :start_date");
+        }
+        if (!options.omitEndDate)
+        {
+            where.append(table + ".played_on < :end_date");
+        }
+    }
+    return where.join(" AND ");
+}
+
+QString SongPlayHistoryQuery::sql() const
+{
+    QString where = whereClause(options.report == NotPlayedInDays ? "song_last_played" : "song_plays");
+
+    switch (options.report)
+    {
+    case History:
+        // #1684: song_plays is the driving table here, and the join to songs is a LEFT JOIN, so that a
+        //   play whose song_rowid matches no song (written by older versions, which recorded -1 when the
+        //   song was not yet in the songs table) still shows up, rather than silently disappearing.
+        return "SELECT COALESCE(songs.name,'<song not recorded>'), played_on, datetime(played_on,'localtime'), COALESCE(songs.filename,''), pitch, tempo, last_cuesheet "
+               "FROM song_plays LEFT JOIN songs ON songs.rowid=song_plays.song_rowid" +
+               (where.isEmpty() ? QString() : " WHERE " + where) +
+               " ORDER BY song_plays.played_on";
+
+    case PlaysPerSongPerSession:
+        // song_play_song_session_played_idx covers the song_plays side of this
+        return "SELECT COALESCE(songs.name,'<song not recorded>'), COALESCE(songs.filename,''), COALESCE(sessions.name,''), plays, datetime(last_played,'localtime') "
+               "FROM (SELECT song_rowid, session_rowid, count(*) AS plays, max(played_on) AS last_played FROM song_plays" +
+               (where.isEmpty() ? QString() : " WHERE " + where) +
+               " GROUP BY song_rowid, session_rowid) AS counts "
+               "LEFT JOIN songs ON songs.rowid=counts.song_rowid "
+               "LEFT JOIN sessions ON sessions.rowid=counts.session_rowid "
+               "ORDER BY plays DESC";
+
+    case PlaysPerMonth:
+        // song_plays_played_on_idx covers this
+        return "SELECT strftime('%Y-%m', played_on, 'localtime') AS month, count(*), count(DISTINCT song_rowid) FROM song_plays" +
+               (where.isEmpty() ? QString() : " WHERE " + where) +
+               " GROUP BY month ORDER BY month";
+
+    case NotPlayedInDays:
+        // song_last_played has one row per song per session, so this never touches song_plays at all
+        return "SELECT songs.name, songs.filename, datetime(last_played,'localtime') "
+               "FROM songs LEFT JOIN (SELECT song_rowid, max(played_on) AS last_played FROM song_last_played" +
+               (where.isEmpty() ? QString() : " WHERE " + where) +
+               " GROUP BY song_rowid) AS last ON last.song_rowid=songs.rowid "
+               "WHERE last_played IS NULL OR last_played < datetime('now', :age) "
+               "ORDER BY last_played";
+    }
+    return QString();
+}
+
+void SongPlayHistoryQuery::run()
+{
+    QString connectionName = QString("SongPlayHistoryQuery_%1").arg(reinterpret_cast<quintptr>(this));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databaseName);
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");  // the writer thread may be committing
+        if (!db.open())
+        {
+            emit failed(db.lastError().text());
+        }
+        else
+        {
+            SongSettings::configureConnection(db, false);
+
+            auto bindFilters = [this](QSqlQuery &q) {
+                if (options.sessionID)
+                {
+                    q.bindValue(":session_rowid", options.sessionID);
+                }
+                if (options.report == NotPlayedInDays)
+                {
+                    q.bindValue(":age", QString("-%1 days").arg(options.notPlayedDays));
+                    return;
+                }
+                if (!options.omitStartDate)
+                {
+                    q.bindValue(":start_date", options.startDate);
+                }
+                if (!options.omitEndDate)
+                {
+                    q.bindValue(":end_date", options.endDate);
+                }
+            };
+
+            int total = 0;
+            if (options.report == History)
+            {
+                QString where = whereClause("song_plays");
+                QSqlQuery q(db);
+                q.prepare("SELECT count(*) FROM song_plays" + (where.isEmpty() ? QString() : " WHERE " + where));
+                bindFilters(q);
+                if (q.exec() && q.next())
+                {
+                    total = q.value(0).toInt();
+                }
+            }
+            emit totalRows(total);
+
+            QSqlQuery q(db);
+            q.setForwardOnly(true);  // rows are streamed, never revisited
+            q.prepare(sql());
+            bindFilters(q);
+            if (!q.exec())
+            {
+                qDebug() << "SongPlayHistoryQuery:" << q.lastQuery() << ":" << q.lastError();
+                emit failed(q.lastError().text());
+            }
+            else
+            {
+                int columns = columnNames(options.report).size();
+                QList<QStringList> rows;
+                rows.reserve(SONGPLAYHISTORY_PAGE_SIZE);
+
+                // waits for the consumer to catch up, so that pages don't pile up in its event queue
+                auto sendPage = [this, &rows]() -> bool {
+                    while (!pagesAllowed.tryAcquire(1, 100))
+                    {
+                        if (isInterruptionRequested())
+                        {
+                            return false;
+                        }
+                    }
+                    emit page(rows);
+                    rows.clear();
+                    return true;
+                };
+
+                bool cancelled = false;
+                while (q.next())
+                {
+                    if (isInterruptionRequested())
+                    {
+                        cancelled = true;
+                        break;
+                    }
+                    QStringList row;
+                    row.reserve(columns);
+                    for (int i = 0; i < columns; ++i)
+                    {
+                        row.append(q.value(i).toString());
+                    }
+                    if (options.report == History && !options.rootDir.isEmpty() && row[6].startsWith(options.rootDir))
+                    {
+                        row[6].remove(0, options.rootDir.length());  // last_cuesheet, relative to the music root
+                    }
+                    rows.append(row);
+
+                    if (rows.size() == SONGPLAYHISTORY_PAGE_SIZE && !sendPage())
+                    {
+                        cancelled = true;
+                        break;
+                    }
+                }
+                if (!cancelled && !rows.isEmpty())
+                {
+                    sendPage();
+                }
+            }
+            q.finish();
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
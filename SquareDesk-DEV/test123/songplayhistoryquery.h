@@ -0,0 +1,94 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGPLAYHISTORYQUERY_H_INCLUDED
+#define SONGPLAYHISTORYQUERY_H_INCLUDED
+
+#include <QThread>
+#include <QSemaphore>
+#include <QStringList>
+#include <QList>
+
+#define SONGPLAYHISTORY_PAGE_SIZE 500       // rows per page() signal
+#define SONGPLAYHISTORY_PAGES_IN_FLIGHT 4   // how far the query may get ahead of whoever is consuming the pages
+
+// Song play history (and reports on it), read on its own thread and connection, and handed to the GUI
+//   thread a page at a time.  Years of song_plays rows used to be read (and exported) on the GUI
+//   thread in one go, which froze the window.  Now memory stays at a few pages no matter how long the
+//   history is: the query waits for the consumer to call pageConsumed() before it gets more than
+//   SONGPLAYHISTORY_PAGES_IN_FLIGHT pages ahead.
+//
+//   Usage: connect totalRows()/page()/finished(), then start().  cancel() (or deleting it) stops the
+//   query at the next row.  Queued writes must be flushed first (SongSettings::flushWrites()), or the
+//   most recent plays won't be in the results.
+class SongPlayHistoryQuery : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum Report {
+        History,                    // every play: name, UTC, local time, filename, pitch, tempo, last_cuesheet
+        PlaysPerSongPerSession,     // name, filename, session, plays, last played (local)
+        PlaysPerMonth,              // month (local), plays, distinct songs
+        NotPlayedInDays             // name, filename, last played (local), for songs not played in notPlayedDays
+    };
+
+    struct Options {
+        Report report = History;
+        int sessionID = 0;              // 0 = all sessions
+        bool omitStartDate = true;
+        QString startDate;              // UTC, "yyyy-MM-dd HH:mm:ss.sss"
+        bool omitEndDate = true;
+        QString endDate;                // UTC
+        int notPlayedDays = 30;         // NotPlayedInDays only
+        QString rootDir;                // stripped from last_cuesheet (see SongSettings::removeRootDirs())
+    };
+
+    SongPlayHistoryQuery(const QString &databaseName, const Options &options, QObject *parent = nullptr);
+    ~SongPlayHistoryQuery();                        // cancels, then waits for the thread
+
+    static QStringList columnNames(Report report);
+
+    void cancel();
+    void pageConsumed();                            // call once for every page() handled
+
+signals:
+    void totalRows(int total);                      // before the first page; 0 = not counted (the reports, which are short)
+    void page(const QList<QStringList> &rows);
+    void failed(const QString &error);
+
+protected:
+    void run() override;
+
+private:
+    QString databaseName;
+    Options options;
+    QSemaphore pagesAllowed;
+
+    QString whereClause(const QString &table) const;
+    QString sql() const;
+};
+
+#endif /* ifndef SONGPLAYHISTORYQUERY_H_INCLUDED */
@@ -0,0 +1,129 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songrecordstore.h"
+
+void SongRecordStore::setMusicRoot(const QString &root)
+{
+    if (root != musicRoot) {
+        musicRoot = root;
+        clear();
+    }
+}
+
+void SongRecordStore::clear()
+{
+    records.clear();
+    freeIds.clear();
+    idByEntry.clear();
+    strings.clear();
+}
+
+QString SongRecordStore::intern(const QString &s)
+{
+    auto it = strings.constFind(s);
+    if (it != strings.constEnd()) {
+        return *it;  // shares the pooled buffer
+    }
+    strings.insert(s);
+    return s;
+}
+
+int SongRecordStore::idFor(const QString &entry)
+{
+    auto it = idByEntry.constFind(entry);
+    if (it != idByEntry.constEnd()) {
+        return it.value();
+    }
+
+    SongRecord r;
+    r.entry = entry;
+
+    // split "type#!#path" by hand, rather than with QString::split (no QStringList, no regex)
+    QStringView e(entry);
+    qsizetype sep = e.indexOf(QLatin1String("#!#"));
+    qsizetype pathStart = (sep >= 0 ? sep + 3 : 0);
+    qsizetype pathEnd = e.indexOf(QLatin1String("#!#"), pathStart);  // pathStackCuesheets entries have a trailing "#!#level"
+    if (pathEnd < 0) {
+        pathEnd = e.length();
+    }
+    if (sep >= 0) {
+        r.type = intern(entry.left(sep));
+    }
+    QStringView path = e.mid(pathStart, pathEnd - pathStart);
+    r.pathStart = static_cast<int>(pathStart);
+    r.pathLength = static_cast<int>(path.length());
+
+    // same results as QFileInfo::path()/completeBaseName()/suffix(), but without touching the filesystem
+    qsizetype slash = path.lastIndexOf('/');
+    QStringView fileName = (slash >= 0 ? path.mid(slash + 1) : path);
+    r.dirPath = intern(slash >= 0 ? path.left(slash).toString() : QString("."));
+    qsizetype dot = fileName.lastIndexOf('.');
+    r.baseNameStart = static_cast<int>(pathStart + (slash >= 0 ? slash + 1 : 0));
+    r.baseNameLength = static_cast<int>(dot >= 0 ? dot : fileName.length());
+    r.suffix = intern(dot >= 0 ? fileName.mid(dot + 1).toString().toLower() : QString());
+    r.isMusic = (r.suffix == QLatin1String("mp3") || r.suffix == QLatin1String("m4a") ||
+                 r.suffix == QLatin1String("wav") || r.suffix == QLatin1String("flac"));
+
+    // the same part of the path that filepath2SongCategoryName() looks at: the music root is taken off
+    //   the front (if it's there), and then it's the second "/"-separated part, e.g. "patter" for
+    //   "<root>/patter/x.mp3", but also "x.mp3" for "<root>/x.mp3", and "users" for "/Users/..."
+    QStringView rest = (path.startsWith(musicRoot) ? path.mid(musicRoot.length()) : path);
+    qsizetype first = rest.indexOf('/');
+    if (first >= 0) {
+        qsizetype second = rest.indexOf('/', first + 1);
+        r.folder = intern(rest.mid(first + 1, (second >= 0 ? second : rest.length()) - first - 1).toString().toLower());
+        r.hasFolder = true;
+    }
+
+    if (freeIds.isEmpty()) {
+        r.id = static_cast<int>(records.size());
+        records.append(r);
+    } else {
+        r.id = freeIds.takeLast();
+        records[r.id] = r;
+    }
+    idByEntry.insert(entry, r.id);
+    return r.id;
+}
+
+void SongRecordStore::remove(const QString &entry)
+{
+    auto it = idByEntry.find(entry);
+    if (it == idByEntry.end()) {
+        return;
+    }
+    int id = it.value();
+    idByEntry.erase(it);
+    records[id] = SongRecord();  // lets go of its strings now, rather than at the next reload
+    freeIds.append(id);
+}
+
+void SongRecordStore::remove(const QList<QString> &entries)
+{
+    for (const auto &entry : entries) {
+        remove(entry);
+    }
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGRECORDSTORE_H_INCLUDED
+#define SONGRECORDSTORE_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+// One entry from a pathStack ("type#!#/full/path.mp3", "PlaylistName%!%pitch,tempo,NN#!#/full/path.mp3",
+//   "ApplePlaylist$!$NN$!$Title#!#/full/path.m4a"), split ONCE into its parts.
+//
+// The record does NOT keep its own copy of the path: entry is the pathStack's own (implicitly shared)
+//   string, and path() and baseName() are cut out of it when asked for.  The small, highly repetitive
+//   strings (type, directory, suffix, category folder) are interned, so 20k songs in a handful of
+//   folders share a handful of QString buffers instead of 20k copies.
+struct SongRecord {
+    int     id = -1;           // stable for as long as the entry is in the store
+    QString entry;            // the original encoded pathStack entry (implicitly shared with the pathStack)
+    QString type;             // everything before the first "#!#" (may contain "%!%" or "$!$" markers)
+    QString dirPath;          // QFileInfo::path()
+    QString suffix;           // lowercase, without the dot (e.g. "mp3")
+    QString folder;           // lowercase folder name that filepath2SongCategoryName() looks at (e.g. "patter")
+    bool    hasFolder = false; // false when filepath2SongCategoryName() would say "unknown"
+    bool    isMusic = false;  // suffix is one of mp3/m4a/wav/flac
+
+    QString path() const { return entry.mid(pathStart, pathLength); }            // the full path to the file
+    QString baseName() const { return entry.mid(baseNameStart, baseNameLength); } // QFileInfo::completeBaseName()
+
+    int     pathStart = 0, pathLength = 0;          // where they are in entry
+    int     baseNameStart = 0, baseNameLength = 0;
+
+    // breakFilenameIntoParts() results for baseName, filled in lazily (they depend on the filename format pref)
+    int     partsFormat = -1; // songFilenameFormat these were parsed with, -1 = not parsed yet
+    QString label;
+    QString labelnum;         // includes labelnum_extra
+    QString title;
+    QString shortTitle;
+};
+
+// breakFilenameIntoParts() results for one filename (see MainWindow::filenamePartsCache)
+struct FilenameParts {
+    bool    foundParts = false;
+    QString label;
+    QString labelnum;
+    QString labelnum_extra;
+    QString title;
+    QString shortTitle;
+};
+
+class SongRecordStore {
+public:
+    SongRecordStore() {}
+
+    void setMusicRoot(const QString &root);   // also clears the store (folder depends on it), but only if root changed
+    void clear();
+
+    int idFor(const QString &entry);          // returns the existing id, or splits entry into a new record
+    void remove(const QString &entry);        // when the entry leaves its pathStack (its id may be reused)
+    void remove(const QList<QString> &entries);
+    int find(const QString &entry) const { return idByEntry.value(entry, -1); }  // -1 if not split yet
+    SongRecord &record(int id) { return records[id]; }
+    const SongRecord &record(int id) const { return records[id]; }
+    int size() const { return static_cast<int>(records.size()); }
+
+    QString intern(const QString &s);
+
+private:
+    QString musicRoot;
+    QVector<SongRecord> records;
+    QVector<int> freeIds;                     // records[] slots left by remove()
+    QHash<QString, int> idByEntry;
+    QSet<QString> strings;                    // intern pool
+};
+
+#endif /* ifndef SONGRECORDSTORE_H_INCLUDED */
@@ -0,0 +1,230 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songsearchindex.h"
+
+#include <algorithm>
+#include <numeric>
+
+void SongSearchIndex::clear()
+{
+    for (int f = 0; f < NumFields; f++) {
+        entries[f].clear();
+    }
+    rowTags.clear();
+    postings.clear();
+}
+
+quint64 SongSearchIndex::trigramKey(int field, QChar a, QChar b, QChar c)
+{
+    return (static_cast<quint64>(field) << 48) |
+           (static_cast<quint64>(a.unicode()) << 32) |
+           (static_cast<quint64>(b.unicode()) << 16) |
+            static_cast<quint64>(c.unicode());
+}
+
+void SongSearchIndex::addRow(const QString (&texts)[NumFields], const int (&titleEnds)[NumFields], quintptr tag)
+{
+    int row = rowCount();
+    rowTags.append(tag);
+
+    for (int f = 0; f < NumFields; f++) {
+        entries[f].append(Entry{texts[f], titleEnds[f]});
+
+        QString folded = texts[f].toCaseFolded();
+        for (qsizetype i = 0; i + 2 < folded.length(); i++) {
+            QVector<int> &rows = postings[trigramKey(f, folded[i], folded[i+1], folded[i+2])];
+            if (rows.isEmpty() || rows.last() != row) {
+                rows.append(row);  // rows are added in order, so posting lists stay sorted and unique
+            }
+        }
+    }
+}
+
+// Same rules as filterContains() always had, minus the HTML clean-up (done once, when indexing):
+//   words must appear in order in the title part, "#word" matches only in the tags, "-word" excludes.
+bool SongSearchIndex::containsWords(const QString &str, int title_end, const QStringList &list)
+{
+    if (list.isEmpty())
+        return true;
+
+    int index = 0;
+
+    if (title_end < 0) title_end = static_cast<int>(str.length());
+
+    for (const auto &t : list)
+    {
+        QString filterWord(t);
+        bool tagsOnly(false);
+        bool exclude(false);
+
+        while (filterWord.length() > 0 &&
+               ('#' == filterWord[0] ||
+                '-' == filterWord[0]))
+        {
+            tagsOnly = ('#' == filterWord[0]);
+            exclude = ('-' == filterWord[0]);
+            filterWord.remove(0,1);
+        }
+        if (filterWord.length() == 0)
+            continue;
+
+        // Keywords can get matched in any order
+        if (index > title_end)
+            index = title_end;
+        int i = static_cast<int>(str.indexOf(filterWord,
+                                             tagsOnly ? title_end : (exclude ? 0 : index),
+                                             Qt::CaseInsensitive));
+        if (i < 0)
+        {
+            if (!exclude)
+                return false;
+        }
+        else
+        {
+            if (exclude)
+                return false;
+        }
+        if (!tagsOnly && !exclude)
+            index = i + static_cast<int>(t.length());
+    }
+    return true;
+}
+
+QVector<int> SongSearchIndex::intersect(const QVector<int> &a, const QVector<int> &b)
+{
+    QVector<int> result;
+    result.reserve(std::min(a.size(), b.size()));
+    std::set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(result));
+    return result;
+}
+
+QVector<int> SongSearchIndex::unite(const QVector<int> &a, const QVector<int> &b)
+{
+    QVector<int> result;
+    result.reserve(a.size() + b.size());
+    std::set_union(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(result));
+    return result;
+}
+
+// Rows that CAN match the words in this field: every trigram of every required (not excluded) word
+//   must be in the field.  Sets *all and returns nothing, if no word is long enough to narrow it down.
+QVector<int> SongSearchIndex::candidates(int field, const QStringList &words, bool *all) const
+{
+    QVector<const QVector<int> *> lists;
+    for (const auto &t : words) {
+        QString w(t);
+        bool exclude(false);
+        while (w.length() > 0 && ('#' == w[0] || '-' == w[0])) {
+            exclude = ('-' == w[0]);
+            w.remove(0,1);
+        }
+        if (exclude || w.length() < 3) {
+            continue;  // excluded words and short words can't narrow the search down
+        }
+        w = w.toCaseFolded();
+        for (qsizetype i = 0; i + 2 < w.length(); i++) {
+            auto it = postings.constFind(trigramKey(field, w[i], w[i+1], w[i+2]));
+            if (it == postings.constEnd()) {
+                *all = false;
+                return QVector<int>();  // a trigram that is nowhere in this field, so no row can match
+            }
+            lists.append(&it.value());
+        }
+    }
+
+    if (lists.isEmpty()) {
+        *all = true;
+        return QVector<int>();
+    }
+
+    // smallest list first, so that the intermediate results stay small
+    std::sort(lists.begin(), lists.end(),
+              [](const QVector<int> *a, const QVector<int> *b) { return a->size() < b->size(); });
+    QVector<int> result = *lists[0];
+    for (int i = 1; i < lists.size() && !result.isEmpty(); i++) {
+        result = intersect(result, *lists[i]);
+    }
+    *all = false;
+    return result;
+}
+
+QVector<int> SongSearchIndex::match(const QStringList &label, const QStringList &type, const QStringList &title, bool searchAllFields) const
+{
+    auto allRows = [this]() {  // for when no field can be narrowed down
+        QVector<int> rows(rowCount());
+        std::iota(rows.begin(), rows.end(), 0);
+        return rows;
+    };
+
+    QVector<int> cand;
+    if (!searchAllFields) {
+        const QStringList *words[NumFields] = { &label, &type, &title };
+        bool first = true;
+        for (int f = 0; f < NumFields; f++) {
+            bool all = false;
+            QVector<int> c = candidates(f, *words[f], &all);
+            if (all) {
+                continue;
+            }
+            cand = (first ? c : intersect(cand, c));
+            first = false;
+        }
+        if (first) {
+            cand = allRows();
+        }
+    } else {
+        bool anyAll = false;
+        for (int f = 0; f < NumFields && !anyAll; f++) {
+            bool all = false;
+            QVector<int> c = candidates(f, title, &all);
+            anyAll = all;
+            cand = unite(cand, c);
+        }
+        if (anyAll) {
+            cand = allRows();
+        }
+    }
+
+    // now check the words for real, but only in the candidate rows
+    QVector<int> result;
+    result.reserve(cand.size());
+    for (int row : std::as_const(cand)) {
+        bool show;
+        if (!searchAllFields) {
+            show = containsWords(entries[LabelField][row].text, entries[LabelField][row].titleEnd, label) &&
+                   containsWords(entries[TypeField][row].text,  entries[TypeField][row].titleEnd,  type) &&
+                   containsWords(entries[TitleField][row].text, entries[TitleField][row].titleEnd, title);
+        } else {
+            show = containsWords(entries[LabelField][row].text, entries[LabelField][row].titleEnd, title) ||
+                   containsWords(entries[TypeField][row].text,  entries[TypeField][row].titleEnd,  title) ||
+                   containsWords(entries[TitleField][row].text, entries[TitleField][row].titleEnd, title);
+        }
+        if (show) {
+            result.append(row);
+        }
+    }
+    return result;
+}
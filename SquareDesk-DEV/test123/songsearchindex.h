@@ -0,0 +1,80 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGSEARCHINDEX_H_INCLUDED
+#define SONGSEARCHINDEX_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// Type-ahead search index for the darkSongTable.
+//
+// Built once per table load (one row per table row), so that each keystroke in the search field
+//   does NOT have to regex the title HTML of every row again.  Each field's text is stored already
+//   normalized (title coloring removed, tags located), and every case-folded trigram of each field
+//   has a posting list of the rows that contain it.  A search intersects the posting lists of the
+//   search words' trigrams to get the candidate rows, and only those are checked with the (regex-free)
+//   word matching rules of filterContains().
+class SongSearchIndex {
+public:
+    enum Field { LabelField = 0, TypeField, TitleField, NumFields };
+
+    SongSearchIndex() {}
+
+    void clear();
+    int rowCount() const { return static_cast<int>(rowTags.size()); }
+
+    // texts must already be normalized (see filterContains()), titleEnd = where the tags start (or -1)
+    //   rowTag is whatever the caller uses to detect that the table was re-sorted (e.g. an item pointer)
+    void addRow(const QString (&texts)[NumFields], const int (&titleEnds)[NumFields], quintptr rowTag);
+    quintptr rowTag(int row) const { return rowTags[row]; }
+
+    // rows (ascending) where:
+    //   searchAllFields == false: label, type AND title words all match their fields
+    //   searchAllFields == true:  title words match at least one of the fields
+    QVector<int> match(const QStringList &label, const QStringList &type, const QStringList &title, bool searchAllFields) const;
+
+    // the word matching rules of filterContains(), on an already-normalized string
+    static bool containsWords(const QString &str, int titleEnd, const QStringList &list);
+
+private:
+    struct Entry {
+        QString text;
+        int titleEnd;
+    };
+
+    static quint64 trigramKey(int field, QChar a, QChar b, QChar c);
+    QVector<int> candidates(int field, const QStringList &words, bool *all) const;
+    static QVector<int> intersect(const QVector<int> &a, const QVector<int> &b);
+    static QVector<int> unite(const QVector<int> &a, const QVector<int> &b);
+
+    QVector<Entry> entries[NumFields];
+    QVector<quintptr> rowTags;
+    QHash<quint64, QVector<int> > postings;  // (field, trigram) -> rows, ascending
+};
+
+#endif /* ifndef SONGSEARCHINDEX_H_INCLUDED */
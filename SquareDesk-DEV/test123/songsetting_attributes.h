@@ -49,7 +49,7 @@ SONGSETTING_ELEMENT(int, Loop)
 
 SONGSETTING_ELEMENT(QString, Tags)
 
-//SONGSETTING_ELEMENT(double, ReplayGain)
+SONGSETTING_ELEMENT(double, ReplayGain)  // dB, to get to LOUDNESS_TARGET_LUFS
 
 // Adding a new per-song setting?  This is location 1 out of 6 to change.
 SONGSETTING_ELEMENT(QString, VSTsettings)
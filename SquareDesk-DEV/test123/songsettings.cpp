@@ -32,37 +32,56 @@
 #include <utility>
 
 #include "songsettings.h"
+#include "songsettingswriter.h"
+#include "songsettingsmirror.h"
 #include "sessioninfo.h"
 #include "default_colors.h"
 using namespace std;
 
+#define SONGSETTINGS_MMAP_SIZE      (64 * 1024 * 1024)  // bytes of the DB file to read through mmap, rather than read()
+#define SONGSETTINGS_CACHE_SIZE_KB  (8 * 1024)          // page cache, per connection (the SQLite default is 2MB)
 
 
 
-void SongSettings::exec(const char *where, QSqlQuery &q)
+
+bool SongSettings::exec(const char *where, QSqlQuery &q)
+{
+    return exec(m_db, where, q);
+}
+
+// same, but on another connection (the write-behind thread has its own)
+// (success is the query's own: the connection's lastError() is whatever its last open() left there)
+bool SongSettings::exec(QSqlDatabase &db, const char *where, QSqlQuery &q)
 {
-    q.exec();
-    debugErrors(where, q);
+    bool ok = q.exec();
+    debugErrors(db, where, q);
+    return ok;
 }
 
-void SongSettings::exec(const char *where, QSqlQuery &q, const QString &str)
+bool SongSettings::exec(const char *where, QSqlQuery &q, const QString &str)
 {
-    q.exec(str);
+    bool ok = q.exec(str);
     if (debugErrors(where, q))
     {
         qInfo() << str;
     }
+    return ok;
 }
 
 
 bool SongSettings::debugErrors(const char *where, QSqlQuery & q)
+{
+    return debugErrors(m_db, where, q);
+}
+
+bool SongSettings::debugErrors(QSqlDatabase &db, const char *where, QSqlQuery & q)
 {
     bool hadError = false;
-    if (m_db.lastError().type() != QSqlError::NoError)
+    if (db.lastError().type() != QSqlError::NoError)
     {
         hadError = true;
-        qDebug() << where << ":" << m_db.lastError();
-        qInfo() << where << ":" << m_db.lastError();
+        qDebug() << where << ":" << db.lastError();
+        qInfo() << where << ":" << db.lastError();
     }
     if (q.lastError().type() != QSqlError::NoError)
     {
@@ -107,11 +126,24 @@ public:
     bool unique;
 };
 
+class TriggerDefinition {
+public:
+    TriggerDefinition(const char *name, const char *definition) :
+        name(name), definition(definition)
+    {}
+
+    const char *name;
+    const char *definition;  // everything after "CREATE TRIGGER <name>"
+};
+
 
-void SongSettings::ensureIndex(IndexDefinition *index_definition)
+bool SongSettings::ensureIndex(IndexDefinition *index_definition)
 {
     QSqlQuery q(m_db);
-    exec("ensureIndex", q, "PRAGMA INDEX_INFO(" + QString(index_definition->name) + ")");
+    if (!exec("ensureIndex", q, "PRAGMA INDEX_INFO(" + QString(index_definition->name) + ")"))
+    {
+        return false;
+    }
     bool found_any_fields = false;
     while (q.next())
     {
@@ -125,14 +157,37 @@ void SongSettings::ensureIndex(IndexDefinition *index_definition)
         sql += index_definition->name;
         sql += " ON ";
         sql += index_definition->definition;
-        exec("ensureIndex: create", q, sql);
+        return exec("ensureIndex: create", q, sql);
+    }
+    return true;
+}
+
+// *created is set if the trigger had to be created, i.e. this DB hasn't been opened by a version that has it
+bool SongSettings::ensureTrigger(TriggerDefinition *trigger_definition, bool *created)
+{
+    *created = false;
+    QSqlQuery q(m_db);
+    q.prepare("SELECT 1 FROM sqlite_master WHERE type = 'trigger' AND name = :name");
+    q.bindValue(":name", trigger_definition->name);
+    if (!exec("ensureTrigger", q))
+    {
+        return false;
+    }
+    if (q.next())
+    {
+        return true;
     }
+    *created = true;
+    return exec("ensureTrigger: create", q, QString("CREATE TRIGGER ") + trigger_definition->name + " " + trigger_definition->definition);
 }
 
-void SongSettings::ensureSchema(TableDefinition *table_definition)
+bool SongSettings::ensureSchema(TableDefinition *table_definition)
 {
     QSqlQuery q(m_db);
-    exec("ensureSchema", q, "PRAGMA TABLE_INFO(" + QString(table_definition->name) + ")");
+    if (!exec("ensureSchema", q, "PRAGMA TABLE_INFO(" + QString(table_definition->name) + ")"))
+    {
+        return false;
+    }
 
     bool found_any_fields = false;
     vector<QString> alter_statements;
@@ -190,8 +245,12 @@ void SongSettings::ensureSchema(TableDefinition *table_definition)
     }
     for (const auto& alter : alter_statements)
     {
-        exec("ensureSchema", q, alter);
+        if (!exec("ensureSchema", q, alter))
+        {
+            return false;
+        }
     }
+    return true;
 }
 
 
@@ -271,8 +330,89 @@ IndexDefinition index_definitions[] = {
     IndexDefinition("songs_name_idx","songs(name)"),
     IndexDefinition("session_name_idx", "sessions(name)", true),
     IndexDefinition("song_play_song_session_played_idx", "song_plays(song_rowid,session_rowid,played_on)"),
-    IndexDefinition("call_taught_on_dance_program_call_name_session","call_taught_on(dance_program, call_name, session_rowid)")
+    IndexDefinition("call_taught_on_dance_program_call_name_session","call_taught_on(dance_program, call_name, session_rowid)"),
+    IndexDefinition("song_last_played_song_session_idx", "song_last_played(song_rowid,session_rowid)", true),
+    IndexDefinition("tags_name_idx", "tags(name)", true),
+    IndexDefinition("song_tags_song_tag_idx", "song_tags(song_rowid,tag_rowid)", true),
+    IndexDefinition("song_tags_tag_idx", "song_tags(tag_rowid)"),
+    IndexDefinition("song_plays_played_on_idx", "song_plays(played_on,session_rowid,song_rowid)")  // covers date-range history and per-month reports
+};
+
+// Last played ----------------
+//  One row per (song, session): the most recent song_plays.played_on.  getSongAges() used to GROUP BY
+//    the whole play history on every reload, which only ever gets longer; this table stays one row
+//    per song per session.  The trigger below updates it in the same statement as the play itself,
+//    whoever inserts the play.  It's filled from song_plays once, when the trigger is created (see
+//    ensureSchemaUpToDate()), for the plays that were recorded before that.
+RowDefinition song_last_played_rows[] =
+{
+    RowDefinition("song_rowid", "int references songs(rowid)"),
+    RowDefinition("session_rowid", "int references session(rowid)"),
+    RowDefinition("played_on", "DATETIME"),
+    RowDefinition(nullptr, nullptr), // NULL, NULL),
+};
+TableDefinition song_last_played_table("song_last_played", song_last_played_rows);
+
+TriggerDefinition song_last_played_trigger("song_plays_last_played",
+    "AFTER INSERT ON song_plays BEGIN"
+    " INSERT INTO song_last_played(song_rowid, session_rowid, played_on) VALUES (NEW.song_rowid, NEW.session_rowid, NEW.played_on)"
+    " ON CONFLICT(song_rowid, session_rowid) DO UPDATE SET played_on = max(played_on, excluded.played_on);"
+    " END");
+
+// Tags ----------------
+//  songs.tags is still THE copy of a song's tags (it's what loadSettings() returns, and what older
+//    versions of SquareDesk read and write), but "which songs have tag X?" would mean splitting every
+//    songs.tags string.  So each distinct tag also gets a tags row, and song_tags has one row per
+//    (song, tag).  A trigger can't split a string (no WITH RECURSIVE in a trigger, and a recursive
+//    trigger only recurses on connections that turned on PRAGMA recursive_triggers), so the triggers
+//    below only drop a changed song's song_tags rows, and list it in song_tags_stale.  That works
+//    whoever writes songs.tags (even an older SquareDesk); indexStaleSongTags() then splits just the
+//    listed songs, in the same transaction for our own writes, and at openDatabase() for anyone else's.
+RowDefinition tags_rows[] =
+{
+    RowDefinition("name", "text"),
+    RowDefinition(nullptr, nullptr), // NULL, NULL),
+};
+TableDefinition tags_table("tags", tags_rows);
+
+RowDefinition song_tags_rows[] =
+{
+    RowDefinition("song_rowid", "int references songs(rowid)"),
+    RowDefinition("tag_rowid", "int references tags(rowid)"),
+    RowDefinition(nullptr, nullptr), // NULL, NULL),
+};
+TableDefinition song_tags_table("song_tags", song_tags_rows);
+
+RowDefinition song_tags_stale_rows[] =
+{
+    RowDefinition("song_rowid", "int PRIMARY KEY"),
+    RowDefinition(nullptr, nullptr), // NULL, NULL),
 };
+TableDefinition song_tags_stale_table("song_tags_stale", song_tags_stale_rows);
+
+TriggerDefinition song_tags_insert_trigger("songs_tags_stale_insert",
+    "AFTER INSERT ON songs WHEN NEW.tags IS NOT NULL AND NEW.tags <> '' BEGIN"
+    " INSERT OR IGNORE INTO song_tags_stale(song_rowid) VALUES (NEW.rowid);"
+    " END");
+TriggerDefinition song_tags_update_trigger("songs_tags_stale_update",
+    "AFTER UPDATE OF tags ON songs BEGIN"
+    " DELETE FROM song_tags WHERE song_rowid = NEW.rowid;"
+    " INSERT OR IGNORE INTO song_tags_stale(song_rowid) VALUES (NEW.rowid);"
+    " END");
+TriggerDefinition song_tags_delete_trigger("songs_tags_stale_delete",
+    "AFTER DELETE ON songs BEGIN"
+    " DELETE FROM song_tags WHERE song_rowid = OLD.rowid;"
+    " DELETE FROM song_tags_stale WHERE song_rowid = OLD.rowid;"
+    " END");
+
+// songs.tags of the songs in song_tags_stale, split on spaces into (song_rowid, tag) rows
+static const char split_stale_song_tags_cte[] =
+    "WITH RECURSIVE split(song_rowid, tag, rest) AS ("
+    " SELECT songs.rowid, '', songs.tags || ' ' FROM song_tags_stale JOIN songs ON songs.rowid = song_tags_stale.song_rowid"
+    "  WHERE songs.tags IS NOT NULL AND songs.tags <> ''"
+    " UNION ALL"
+    " SELECT song_rowid, substr(rest, 1, instr(rest, ' ') - 1), substr(rest, instr(rest, ' ') + 1) FROM split WHERE rest <> ''"
+    ") ";
 
 // Markers ----------------
 //  Any number of markers can be placed in a song, and the user can FF/REW to the next/previous one.
@@ -305,6 +445,90 @@ RowDefinition cuesheet_rows[] =
 };
 TableDefinition cuesheet_table("cuesheets", cuesheet_rows);
 
+// Cuesheet text ----------------
+//  Full-text index of what's in each cuesheet (and each MP3's USLT lyrics), so a song can be found by a
+//    lyric line or a call phrase (see searchIndexedText()).  One row here per file that has been read,
+//    keyed like cuesheets, by path relative to the music root.  The size and mtime are what the file
+//    had when it was read, so only new or changed files are read again.  The text itself is in the
+//    FTS5 table cuesheet_text, under the same rowid; a file with no text (e.g. an MP3 without lyrics)
+//    only gets a row here.
+RowDefinition cuesheet_text_file_rows[] =
+{
+    RowDefinition("relative_path", "text PRIMARY KEY"),
+    RowDefinition("size", "int"),
+    RowDefinition("mtime", "int"),   // ms since the epoch
+    RowDefinition(nullptr, nullptr), // NULL, NULL),
+};
+TableDefinition cuesheet_text_file_table("cuesheet_text_files", cuesheet_text_file_rows);
+
+// ensureSchema() doesn't do virtual tables, so this one is created by ensureSchemaUpToDate()
+static const char cuesheet_text_definition[] =
+    "CREATE VIRTUAL TABLE IF NOT EXISTS cuesheet_text USING fts5(body, tokenize='unicode61 remove_diacritics 2')";
+
+TriggerDefinition *trigger_definitions[] =
+{
+    &song_last_played_trigger,
+    &song_tags_insert_trigger,
+    &song_tags_update_trigger,
+    &song_tags_delete_trigger,
+};
+
+TableDefinition *table_definitions[] =
+{
+    &song_table,
+    &session_table,
+    &song_plays_table,
+    &call_taught_on_table,
+    &tag_colors_table,
+    &markers_table,
+    &cuesheet_table,
+    &song_last_played_table,
+    &tags_table,
+    &song_tags_table,
+    &song_tags_stale_table,
+    &cuesheet_text_file_table,
+};
+
+// A fingerprint of all of the table and index definitions above, which is stored in the DB as
+//   PRAGMA user_version.  So there's no version number to remember to bump: changing any definition
+//   (e.g. adding a per-song setting) changes it, and the next openDatabase() brings the DB up to date.
+static int schemaVersion()
+{
+    quint32 hash = 2166136261u;  // FNV-1a
+    auto add = [&hash](const char *str) {
+        for (; *str; ++str)
+        {
+            hash = (hash ^ static_cast<unsigned char>(*str)) * 16777619u;
+        }
+        hash = (hash ^ 0x1f) * 16777619u;  // separator, so that "ab"+"c" != "a"+"bc"
+    };
+
+    for (const auto table : table_definitions)
+    {
+        add(table->name);
+        for (int i = 0; table->rows[i].name; ++i)
+        {
+            add(table->rows[i].name);
+            add(table->rows[i].definition);
+        }
+    }
+    for (const auto &index : index_definitions)
+    {
+        add(index.name);
+        add(index.definition);
+        add(index.unique ? "unique" : "");
+    }
+    for (const auto trigger : trigger_definitions)
+    {
+        add(trigger->name);
+        add(trigger->definition);
+    }
+    add(cuesheet_text_definition);
+
+    int version = static_cast<int>(hash & 0x7fffffff);
+    return version == 0 ? 1 : version;  // 0 is what a brand new DB says
+}
+
 /*
 "CREATE TABLE play_history (
  id int auto_increment primary key,
@@ -319,10 +543,21 @@ SongSettings::SongSettings() :
     tagsForegroundColorString(DEFAULTTAGSFOREGROUNDCOLOR),
     databaseOpened(false),
     current_session_id(0), // NOTE: invalid current_session_id (this is supposed to be a row number in the sessions table)
+    writer(nullptr),
+    useLocalWorkingCopy(false),
+    mirror(nullptr),
+    textSearchAvailable(false),
+    lastPlayedCacheLoaded(false),
+    settingsCacheLoaded(false),
     tagColorCacheSet(false)
 {
 }
 
+SongSettings::~SongSettings()
+{
+    closeDatabase();  // commits anything still in the write-behind queue
+}
+
 void SongSettings::setDefaultTagColors( const QString &background, const QString & foreground)
 {
     tagsBackgroundColorString = background;
@@ -380,6 +615,109 @@ static const char *default_session_names[] =
 };
 
 static const char database_type_name[] = "QSQLITE";
+
+// An up-to-date DB costs just one PRAGMA here.  Otherwise (new DB, new version of SquareDesk, or an
+//   older one), every table and index is checked the long way, all in one transaction.
+bool SongSettings::ensureSchemaUpToDate()
+{
+    int version = schemaVersion();
+    {
+        QSqlQuery q(m_db);
+        exec("ensureSchemaUpToDate", q, "PRAGMA user_version");
+        if (q.next() && q.value(0).toInt() == version)
+        {
+            return false;
+        }
+    }
+
+    QSqlQuery q(m_db);
+    if (!exec("ensureSchemaUpToDate BEGIN", q, "BEGIN"))
+    {
+        return false;
+    }
+
+    // user_version is only stamped if EVERY step worked, so a DB that's partly migrated gets the
+    //   whole thing tried again next time, instead of looking up to date
+    bool ok = true;
+    for (const auto table : table_definitions)
+    {
+        ok = ensureSchema(table) && ok;
+    }
+    for (size_t i = 0; i < sizeof(index_definitions) / sizeof(*index_definitions); ++i)
+    {
+        ok = ensureIndex(&index_definitions[i]) && ok;
+    }
+    if (!q.exec(cuesheet_text_definition))
+    {
+        qDebug() << "ensureSchemaUpToDate: no full-text search:" << q.lastError();  // SQLite built without FTS5, not a failure
+    }
+
+    // derived from song_plays, and kept up to date by its trigger from then on
+    bool created = false;
+    ok = ensureTrigger(&song_last_played_trigger, &created) && ok;
+    if (created)
+    {
+        ok = exec("ensureSchemaUpToDate", q, "DELETE FROM song_last_played") && ok;
+        ok = exec("ensureSchemaUpToDate", q, "INSERT INTO song_last_played(song_rowid, session_rowid, played_on) "
+                                             "SELECT song_rowid, session_rowid, max(played_on) FROM song_plays GROUP BY song_rowid, session_rowid") && ok;
+    }
+    // derived from songs.tags, likewise (every trigger is checked, so that a missing one gets created).
+    //   The recursive split trigger of an earlier schema is dropped: it only split past the first tag
+    //   on connections with PRAGMA recursive_triggers on.
+    for (const char *old : { "song_tags_split_word", "songs_tags_insert", "songs_tags_update", "songs_tags_delete" })
+    {
+        ok = exec("ensureSchemaUpToDate", q, QString("DROP TRIGGER IF EXISTS ") + old) && ok;
+    }
+    ok = exec("ensureSchemaUpToDate", q, "DROP TABLE IF EXISTS song_tags_split") && ok;
+    bool tagTriggersCreated = false;
+    for (TriggerDefinition *trigger : { &song_tags_insert_trigger, &song_tags_update_trigger, &song_tags_delete_trigger })
+    {
+        ok = ensureTrigger(trigger, &created) && ok;
+        tagTriggersCreated = tagTriggersCreated || created;
+    }
+    if (tagTriggersCreated)
+    {
+        ok = exec("ensureSchemaUpToDate", q, "DELETE FROM song_tags") && ok;
+        ok = exec("ensureSchemaUpToDate", q, "DELETE FROM tags") && ok;
+        ok = exec("ensureSchemaUpToDate", q, "INSERT OR IGNORE INTO song_tags_stale(song_rowid) SELECT rowid FROM songs") && ok;
+        ok = indexStaleSongTags(statements) && ok;
+    }
+
+    if (!ok)
+    {
+        qInfo() << "ensureSchemaUpToDate: schema update failed, rolled back";
+        exec("ensureSchemaUpToDate ROLLBACK", q, "ROLLBACK");
+        return false;
+    }
+    exec("ensureSchemaUpToDate", q, "PRAGMA user_version = " + QString::number(version));
+    return exec("ensureSchemaUpToDate COMMIT", q, "COMMIT");
+}
+
+// Pragmas for every connection to the SongSettings DB (the GUI thread's, and the write-behind thread's).
+//   WAL lets the GUI thread keep reading while the writer commits, and only fsyncs at checkpoints; with
+//   WAL, synchronous=NORMAL can lose the last few commits on a power failure, but can't corrupt the DB.
+//   journal_mode is remembered in the file, so the other connections find it already in WAL mode.
+void SongSettings::configureConnection(QSqlDatabase &db, bool in_memory)
+{
+    QStringList pragmas;
+    if (!in_memory)
+    {
+        pragmas << "PRAGMA journal_mode=WAL"
+                << "PRAGMA synchronous=NORMAL"
+                << "PRAGMA mmap_size=" + QString::number(SONGSETTINGS_MMAP_SIZE);
+    }
+    pragmas << "PRAGMA cache_size=" + QString::number(-SONGSETTINGS_CACHE_SIZE_KB)  // negative = KiB, rather than pages
+            << "PRAGMA temp_store=MEMORY";
+
+    for (const auto &pragma : pragmas)
+    {
+        QSqlQuery q(db);
+        if (!q.exec(pragma))
+        {
+            qDebug() << "configureConnection:" << pragma << ":" << q.lastError();
+        }
+    }
+}
 void SongSettings::openDatabase(const QString& path,
                                 const QString& root_dir,
                                 bool in_memory)
@@ -402,7 +740,20 @@ void SongSettings::openDatabase(const QString& path,
         {
             dir.mkpath(".");
         }
-        m_db.setDatabaseName(path + "/SquareDesk.sqlite3");
+        QString databaseFilename = path + "/SquareDesk.sqlite3";
+        if (useLocalWorkingCopy)
+        {
+            mirror = new SongSettingsMirror(databaseFilename,
+                                            [this](const QString &conflictFilename) { emit mirrorConflict(conflictFilename); });
+            QString localFilename = mirror->prepareLocalCopy();
+            if (localFilename == databaseFilename)
+            {
+                delete mirror;  // couldn't make a local copy, so use the shared one, just like the normal mode
+                mirror = nullptr;
+            }
+            databaseFilename = localFilename;
+        }
+        m_db.setDatabaseName(databaseFilename);
     }
 
     if (!m_db.open())
@@ -413,19 +764,27 @@ void SongSettings::openDatabase(const QString& path,
     {
         databaseOpened = true;
 //        qDebug() << "Database: connection ok";
+        configureConnection(m_db, in_memory);
+    }
+    statements = SqlStatementCache(m_db);
+    bool changed = ensureSchemaUpToDate();
+    {
+        // songs.tags written by someone else since (e.g. an older SquareDesk, or the other machine's copy)
+        QSqlQuery q(m_db);
+        exec("openDatabase", q, "SELECT 1 FROM song_tags_stale LIMIT 1");
+        if (q.next())
+        {
+            q.finish();
+            exec("openDatabase", q, "BEGIN IMMEDIATE");
+            exec("openDatabase", q, indexStaleSongTags(statements) ? "COMMIT" : "ROLLBACK");
+        }
     }
-    ensureSchema(&song_table);
-    ensureSchema(&session_table);
-    ensureSchema(&song_plays_table);
-    ensureSchema(&call_taught_on_table);
-    ensureSchema(&tag_colors_table);
-    ensureSchema(&markers_table);
-    ensureSchema(&cuesheet_table);
-    
-    for (size_t i = 0; i < sizeof(index_definitions) / sizeof(*index_definitions); ++i)
     {
-        ensureIndex(&index_definitions[i]);
+        QSqlQuery q(m_db);
+        exec("openDatabase", q, "SELECT 1 FROM sqlite_master WHERE name='cuesheet_text'");
+        textSearchAvailable = q.next();
     }
+
     {
         bool sessions_available = false;
         {
@@ -449,19 +808,42 @@ void SongSettings::openDatabase(const QString& path,
                 q.bindValue(":day_of_week", id);
                 exec("openDatabase", q);
             }
+            changed = true;
+        }
+    }
+
+    // an in-memory database is private to its connection, so those writes stay synchronous
+    if (databaseOpened && !in_memory)
+    {
+        writer = new SongSettingsWriter(m_db.databaseName(),
+                                        [this](SqlStatementCache &writerStatements, const QList<SongSettingsWrite> &writes, int *failedWrite) {
+                                            return applyWrites(writerStatements, writes, failedWrite);
+                                        },
+                                        [this](int droppedWrites) { emit writesFailed(droppedWrites); },
+                                        mirror);
+        if (!writer->startWriting())
+        {
+            delete writer;  // already stopped, with nothing queued: the writes just stay synchronous
+            writer = nullptr;
+        }
+        else if (changed)
+        {
+            writer->mirrorSoon();  // so that the shared copy gets the new schema/sessions, too
         }
     }
 }
 
 void SongSettings::setTagColors( const QHash<QString,QPair<QString,QString>> &colors)
 {
+    flushWrites();  // the tag cleanup below rewrites songs.tags and song_tags, so queued saves must land first
+
     QHash<QString, QPair<QString,QString> > existingColors = getTagColors(false);
     
     tagColorCache = colors;
     tagColorCacheSet = true;
     {
         QSqlQuery q(m_db);
-        q.prepare("BEGIN");
+        q.prepare("BEGIN IMMEDIATE");  // see applyWrites()
         exec("setTagColors BEGIN", q);
     }
     {
@@ -484,45 +866,65 @@ void SongSettings::setTagColors( const QHash<QString,QPair<QString,QString>> &co
         }
     }
 
+    // Tags that lost their color are removed from every song that has them, all in one UPDATE.
+    //   song_tags finds those songs, so only their songs.tags strings are split, and rejoined in
+    //   their original order without the removed tags (rather than replace(), so that every copy
+    //   of a tag goes).  The update trigger then marks them for indexStaleSongTags().
+    if (!existingColors.isEmpty())
     {
-        QSqlQuery q(m_db);
-        q.prepare("COMMIT");
-        exec("setTagColors COMMIT", q);
-    }
+        QStringList placeholders;
+        for (int i = 0; i < existingColors.size(); ++i)
+        {
+            placeholders.append("?");
+        }
+        QString removedTags = "(" + placeholders.join(",") + ")";
 
-    {
-        QHash<int, QString> updates;
-        
         QSqlQuery q(m_db);
-        q.prepare("SELECT rowid, tags FROM songs");
-        exec("Tag cleanup", q);
-        while (q.next())
+        indexStaleSongTags(statements);  // so that song_tags is complete, even for songs.tags written by someone else
+
+        q.prepare("WITH RECURSIVE split(song_rowid, pos, tag, rest) AS ("
+                  " SELECT rowid, 0, '', tags || ' ' FROM songs WHERE rowid IN"
+                  "  (SELECT song_tags.song_rowid FROM song_tags JOIN tags ON tags.rowid = song_tags.tag_rowid WHERE tags.name IN " + removedTags + ")"
+                  " UNION ALL"
+                  " SELECT song_rowid, pos + 1, substr(rest, 1, instr(rest, ' ') - 1), substr(rest, instr(rest, ' ') + 1) FROM split WHERE rest <> ''"
+                  ") "
+                  "UPDATE songs SET tags = coalesce((SELECT group_concat(tag, ' ') FROM"
+                  "  (SELECT tag FROM split WHERE split.song_rowid = songs.rowid AND tag <> '' AND tag NOT IN " + removedTags + " ORDER BY pos)), '')"
+                  " WHERE rowid IN (SELECT song_rowid FROM split)");
+        for (int pass = 0; pass < 2; ++pass)  // the list appears twice
         {
-            int rowid = q.value(0).toInt();
-            QString tagstr = q.value(1).toString();
-            QStringList tags = tagstr.split(" ");
-            bool changed(false);
-            for (int i = 0; i < tags.size(); ++i)
+            for (auto removedTag = existingColors.cbegin(); removedTag != existingColors.cend(); ++removedTag)
             {
-                QString tag = tags[i];
-                if (existingColors.contains(tag))
-                {
-                    changed = true;
-                    tags.removeAt(i);
-                    --i;
-                }
+                q.addBindValue(removedTag.key());
             }
-            if (changed)
-                updates[rowid] = tags.join(" ");
         }
-        QSqlQuery qupdate(m_db);
-        qupdate.prepare("UPDATE songs SET tags=:tags WHERE rowid=:rowid");
-        for (auto update = updates.cbegin(); update != updates.cend(); ++update)
+        exec("Tag cleanup update", q);
+
+        q.prepare("DELETE FROM tags WHERE name IN " + removedTags);
+        for (auto removedTag = existingColors.cbegin(); removedTag != existingColors.cend(); ++removedTag)
         {
-            qupdate.bindValue(":tags", update.value());
-            qupdate.bindValue(":rowid", update.key());
-            exec("Tag cleanup update", qupdate);
+            q.addBindValue(removedTag.key());
         }
+        exec("Tag cleanup tags", q);
+
+        indexStaleSongTags(statements);
+    }
+
+    {
+        QSqlQuery q(m_db);
+        q.prepare("COMMIT");
+        exec("setTagColors COMMIT", q);
+    }
+
+    if (!existingColors.isEmpty())
+    {
+        settingsCache.clear();  // some songs.tags just changed underneath it
+        settingsCacheLoaded = false;
+    }
+
+    if (writer)
+    {
+        writer->mirrorSoon();  // written on this thread, so the writer doesn't know about it
     }
 }
 
@@ -635,15 +1037,14 @@ QHash<QString,QPair<QString,QString>> SongSettings::getTagColors(bool loadCache)
 }
 
 
-int SongSettings::getSongIDFromFilenameAlone(const QString &filename)
+int SongSettings::getSongIDFromFilenameAlone(SqlStatementCache &statements, const QString &filename)
 {
     int id = -1;
 
     {
-        QSqlQuery q(m_db);
-        q.prepare("SELECT rowid FROM songs WHERE filename=:filename");
+        QSqlQuery &q = statements.prepared("SELECT rowid FROM songs WHERE filename=:filename");
         q.bindValue(":filename", filename);
-        exec("getSongIDFromFilename",q);
+        exec(statements.database(), "getSongIDFromFilename",q);
         while (q.next())
         {
             id = q.value(0).toInt();
@@ -652,20 +1053,19 @@ int SongSettings::getSongIDFromFilenameAlone(const QString &filename)
     return id;
 }
 
-int SongSettings::getSongIDFromFilename(const QString &filename, const QString &filenameWithPathNormalized)
+int SongSettings::getSongIDFromFilename(SqlStatementCache &statements, const QString &filename, const QString &filenameWithPathNormalized)
 {
-    int id = getSongIDFromFilenameAlone(filenameWithPathNormalized);
+    int id = getSongIDFromFilenameAlone(statements, filenameWithPathNormalized);
     if (-1 == id)
     {
-        id = getSongIDFromFilenameAlone(filename);
+        id = getSongIDFromFilenameAlone(statements, filename);
         if (-1 != id)
         {
-            QSqlQuery q(m_db);
-            q.prepare("UPDATE songs SET filename=:newfilename, songname=:songname WHERE rowid=:id");
+            QSqlQuery &q = statements.prepared("UPDATE songs SET filename=:newfilename, songname=:songname WHERE rowid=:id");
             q.bindValue(":newfilename", filenameWithPathNormalized);
             q.bindValue(":songname", filename);
             q.bindValue(":id", id);
-            exec("updatingSongName", q);
+            exec(statements.database(), "updatingSongName", q);
         }
     }
     return id;
@@ -709,136 +1109,140 @@ QString SongSettings::removeRootDirs(const QString &filenameWithPath)
 
 void SongSettings::markSongPlayed(const QString &filename, const QString &filenameWithPath)
 {
-    QString filenameWithPathNormalized = removeRootDirs(filenameWithPath);
-    int song_rowid = getSongIDFromFilename(filename, filenameWithPathNormalized);
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::MarkSongPlayed;
+    write.key = removeRootDirs(filenameWithPath);
+    write.name = filename;
+    write.sessionID = current_session_id;
+    write.queuedAt = QDateTime::currentDateTimeUtc();  // when it was played, not when the writer gets to it
+    queueWrite(write);
 
-    // #1684: a song only gets a songs row when saveSettings() runs (Import & Organize, or a
-    //   settings change/song switch).  A song that was just dropped into the music directory and
-    //   played right away has no row yet, so the lookup above returns -1.  Inserting -1 here would
-    //   record the play against a song_rowid that matches nothing, and it would be invisible in
-    //   Song Play History forever.  So: create the minimal row now, and use it.
-    if (-1 == song_rowid)
+    if (lastPlayedCacheLoaded)
     {
-        QSqlQuery insertQ(m_db);
-        insertQ.prepare("INSERT OR IGNORE INTO songs(filename, songname) VALUES (:filename, :songname)");
-        insertQ.bindValue(":filename", filenameWithPathNormalized);
-        insertQ.bindValue(":songname", filename);
-        exec("markSongPlayed_addSong", insertQ);
+        lastPlayedCache[write.key][write.sessionID] = write.queuedAt;
+    }
+}
 
-        song_rowid = getSongIDFromFilenameAlone(filenameWithPathNormalized);
+// getSongAge() answers from an in-memory copy of song_last_played, rather than with up to two queries per song
+void SongSettings::loadLastPlayedCache()
+{
+    if (lastPlayedCacheLoaded)
+    {
+        return;
     }
 
     QSqlQuery q(m_db);
-    q.prepare("INSERT INTO song_plays(song_rowid,session_rowid) VALUES (:song_rowid, :session_rowid)");
-    q.bindValue(":song_rowid", song_rowid);
-    q.bindValue(":session_rowid", current_session_id);
-    exec("markSongPlayed", q);
+    q.prepare("SELECT songs.filename, session_rowid, played_on FROM song_last_played JOIN songs ON songs.rowid = song_last_played.song_rowid");
+    exec("loadLastPlayedCache", q);
+    while (q.next())
+    {
+        QDateTime playedOn = QDateTime::fromString(q.value(2).toString(), "yyyy-MM-dd hh:mm:ss");
+        playedOn.setTimeZone(QTimeZone::UTC);  // CURRENT_TIMESTAMP is UTC
+        lastPlayedCache[q.value(0).toString()][q.value(1).toInt()] = playedOn;
+    }
+
+    // plays still in the write-behind queue
+    for (const auto &write : pendingWrites())
+    {
+        if (write.kind == SongSettingsWrite::MarkSongPlayed)
+        {
+            lastPlayedCache[write.key][write.sessionID] = write.queuedAt;
+        }
+    }
+    lastPlayedCacheLoaded = true;
+}
+
+// days since filename (a songs.filename) was last played, as a float string, or "" if never
+QString SongSettings::ageFromLastPlayedCache(const QString &filename, bool show_all_sessions)
+{
+    auto found = lastPlayedCache.constFind(filename);
+    if (found == lastPlayedCache.constEnd())
+    {
+        return QString("");
+    }
+
+    QDateTime latest;
+    for (auto session = found->cbegin(); session != found->cend(); ++session)
+    {
+        if ((show_all_sessions || session.key() == current_session_id) && (!latest.isValid() || session.value() > latest))
+        {
+            latest = session.value();
+        }
+    }
+    if (!latest.isValid())
+    {
+        return QString("");
+    }
+    return QString::number(latest.msecsTo(QDateTime::currentDateTimeUtc()) / 86400000.0, 'f', 8);  // leave it as a float string
 }
 
 QString SongSettings::getCallTaughtOn(const QString &program, const QString &call_name)
 {
-    QSqlQuery q(m_db);
-    q.prepare("SELECT date(taught_on, 'localtime') FROM call_taught_on WHERE dance_program= :dance_program AND call_name = :call_name AND session_rowid = :session_rowid");
+    QString taughtOn;
+    QSqlQuery &q = statements.prepared("SELECT date(taught_on, 'localtime') FROM call_taught_on WHERE dance_program= :dance_program AND call_name = :call_name AND session_rowid = :session_rowid");
     q.bindValue(":session_rowid", current_session_id);
     q.bindValue(":dance_program", program);
     q.bindValue(":call_name", call_name);
     exec("getCallTaughtOn", q);
     if (q.next())
     {
-        return q.value(0).toString();
+        taughtOn = q.value(0).toString();
+    }
+    q.finish();
+
+    // and what the queued writes will do to that, in order
+    for (const auto &write : pendingWrites())
+    {
+        if (write.sessionID != current_session_id || write.name != program)
+        {
+            continue;
+        }
+        if (write.kind == SongSettingsWrite::SetCallTaught && write.callName == call_name && taughtOn.isEmpty())
+        {
+            taughtOn = write.queuedAt.toLocalTime().date().toString("yyyy-MM-dd");
+        }
+        else if ((write.kind == SongSettingsWrite::DeleteCallTaught && write.callName == call_name) ||
+                 write.kind == SongSettingsWrite::ClearTaughtCalls)
+        {
+            taughtOn = "";
+        }
     }
-    return QString("");
+    return taughtOn;
 }
 
 void SongSettings::setCallTaught(const QString &program, const QString &call_name)
 {
-    QSqlQuery q(m_db);
-    q.prepare("INSERT INTO call_taught_on(dance_program, call_name, session_rowid) VALUES (:dance_program, :call_name, :session_rowid)");
-    q.bindValue(":session_rowid", current_session_id);
-    q.bindValue(":dance_program", program);
-    q.bindValue(":call_name", call_name);
-    exec("setCallTaught", q);
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::SetCallTaught;
+    write.name = program;
+    write.callName = call_name;
+    write.sessionID = current_session_id;
+    write.queuedAt = QDateTime::currentDateTimeUtc();
+    queueWrite(write);
 }
 void SongSettings::deleteCallTaught(const QString &program, const QString &call_name)
 {
-    QSqlQuery q(m_db);
-    q.prepare("DELETE FROM call_taught_on WHERE dance_program = :dance_program AND call_name = :call_name AND session_rowid = :session_rowid");
-    q.bindValue(":session_rowid", current_session_id);
-    q.bindValue(":dance_program", program);
-    q.bindValue(":call_name", call_name);
-    exec("deleteCallTaught", q);
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::DeleteCallTaught;
+    write.name = program;
+    write.callName = call_name;
+    write.sessionID = current_session_id;
+    queueWrite(write);
 }
 
 void SongSettings::clearTaughtCalls(const QString &program)
 {
-    QSqlQuery q(m_db);
-    q.prepare("DELETE FROM call_taught_on WHERE session_rowid = :session_rowid AND dance_program = :dance_program");
-    q.bindValue(":session_rowid", current_session_id);
-    q.bindValue(":dance_program", program);
-    exec("clearTaughtCalls", q);
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::ClearTaughtCalls;
+    write.name = program;
+    write.sessionID = current_session_id;
+    queueWrite(write);
 }
 
 
-void SongSettings::getSongPlayHistory(SongPlayEvent &event,
-                            int session_id,
-                            bool omitStartDate,
-                            QString startDate,
-                            bool omitEndDate,
-                            QString endDate)
-{
-    // #1684: song_plays is the driving table here, and the join to songs is a LEFT JOIN, so that a
-    //   play whose song_rowid matches no song (written by older versions, which recorded -1 when the
-    //   song was not yet in the songs table) still shows up, rather than silently disappearing.
-    QString sql("SELECT COALESCE(songs.name,'<song not recorded>'), played_on, datetime(played_on,'localtime'), COALESCE(songs.filename,''), pitch, tempo, last_cuesheet FROM song_plays LEFT JOIN songs ON songs.rowid=song_plays.song_rowid");
-    QStringList whereClause;
-    
-    if (session_id)
-    {
-        whereClause.append("session_rowid=:session_rowid");
-    }
-    if (!omitStartDate)
-    {
-        whereClause.append("played_on > :start_date");
-    }
-    if (!omitEndDate)
-    {
-        whereClause.append("played_on < :end_date");
-    }
-    if (!whereClause.empty())
-    {
-        sql += " WHERE " + whereClause.join(" AND ");
-    }
-    QSqlQuery q(m_db);
-    q.prepare(sql);
-    if (session_id)
-    {
-        q.bindValue(":session_rowid", session_id);
-    }
-    if (!omitStartDate)
-    {
-        q.bindValue(":start_date", startDate);
-    }
-    if (!omitEndDate)
-    {
-        q.bindValue(":end_date", endDate);
-    }
-    exec("songplayhistory", q);
-    while (q.next())
-    {
-        event(q.value(0).toString(), // name
-              q.value(1).toString(), // UTC time
-              q.value(2).toString(), // local time
-              q.value(3).toString(), // filename
-              q.value(4).toString(), // pitch (NOTE: current pitch, not necessarily the pitch at playback time - FIX)
-              q.value(5).toString(), // tempo (NOTE: current tempo, not necessarily the tempo at playback time - FIX)
-              removeRootDirs(q.value(6).toString())  // last_cuesheet (NOTE: current last_cuesheet, not necessarily the last_cuesheet at playback time - FIX)
-              );
-    }
-}
-
 void SongSettings::getSongAges(QHash<QString,QString> &ages, bool show_all_sessions)
 {
-    QString sql("SELECT filename, julianday('now') - julianday(max(played_on)) FROM songs JOIN song_plays ON song_plays.song_rowid=songs.rowid");
+    QString sql("SELECT filename, julianday('now') - julianday(max(played_on)) FROM songs JOIN song_last_played ON song_last_played.song_rowid=songs.rowid");
     if (!show_all_sessions)
         sql += " WHERE session_rowid = :session_rowid";
     sql += " GROUP BY songs.rowid";
@@ -854,6 +1258,16 @@ void SongSettings::getSongAges(QHash<QString,QString> &ages, bool show_all_sessi
         QString str = q.value(1).toString();  // leave it as a float string
         ages[q.value(0).toString()] = str;
     }
+
+    // plays still in the write-behind queue are the most recent ones
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    for (const auto &write : pendingWrites())
+    {
+        if (write.kind == SongSettingsWrite::MarkSongPlayed && (show_all_sessions || write.sessionID == current_session_id))
+        {
+            ages[write.key] = QString::number(write.queuedAt.msecsTo(now) / 86400000.0);
+        }
+    }
 }
 
 QString SongSettings::getSongAge(const QString &filename, const QString &filenameWithPath, bool show_all_sessions)
@@ -867,50 +1281,17 @@ QString SongSettings::getSongAge(const QString &filename, const QString &filenam
 #if 1
     QString filenameWithPathNormalized = removeRootDirs(filenameWithPath);
     // qDebug() << "getSongAge" << filename << filenameWithPath << show_all_sessions << filenameWithPathNormalized;
-    QString sql = "SELECT julianday('now') - julianday(played_on) FROM song_plays JOIN songs ON songs.rowid = song_plays.song_rowid WHERE ";
-    if (!show_all_sessions)
-    {
-        sql += "session_rowid = :session_rowid AND ";
-    }
 
-    sql += "songs.filename = :filename ORDER BY played_on DESC LIMIT 1";
+    loadLastPlayedCache();
 
+    QString age = ageFromLastPlayedCache(filenameWithPathNormalized, show_all_sessions);
+    if (age.isEmpty())
     {
-        QSqlQuery q(m_db);
-        q.prepare(sql);
-        q.bindValue(":filename", filenameWithPathNormalized);
-        q.bindValue(":session_rowid", current_session_id);
-        exec("getSongAge", q);
-
-        if (q.next())
-        {
-//            int age = q.value(0).toInt();
-//            QString str(QString("%1").arg(age, 3));
-            QString str = q.value(0).toString();  // leave it as a float string
-            return str;
-        }
+        age = ageFromLastPlayedCache(filename, show_all_sessions);  // legacy rows keyed by base filename
     }
-
-    {
-        QSqlQuery q(m_db);
-        q.prepare(sql);
-        q.bindValue(":filename", filename);
-        q.bindValue(":session_rowid", current_session_id);
-        exec("getSongAge", q);
-
-        if (q.next())
-        {
-//            int age = q.value(0).toInt();
-//            QString str(QString("%1").arg(age, 3));
-            QString str = q.value(0).toString();  // leave it as a float string
-            // qDebug() << "found it 2" << str;
-            return str;
-        }
-    }
-    // qDebug() << "    nope. did not find it 3";
-    return QString("");
-#endif
-}
+    return age;
+#endif
+}
 
 
 SongSetting::SongSetting()
@@ -924,6 +1305,31 @@ SongSetting::SongSetting()
     dummy = false;  // remove Mac OS X compiler warning (it doesn't realize that the initializer above DOES use dummy)
 }
 
+void SongSetting::mergeFrom(const SongSetting &other)
+{
+#define SONGSETTING_ELEMENT(type, name) if (other.set_##name) { set##name(other.m_##name); }
+#include "songsetting_attributes.h"
+#undef SONGSETTING_ELEMENT
+}
+
+SongSetting SongSetting::changesFrom(const SongSetting &before) const
+{
+    SongSetting changes;
+#define SONGSETTING_ELEMENT(type, name) if (set_##name && (!before.set_##name || m_##name != before.m_##name)) { changes.set##name(m_##name); }
+#include "songsetting_attributes.h"
+#undef SONGSETTING_ELEMENT
+    return changes;
+}
+
+bool SongSetting::isAnySet() const
+{
+    return
+#define SONGSETTING_ELEMENT(type, name) set_##name ||
+#include "songsetting_attributes.h"
+#undef SONGSETTING_ELEMENT
+        false;
+}
+
 QDebug operator<<(QDebug dbg, const SongSetting &setting)
 {
     QDebugStateSaver stateSaver(dbg);
@@ -939,112 +1345,116 @@ QDebug operator<<(QDebug dbg, const SongSetting &setting)
 void SongSettings::saveSettings(const QString &filenameWithPath,
                                 const SongSetting &settings)
 {
-    QString filenameWithPathNormalized = removeRootDirs(filenameWithPath);
-    int id = getSongIDFromFilename(settings.getFilename(), filenameWithPathNormalized);
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::SaveSettings;
+    write.key = removeRootDirs(filenameWithPath);
+    write.name = settings.getFilename();
+    write.settings = settings;
 
-//    qDebug() << "saveSettings: id = " << id;
+    if (!settingsCacheLoaded)
+    {
+        loadSettingsCache();  // before queueWrite(), or the cache would already include this save
+    }
+    queueWrite(write);  // repeated saves of the same song (e.g. tempo changes) coalesce in the queue
 
-    QStringList fields;
-    if (settings.isSetFilename()) { fields.append("songname" ); }
-    if (settings.isSetPitch()) { fields.append("pitch" ); }
-    if (settings.isSetTempo()) { fields.append("tempo" ); }
-    if (settings.isSetTempoIsPercent()) { fields.append("tempoIsPercent" ); }
-    if (settings.isSetIntroPos()) { fields.append("introPos" ); }
-    if (settings.isSetOutroPos()) { fields.append("outroPos" ); }
-    if (settings.isSetVolume()) { fields.append("volume" ); }
-    if (settings.isSetSongname()) { fields.append("name" ); }
-    if (settings.isSetCuesheetName()) { fields.append("last_cuesheet" ); }  // ADDED ********
-    if (settings.isSetSongLength()) { fields.append("songLength" ); }
-    if (settings.isSetIntroOutroIsTimeBased()) { fields.append("introOutroIsTimeBased" ); }
-    if (settings.isSetTreble()) { fields.append("treble"); }
-    if (settings.isSetBass()) { fields.append("bass"); }
-    if (settings.isSetMidrange()) { fields.append("midrange"); }
-    if (settings.isSetMix()) { fields.append("mix"); }
-    if (settings.isSetLoop()) { fields.append("loop"); }
-    if (settings.isSetTags()) { fields.append("tags"); }
-//    if (settings.isSetReplayGain()) { fields.append("replayGain"); }
+    SongSetting &cached = settingsCache[write.key];
+    SongSetting changes = settings.changesFrom(cached);
+    cached.mergeFrom(settings);
+    if (changes.isAnySet())
+    {
+        emit songSettingChanged(write.key, changes);
+    }
+}
 
-    // Adding a new per-song setting?  This is location 3 out of 6 to change.
-    if (settings.isSetVSTsettings()) { fields.append("vstSettings"); }
+void SongSettings::saveSettingsForSongs(const QStringList &filenamesWithPath, const SongSetting &delta)
+{
+    QStringList keys;
+    QList<SongSetting> settings;
+    for (const auto &filenameWithPath : filenamesWithPath)
+    {
+        keys.append(removeRootDirs(filenameWithPath));
+        settings.append(delta);
+    }
+    saveSettingsForSongs(keys, settings);
+}
 
-//    qDebug() << "saveSettings: " << fields;
+void SongSettings::changeTagForSongs(const QStringList &filenamesWithPath, const QString &tag, bool add)
+{
+    const QHash<QString, SongSetting> &cache = allSongSettings();
 
-    QSqlQuery q(m_db);
-    if (id == -1)
+    QStringList keys;
+    QList<SongSetting> settings;
+    for (const auto &filenameWithPath : filenamesWithPath)
     {
-        fields.append("filename");
-        QString sql("INSERT INTO songs(");
+        QString key = removeRootDirs(filenameWithPath);
+        QStringList tags = cache.value(key).getTags().split(" ", Qt::SkipEmptyParts);
+        if (add == tags.contains(tag))
         {
-            bool first = true;
-            for (const auto& s : fields)
-            {
-                if (!first) { sql += ","; }
-                first = false;
-                sql += s;
-            }
+            continue;  // already the way we want it: nothing to write
         }
-        sql += ") VALUES (";
+        if (add)
         {
-            bool first = true;
-            for (const auto& s : fields)
-            {
-                if (!first) { sql += ","; }
-                first = false;
-                sql += ":" + s;
-            }
+            tags.append(tag);
         }
-        sql += ")";
-        q.prepare(sql);
-    }
-    else
-    {
-        QString sql("UPDATE songs SET ");
+        else
         {
-            bool first = true;
-            for (const auto& s : fields)
-            {
-                if (!first) { sql += ","; }
-                first = false;
-                sql += s + " = :" + s;
-            }
+            tags.removeAll(tag);
         }
-        sql += " WHERE rowid = :rowid";
-        q.prepare(sql);
-        q.bindValue(":rowid", id);
+        SongSetting setting;
+        setting.setTags(tags.join(" "));
+        keys.append(key);
+        settings.append(setting);
     }
+    saveSettingsForSongs(keys, settings);
+}
 
-    q.bindValue(":filename", filenameWithPathNormalized);
-    q.bindValue(":songname", settings.getFilename() );
-    q.bindValue(":pitch", settings.getPitch() );
-    q.bindValue(":tempo", settings.getTempo() );
-    q.bindValue(":tempoIsPercent", settings.getTempoIsPercent() );
-    q.bindValue(":introPos", settings.getIntroPos() );
-    q.bindValue(":outroPos", settings.getOutroPos() );
-    q.bindValue(":volume", settings.getVolume() );
-
-    QString revisedSongName = settings.getSongname();
-    revisedSongName = revisedSongName.replace(QRegularExpression(" \\[L:.*\\]$"), ""); // for safety, remove the " [L: level]"
-    // q.bindValue(":name", settings.getSongname() );
-    q.bindValue(":name", revisedSongName ); // I don't think the :name is used anymore, but just being safe here.
+// what saveSettings() does, for many songs: one write in the queue (so one transaction, however many
+//   songs), one pass over the cache, and one signal
+void SongSettings::saveSettingsForSongs(const QStringList &filenamesWithPathNormalized, const QList<SongSetting> &settings)
+{
+    if (filenamesWithPathNormalized.isEmpty())
+    {
+        return;
+    }
 
-    q.bindValue(":last_cuesheet", settings.getCuesheetName() );
-    q.bindValue(":songLength", settings.getSongLength() );
-    q.bindValue(":introOutroIsTimeBased", settings.getIntroOutroIsTimeBased() );
-    q.bindValue(":treble", settings.getTreble());
-    q.bindValue(":bass", settings.getBass());
-    q.bindValue(":midrange", settings.getMidrange());
-    q.bindValue(":mix", settings.getMix());
-    q.bindValue(":loop", settings.getLoop());
-    q.bindValue(":tags", settings.getTags());
-//    q.bindValue(":replayGain", settings.getReplayGain());
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::SaveSettingsForSongs;
+    write.keys = filenamesWithPathNormalized;
+    write.songSettings = settings;
 
-    // Adding a new per-song setting?  This is location 4 out of 6 to change.
-    q.bindValue(":vstSettings", settings.getVSTsettings());
+    if (!settingsCacheLoaded)
+    {
+        loadSettingsCache();  // before queueWrite(), see saveSettings()
+    }
+    queueWrite(write);
 
-    exec("saveSettings", q);
+    QStringList changedKeys;
+    SongSetting allChanges;
+    for (int i = 0; i < write.keys.size(); i++)
+    {
+        SongSetting &cached = settingsCache[write.keys[i]];
+        SongSetting changes = settings[i].changesFrom(cached);
+        if (changes.isAnySet())
+        {
+            if (changes.isSetTags())
+            {
+                if (cached.isSetTags())
+                {
+                    removeTags(cached.getTags());
+                }
+                addTags(changes.getTags());
+            }
+            changedKeys.append(write.keys[i]);
+            allChanges.mergeFrom(changes);
+        }
+        cached.mergeFrom(settings[i]);
+    }
+    if (!changedKeys.isEmpty())
+    {
+        emit songSettingsChanged(changedKeys, allChanges);
+    }
 }
 
-
 void setSongSettingFromSQLQuery(QSqlQuery &q, SongSetting &settings)
 {
     if (!q.value(1).isNull()) { settings.setPitch(q.value(1).toInt()); };
@@ -1063,10 +1473,9 @@ void setSongSettingFromSQLQuery(QSqlQuery &q, SongSetting &settings)
     if (!q.value(13).isNull()) { settings.setMix(q.value(13).toInt()); }
     if (!q.value(14).isNull()) { settings.setLoop(q.value(14).toInt()); }
     if (!q.value(15).isNull()) { settings.setTags(q.value(15).toString()); }
-//    if (!q.value(16).isNull()) { settings.setReplayGain(q.value(16).toFloat()); }
-
     // Adding a new per-song setting?  This is location 5 out of 6 to change.
     if (!q.value(16).isNull()) { settings.setVSTsettings(q.value(16).toString()); }
+    if (!q.value(17).isNull()) { settings.setReplayGain(q.value(17).toDouble()); }
 }
 
 bool SongSettings::loadSettings(const QString &filenameWithPath,
@@ -1074,7 +1483,7 @@ bool SongSettings::loadSettings(const QString &filenameWithPath,
 {
 //    QString baseSql = "SELECT filename, pitch, tempo, introPos, outroPos, volume, last_cuesheet,tempoIsPercent,songLength,introOutroIsTimeBased, treble, bass, midrange, mix, loop, tags, replayGain FROM songs WHERE ";
     // Adding a new per-song setting?  This is location 6 out of 6 to change.
-    QString baseSql = "SELECT filename, pitch, tempo, introPos, outroPos, volume, last_cuesheet,tempoIsPercent,songLength,introOutroIsTimeBased, treble, bass, midrange, mix, loop, tags, VSTsettings FROM songs WHERE ";
+    QString baseSql = "SELECT filename, pitch, tempo, introPos, outroPos, volume, last_cuesheet,tempoIsPercent,songLength,introOutroIsTimeBased, treble, bass, midrange, mix, loop, tags, VSTsettings, replayGain FROM songs WHERE ";
     QString filenameWithPathNormalized = removeRootDirs(filenameWithPath);
 
 //    qDebug() << "********* DEBUG get/setSongMarkers **********";
@@ -1110,9 +1519,18 @@ bool SongSettings::loadSettings(const QString &filenameWithPath,
 //    qDebug() << "********* END DEBUG get/setSongMarkers **********";
 
     bool foundResults = false;
+    if (settingsCacheLoaded)
     {
-        QSqlQuery q(m_db);
-        q.prepare(baseSql + "filename=:filename");
+        auto cached = settingsCache.constFind(filenameWithPathNormalized);
+        if (cached != settingsCache.constEnd())
+        {
+            foundResults = true;
+            settings.mergeFrom(cached.value());
+        }
+    }
+    else
+    {
+        QSqlQuery &q = statements.prepared(baseSql + "filename=:filename");
         q.bindValue(":filename", filenameWithPathNormalized);
         exec("loadSettings", q);
 
@@ -1124,8 +1542,7 @@ bool SongSettings::loadSettings(const QString &filenameWithPath,
     }
     if (!foundResults && settings.isSetFilename())
     {
-        QSqlQuery q(m_db);
-        q.prepare(baseSql + " filename=:filename");
+        QSqlQuery &q = statements.prepared(baseSql + " filename=:filename");
         q.bindValue(":filename", settings.getFilename());
         exec("loadSettings", q);
 
@@ -1137,8 +1554,7 @@ bool SongSettings::loadSettings(const QString &filenameWithPath,
     }
     if (!foundResults && settings.isSetSongname())
     {
-        QSqlQuery q(m_db);
-        q.prepare(baseSql + " name=:name");
+        QSqlQuery &q = statements.prepared(baseSql + " name=:name");
 
         QString revisedSongName = settings.getSongname();
         revisedSongName = revisedSongName.replace(QRegularExpression(" \\[L:.*\\]$"), ""); // for safety, remove the " [L: level]"
@@ -1152,6 +1568,19 @@ bool SongSettings::loadSettings(const QString &filenameWithPath,
             setSongSettingFromSQLQuery(q, settings);
         }
     }
+    for (const auto &write : pendingWrites())
+    {
+        if (write.kind == SongSettingsWrite::SaveSettings && write.key == filenameWithPathNormalized)
+        {
+            settings.mergeFrom(write.settings);  // not committed yet, but newer than what's in the DB
+            foundResults = true;
+        }
+        else if (write.kind == SongSettingsWrite::SaveSettingsForSongs && write.keys.contains(filenameWithPathNormalized))
+        {
+            settings.mergeFrom(write.songSettings[write.keys.indexOf(filenameWithPathNormalized)]);
+            foundResults = true;
+        }
+    }
     if (foundResults && settings.isSetTags() && !settings.getTags().isNull())
     {
         addTags(settings.getTags());
@@ -1159,28 +1588,76 @@ bool SongSettings::loadSettings(const QString &filenameWithPath,
     return foundResults;
 }
 
-// Batch version of loadSettings(): loads the settings rows for ALL songs in one
-// query, keyed by the songs.filename column (normally the path relative to the
-// music root dir -- see removeRootDirs()). Used at startup by darkLoadMusicList(),
-// where one big SELECT is much faster than one SELECT per song (Issue #1669).
+// Batch version of loadSettings(): every song's settings, keyed by the songs.filename column
+// (normally the path relative to the music root dir -- see removeRootDirs()).  One big SELECT is
+// much faster than one SELECT per song (Issue #1669), and it's only done once per database: after
+// that, saveSettings() keeps the cache up to date, so darkLoadMusicList() and every palette slot
+// that loads a playlist share the same copy.
 // Unlike loadSettings(), this does NOT call addTags() -- the caller already does.
-void SongSettings::loadSettingsForAllSongs(QHash<QString, SongSetting> &settingsByFilename)
+const QHash<QString, SongSetting> &SongSettings::allSongSettings()
+{
+    if (!settingsCacheLoaded)
+    {
+        loadSettingsCache();
+    }
+    return settingsCache;
+}
+
+void SongSettings::loadSettingsCache()
 {
+    settingsCache.clear();
+
     // Adding a new per-song setting?  Update this SELECT along with the one in loadSettings()
     // (the column order here must stay in sync, for setSongSettingFromSQLQuery()).
     QSqlQuery q(m_db);
-    q.prepare("SELECT filename, pitch, tempo, introPos, outroPos, volume, last_cuesheet,tempoIsPercent,songLength,introOutroIsTimeBased, treble, bass, midrange, mix, loop, tags, VSTsettings FROM songs");
-    exec("loadSettingsForAllSongs", q);
+    q.setForwardOnly(true);
+    q.prepare("SELECT filename, pitch, tempo, introPos, outroPos, volume, last_cuesheet,tempoIsPercent,songLength,introOutroIsTimeBased, treble, bass, midrange, mix, loop, tags, VSTsettings, replayGain FROM songs");
+    exec("loadSettingsCache", q);
     while (q.next())
     {
         SongSetting settings;
         setSongSettingFromSQLQuery(q, settings);
-        settingsByFilename.insert(q.value(0).toString(), settings);
+        settingsCache.insert(q.value(0).toString(), settings);
+    }
+    for (const auto &write : pendingWrites())
+    {
+        if (write.kind == SongSettingsWrite::SaveSettings)
+        {
+            settingsCache[write.key].mergeFrom(write.settings);  // not committed yet
+        }
+        else if (write.kind == SongSettingsWrite::SaveSettingsForSongs)
+        {
+            for (int i = 0; i < write.keys.size(); i++)
+            {
+                settingsCache[write.keys[i]].mergeFrom(write.songSettings[i]);
+            }
+        }
     }
+    settingsCacheLoaded = true;
 }
 
 void SongSettings::closeDatabase()
 {
+    if (writer)
+    {
+        delete writer;  // commits whatever is still queued, on its own connection (and updates the shared copy)
+        writer = nullptr;
+    }
+    else if (mirror && databaseOpened)
+    {
+        // no writer thread (it couldn't open its connection), so the writes were made on this one
+        mirror->noteLocalChanges();
+        statements.finishAll();
+        mirror->pushToShared(m_db);
+    }
+    delete mirror;
+    mirror = nullptr;
+    lastPlayedCache.clear();
+    lastPlayedCacheLoaded = false;
+    settingsCache.clear();
+    settingsCacheLoaded = false;
+    statements.clear();  // a connection can't be removed while queries still refer to it
+
     if (databaseOpened)
     {
         QString connection;
@@ -1192,6 +1669,408 @@ void SongSettings::closeDatabase()
 }
 
 
+void SongSettings::flushWrites()
+{
+    if (writer)
+    {
+        writer->flush();
+    }
+}
+
+void SongSettings::queueWrite(const SongSettingsWrite &write)
+{
+    if (writer)
+    {
+        writer->enqueue(write);
+    }
+    else
+    {
+        // in-memory DB, or the writer couldn't open it: no writer thread
+        if (!applyWrites(statements, QList<SongSettingsWrite>() << write))
+        {
+            emit writesFailed(1);
+        }
+    }
+}
+
+// what the readers have to overlay on top of what's in the DB, oldest first
+QList<SongSettingsWrite> SongSettings::pendingWrites()
+{
+    if (writer)
+    {
+        return writer->pendingWrites();
+    }
+    return QList<SongSettingsWrite>();
+}
+
+// one songs row (INSERT or UPDATE), for the SaveSettings and SaveSettingsForSongs writes
+bool SongSettings::saveSongRow(SqlStatementCache &statements, const QString &songname,
+                               const QString &filenameWithPathNormalized, const SongSetting &settings)
+{
+    QSqlDatabase &db = statements.database();
+
+    int id = getSongIDFromFilename(statements, songname, filenameWithPathNormalized);
+
+//        qDebug() << "saveSettings: id = " << id;
+
+    QStringList fields;
+    if (settings.isSetFilename()) { fields.append("songname" ); }
+    if (settings.isSetPitch()) { fields.append("pitch" ); }
+    if (settings.isSetTempo()) { fields.append("tempo" ); }
+    if (settings.isSetTempoIsPercent()) { fields.append("tempoIsPercent" ); }
+    if (settings.isSetIntroPos()) { fields.append("introPos" ); }
+    if (settings.isSetOutroPos()) { fields.append("outroPos" ); }
+    if (settings.isSetVolume()) { fields.append("volume" ); }
+    if (settings.isSetSongname()) { fields.append("name" ); }
+    if (settings.isSetCuesheetName()) { fields.append("last_cuesheet" ); }  // ADDED ********
+    if (settings.isSetSongLength()) { fields.append("songLength" ); }
+    if (settings.isSetIntroOutroIsTimeBased()) { fields.append("introOutroIsTimeBased" ); }
+    if (settings.isSetTreble()) { fields.append("treble"); }
+    if (settings.isSetBass()) { fields.append("bass"); }
+    if (settings.isSetMidrange()) { fields.append("midrange"); }
+    if (settings.isSetMix()) { fields.append("mix"); }
+    if (settings.isSetLoop()) { fields.append("loop"); }
+    if (settings.isSetTags()) { fields.append("tags"); }
+    if (settings.isSetReplayGain()) { fields.append("replayGain"); }
+
+    // Adding a new per-song setting?  This is location 3 out of 6 to change.
+    if (settings.isSetVSTsettings()) { fields.append("vstSettings"); }
+
+//        qDebug() << "saveSettings: " << fields;
+
+    QString sql;
+    if (id == -1)
+    {
+        fields.append("filename");
+        sql = "INSERT INTO songs(";
+        {
+            bool first = true;
+            for (const auto& s : fields)
+            {
+                if (!first) { sql += ","; }
+                first = false;
+                sql += s;
+            }
+        }
+        sql += ") VALUES (";
+        {
+            bool first = true;
+            for (const auto& s : fields)
+            {
+                if (!first) { sql += ","; }
+                first = false;
+                sql += ":" + s;
+            }
+        }
+        sql += ")";
+    }
+    else
+    {
+        sql = "UPDATE songs SET ";
+        {
+            bool first = true;
+            for (const auto& s : fields)
+            {
+                if (!first) { sql += ","; }
+                first = false;
+                sql += s + " = :" + s;
+            }
+        }
+        sql += " WHERE rowid = :rowid";
+    }
+
+    QSqlQuery &q = statements.prepared(sql);  // only a handful of different field lists are ever used
+    if (id != -1)
+    {
+        q.bindValue(":rowid", id);
+    }
+
+    q.bindValue(":filename", filenameWithPathNormalized);
+    q.bindValue(":songname", songname );
+    q.bindValue(":pitch", settings.getPitch() );
+    q.bindValue(":tempo", settings.getTempo() );
+    q.bindValue(":tempoIsPercent", settings.getTempoIsPercent() );
+    q.bindValue(":introPos", settings.getIntroPos() );
+    q.bindValue(":outroPos", settings.getOutroPos() );
+    q.bindValue(":volume", settings.getVolume() );
+
+    QString revisedSongName = settings.getSongname();
+    revisedSongName = revisedSongName.replace(QRegularExpression(" \\[L:.*\\]$"), ""); // for safety, remove the " [L: level]"
+    // q.bindValue(":name", settings.getSongname() );
+    q.bindValue(":name", revisedSongName ); // I don't think the :name is used anymore, but just being safe here.
+
+    q.bindValue(":last_cuesheet", settings.getCuesheetName() );
+    q.bindValue(":songLength", settings.getSongLength() );
+    q.bindValue(":introOutroIsTimeBased", settings.getIntroOutroIsTimeBased() );
+    q.bindValue(":treble", settings.getTreble());
+    q.bindValue(":bass", settings.getBass());
+    q.bindValue(":midrange", settings.getMidrange());
+    q.bindValue(":mix", settings.getMix());
+    q.bindValue(":loop", settings.getLoop());
+    q.bindValue(":tags", settings.getTags());
+    q.bindValue(":replayGain", settings.getReplayGain());
+
+    // Adding a new per-song setting?  This is location 4 out of 6 to change.
+    q.bindValue(":vstSettings", settings.getVSTsettings());
+
+    bool ok = exec(db, "saveSettings", q);
+    if (settings.isSetTags())
+    {
+        ok = indexStaleSongTags(statements) && ok;  // the songs.tags triggers only marked this song
+    }
+    return ok;
+}
+
+// Re-index the songs that the songs.tags triggers listed in song_tags_stale (their old song_tags rows
+//   are already gone), on whichever connection statements belongs to.  Call it inside a transaction.
+bool SongSettings::indexStaleSongTags(SqlStatementCache &statements)
+{
+    QSqlDatabase &db = statements.database();
+    bool ok = exec(db, "indexStaleSongTags", statements.prepared(QString(split_stale_song_tags_cte) +
+                   "INSERT OR IGNORE INTO tags(name) SELECT DISTINCT tag FROM split WHERE tag <> ''"));
+    ok = exec(db, "indexStaleSongTags", statements.prepared(QString(split_stale_song_tags_cte) +
+              "INSERT OR IGNORE INTO song_tags(song_rowid, tag_rowid) "
+              "SELECT split.song_rowid, tags.rowid FROM split JOIN tags ON tags.name = split.tag")) && ok;
+    ok = exec(db, "indexStaleSongTags", statements.prepared("DELETE FROM song_tags_stale")) && ok;
+    return ok;
+}
+
+// runs on the writer thread (or the GUI thread, for an in-memory DB): only db and the writes
+//   themselves may be touched here, everything else was captured when the write was queued
+//
+// All of the writes, in one transaction, or none of them: false (and rolled back) if anything failed,
+//   so that the caller can try again, and then *failedWrite says which write failed (-1: BEGIN or
+//   COMMIT, i.e. none of them in particular).  IMMEDIATE takes the write lock up front.  A deferred transaction
+//   that reads first (getSongIDFromFilename()) and then writes fails with SQLITE_BUSY_SNAPSHOT in WAL
+//   mode if another connection committed in between, and the busy handler never retries that.
+bool SongSettings::applyWrites(SqlStatementCache &statements, const QList<SongSettingsWrite> &writes, int *failedWrite)
+{
+    QSqlDatabase &db = statements.database();
+    if (failedWrite)
+    {
+        *failedWrite = -1;
+    }
+
+    {
+        QSqlQuery &q = statements.prepared("BEGIN IMMEDIATE");
+        if (!exec(db, "applyWrites BEGIN", q))
+        {
+            return false;  // e.g. still locked after the busy timeout: nothing to roll back
+        }
+    }
+
+    bool ok = true;
+    for (int i = 0; i < writes.size(); i++)
+    {
+        if (!applyWrite(statements, writes[i]))
+        {
+            if (failedWrite)
+            {
+                *failedWrite = i;
+            }
+            ok = false;
+            break;
+        }
+    }
+
+    if (ok)
+    {
+        QSqlQuery &q = statements.prepared("COMMIT");
+        ok = exec(db, "applyWrites COMMIT", q);
+    }
+    if (!ok)
+    {
+        // also after a failed COMMIT, which can leave the transaction open (and then every BEGIN would fail)
+        QSqlQuery &q = statements.prepared("ROLLBACK");
+        exec(db, "applyWrites ROLLBACK", q);
+    }
+    return ok;
+}
+
+bool SongSettings::applyWrite(SqlStatementCache &statements, const SongSettingsWrite &write)
+{
+    QSqlDatabase &db = statements.database();
+    bool ok = true;
+    static const QString timestampFormat("yyyy-MM-dd hh:mm:ss");  // same as CURRENT_TIMESTAMP
+
+    switch (write.kind)
+    {
+    case SongSettingsWrite::SaveSettings:
+        ok = saveSongRow(statements, write.name, write.key, write.settings);
+        break;
+
+    case SongSettingsWrite::SaveSettingsForSongs:
+        for (int i = 0; i < write.keys.size(); i++)
+        {
+            ok = saveSongRow(statements, QString(), write.keys[i], write.songSettings[i]) && ok;  // same transaction, same prepared UPDATEs
+        }
+        break;
+
+    case SongSettingsWrite::MarkSongPlayed:
+    {
+        int song_rowid = getSongIDFromFilename(statements, write.name, write.key);
+
+        // #1684: a song only gets a songs row when saveSettings() runs (Import & Organize, or a
+        //   settings change/song switch).  A song that was just dropped into the music directory and
+        //   played right away has no row yet, so the lookup above returns -1.  Inserting -1 here would
+        //   record the play against a song_rowid that matches nothing, and it would be invisible in
+        //   Song Play History forever.  So: create the minimal row now, and use it.
+        if (-1 == song_rowid)
+        {
+            QSqlQuery &insertQ = statements.prepared("INSERT OR IGNORE INTO songs(filename, songname) VALUES (:filename, :songname)");
+            insertQ.bindValue(":filename", write.key);
+            insertQ.bindValue(":songname", write.name);
+            ok = exec(db, "markSongPlayed_addSong", insertQ) && ok;
+
+            song_rowid = getSongIDFromFilenameAlone(statements, write.key);
+            if (-1 == song_rowid)
+            {
+                ok = false;  // don't record a play that nothing will ever find (see above)
+                break;
+            }
+        }
+
+        QSqlQuery &q = statements.prepared("INSERT INTO song_plays(song_rowid,session_rowid,played_on) VALUES (:song_rowid, :session_rowid, :played_on)");
+        q.bindValue(":song_rowid", song_rowid);
+        q.bindValue(":session_rowid", write.sessionID);
+        q.bindValue(":played_on", write.queuedAt.toString(timestampFormat));
+        ok = exec(db, "markSongPlayed", q) && ok;  // song_last_played is updated by its trigger
+        break;
+    }
+
+    case SongSettingsWrite::SetSongMarkers:
+    {
+        int song_rowid = getSongIDFromFilenameAlone(statements, write.key);
+
+        {
+            // delete old markers for this song -------
+            QSqlQuery &q = statements.prepared("DELETE FROM markers WHERE song_rowid=:song_rowid");
+            q.bindValue(":song_rowid", song_rowid);
+            ok = exec(db, "setSongMarkers DELETE", q) && ok;
+        }
+
+        {
+            // insert new markers for this song --------
+            QSqlQuery &q = statements.prepared("INSERT INTO markers(song_rowid, markerPos) VALUES (:song_rowid,:markerPos)");
+            for (QMap<float, int>::const_iterator markerPosition = write.markers.cbegin(); markerPosition != write.markers.cend(); ++markerPosition)
+            {
+                if (markerPosition.key() >= 0.0 && markerPosition.key() <= 1.0) {  // a little bit of error checking, to prevent weird corruption
+                    // only allow storing of valid markerPositions into DB
+                    q.bindValue(":song_rowid", song_rowid);             // key is song's rowid
+                    q.bindValue(":markerPos", markerPosition.key());    // key in QMap is the markerPosition, QMap value is ignored
+                    ok = exec(db, "setSongMarkers INSERT", q) && ok;
+                }
+            }
+        }
+        break;
+    }
+
+    case SongSettingsWrite::SetCallTaught:
+    {
+        QSqlQuery &q = statements.prepared("INSERT INTO call_taught_on(dance_program, call_name, session_rowid, taught_on) VALUES (:dance_program, :call_name, :session_rowid, :taught_on)");
+        q.bindValue(":session_rowid", write.sessionID);
+        q.bindValue(":dance_program", write.name);
+        q.bindValue(":call_name", write.callName);
+        q.bindValue(":taught_on", write.queuedAt.toString(timestampFormat));
+        ok = exec(db, "setCallTaught", q) && ok;
+        break;
+    }
+
+    case SongSettingsWrite::DeleteCallTaught:
+    {
+        QSqlQuery &q = statements.prepared("DELETE FROM call_taught_on WHERE dance_program = :dance_program AND call_name = :call_name AND session_rowid = :session_rowid");
+        q.bindValue(":session_rowid", write.sessionID);
+        q.bindValue(":dance_program", write.name);
+        q.bindValue(":call_name", write.callName);
+        ok = exec(db, "deleteCallTaught", q) && ok;
+        break;
+    }
+
+    case SongSettingsWrite::ClearTaughtCalls:
+    {
+        QSqlQuery &q = statements.prepared("DELETE FROM call_taught_on WHERE session_rowid = :session_rowid AND dance_program = :dance_program");
+        q.bindValue(":session_rowid", write.sessionID);
+        q.bindValue(":dance_program", write.name);
+        ok = exec(db, "clearTaughtCalls", q) && ok;
+        break;
+    }
+
+    case SongSettingsWrite::IndexText:
+    {
+        {
+            QSqlQuery &q = statements.prepared("INSERT INTO cuesheet_text_files(relative_path, size, mtime) VALUES (:relative_path, :size, :mtime)"
+                                               " ON CONFLICT(relative_path) DO UPDATE SET size=excluded.size, mtime=excluded.mtime");
+            q.bindValue(":relative_path", write.key);
+            q.bindValue(":size", write.fileSize);
+            q.bindValue(":mtime", write.fileMtime);
+            ok = exec(db, "indexText files", q) && ok;
+        }
+        int rowid = -1;
+        {
+            QSqlQuery &q = statements.prepared("SELECT rowid FROM cuesheet_text_files WHERE relative_path=:relative_path");
+            q.bindValue(":relative_path", write.key);
+            ok = exec(db, "indexText rowid", q) && ok;
+            if (q.next())
+            {
+                rowid = q.value(0).toInt();
+            }
+        }
+        {
+            QSqlQuery &q = statements.prepared("DELETE FROM cuesheet_text WHERE rowid=:rowid");
+            q.bindValue(":rowid", rowid);
+            ok = exec(db, "indexText DELETE", q) && ok;
+        }
+        if (!write.text.trimmed().isEmpty())
+        {
+            QSqlQuery &q = statements.prepared("INSERT INTO cuesheet_text(rowid, body) VALUES (:rowid, :body)");
+            q.bindValue(":rowid", rowid);
+            q.bindValue(":body", write.text);
+            ok = exec(db, "indexText INSERT", q) && ok;
+        }
+        break;
+    }
+
+    case SongSettingsWrite::RemoveIndexedText:
+    {
+        {
+            QSqlQuery &q = statements.prepared("DELETE FROM cuesheet_text WHERE rowid IN (SELECT rowid FROM cuesheet_text_files WHERE relative_path=:relative_path)");
+            q.bindValue(":relative_path", write.key);
+            ok = exec(db, "removeIndexedText", q) && ok;
+        }
+        {
+            QSqlQuery &q = statements.prepared("DELETE FROM cuesheet_text_files WHERE relative_path=:relative_path");
+            q.bindValue(":relative_path", write.key);
+            ok = exec(db, "removeIndexedText files", q) && ok;
+        }
+        break;
+    }
+
+    case SongSettingsWrite::SetCuesheetFontOffset:
+    {
+        if (write.value == 0)
+        {
+            // back to the default, so don't keep a row around just to say "normal"
+            QSqlQuery &q = statements.prepared("DELETE FROM cuesheets WHERE relative_path=:relative_path");
+            q.bindValue(":relative_path", write.key);
+            ok = exec(db, "setCuesheetFontOffset DELETE", q) && ok;
+            break;
+        }
+
+        // NOTE: a real UPSERT here (rather than INSERT OR REPLACE), so that any per-cuesheet columns
+        //   added to this table later aren't silently wiped when only the font size is being written.
+        QSqlQuery &q = statements.prepared("INSERT INTO cuesheets(relative_path, fontSizeOffset) VALUES (:relative_path,:fontSizeOffset)"
+                                           " ON CONFLICT(relative_path) DO UPDATE SET fontSizeOffset=:fontSizeOffset2");
+        q.bindValue(":relative_path", write.key);
+        q.bindValue(":fontSizeOffset", write.value);
+        q.bindValue(":fontSizeOffset2", write.value);
+        ok = exec(db, "setCuesheetFontOffset UPSERT", q) && ok;
+        break;
+    }
+    }
+    return ok;
+}
+
+
 QList<SessionInfo> SongSettings::getSessionInfo()
 {
     QList<SessionInfo> sessions;
@@ -1218,6 +2097,8 @@ QList<SessionInfo> SongSettings::getSessionInfo()
 
 void SongSettings::setSessionInfo(const QList<SessionInfo> &sessions)
 {
+    flushWrites();  // queued writes captured the old session rowids
+
     QList<SessionInfo> currentSessions(getSessionInfo());
     QHash<int, SessionInfo> sessionsById;
     QHash<QString, SessionInfo> sessionsByName;
@@ -1230,7 +2111,7 @@ void SongSettings::setSessionInfo(const QList<SessionInfo> &sessions)
     
     {
         QSqlQuery q(m_db);
-        q.prepare("BEGIN");
+        q.prepare("BEGIN IMMEDIATE");  // see applyWrites()
         exec("SessionInfo BEGIN", q);
     }
 
@@ -1273,6 +2154,11 @@ void SongSettings::setSessionInfo(const QList<SessionInfo> &sessions)
         q.prepare("COMMIT");
         exec("SessionInfo COMMIT", q);
     }
+
+    if (writer)
+    {
+        writer->mirrorSoon();  // written on this thread, so the writer doesn't know about it
+    }
 }
 
 // MARKERS ---------------
@@ -1280,10 +2166,25 @@ void SongSettings::setSessionInfo(const QList<SessionInfo> &sessions)
 void SongSettings::getSongMarkers(const QString &filename, QMap<float,int> &markers)
 {
     markers.clear(); // clear out whatever was in the QMap before
-    int song_rowid = getSongIDFromFilenameAlone(filename);
 
-    QSqlQuery q(m_db);
-    q.prepare("SELECT markerPos FROM markers WHERE song_rowid=:song_rowid");
+    QList<SongSettingsWrite> writes = pendingWrites();
+    for (auto write = writes.crbegin(); write != writes.crend(); ++write)  // newest first
+    {
+        if (write->kind == SongSettingsWrite::SetSongMarkers && write->key == filename)
+        {
+            for (auto markerPosition = write->markers.cbegin(); markerPosition != write->markers.cend(); ++markerPosition)
+            {
+                if (markerPosition.key() >= 0.0 && markerPosition.key() <= 1.0) {
+                    markers[markerPosition.key()] = 0;  // not committed yet
+                }
+            }
+            return;
+        }
+    }
+
+    int song_rowid = getSongIDFromFilenameAlone(statements, filename);
+
+    QSqlQuery &q = statements.prepared("SELECT markerPos FROM markers WHERE song_rowid=:song_rowid");
     q.bindValue(":song_rowid", song_rowid);
     exec("getSongMarkers", q);
 
@@ -1301,44 +2202,11 @@ void SongSettings::getSongMarkers(const QString &filename, QMap<float,int> &mark
 
 void SongSettings::setSongMarkers(const QString &filename, const QMap<float,int> &markers)
 {
-    int song_rowid = getSongIDFromFilenameAlone(filename);
-
-    {
-        // start transaction -------
-        QSqlQuery q(m_db);
-        q.prepare("BEGIN");
-        exec("setSongMarkers BEGIN", q);
-    }
-
-    {
-        // delete old markers for this song -------
-        QSqlQuery q(m_db);
-        q.prepare("DELETE FROM markers WHERE song_rowid=:song_rowid");
-        q.bindValue(":song_rowid", song_rowid);
-        exec("setSongMarkers DELETE", q);
-    }
-
-    {
-        // insert new markers for this song --------
-        QSqlQuery q(m_db);
-        q.prepare("INSERT INTO markers(song_rowid, markerPos) VALUES (:song_rowid,:markerPos)");
-        for (QMap<float, int>::const_iterator markerPosition = markers.cbegin(); markerPosition != markers.cend(); ++markerPosition)
-        {
-            if (markerPosition.key() >= 0.0 && markerPosition.key() <= 1.0) {  // a little bit of error checking, to prevent weird corruption
-                // only allow storing of valid markerPositions into DB
-                q.bindValue(":song_rowid", song_rowid);             // key is song's rowid
-                q.bindValue(":markerPos", markerPosition.key());    // key in QMap is the markerPosition, QMap value is ignored
-                exec("setSongMarkers INSERT", q);
-            }
-        }
-    }
-
-    {
-        // end transaction --------
-        QSqlQuery q(m_db);
-        q.prepare("COMMIT");
-        exec("setSongMarkers COMMIT", q);
-    }
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::SetSongMarkers;
+    write.key = filename;
+    write.markers = markers;
+    queueWrite(write);  // one transaction: old markers deleted, new ones inserted
 }
 
 // add a marker position to a set of markers
@@ -1394,16 +2262,26 @@ int SongSettings::getCuesheetFontOffset(const QString &filenameWithPath)
         return 0;  // no cuesheet is loaded (or no DB yet), so no offset
     }
 
-    QSqlQuery q(m_db);
-    q.prepare("SELECT fontSizeOffset FROM cuesheets WHERE relative_path=:relative_path");
+    QList<SongSettingsWrite> writes = pendingWrites();
+    for (auto write = writes.crbegin(); write != writes.crend(); ++write)  // newest first
+    {
+        if (write->kind == SongSettingsWrite::SetCuesheetFontOffset && write->key == removeRootDirs(filenameWithPath))
+        {
+            return write->value;  // not committed yet
+        }
+    }
+
+    QSqlQuery &q = statements.prepared("SELECT fontSizeOffset FROM cuesheets WHERE relative_path=:relative_path");
     q.bindValue(":relative_path", removeRootDirs(filenameWithPath));
     exec("getCuesheetFontOffset", q);
 
+    int offset = 0;  // no row for this cuesheet yet
     if (q.next())
     {
-        return q.value(0).toInt();
+        offset = q.value(0).toInt();
     }
-    return 0;  // no row for this cuesheet yet
+    q.finish();
+    return offset;
 }
 
 void SongSettings::setCuesheetFontOffset(const QString &filenameWithPath, int offset)
@@ -1412,23 +2290,89 @@ void SongSettings::setCuesheetFontOffset(const QString &filenameWithPath, int of
         return;  // no cuesheet is loaded (or no DB yet), so there's nothing to remember it against
     }
 
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::SetCuesheetFontOffset;
+    write.key = removeRootDirs(filenameWithPath);
+    write.value = offset;  // 0 deletes the row
+    queueWrite(write);
+}
+
+
+// Full-text index of cuesheets and lyrics ---------------------
+
+// What's in the index now: relative path --> (size, mtime) of the file when it was read
+QHash<QString, QPair<qint64, qint64>> SongSettings::getIndexedTextFiles()
+{
+    QHash<QString, QPair<qint64, qint64>> files;
     QSqlQuery q(m_db);
-    if (offset == 0)
+    q.setForwardOnly(true);
+    exec("getIndexedTextFiles", q, "SELECT relative_path, size, mtime FROM cuesheet_text_files");
+    while (q.next())
+    {
+        files.insert(q.value(0).toString(), qMakePair(q.value(1).toLongLong(), q.value(2).toLongLong()));
+    }
+    return files;
+}
+
+void SongSettings::setIndexedText(const QString &filenameWithPath, qint64 size, qint64 mtime, const QString &text)
+{
+    if (!textSearchAvailable)
     {
-        // back to the default, so don't keep a row around just to say "normal"
-        q.prepare("DELETE FROM cuesheets WHERE relative_path=:relative_path");
-        q.bindValue(":relative_path", removeRootDirs(filenameWithPath));
-        exec("setCuesheetFontOffset DELETE", q);
         return;
     }
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::IndexText;
+    write.key = removeRootDirs(filenameWithPath);
+    write.fileSize = size;
+    write.fileMtime = mtime;
+    write.text = text;
+    queueWrite(write);  // a whole library's worth of these is committed in a few big transactions
+}
 
-    // NOTE: a real UPSERT here (rather than INSERT OR REPLACE), so that any per-cuesheet columns
-    //   added to this table later aren't silently wiped when only the font size is being written.
-    q.prepare("INSERT INTO cuesheets(relative_path, fontSizeOffset) VALUES (:relative_path,:fontSizeOffset)"
-              " ON CONFLICT(relative_path) DO UPDATE SET fontSizeOffset=:fontSizeOffset2");
-    q.bindValue(":relative_path", removeRootDirs(filenameWithPath));
-    q.bindValue(":fontSizeOffset", offset);
-    q.bindValue(":fontSizeOffset2", offset);
-    exec("setCuesheetFontOffset UPSERT", q);
+void SongSettings::removeIndexedText(const QString &filenameWithPathNormalized)
+{
+    if (!textSearchAvailable)
+    {
+        return;
+    }
+    SongSettingsWrite write;
+    write.kind = SongSettingsWrite::RemoveIndexedText;
+    write.key = filenameWithPathNormalized;
+    queueWrite(write);
 }
 
+// All of the indexed files (relative paths) containing all of these words, best match first.  The words
+//   are quoted, so punctuation can't turn into FTS5 syntax, and the last one is a prefix, so that results
+//   show up while the user is still typing it.  No LIMIT: a filter that silently drops matches past some
+//   count would hide songs that really do contain the words.
+QStringList SongSettings::searchIndexedText(const QString &words)
+{
+    QStringList results;
+    if (!textSearchAvailable)
+    {
+        return results;
+    }
+
+    static const QRegularExpression nonWord("[^\\w']+");
+    QStringList terms = words.split(nonWord, Qt::SkipEmptyParts);
+    if (terms.isEmpty())
+    {
+        return results;
+    }
+    for (auto &term : terms)
+    {
+        term = "\"" + term + "\"";
+    }
+    terms.last() += "*";
+
+    QSqlQuery &q = statements.prepared("SELECT cuesheet_text_files.relative_path FROM cuesheet_text"
+                                       " JOIN cuesheet_text_files ON cuesheet_text_files.rowid = cuesheet_text.rowid"
+                                       " WHERE cuesheet_text MATCH :query ORDER BY rank");
+    q.bindValue(":query", terms.join(" "));
+    exec("searchIndexedText", q);
+    while (q.next())
+    {
+        results.append(q.value(0).toString());
+    }
+    return results;
+}
@@ -29,7 +29,12 @@
 #include <QtSql>
 #include <vector>
 
+#include "sqlstatementcache.h"
+
 class SessionInfo;
+class SongSettingsWriter;
+class SongSettingsMirror;
+struct SongSettingsWrite;
 
 class SongPlayEvent {
 public:
@@ -64,26 +69,40 @@ private :
     bool dummy;
 public:
     SongSetting();
+    void mergeFrom(const SongSetting &other);  // copy every field that is set in other
+    SongSetting changesFrom(const SongSetting &before) const;  // just the fields set here that differ from before
+    bool isAnySet() const;
     friend QDebug operator<<(QDebug dbg, const SongSetting &setting);  // DEBUG
 };
 
 
 class TableDefinition;
 class IndexDefinition;
+class TriggerDefinition;
 
-class SongSettings
+class SongSettings : public QObject
 {
+    Q_OBJECT
+
 public:
     SongSettings();
+    ~SongSettings();
     void openDatabase(const QString &path,
                       const QString &mainRootDir,
                       bool in_memory);
     void closeDatabase();
+    void flushWrites();     // blocks until every queued write has been committed
+    void setUseLocalWorkingCopy(bool b) { useLocalWorkingCopy = b; }  // takes effect at the next openDatabase()
+    static void configureConnection(QSqlDatabase &db, bool in_memory);  // pragmas, for every connection we open
     void saveSettings(const QString &filenameWithPath,
                       const SongSetting &settings);
     bool loadSettings(const QString &filenameWithPath,
                       SongSetting &settings);
-    void loadSettingsForAllSongs(QHash<QString, SongSetting> &settingsByFilename);
+    // the same change to many songs at once (e.g. the music table's multi-select context menu): one queued
+    //   write, so one transaction, and one songSettingsChanged() signal.  These keep tagCounts up to date.
+    void saveSettingsForSongs(const QStringList &filenamesWithPath, const SongSetting &delta);
+    void changeTagForSongs(const QStringList &filenamesWithPath, const QString &tag, bool add);
+    const QHash<QString, SongSetting> &allSongSettings();  // every song's settings, keyed by removeRootDirs() path
 
     void setCurrentSession(int id) { current_session_id = id; }
     int getCurrentSession() { return current_session_id; }
@@ -110,12 +129,7 @@ public:
     void removeTags(const QString &str);
     void setDefaultTagColors( const QString &background, const QString & foreground);
 
-    void getSongPlayHistory(SongPlayEvent &event,
-                            int session_id,
-                            bool omitStartDate,
-                            QString startDate,
-                            bool omitEndDate,
-                            QString endDate);
+    QString databaseName() const { return m_db.databaseName(); }  // e.g. for SongPlayHistoryQuery's own connection
 
     void getSongMarkers(const QString &filename, QMap<float,int> &markers);  // get all markers associated with a song from DB
     void setSongMarkers(const QString &filename, const QMap<float,int> &markers);  // set markers associated with a song in DB
@@ -128,27 +142,78 @@ public:
     int getCuesheetFontOffset(const QString &filenameWithPath);                // 0, if never customized
     void setCuesheetFontOffset(const QString &filenameWithPath, int offset);   // 0 deletes the row
 
+    // full-text index of cuesheet text and MP3 lyrics, built by MainWindow::refreshCuesheetTextIndexInBackground()
+    bool isTextSearchAvailable() { return textSearchAvailable; }  // false if this SQLite has no FTS5
+    QHash<QString, QPair<qint64, qint64>> getIndexedTextFiles();
+    void setIndexedText(const QString &filenameWithPath, qint64 size, qint64 mtime, const QString &text);
+    void removeIndexedText(const QString &filenameWithPathNormalized);
+    QStringList searchIndexedText(const QString &words);
+
     bool isDatabaseOpened() {
         return(databaseOpened);
     }
 
+signals:
+    // emitted by saveSettings(), with just the fields that actually changed (e.g. only Tempo, when the
+    //   tempo slider moves), so that views can update that song's cells instead of reloading everything
+    void songSettingChanged(const QString &filenameWithPathNormalized, const SongSetting &changes);
+    // emitted by saveSettingsForSongs()/changeTagForSongs() instead, once for all of the songs that changed.
+    //   The values can differ per song (e.g. tags), so read them from allSongSettings().
+    void songSettingsChanged(const QStringList &filenamesWithPathNormalized, const SongSetting &changes);
+    // some queued writes could not be saved, even after retrying (may be emitted from the writer thread)
+    void writesFailed(int droppedWrites);
+    // the local working copy and the shared copy were both changed, and the one that lost was saved
+    //   as this file (see songsettingsmirror.h; may be emitted from the writer thread)
+    void mirrorConflict(const QString &conflictFilename);
+
 private:
     bool debugErrors(const char *where, QSqlQuery &q);
-    void exec(const char *where, QSqlQuery &q);
-    void exec(const char *where, QSqlQuery &q, const QString &str);
+    bool exec(const char *where, QSqlQuery &q);  // the exec()s return true on success
+    bool exec(const char *where, QSqlQuery &q, const QString &str);
+    bool debugErrors(QSqlDatabase &db, const char *where, QSqlQuery &q);
+    bool exec(QSqlDatabase &db, const char *where, QSqlQuery &q);
+
     QString tagsBackgroundColorString;
     QString tagsForegroundColorString;
     bool databaseOpened;
     QSqlDatabase m_db;
+    SqlStatementCache statements;   // for m_db, i.e. the GUI thread
     int current_session_id;
     QHash<QString, int> tagCounts;
 
-    void ensureSchema(TableDefinition *);
-    void ensureIndex(IndexDefinition *index_definition);
-    int getSongIDFromFilename(const QString &filename, const QString &filenameWithPathNormalized);
-    int getSongIDFromFilenameAlone(const QString &filename);
+    // writes go through the write-behind queue (see songsettingswriter.h), and are applied on its thread
+    SongSettingsWriter *writer;
+    bool useLocalWorkingCopy;       // work on a local copy of the DB, and mirror it to the music root's (see songsettingsmirror.h)
+    SongSettingsMirror *mirror;
+    void queueWrite(const SongSettingsWrite &write);
+    QList<SongSettingsWrite> pendingWrites();
+    bool applyWrites(SqlStatementCache &statements, const QList<SongSettingsWrite> &writes, int *failedWrite = nullptr);
+    bool applyWrite(SqlStatementCache &statements, const SongSettingsWrite &write);  // true on success
+
+    bool ensureSchemaUpToDate();  // true if it had to change anything
+    bool ensureSchema(TableDefinition *);                       // these three return true on success
+    bool ensureIndex(IndexDefinition *index_definition);
+    bool ensureTrigger(TriggerDefinition *trigger_definition, bool *created);
+    int getSongIDFromFilename(SqlStatementCache &statements, const QString &filename, const QString &filenameWithPathNormalized);
+    int getSongIDFromFilenameAlone(SqlStatementCache &statements, const QString &filename);
+    bool saveSongRow(SqlStatementCache &statements, const QString &songname,
+                     const QString &filenameWithPathNormalized, const SongSetting &settings);
+    bool indexStaleSongTags(SqlStatementCache &statements);  // true on success
     int getSessionIDFromName(const QString &name);
 
+    bool textSearchAvailable;
+    bool lastPlayedCacheLoaded;
+    QHash<QString, QHash<int, QDateTime>> lastPlayedCache;   // songs.filename --> session_rowid --> played_on (UTC)
+    void loadLastPlayedCache();
+    QString ageFromLastPlayedCache(const QString &filename, bool show_all_sessions);
+
+    // Process-wide copy of every songs row (plus writes still in the queue), loaded by the first
+    //   allSongSettings() and kept up to date by saveSettings() from then on
+    bool settingsCacheLoaded;
+    QHash<QString, SongSetting> settingsCache;
+    void loadSettingsCache();
+    void saveSettingsForSongs(const QStringList &filenamesWithPathNormalized, const QList<SongSetting> &settings);
+
     bool tagColorCacheSet;
     QHash<QString,QPair<QString,QString>> tagColorCache;
     
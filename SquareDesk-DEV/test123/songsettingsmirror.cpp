@@ -0,0 +1,297 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songsettingsmirror.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+#include <utility>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <cstdio>
+#endif
+
+SongSettingsMirror::SongSettingsMirror(const QString &sharedFilename, ConflictFunction reportConflict) :
+    sharedFilename(sharedFilename),
+    localChanges(false),
+    reportConflict(reportConflict)
+{
+    // one local copy per music root (so per shared copy), e.g. .../databases/1a2b3c4d5e6f7a8b/SquareDesk.sqlite3
+    QString id = QCryptographicHash::hash(QFileInfo(sharedFilename).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    QString localDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/databases/" + id;
+    QDir().mkpath(localDir);
+
+    localFilename = localDir + "/SquareDesk.sqlite3";
+    stateFilename = localDir + "/mirror.ini";
+    loadState();
+}
+
+void SongSettingsMirror::loadState()
+{
+    QSettings state(stateFilename, QSettings::IniFormat);
+    localChanges = state.value("localChanges", false).toBool();
+    syncedSharedSignature = state.value("sharedSignature").toString();
+    reportedConflicts = state.value("reportedConflicts").toStringList();
+}
+
+void SongSettingsMirror::saveState()
+{
+    QSettings state(stateFilename, QSettings::IniFormat);
+    state.setValue("sharedFilename", sharedFilename);  // just so a human can tell which copy this is
+    state.setValue("localChanges", localChanges);
+    state.setValue("sharedSignature", syncedSharedSignature);
+    state.setValue("reportedConflicts", reportedConflicts);
+    state.sync();
+}
+
+// Conflict files next to the shared copy that nobody has been told about yet: ours, or the other
+//   machine's (which hold ITS changes that lost to some other copy)
+void SongSettingsMirror::reportNewConflicts()
+{
+    QFileInfo shared(sharedFilename);
+    QStringList conflicts = QDir(shared.absolutePath()).entryList(QStringList(shared.fileName() + ".conflict-*"),
+                                                                    QDir::Files, QDir::Name);
+    bool changed = false;
+    for (const QString &conflict : std::as_const(conflicts))
+    {
+        if (!reportedConflicts.contains(conflict))
+        {
+            reportedConflicts.append(conflict);
+            changed = true;
+            if (reportConflict)
+            {
+                reportConflict(shared.absolutePath() + "/" + conflict);
+            }
+        }
+    }
+    for (int i = reportedConflicts.size() - 1; i >= 0; --i)
+    {
+        if (!conflicts.contains(reportedConflicts[i]))
+        {
+            reportedConflicts.removeAt(i);  // the user deleted it, no need to remember it
+            changed = true;
+        }
+    }
+    if (changed)
+    {
+        saveState();
+    }
+}
+
+QString SongSettingsMirror::sharedSignature()
+{
+    QString signature;
+    for (const QString &filename : QStringList({ sharedFilename, sharedFilename + "-wal" }))
+    {
+        QFileInfo fi(filename);
+        signature += fi.exists() ? QString("%1:%2;").arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch()) : QString("-;");
+    }
+    return signature;
+}
+
+bool SongSettingsMirror::sharedChangedSinceSync()
+{
+    return QFileInfo::exists(sharedFilename) && sharedSignature() != syncedSharedSignature;
+}
+
+bool SongSettingsMirror::replaceFile(const QString &fromFilename, const QString &toFilename)
+{
+#if defined(Q_OS_WIN)
+    return MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(fromFilename).utf16()),
+                       reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(toFilename).utf16()),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(QFile::encodeName(fromFilename).constData(), QFile::encodeName(toFilename).constData()) == 0;
+#endif
+}
+
+// VACUUM INTO writes a complete, consistent copy (including anything still in the source's -wal)
+bool SongSettingsMirror::vacuumInto(QSqlDatabase &from, const QString &toFilename)
+{
+    QFile::remove(toFilename);  // VACUUM INTO won't overwrite
+
+    QSqlQuery q(from);
+    q.prepare("VACUUM INTO :filename");
+    q.bindValue(":filename", toFilename);
+    if (!q.exec())
+    {
+        qWarning() << "SongSettingsMirror: copy to" << toFilename << "failed:" << q.lastError();
+        QFile::remove(toFilename);
+        return false;
+    }
+    return true;
+}
+
+// ...to a temporary name first, then renamed over toFilename in one step, so that toFilename is never
+//   seen half-written, or missing.  The caller makes sure that toFilename has no -wal worth keeping.
+bool SongSettingsMirror::copyDatabase(QSqlDatabase &from, const QString &toFilename)
+{
+    QString tempFilename = toFilename + ".tmp";
+    if (!vacuumInto(from, tempFilename))
+    {
+        return false;
+    }
+    if (!replaceFile(tempFilename, toFilename))
+    {
+        qWarning() << "SongSettingsMirror: could not replace" << toFilename;
+        QFile::remove(tempFilename);
+        return false;
+    }
+    return true;
+}
+
+// Folds the shared copy's -wal (e.g. another machine's commits) into it, so that it can be replaced.
+//   If backUpFirst, it's copied to a .conflict- file first, -wal and all.
+bool SongSettingsMirror::checkpointShared(bool backUpFirst)
+{
+    QString connectionName = QString("SongSettingsMirrorShared_%1").arg(reinterpret_cast<quintptr>(this));
+    bool checkpointed = false;
+    {
+        QSqlDatabase shared = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        shared.setDatabaseName(sharedFilename);
+        if (shared.open())
+        {
+            if (backUpFirst)
+            {
+                QString conflictFilename = sharedFilename + ".conflict-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss");
+                qWarning() << "SongSettingsMirror: the shared copy was changed elsewhere, saving it as" << conflictFilename;
+                if (vacuumInto(shared, conflictFilename))
+                {
+                    reportNewConflicts();
+                }
+            }
+
+            QSqlQuery q(shared);
+            // returns (busy, frames in the -wal, frames checkpointed); busy = someone else is in the middle of something
+            checkpointed = q.exec("PRAGMA wal_checkpoint(TRUNCATE)") && q.next() && q.value(0).toInt() == 0;
+            q.finish();
+            shared.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    QFileInfo wal(sharedFilename + "-wal");
+    return checkpointed && (!wal.exists() || wal.size() == 0);
+}
+
+QString SongSettingsMirror::prepareLocalCopy()
+{
+    reportNewConflicts();
+
+    bool haveLocal = QFileInfo::exists(localFilename);
+
+    if (!QFileInfo::exists(sharedFilename))
+    {
+        // nothing shared yet (new music root): whatever we have locally becomes the shared copy
+        noteLocalChanges();
+        return localFilename;
+    }
+
+    if (haveLocal && !sharedChangedSinceSync())
+    {
+        return localFilename;  // the usual case: nobody else touched it
+    }
+
+    if (haveLocal && localChanges)
+    {
+        // both changed: keep ours, and pushToShared() sets theirs aside before replacing it
+        qWarning() << "SongSettingsMirror: both" << sharedFilename << "and the local copy changed since the last sync";
+        return localFilename;
+    }
+
+    // no local copy yet, or only the shared copy changed: (re)load it, once, here at startup
+    QString connectionName = QString("SongSettingsMirror_%1").arg(reinterpret_cast<quintptr>(this));
+    bool copied = false;
+    {
+        QSqlDatabase shared = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        shared.setDatabaseName(sharedFilename);
+        shared.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (shared.open())
+        {
+            // the local copy isn't open yet, and everything in it is in the shared copy too (or it
+            //   wouldn't be replaced), so its -wal can go; a stale one would be replayed into the new file
+            QFile::remove(localFilename + "-wal");
+            QFile::remove(localFilename + "-shm");
+            copied = copyDatabase(shared, localFilename);
+            shared.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (!copied)
+    {
+        qWarning() << "SongSettingsMirror: could not make a local copy of" << sharedFilename << ", using it directly";
+        return sharedFilename;
+    }
+
+    syncedSharedSignature = sharedSignature();
+    localChanges = false;
+    saveState();
+    return localFilename;
+}
+
+void SongSettingsMirror::noteLocalChanges()
+{
+    if (!localChanges)
+    {
+        localChanges = true;
+        saveState();  // so that a crash before the next push can't turn our changes into "theirs win"
+    }
+}
+
+bool SongSettingsMirror::pushToShared(QSqlDatabase &db)
+{
+    if (!localChanges)
+    {
+        return true;
+    }
+
+    if (QFileInfo::exists(sharedFilename) && !checkpointShared(sharedChangedSinceSync()))
+    {
+        qWarning() << "SongSettingsMirror:" << sharedFilename << "is in use elsewhere, will try again later";
+        return false;  // still localChanges, so the next push tries again (and backs it up again, if need be)
+    }
+
+    if (!copyDatabase(db, sharedFilename))
+    {
+        return false;  // still localChanges, so the next push tries again
+    }
+
+    syncedSharedSignature = sharedSignature();
+    localChanges = false;
+    saveState();
+    return true;
+}
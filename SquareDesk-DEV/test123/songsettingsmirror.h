@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGSETTINGSMIRROR_H_INCLUDED
+#define SONGSETTINGSMIRROR_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QtSql/QSqlDatabase>
+#include <functional>
+
+#define SONGSETTINGS_MIRROR_DELAY_MS 10000   // push to the shared copy after this long without any writes
+
+// The "local working copy" mode of SongSettings.  The DB in <musicRoot>/.squaredesk is the SHARED copy
+//   (it travels with the music, e.g. via iCloud/Dropbox/a NAS), but it can be slow, and can be locked
+//   for a while by whatever is syncing it.  In this mode, SongSettings works on a copy on the local
+//   disk instead, and the write-behind thread mirrors it back to the shared copy in the background
+//   (with VACUUM INTO, which writes a consistent snapshot even while the local DB is in use).
+//
+//   Conflicts: the size and mtime of the shared copy AND of its -wal are remembered after each sync
+//   (a commit in WAL mode only touches the -wal).  If they changed since then, another machine wrote
+//   it.  If we have no unsynced changes, we just take theirs (at open).  If we DO, ours wins, but
+//   theirs is first set aside next to it (with VACUUM INTO, so including its -wal) as
+//   SquareDesk.sqlite3.conflict-<date>-<time>, so that nothing is silently thrown away, and the
+//   ConflictFunction is told about it (so that the user can be).  So is any conflict file that turns up
+//   next to the shared copy that we haven't reported yet (e.g. one written as SquareDesk quit, or one
+//   written by the other machine), the next time the local copy is prepared.
+//
+//   The shared copy is replaced with one atomic rename, and only once its -wal has been checkpointed
+//   (a -wal belongs to the file next to it, and can hold another machine's commits).  If it can't be
+//   checkpointed right now (someone has it open), the push is tried again later.
+//
+//   prepareLocalCopy() runs on the GUI thread, before the local DB is opened; everything else runs on
+//   the write-behind thread.
+class SongSettingsMirror
+{
+public:
+    typedef std::function<void(const QString &conflictFilename)> ConflictFunction;  // called on the thread that found it
+
+    explicit SongSettingsMirror(const QString &sharedFilename, ConflictFunction reportConflict = ConflictFunction());
+
+    QString prepareLocalCopy();             // returns the DB filename to open (the shared one, if this fails)
+    void noteLocalChanges();                // the local copy now has changes that the shared copy doesn't
+    bool pushToShared(QSqlDatabase &db);    // db = a connection to the local copy
+
+private:
+    QString sharedFilename;
+    QString localFilename;
+    QString stateFilename;                  // what we know about the last sync
+
+    bool localChanges;                      // not pushed to the shared copy yet (persisted, in case we crash)
+    QString syncedSharedSignature;          // sharedSignature(), as of the last time we synced with it
+    ConflictFunction reportConflict;
+    QStringList reportedConflicts;          // conflict files already reported (persisted)
+
+    void loadState();
+    void saveState();
+    QString sharedSignature();              // size and mtime of the shared copy and its -wal
+    bool sharedChangedSinceSync();
+    void reportNewConflicts();
+    bool checkpointShared(bool backUpFirst);  // false if its -wal is still not empty
+    static bool vacuumInto(QSqlDatabase &from, const QString &toFilename);
+    static bool copyDatabase(QSqlDatabase &from, const QString &toFilename);
+    static bool replaceFile(const QString &fromFilename, const QString &toFilename);  // atomic
+};
+
+#endif /* ifndef SONGSETTINGSMIRROR_H_INCLUDED */
@@ -0,0 +1,253 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songsettingswriter.h"
+
+#include <QDeadlineTimer>
+#include <QDebug>
+
+SongSettingsWriter::SongSettingsWriter(const QString &databaseName, ApplyFunction apply, ReportFunction report, SongSettingsMirror *mirror) :
+    databaseName(databaseName),
+    apply(apply),
+    report(report),
+    mirror(mirror),
+    backingOff(false),
+    openDone(false),
+    openOK(false),
+    flushRequested(false),
+    stopRequested(false),
+    mirrorPending(false)
+{
+}
+
+SongSettingsWriter::~SongSettingsWriter()
+{
+    if (isRunning()) {
+        {
+            QMutexLocker locker(&mutex);
+            stopRequested = true;   // the run loop writes whatever is still queued before it returns
+            workAvailable.wakeOne();
+        }
+        wait();
+    }
+}
+
+// Nothing can be queued before this returns true, so when the writer's own connection can't be
+//   opened, no writes are lost: the caller just writes synchronously instead.
+bool SongSettingsWriter::startWriting()
+{
+    start();
+    QMutexLocker locker(&mutex);
+    while (!openDone) {
+        openFinished.wait(&mutex);
+    }
+    if (!openOK) {
+        locker.unlock();
+        wait();  // run() returns right away
+    }
+    return openOK;
+}
+
+void SongSettingsWriter::enqueue(const SongSettingsWrite &write)
+{
+    QMutexLocker locker(&mutex);
+
+    // coalesce with a write for the same key that hasn't been picked up yet (in-flight ones are too late)
+    if (write.kind == SongSettingsWrite::SaveSettings ||
+        write.kind == SongSettingsWrite::SetSongMarkers ||
+        write.kind == SongSettingsWrite::SetCuesheetFontOffset ||
+        write.kind == SongSettingsWrite::IndexText) {
+        for (auto it = queue.rbegin(); it != queue.rend(); ++it) {  // newest first
+            SongSettingsWrite &queued = *it;
+            if (queued.kind == SongSettingsWrite::SaveSettingsForSongs && queued.keys.contains(write.key)) {
+                break;  // merging into an older write would put this one before the bulk write
+            }
+            if (queued.kind == write.kind && queued.key == write.key) {
+                if (write.kind == SongSettingsWrite::SaveSettings) {
+                    queued.settings.mergeFrom(write.settings);  // e.g. many tempo/pitch/volume changes --> one UPDATE
+                    if (write.settings.isSetFilename()) {
+                        queued.name = write.name;
+                    }
+                } else {
+                    queued = write;                              // last one wins
+                }
+                return;
+            }
+        }
+    }
+
+    queue.append(write);
+    workAvailable.wakeOne();
+}
+
+void SongSettingsWriter::flush()
+{
+    QMutexLocker locker(&mutex);
+    if (!isRunning()) {
+        return;
+    }
+    flushRequested = true;
+    workAvailable.wakeOne();
+    while (!queue.isEmpty() || !inFlight.isEmpty()) {
+        batchDone.wait(&mutex);
+    }
+}
+
+QList<SongSettingsWrite> SongSettingsWriter::pendingWrites()
+{
+    QMutexLocker locker(&mutex);
+    return inFlight + queue;
+}
+
+void SongSettingsWriter::mirrorSoon()
+{
+    QMutexLocker locker(&mutex);
+    if (mirror) {
+        mirrorPending = true;
+        workAvailable.wakeOne();  // starts the quiet period over
+    }
+}
+
+void SongSettingsWriter::run()
+{
+    QString connectionName = QString("SongSettingsWriter_%1").arg(reinterpret_cast<quintptr>(this));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databaseName);
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");  // the GUI thread's connection may be reading
+        bool opened = db.open();
+        if (!opened) {
+            qWarning() << "SongSettingsWriter: database fail, writing synchronously instead:" << databaseName << ":" << db.lastError();
+        } else {
+            SongSettings::configureConnection(db, false);
+        }
+        {
+            QMutexLocker locker(&mutex);
+            openDone = true;
+            openOK = opened;
+            openFinished.wakeAll();
+        }
+        if (!opened) {
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(connectionName);
+            return;
+        }
+        SqlStatementCache statements(db);  // this thread's prepared statements, reused by every batch
+
+        QMutexLocker locker(&mutex);
+        for (;;) {
+            while (queue.isEmpty() && !stopRequested) {
+                if (!mirrorPending) {
+                    workAvailable.wait(&mutex);
+                } else if (!workAvailable.wait(&mutex, SONGSETTINGS_MIRROR_DELAY_MS)) {
+                    // quiet for long enough: push to the (slow) shared copy now
+                    mirrorPending = false;
+                    locker.unlock();
+                    mirror->noteLocalChanges();
+                    statements.finishAll();
+                    bool pushed = mirror->pushToShared(db);
+                    locker.relock();
+                    if (!pushed) {
+                        mirrorPending = true;  // e.g. the shared folder is offline: try again after another quiet period
+                    }
+                }
+            }
+            if (queue.isEmpty()) {
+                break;  // stopRequested, and nothing left to write
+            }
+
+            // give a burst of writes (e.g. dragging the tempo slider) a moment to coalesce into one
+            QDeadlineTimer deadline(backingOff ? SONGSETTINGS_WRITE_BACKOFF_MS : SONGSETTINGS_WRITE_DELAY_MS);
+            while (!flushRequested && !stopRequested && workAvailable.wait(&mutex, deadline)) {
+                // woken by another enqueue(): keep waiting for the rest of the burst
+            }
+
+            inFlight.swap(queue);
+            bool mustFinish = flushRequested || stopRequested;  // someone is waiting for this batch
+            flushRequested = false;
+            locker.unlock();
+
+            QList<SongSettingsWrite> batch = inFlight;
+            int attempts = 0;
+            int dropped = 0;
+            bool wroteAny = false;
+            while (!batch.isEmpty()) {
+                int failedWrite = -1;
+                if (apply(statements, batch, &failedWrite)) {  // one transaction for the whole batch
+                    batch.clear();
+                    wroteAny = true;
+                    break;
+                }
+                if (++attempts <= SONGSETTINGS_WRITE_RETRIES) {
+                    QThread::msleep(SONGSETTINGS_WRITE_RETRY_DELAY_MS);
+                    continue;
+                }
+                if (failedWrite < 0) {
+                    break;  // BEGIN or COMMIT: the DB itself can't be written right now
+                }
+                qWarning() << "SongSettingsWriter: dropping a write that keeps failing, kind" << batch[failedWrite].kind << ":" << batch[failedWrite].key;
+                batch.removeAt(failedWrite);  // the rest were rolled back with it, but can still be written
+                dropped++;
+                attempts = 0;
+            }
+            if (wroteAny && mirror) {
+                mirror->noteLocalChanges();
+            }
+
+            locker.relock();
+            backingOff = false;
+            if (!batch.isEmpty()) {
+                if (!mustFinish && !flushRequested && !stopRequested) {
+                    qWarning() << "SongSettingsWriter: can't write the DB, keeping" << batch.size() << "write(s) queued:" << databaseName;
+                    queue = batch + queue;  // still in order, and still visible to pendingWrites()
+                    backingOff = true;
+                } else {
+                    qWarning() << "SongSettingsWriter: can't write the DB, dropping" << batch.size() << "write(s):" << databaseName;
+                    dropped += batch.size();
+                }
+            }
+            if (dropped > 0) {
+                report(dropped);
+            }
+            inFlight.clear();
+            if (mirror) {
+                mirrorPending = true;
+            }
+            batchDone.wakeAll();
+        }
+        bool finalPush = mirrorPending;
+        locker.unlock();
+
+        if (finalPush) {
+            mirror->noteLocalChanges();
+            statements.finishAll();
+            mirror->pushToShared(db);  // SquareDesk is quitting (or switching music roots)
+        }
+
+        statements.clear();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGSETTINGSWRITER_H_INCLUDED
+#define SONGSETTINGSWRITER_H_INCLUDED
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <functional>
+
+#include "songsettings.h"
+#include "songsettingsmirror.h"
+
+#define SONGSETTINGS_WRITE_DELAY_MS 250   // how long a write waits for more writes to batch (and coalesce) with
+#define SONGSETTINGS_WRITE_RETRIES 2            // a failed batch is tried this many more times...
+#define SONGSETTINGS_WRITE_RETRY_DELAY_MS 500   // ...this far apart
+#define SONGSETTINGS_WRITE_BACKOFF_MS 10000     // a DB that can't be written at all is tried again after this long
+
+// One write to the SongSettings database, as queued by the SongSettings setters.  Everything that
+//   depends on state at the time of the call (the session, the time, the music root) is captured here,
+//   so that the write means the same thing whenever the writer thread gets around to it.
+struct SongSettingsWrite {
+    enum Kind {
+        SaveSettings,
+        SaveSettingsForSongs,
+        MarkSongPlayed,
+        SetSongMarkers,
+        SetCallTaught,
+        DeleteCallTaught,
+        ClearTaughtCalls,
+        SetCuesheetFontOffset,
+        IndexText,
+        RemoveIndexedText
+    };
+
+    Kind kind;
+    QString key;                // songs.filename (relative to the music root), or cuesheets.relative_path
+    QString name;               // songname (SaveSettings, MarkSongPlayed), or the dance program (taught calls)
+    QString callName;           // SetCallTaught, DeleteCallTaught
+    int sessionID = 0;          // current_session_id at the time of the call
+    int value = 0;              // SetCuesheetFontOffset
+    QDateTime queuedAt;         // UTC; becomes played_on/taught_on
+    SongSetting settings;       // SaveSettings: only the fields that are set get written
+    QStringList keys;           // SaveSettingsForSongs: songs.filename of each song...
+    QList<SongSetting> songSettings;  //   ...and what to write for it (same rules as settings)
+    QMap<float,int> markers;    // SetSongMarkers
+    qint64 fileSize = 0;        // IndexText
+    qint64 fileMtime = 0;       // IndexText, ms since the epoch
+    QString text;               // IndexText
+};
+
+// Write-behind queue for the SongSettings database.  The GUI thread only appends to the queue; this
+//   thread commits the writes in batched transactions on its own connection, so that a slow fsync
+//   (e.g. the database is in a cloud-synced folder) no longer stalls the UI.
+//
+//   Repeated SaveSettings (and SetSongMarkers/SetCuesheetFontOffset) writes for the same key that are
+//   still queued are merged into one (but never across a SaveSettingsForSongs of that key).  Readers on the GUI thread use pendingWrites() to see writes that
+//   have not been committed yet, and flush() waits for everything queued so far.
+//
+//   In local working copy mode (see SongSettingsMirror), this thread also pushes the local DB to the
+//   shared copy, once the writes have been quiet for a while, and one last time when it stops.
+//
+//   A batch that fails is rolled back and tried again.  If one write in it keeps failing, that write is
+//   dropped, and the rest are written without it.  If the DB can't be written at all (locked, full,
+//   offline), the whole batch goes back on the queue until it can, unless a flush() or the destructor
+//   is waiting for it.  Anything that's dropped is reported through report().
+class SongSettingsWriter : public QThread
+{
+public:
+    // all of the writes in one transaction, or (false) none of them, and then *failedWrite is the index
+    //   of the write that failed, or -1 if it was the transaction itself
+    typedef std::function<bool(SqlStatementCache &statements, const QList<SongSettingsWrite> &writes, int *failedWrite)> ApplyFunction;
+    typedef std::function<void(int droppedWrites)> ReportFunction;  // called on the writer thread
+
+    SongSettingsWriter(const QString &databaseName, ApplyFunction apply, ReportFunction report, SongSettingsMirror *mirror = nullptr);
+    ~SongSettingsWriter();                          // flushes, then stops the thread
+
+    bool startWriting();                            // starts the thread: false if it couldn't open the DB (and has stopped)
+    void enqueue(const SongSettingsWrite &write);
+    void flush();                                   // blocks until everything queued so far is committed
+    QList<SongSettingsWrite> pendingWrites();       // not committed yet, oldest first
+    void mirrorSoon();                              // the DB was written some other way (e.g. by the GUI thread)
+
+protected:
+    void run() override;
+
+private:
+    QString databaseName;
+    ApplyFunction apply;
+    ReportFunction report;
+    SongSettingsMirror *mirror;                     // local working copy mode only, else nullptr
+
+    QMutex mutex;
+    QWaitCondition workAvailable;
+    QWaitCondition batchDone;
+    QList<SongSettingsWrite> queue;                 // not picked up by the writer yet
+    QList<SongSettingsWrite> inFlight;              // being written right now
+    bool backingOff;                                // the DB couldn't be written at all, so wait a while
+    QWaitCondition openFinished;
+    bool openDone;                                  // run() has tried to open its connection...
+    bool openOK;                                    // ...and this is how that went
+    bool flushRequested;
+    bool stopRequested;
+    bool mirrorPending;                             // committed, but not pushed to the shared copy yet
+};
+
+#endif /* ifndef SONGSETTINGSWRITER_H_INCLUDED */
@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songtitledelegate.h"
+#include "songlistmodel.h"
+
+#include <QApplication>
+#include <QPainter>
+#include <QAbstractTextDocumentLayout>
+
+// enough for several screenfuls of rows, so scrolling back and forth does not re-layout
+#define TITLEDELEGATE_CACHE_SIZE 512
+
+DarkSongTitleDelegate::DarkSongTitleDelegate(QObject *parent)
+    : QStyledItemDelegate(parent),
+      documentCache(TITLEDELEGATE_CACHE_SIZE)
+{
+}
+
+void DarkSongTitleDelegate::setTitleFont(const QFont &f)
+{
+    titleFont = f;
+    documentCache.clear();
+}
+
+QTextDocument *DarkSongTitleDelegate::documentFor(const QString &html) const
+{
+    QTextDocument *doc = documentCache.object(html);
+    if (doc == nullptr) {
+        doc = new QTextDocument();
+        doc->setDocumentMargin(0);   // same as the QLabel that used to be in this cell
+        doc->setDefaultFont(titleFont);
+        doc->setHtml(html);
+        documentCache.insert(html, doc);  // cache takes ownership
+    }
+    return doc;
+}
+
+void DarkSongTitleDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    opt.text.clear();  // let the style draw only the background/selection, the title is drawn below
+
+    const QWidget *widget = opt.widget;
+    QStyle *style = (widget != nullptr ? widget->style() : QApplication::style());
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    QString html = index.data(kTitleHTMLRole).toString();
+    if (html.isEmpty()) {
+        return;
+    }
+
+    QTextDocument *doc = documentFor(html);
+    QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget);
+
+    QAbstractTextDocumentLayout::PaintContext ctx;
+    ctx.palette.setColor(QPalette::Text, opt.palette.color(QPalette::Text));  // the title and tags have their own colors, this is just a fallback
+
+    painter->save();
+    painter->setClipRect(textRect);
+    painter->translate(textRect.left(), textRect.top() + (textRect.height() - doc->size().height()) / 2.0); // vertically centered, like QLabel
+    doc->documentLayout()->draw(painter, ctx);
+    painter->restore();
+}
+
+QSize DarkSongTitleDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    // NOTE: the vertical header is ResizeToContents, so this is called for EVERY row, visible or not.
+    //   Keep it cheap: no HTML layout here, just the height of one line of the title font.
+    QSize s = QStyledItemDelegate::sizeHint(option, index);
+    s.setHeight(qMax(s.height(), QFontMetrics(titleFont).height()));
+    return s;
+}
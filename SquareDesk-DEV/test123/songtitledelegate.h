@@ -0,0 +1,56 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGTITLEDELEGATE_H_INCLUDED
+#define SONGTITLEDELEGATE_H_INCLUDED
+
+#include <QStyledItemDelegate>
+#include <QTextDocument>
+#include <QCache>
+#include <QFont>
+
+// Paints the Title column of the darkSongTable (title + tag pills, in the song type's color)
+//   directly from the HTML stored in the kTitleHTMLRole of the title item.  This replaces the
+//   per-row QLabel cell widgets, so only the rows that are actually on screen ever get laid out,
+//   and reloading/filtering/sorting the table no longer creates (or destroys) one widget per song.
+class DarkSongTitleDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit DarkSongTitleDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    void setTitleFont(const QFont &f);  // all cached layouts are thrown away when the font changes
+
+private:
+    QTextDocument *documentFor(const QString &html) const;
+
+    QFont titleFont;
+    mutable QCache<QString, QTextDocument> documentCache;  // title HTML -> laid out document (visible rows only)
+};
+
+#endif /* ifndef SONGTITLEDELEGATE_H_INCLUDED */
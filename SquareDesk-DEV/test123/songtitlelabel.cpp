@@ -41,99 +41,6 @@ void SongTitleLabel::mouseDoubleClickEvent(QMouseEvent *e)
 static QRegularExpression title_tags_remover3("(\\&nbsp\\;)*\\<\\/?span( .*?)?>");
 static QRegularExpression spanPrefixRemover3("<span style=\"color:.*\">(.*)</span>", QRegularExpression::InvertedGreedinessOption);
 
-void darkSongTitleLabel::mouseDoubleClickEvent(QMouseEvent *e)
-{
-    mw->darkTitleLabelDoubleClicked(e);
-}
-
-void darkSongTitleLabel::mousePressEvent(QMouseEvent *event)
-{
-    if (event->button() == Qt::LeftButton) {
-        dragStartPosition = event->pos();
-    }
-    QLabel::mousePressEvent(event);
-}
-
-void darkSongTitleLabel::mouseMoveEvent(QMouseEvent *event)
-{
-    // qDebug() << "darkSongTitleLabel::mouseMoveEvent";
-    if (!(event->buttons() & Qt::LeftButton)) {
-        // qDebug() << "return 1";
-        return; // return if not left button down and move
-    }
-    if ((event->pos() - dragStartPosition).manhattanLength() < QApplication::startDragDistance()) {
-        // qDebug() << "return 2";
-        return; // return if haven't moved far enough with L mouse button down
-    }
-
-    QDrag *drag = new QDrag(this);
-    QMimeData *mimeData = new QMimeData;
-
-    // int sourceRow; // = itemAt(dragStartPosition)->row();
-    QString sourceInfo;
-    // int rowNum = 0;
-
-    // qDebug() << "THIS:" << this << this->parent()->parent();
-    // parent is viewport, parent/parent is the QTableWidget
-    // QPoint pos = this->pos();
-    QTableWidget *theTable = qobject_cast<QTableWidget *>(this->parent()->parent());
-    // int row = theTable->indexAt(pos).row()
-    // qDebug() << "INDEX AT ROW: " << row;
-
-    // the source is the darkSongTable --------
-    int sourceRow;
-    int rowNum = 0;
-    for (const auto &mi : theTable->selectionModel()->selectedRows()) {
-        sourceRow = mi.row();  // this is the actual row number of each selected row, overriding the cursor-located row (just pick all selected rows)
-        // qDebug() << "***** darkSongTitleLabel: DRAGGING THIS ROW NUMBER:" << sourceRow;
-
-        QString title = text();
-        title.replace(spanPrefixRemover3, "\\1"); // remove <span style="color:#000000"> and </span> title string coloring
-        int where = title.indexOf(title_tags_remover3);
-        if (where >= 0) {
-            title.truncate(where);
-        }
-        title.replace("&quot;","\"").replace("&amp;","&").replace("&gt;",">").replace("&lt;","<");  // if filename contains HTML encoded chars, put originals back
-
-        if (theTable->isRowHidden(sourceRow)) {
-            // don't allow drag and drop for rows that are not visible!  This only is a problem for darkSongTable, which may have filters applied.
-            // qDebug() << "no drag and drop for you: " << sourceRow << title;
-            continue;
-        } else {
-            // qDebug() << "drag and drop is OK for you: " << sourceRow << title;
-        }
-
-        QString sourceName = "darkSongTable";
-
-        QString sourceTrackName = theTable->item(sourceRow, kLabelCol)->text() + " - " + title; // e.g. "ESP 1234 - Ricochet"
-        QString sourcePitch = theTable->item(sourceRow, kPitchCol)->text();
-        QString sourceTempo = theTable->item(sourceRow, kTempoCol)->text();
-        QString sourcePath = theTable->item(sourceRow, kPathCol)->data(Qt::UserRole).toString();
-
-        QString sourceInfoForThisRow = (rowNum++ > 0 ? "!!&!!" : "") +
-                                       sourceTrackName + "                                    !#!" + // the spaces are so that the visible drag text is just the track name (hack!)
-                                       sourceName + "!#!" +
-                                       sourcePitch + "!#!" +
-                                       sourceTempo + "!#!" +
-                                       sourcePath;
-        sourceInfo.append(sourceInfoForThisRow);
-    }
-
-    // qDebug() << "sourceInfo: " << sourceInfo;  // this has info on ALL the selected items
-
-    mimeData->setText(sourceInfo); // send all the info!
-    drag->setMimeData(mimeData);
-
-    // Set custom drag icon with count badge
-    QPixmap dragPixmap = DragIcon::createDragIcon(rowNum);
-    drag->setPixmap(dragPixmap);
-    drag->setHotSpot(QPoint(dragPixmap.width() / 2, dragPixmap.height() / 2));
-
-    Qt::DropAction dropAction = drag->exec(Qt::CopyAction);
-    Q_UNUSED(dropAction)
-}
-
-
 // ===============================================================
 void darkPaletteSongTitleLabel::mouseDoubleClickEvent(QMouseEvent *e)
 {
@@ -225,37 +132,6 @@ void darkPaletteSongTitleLabel::mouseMoveEvent(QMouseEvent *event)
 
 #define ENABLESTRIKETHROUGH 0
 
-// true = song was used recently (Recent == "*")
-void darkSongTitleLabel::setSongUsed(bool b) {
-    return; // DISABLED FOR NOW
-#if ENABLESTRIKETHROUGH==1
-    // qDebug() << "setSongUsed: current text =" << this->text() << songUsed << b;
-
-    // QString strikethrough("text-decoration:line-through;background-color:#00FF00;");
-    QString strikethrough("text-decoration:line-through;text-decoration-color: #00FF00;");
-
-    if (songUsed & !b) {
-        // turning off used marker
-        // typical text: <span style="color: #a364dc;text-decoration:line-through;background-color:#00FF00;">Gobs Of Guitars</span>
-        // typical text with tags: <span style="color: #a364dc;text-decoration:line-through;background-color:#00FF00;">Tango Burlesque</span>&nbsp;&nbsp;<span style="background-color:#ffffff; color: #c64434;"> NEW </span>
-        QString currentText = this->text();
-        currentText.replace(strikethrough, "");
-        this->setText(currentText); // revised text, WITHOUT strikethrough
-    } else if (!songUsed & b) {
-        // turning on used marker
-        // typical text: <span style="color: #a364dc;">Gobs Of Guitars</span>
-        // typical text with tags: <span style="color: #a364dc;">Tango Burlesque</span>&nbsp;&nbsp;<span style="background-color:#ffffff; color: #c64434;"> NEW </span>
-        QString currentText = this->text();
-        int endOfFirstTag = currentText.indexOf("\">"); // end of the title's span
-        if (endOfFirstTag != -1) {
-            currentText.insert(endOfFirstTag, strikethrough);
-        }
-        this->setText(currentText); // revised text, WITH strikethrough
-    }
-#endif
-    songUsed = b;
-}
-
 // true = song was used recently (Recent == "*")
 void darkPaletteSongTitleLabel::setSongUsed(bool b) {
 #if ENABLESTRIKETHROUGH==1
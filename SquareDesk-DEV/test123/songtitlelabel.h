@@ -46,21 +46,6 @@ public:
     QString textColor;  // saved so that we can restore it when not selected
 };
 
-// ================================================================
-class darkSongTitleLabel : public QLabel {
-private:
-    MainWindow *mw;
-    QPoint dragStartPosition;
-    bool songUsed;
-public:
-    darkSongTitleLabel(MainWindow *mw) : QLabel(), mw(mw), songUsed(false) {}
-    void mouseDoubleClickEvent(QMouseEvent *) override;
-    void mousePressEvent(QMouseEvent *event) override;
-    void mouseMoveEvent(QMouseEvent *event) override;
-    void setSongUsed(bool b);  // true = song was used recently (Recent == "*")
-    QString textColor;  // saved so that we can restore it when not selected
-};
-
 // ================================================================
 // when a MyTableWidget is in a palette slot, we need different handling for double-clicking
 class darkPaletteSongTitleLabel : public QLabel {
@@ -0,0 +1,67 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "sqlstatementcache.h"
+
+#include <QtSql/QSqlError>
+#include <QDebug>
+
+SqlStatementCache::SqlStatementCache(const QSqlDatabase &db) :
+    db(db)
+{
+}
+
+QSqlQuery &SqlStatementCache::prepared(const QString &sql)
+{
+    auto found = queries.constFind(sql);
+    if (found != queries.constEnd())
+    {
+        (*found)->finish();  // let go of the last result set (and the read lock that goes with it)
+        return **found;
+    }
+
+    QSharedPointer<QSqlQuery> q = QSharedPointer<QSqlQuery>::create(db);
+    q->setForwardOnly(true);  // nobody here ever scrolls backwards, and this way SQLite doesn't have to buffer
+    if (!q->prepare(sql))
+    {
+        qDebug() << "SqlStatementCache: prepare failed: " << sql << ":" << q->lastError();
+    }
+    queries.insert(sql, q);
+    return *q;
+}
+
+void SqlStatementCache::finishAll()
+{
+    for (auto &q : queries)
+    {
+        q->finish();
+    }
+}
+
+void SqlStatementCache::clear()
+{
+    queries.clear();
+    db = QSqlDatabase();  // our copy of the connection would also keep removeDatabase() from removing it
+}
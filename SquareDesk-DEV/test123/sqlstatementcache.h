@@ -0,0 +1,57 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SQLSTATEMENTCACHE_H_INCLUDED
+#define SQLSTATEMENTCACHE_H_INCLUDED
+
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QHash>
+#include <QSharedPointer>
+
+// Keeps queries prepared for the life of one database connection, so that the hot ones are parsed
+//   and planned by SQLite once, rather than once per call.  A QSqlQuery may only be used on the thread
+//   that owns its connection, so each connection (the GUI thread's, the write-behind thread's) gets its
+//   own cache.  clear() it (which also lets go of the connection) before the connection is removed.
+class SqlStatementCache
+{
+public:
+    explicit SqlStatementCache(const QSqlDatabase &db = QSqlDatabase());
+
+    QSqlDatabase &database() { return db; }
+
+    // prepare()d the first time this SQL is seen; after that, the same query is finish()ed and handed
+    //   back (the values bound last time are still there, so bind them all again).  The reference stays
+    //   valid until clear(), even when other statements are added in the meantime.
+    QSqlQuery &prepared(const QString &sql);
+    void finishAll();   // e.g. before a VACUUM, which refuses to run while any statement is still active
+    void clear();
+
+private:
+    QSqlDatabase db;
+    QHash<QString, QSharedPointer<QSqlQuery>> queries;
+};
+
+#endif /* ifndef SQLSTATEMENTCACHE_H_INCLUDED */
@@ -405,6 +405,12 @@ void svgWaveformSlider::SetDefaultIntroOutroPositions(bool tempoIsBPM, double es
             double defaultSingerLengthInBeats = 16 + (64 * 7) + 8;  // 16 beat intro + 7 64-beat sections + 8 beat tag
             introPosition = (16 / defaultSingerLengthInBeats);           // 0.0 - 1.0
             outroPosition = (1.0 - 8 / defaultSingerLengthInBeats );     // 0.0 - 1.0
+        } else if (songLength_sec > 0.0 && songEnd_sec > songStart_sec) {
+            // take a guess on a patter or xtra or unknown, when we don't know the BPM,
+            //   but we DO know where the music starts and ends (leading/trailing silence is skipped)
+            double musicLength_sec = songEnd_sec - songStart_sec;
+            introPosition = (songStart_sec + 0.033 * musicLength_sec)/songLength_sec;  // 0.0 - 1.0
+            outroPosition = (songEnd_sec   - 0.033 * musicLength_sec)/songLength_sec;  // 0.0 - 1.0
         } else {
             // take a guess on a patter or xtra or unknown, when we don't know the BPM
             introPosition = 0.033;         // 0.0 - 1.0
@@ -147,8 +147,23 @@ SOURCES += main.cpp\
     sdformationutils.cpp \
     mainwindow_sd.cpp \
     songtitlelabel.cpp \
+    songtitledelegate.cpp \
     sdsequencecalllabel.cpp \
     perftimer.cpp \
+    songrecordstore.cpp \
+    songsearchindex.cpp \
+    inotifywatcher.cpp \
+    paralleldirwalker.cpp \
+    cuesheetmatchindex.cpp \
+    editdistance.cpp \
+    filenameparser.cpp \
+    cuesheetmetadatacache.cpp \
+    songsettingswriter.cpp \
+    sqlstatementcache.cpp \
+    songsettingsmirror.cpp \
+    songplayhistoryquery.cpp \
+    waveformpyramid.cpp \
+    audiofingerprint.cpp \
     tablewidgettimingitem.cpp \
     sdredostack.cpp \
     makeflashdrivewizard.cpp \
@@ -240,8 +255,23 @@ HEADERS  += mainwindow.h \
     sdinterface.h \
     sdformationutils.h \
     songtitlelabel.h \
+    songtitledelegate.h \
     sdsequencecalllabel.h \
     perftimer.h \
+    songrecordstore.h \
+    songsearchindex.h \
+    inotifywatcher.h \
+    paralleldirwalker.h \
+    cuesheetmatchindex.h \
+    editdistance.h \
+    filenameparser.h \
+    cuesheetmetadatacache.h \
+    songsettingswriter.h \
+    sqlstatementcache.h \
+    songsettingsmirror.h \
+    songplayhistoryquery.h \
+    waveformpyramid.h \
+    audiofingerprint.h \
     tablewidgettimingitem.h \
     sdredostack.h \
     makeflashdrivewizard.h \
@@ -314,7 +344,7 @@ INCLUDEPATH += $$PWD/../taglib/taglib/mpeg/id3v2
 INCLUDEPATH += $$PWD/ $$PWD/../local/include $$(HOME)/local/include $$(HOME)/local/include/soundtouch 
 DEPENDPATH += $$PWD/ $$PWD/../local/include
 LIBS += -L$$PWD/../sdlib -lsdlib
-LIBS += -L$$(HOME)/local/lib -lkfr_dsp -lkfr_io
+LIBS += -L$$(HOME)/local/lib -lkfr_dsp -lkfr_dft -lkfr_io
 
 QT += multimedia httpserver concurrent
 
@@ -442,7 +472,7 @@ macx {
     PRE_TARGETDEPS += $$libkfr.target
 
     INCLUDEPATH += $$PWD/../kfr/include
-    LIBS += -L$$KFR_LIB -lkfr_dsp_neon64 -lkfr_io
+    LIBS += -L$$KFR_LIB -lkfr_dsp_neon64 -lkfr_dft_neon64 -lkfr_io
 }
 
 macx {
@@ -0,0 +1,162 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "waveformpyramid.h"
+#include <algorithm>
+#include <cmath>
+
+// Disable unused parameter warnings (kfr has a lot of them)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+
+#include <kfr/base.hpp>
+
+#pragma GCC diagnostic pop
+
+WaveformPyramid::WaveformPyramid() : frames(0)
+{
+}
+
+void WaveformPyramid::clear()
+{
+    frames = 0;
+    pyramid.clear();
+}
+
+bool WaveformPyramid::isEmpty() const
+{
+    return(pyramid.empty());
+}
+
+unsigned int WaveformPyramid::totalFrames() const
+{
+    return(frames);
+}
+
+unsigned int WaveformPyramid::levels() const
+{
+    return(static_cast<unsigned int>(pyramid.size()));
+}
+
+unsigned int WaveformPyramid::framesPerBin(unsigned int level) const
+{
+    return(WAVEFORMPYRAMID_BASE_FRAMES << level);
+}
+
+void WaveformPyramid::build(const float *interleavedLR, unsigned int totalFrames)
+{
+    clear();
+    if (interleavedLR == nullptr || totalFrames == 0) {
+        return;
+    }
+    frames = totalFrames;
+
+    // LEVEL 0: the only pass over the audio itself.  Each chunk is 2KB (fits in L1), and kfr's
+    //   minof/maxof/sumsqr are SIMD, so the three reductions cost about the same as one.
+    //   L and R are deliberately not separated: the waveform is drawn mono.
+    unsigned int numBins = (totalFrames + WAVEFORMPYRAMID_BASE_FRAMES - 1) / WAVEFORMPYRAMID_BASE_FRAMES;  // last one may be partial
+    std::vector<Bin> level0(numBins);
+    for (unsigned int b = 0; b < numBins; b++) {
+        unsigned int firstFrame = b * WAVEFORMPYRAMID_BASE_FRAMES;
+        unsigned int n = std::min((unsigned int)WAVEFORMPYRAMID_BASE_FRAMES, totalFrames - firstFrame);
+        auto chunk = kfr::make_univector(interleavedLR + 2 * firstFrame, 2 * n);
+        level0[b].min        = kfr::minof(chunk);
+        level0[b].max        = kfr::maxof(chunk);
+        level0[b].meanSquare = kfr::sumsqr(chunk) / (2 * n);
+    }
+    pyramid.push_back(std::move(level0));
+
+    // LEVELS 1..N: pairwise reductions of the level below, until there's just one bin
+    while (pyramid.back().size() > 1) {
+        const std::vector<Bin> &below = pyramid.back();
+        std::vector<Bin> above((below.size() + 1) / 2);
+        for (size_t i = 0; i < above.size(); i++) {
+            const Bin &a = below[2*i];
+            if (2*i + 1 < below.size()) {
+                const Bin &b = below[2*i + 1];
+                above[i].min        = std::min(a.min, b.min);
+                above[i].max        = std::max(a.max, b.max);
+                above[i].meanSquare = 0.5f * (a.meanSquare + b.meanSquare);
+            } else {
+                above[i] = a;  // odd one out at the end
+            }
+        }
+        pyramid.push_back(std::move(above));
+    }
+
+    // qDebug() << "WaveformPyramid::build:" << totalFrames << "frames," << pyramid.size() << "levels";
+}
+
+void WaveformPyramid::query(unsigned int fromFrame, unsigned int toFrame, unsigned int numBins,
+                            float *mins, float *maxs, float *rms) const
+{
+    if (numBins == 0) {
+        return;
+    }
+
+    toFrame = std::min(toFrame, frames);
+    if (pyramid.empty() || toFrame <= fromFrame) {
+        // nothing there, so it's silence
+        for (unsigned int i = 0; i < numBins; i++) {
+            if (mins) mins[i] = 0.0f;
+            if (maxs) maxs[i] = 0.0f;
+            if (rms)  rms[i]  = 0.0f;
+        }
+        return;
+    }
+
+    // pick the coarsest level whose bins are no wider than one output window (level 0 if zoomed way in)
+    double framesPerOutputBin = (double)(toFrame - fromFrame) / numBins;
+    unsigned int level = 0;
+    while (level + 1 < pyramid.size() && framesPerBin(level + 1) <= framesPerOutputBin) {
+        level++;
+    }
+    const std::vector<Bin> &bins = pyramid[level];
+    const double binFrames = framesPerBin(level);
+
+    for (unsigned int i = 0; i < numBins; i++) {
+        double windowStart = fromFrame + i * framesPerOutputBin;
+        double windowEnd   = windowStart + framesPerOutputBin;
+
+        size_t first = static_cast<size_t>(windowStart / binFrames);
+        size_t last  = static_cast<size_t>(std::ceil(windowEnd / binFrames));  // exclusive
+        first = std::min(first, bins.size() - 1);
+        last  = std::max(first + 1, std::min(last, bins.size()));  // always at least one bin
+
+        float mn = bins[first].min;
+        float mx = bins[first].max;
+        float ms = 0.0f;
+        for (size_t b = first; b < last; b++) {  // usually 1-3 bins
+            mn = std::min(mn, bins[b].min);
+            mx = std::max(mx, bins[b].max);
+            ms += bins[b].meanSquare;
+        }
+
+        if (mins) mins[i] = mn;
+        if (maxs) maxs[i] = mx;
+        if (rms)  rms[i]  = std::sqrt(ms / (last - first));
+    }
+}
@@ -0,0 +1,66 @@
+/****************************************************************************
+**
+** Copyright (C) 2016-2025 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef WAVEFORMPYRAMID_H_INCLUDED
+#define WAVEFORMPYRAMID_H_INCLUDED
+
+#include <vector>
+
+// Multi-resolution (mipmapped) min/max/RMS summary of a decoded song, for drawing waveforms at any zoom level.
+//   Level 0 has one bin per WAVEFORMPYRAMID_BASE_FRAMES frames, and each level above it has half as many bins
+//   (each covering twice as many frames), all the way up to a single bin for the whole song.
+//   Built once per song (one pass over the audio, then pairwise reductions), about 2x the size of level 0.
+#define WAVEFORMPYRAMID_BASE_FRAMES 256
+
+class WaveformPyramid {
+public:
+    WaveformPyramid();
+
+    void build(const float *interleavedLR, unsigned int totalFrames);  // stereo, interleaved floats
+    void clear();
+
+    bool isEmpty() const;
+    unsigned int totalFrames() const;
+    unsigned int levels() const;
+    unsigned int framesPerBin(unsigned int level) const;
+
+    // splits [fromFrame, toFrame) into numBins equal windows, and returns the min, max, and RMS of each
+    //   (L and R combined).  Each window is summarized from at most a few bins of the best level,
+    //   so the cost is proportional to numBins, regardless of zoom level.  Any output can be nullptr.
+    void query(unsigned int fromFrame, unsigned int toFrame, unsigned int numBins,
+               float *mins, float *maxs, float *rms) const;
+
+private:
+    struct Bin {
+        float min;
+        float max;
+        float meanSquare;  // kept as mean square (not RMS), so that bins can be combined by averaging
+    };
+
+    unsigned int frames;
+    std::vector< std::vector<Bin> > pyramid;  // pyramid[k] has WAVEFORMPYRAMID_BASE_FRAMES << k frames per bin
+};
+
+#endif /* ifndef WAVEFORMPYRAMID_H_INCLUDED */